@@ -0,0 +1,208 @@
+/*
+ * Bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> allocCount(0);
+std::atomic<uint64_t> allocBytes(0);
+const void* volatile sink;
+
+void* CountedAlloc(std::size_t size)
+{
+	allocCount.fetch_add(1, std::memory_order_relaxed);
+	allocBytes.fetch_add(size, std::memory_order_relaxed);
+	void* p = std::malloc(size == 0 ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	try { return CountedAlloc(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace circuit {
+
+namespace bench {
+
+std::vector<SKernel>& GetKernels()
+{
+	static std::vector<SKernel> kernels;
+	return kernels;
+}
+
+uint64_t GetAllocCount()
+{
+	return allocCount.load(std::memory_order_relaxed);
+}
+
+uint64_t GetAllocBytes()
+{
+	return allocBytes.load(std::memory_order_relaxed);
+}
+
+void DoNotOptimize(const void* p)
+{
+	sink = p;
+}
+
+static SResult Run(const SKernel& kernel, const SMapConfig& map, double minTimeNs)
+{
+	using clock = std::chrono::steady_clock;
+
+	Op op = kernel.setup(map);
+	op();  // warm-up, also triggers lazy allocations
+
+	// Grow batch until it takes long enough to trust the clock
+	uint64_t batch = 1;
+	uint64_t iterations = 0;
+	double elapsed = 0.0;
+	const uint64_t count0 = GetAllocCount();
+	const uint64_t bytes0 = GetAllocBytes();
+	while (elapsed < minTimeNs) {
+		const clock::time_point t0 = clock::now();
+		for (uint64_t i = 0; i < batch; ++i) {
+			op();
+		}
+		elapsed += std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+		iterations += batch;
+		if (elapsed < minTimeNs / 10) {
+			batch *= 2;
+		}
+	}
+
+	SResult result;
+	result.name = kernel.name;
+	result.mapSize = map.mapSize;
+	result.iterations = iterations;
+	result.nsPerOp = elapsed / iterations;
+	result.allocsPerOp = double(GetAllocCount() - count0) / iterations;
+	result.bytesPerOp = double(GetAllocBytes() - bytes0) / iterations;
+	return result;
+}
+
+static void WriteJSON(std::ostream& os, const std::vector<SResult>& results)
+{
+	os << "[\n";
+	for (unsigned i = 0; i < results.size(); ++i) {
+		const SResult& r = results[i];
+		os << "  {\"name\": \"" << r.name << "\", \"map\": " << r.mapSize << ", \"iterations\": " << r.iterations
+		   << ", \"ns_per_op\": " << r.nsPerOp << ", \"allocs_per_op\": " << r.allocsPerOp
+		   << ", \"bytes_per_op\": " << r.bytesPerOp << "}" << ((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+	os << "]\n";
+}
+
+static void Usage(const char* self)
+{
+	std::cout << "Usage: " << self << " [options]\n"
+			"  --sizes 8,16,24    map sizes in map units (512 elmos)\n"
+			"  --filter <str>     run kernels whose name contains <str>\n"
+			"  --min-time <ms>    measurement time per kernel and map size\n"
+			"  --seed <n>         synthetic map seed\n"
+			"  --json <file>      also write results as JSON\n"
+			"  --list             list kernels\n";
+}
+
+} // namespace bench
+
+} // namespace circuit
+
+int main(int argc, char* argv[])
+{
+	using namespace circuit::bench;
+
+	std::vector<int> sizes = {8, 12, 16, 24};
+	std::string filter;
+	double minTimeMs = 200.0;
+	unsigned seed = 1;
+	std::string jsonPath;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		const bool hasValue = (i + 1 < argc);
+		if ((strcmp(arg, "--sizes") == 0) && hasValue) {
+			sizes.clear();
+			std::stringstream ss(argv[++i]);
+			std::string item;
+			while (std::getline(ss, item, ',')) {
+				sizes.push_back(std::max(std::atoi(item.c_str()), 1));
+			}
+		} else if ((strcmp(arg, "--filter") == 0) && hasValue) {
+			filter = argv[++i];
+		} else if ((strcmp(arg, "--min-time") == 0) && hasValue) {
+			minTimeMs = std::atof(argv[++i]);
+		} else if ((strcmp(arg, "--seed") == 0) && hasValue) {
+			seed = std::atoi(argv[++i]);
+		} else if ((strcmp(arg, "--json") == 0) && hasValue) {
+			jsonPath = argv[++i];
+		} else if (strcmp(arg, "--list") == 0) {
+			for (const SKernel& kernel : GetKernels()) {
+				std::cout << kernel.name << "\n";
+			}
+			return 0;
+		} else {
+			Usage(argv[0]);
+			return (strcmp(arg, "--help") == 0) ? 0 : 1;
+		}
+	}
+
+	std::vector<SResult> results;
+	std::cout << std::left << std::setw(32) << "kernel" << std::right << std::setw(5) << "map"
+			  << std::setw(12) << "iterations" << std::setw(16) << "ns/op"
+			  << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << "\n";
+	for (const SKernel& kernel : GetKernels()) {
+		if (!filter.empty() && (std::string(kernel.name).find(filter) == std::string::npos)) {
+			continue;
+		}
+		for (int size : sizes) {
+			// 1 map unit = 512 elmos = 64 squares
+			SMapConfig map = {size, size * 64, size * 64, seed};
+			SResult r = Run(kernel, map, minTimeMs * 1e6);
+			std::cout << std::left << std::setw(32) << r.name << std::right << std::setw(5) << r.mapSize
+					  << std::setw(12) << r.iterations << std::setw(16) << std::fixed << std::setprecision(1) << r.nsPerOp
+					  << std::setw(12) << std::setprecision(2) << r.allocsPerOp
+					  << std::setw(14) << std::setprecision(1) << r.bytesPerOp << std::endl;
+			results.push_back(r);
+		}
+	}
+
+	if (!jsonPath.empty()) {
+		std::ofstream ofs(jsonPath);
+		if (!ofs) {
+			std::cerr << "Can't write " << jsonPath << "\n";
+			return 1;
+		}
+		WriteJSON(ofs, results);
+	}
+	return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Bench.h
+ *
+ *  Minimal harness of circuit_bench: kernel registry, timing and allocation accounting
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef BENCH_BENCH_H_
+#define BENCH_BENCH_H_
+
+#include <functional>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace circuit {
+
+namespace bench {
+
+/*
+ * Synthetic map parameters, sizes follow engine's conventions
+ */
+struct SMapConfig {
+	int mapSize;  // in map units (512 elmos), as in "12x12" map
+	int width;  // in SQUARE_SIZE
+	int height;  // in SQUARE_SIZE
+	unsigned seed;
+};
+
+/*
+ * Kernel is created per map size: setup runs untimed once, returned op is timed.
+ */
+using Op = std::function<void ()>;
+using Setup = std::function<Op (const SMapConfig& map)>;
+
+struct SKernel {
+	const char* name;
+	Setup setup;
+};
+
+struct SResult {
+	std::string name;
+	int mapSize;
+	uint64_t iterations;
+	double nsPerOp;
+	double allocsPerOp;
+	double bytesPerOp;
+};
+
+std::vector<SKernel>& GetKernels();
+
+struct SRegistrar {
+	SRegistrar(const char* name, Setup setup) { GetKernels().push_back({name, setup}); }
+};
+
+/*
+ * Allocation counters of the global operator new, cumulative
+ */
+uint64_t GetAllocCount();
+uint64_t GetAllocBytes();
+
+/*
+ * Prevent optimizer from dropping results
+ */
+void DoNotOptimize(const void* p);
+
+} // namespace bench
+
+} // namespace circuit
+
+#define BENCH_CONCAT_(a, b)	a##b
+#define BENCH_CONCAT(a, b)	BENCH_CONCAT_(a, b)
+#define BENCH_KERNEL(name, ...)	static circuit::bench::SRegistrar BENCH_CONCAT(benchRegistrar, __LINE__)(name, __VA_ARGS__)
+
+#endif // BENCH_BENCH_H_
@@ -0,0 +1,1394 @@
+/*
+ * Kernels.cpp
+ *
+ *  Pure-compute kernels of the AI driven by synthetic maps
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Bench.h"
+
+#include "resource/MetalData.h"
+#include "terrain/BlockRectangle.h"
+#include "terrain/HavenIndex.h"
+#include "terrain/HeightDiff.h"
+#include "terrain/MicroPather.h"
+#include "terrain/TerrainData.h"
+#include "terrain/ThreatPyramid.h"
+#include "terrain/ThreatRaster.h"
+#include "util/math/EncloseCircle.h"
+#include "util/math/HierarchCluster.h"
+#include "util/math/KMeansCluster.h"
+#include "util/math/RagMatrix.h"
+#include "unit/EnemyEvents.h"
+#include "util/Defines.h"
+#include "util/MultiQueue.h"
+#include "util/RingQueue.h"
+#include "util/SaveState.h"
+#include "util/SaveStream.h"
+#include "util/SlotMap.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+namespace circuit {
+
+namespace bench {
+
+using namespace springai;
+
+#define SECTOR_SIZE		64  // elmos, CTerrainData::convertStoP
+#define SEARCH_RADIUS	1000.f
+
+/*
+ * Deterministic terrain at sector resolution: rolling hills, ridges and lakes.
+ * Layout of layers matches CThreatMap / CPathFinder: sectors with 1-cell edges.
+ */
+struct SSyntheticMap {
+	SSyntheticMap(const SMapConfig& cfg) : rng(cfg.seed) {
+		sectorX = cfg.width * SQUARE_SIZE / SECTOR_SIZE;
+		sectorZ = cfg.height * SQUARE_SIZE / SECTOR_SIZE;
+		width = sectorX + 2;
+		height = sectorZ + 2;
+
+		std::uniform_real_distribution<float> phase(0.f, 6.2832f);
+		const float p0 = phase(rng), p1 = phase(rng), p2 = phase(rng);
+		elevation.resize(sectorX * sectorZ);
+		for (int z = 0; z < sectorZ; ++z) {
+			for (int x = 0; x < sectorX; ++x) {
+				elevation[z * sectorX + x] = 120.f * std::sin(x * 0.11f + p0) * std::cos(z * 0.07f + p1)
+										   + 60.f * std::sin((x + z) * 0.23f + p2) + 40.f;
+			}
+		}
+
+		canMove.assign(width * height, false);
+		for (int z = 1; z < height - 1; ++z) {
+			for (int x = 1; x < width - 1; ++x) {
+				const float e = Elevation(x, z);
+				const float dx = std::fabs(e - Elevation(std::min(x + 1, width - 2), z));
+				const float dz = std::fabs(e - Elevation(x, std::min(z + 1, height - 2)));
+				canMove[z * width + x] = (e > -40.f) && (std::max(dx, dz) < 45.f);
+			}
+		}
+	}
+
+	// @param x, z  layer coordinates (with edges)
+	float Elevation(int x, int z) const { return elevation[(z - 1) * sectorX + (x - 1)]; }
+	bool IsWater(int x, int z) const { return Elevation(x, z) < 0.f; }
+
+	int RandomPassable() {
+		std::uniform_int_distribution<int> dist(0, width * height - 1);
+		int idx;
+		do {
+			idx = dist(rng);
+		} while (!canMove[idx]);
+		return idx;
+	}
+
+	std::vector<AIFloat3> RandomPositions(int count) {
+		std::uniform_real_distribution<float> distX(0.f, sectorX * SECTOR_SIZE);
+		std::uniform_real_distribution<float> distZ(0.f, sectorZ * SECTOR_SIZE);
+		std::vector<AIFloat3> result(count);
+		for (AIFloat3& pos : result) {
+			pos = AIFloat3(distX(rng), 0.f, distZ(rng));
+		}
+		return result;
+	}
+
+	std::mt19937 rng;
+	int sectorX, sectorZ;
+	int width, height;
+	std::vector<float> elevation;
+	std::vector<char> canMove;  // not vector<bool>, MicroPather wants bool*
+};
+
+class CBenchGraph: public NSMicroPather::Graph {
+};
+
+/*
+ * Path finding on threat-weighted move map, same layout as CPathFinder
+ */
+static Op SetupPather(const SMapConfig& cfg, int radius)
+{
+	auto map = std::make_shared<SSyntheticMap>(cfg);
+	auto graph = std::make_shared<CBenchGraph>();
+	auto pather = std::make_shared<NSMicroPather::CMicroPather>(graph.get(), map->width, map->height);
+
+	auto costs = std::make_shared<std::vector<float>>(map->width * map->height, THREAT_BASE);
+	std::uniform_int_distribution<int> distX(1, map->width - 2), distZ(1, map->height - 2);
+	for (int i = 0; i < cfg.mapSize * 4; ++i) {
+		raster::AddThreat(&(*costs)[0], map->width, map->height, distX(map->rng), distZ(map->rng), 12, 50.f);
+	}
+	pather->SetMapData(reinterpret_cast<bool*>(&map->canMove[0]), &(*costs)[0]);
+
+	auto queries = std::make_shared<std::vector<std::pair<int, int>>>();
+	for (int i = 0; i < 64; ++i) {
+		queries->emplace_back(map->RandomPassable(), map->RandomPassable());
+	}
+	auto path = std::make_shared<std::vector<void*>>();
+	auto counter = std::make_shared<unsigned>(0);
+
+	return [map, graph, pather, costs, queries, path, counter, radius]() {
+		const std::pair<int, int>& q = (*queries)[(*counter)++ % queries->size()];
+		float cost;
+		path->clear();
+		if (radius > 0) {
+			pather->FindBestPathToPointOnRadius((void*)(intptr_t)q.first, (void*)(intptr_t)q.second, path.get(), &cost, radius);
+		} else {
+			pather->Solve((void*)(intptr_t)q.first, (void*)(intptr_t)q.second, path.get(), &cost);
+		}
+		DoNotOptimize(path->data());
+	};
+}
+BENCH_KERNEL("pather/solve", [](const SMapConfig& cfg) { return SetupPather(cfg, 0); });
+BENCH_KERNEL("pather/radius", [](const SMapConfig& cfg) { return SetupPather(cfg, 8); });
+
+/*
+ * Path to the closest of many targets, goals are rings around targets as in
+ * CPathFinder::FindBestPath. Correctness against Dijkstra is test/MicroPatherTest.cpp.
+ */
+struct SAnyGoalBench {
+	struct SQuery {
+		int start;
+		std::vector<void*> endNodes;
+	};
+
+	SAnyGoalBench(const SMapConfig& cfg, int numTargets) : map(cfg) {
+		costs.assign(map.width * map.height, THREAT_BASE);
+		std::uniform_int_distribution<int> distX(1, map.width - 2), distZ(1, map.height - 2);
+		for (int i = 0; i < cfg.mapSize * 4; ++i) {
+			raster::AddThreat(&costs[0], map.width, map.height, distX(map.rng), distZ(map.rng), 12, 50.f);
+		}
+		for (int i = 0; i < NUM_QUERIES; ++i) {
+			SQuery q;
+			q.start = map.RandomPassable();
+			for (int j = 0; j < numTargets; ++j) {
+				AddRing(map.RandomPassable(), q.endNodes);
+			}
+			queries.push_back(q);
+		}
+	}
+
+	void AddRing(int target, std::vector<void*>& outNodes) const {
+		const int tz = target / map.width, tx = target % map.width;
+		for (int z = -RING_RADIUS; z <= RING_RADIUS; ++z) {
+			for (int x = -RING_RADIUS; x <= RING_RADIUS; ++x) {
+				const int r = int(std::round(std::sqrt(float(x * x + z * z))));
+				const int sx = tx + x, sz = tz + z;
+				if ((r == RING_RADIUS) && (sx > 0) && (sx < map.width - 1) && (sz > 0) && (sz < map.height - 1)) {
+					outNodes.push_back((void*)(intptr_t)(sz * map.width + sx));
+				}
+			}
+		}
+	}
+
+	static constexpr int NUM_QUERIES = 32;
+	static constexpr int RING_RADIUS = 4;  // weapon range or build distance in path nodes
+
+	SSyntheticMap map;
+	std::vector<float> costs;
+	std::vector<SQuery> queries;
+	std::vector<void*> endNodes;  // scratch, pather fixes nodes in place
+	unsigned counter = 0;
+};
+
+static Op SetupAnyGoal(const SMapConfig& cfg, const char* name, int numTargets)
+{
+	auto ab = std::make_shared<SAnyGoalBench>(cfg, numTargets);
+	auto graph = std::make_shared<CBenchGraph>();
+	auto pather = std::make_shared<NSMicroPather::CMicroPather>(graph.get(), ab->map.width, ab->map.height);
+	pather->SetMapData(reinterpret_cast<bool*>(&ab->map.canMove[0]), &ab->costs[0]);
+	auto path = std::make_shared<std::vector<void*>>();
+
+	unsigned expanded = 0;
+	for (const SAnyGoalBench::SQuery& q : ab->queries) {
+		ab->endNodes = q.endNodes;
+		float cost;
+		const unsigned count = pather->GetExpandCount();
+		pather->FindBestPathToAnyGivenPoint((void*)(intptr_t)q.start, ab->endNodes, path.get(), &cost);
+		expanded += pather->GetExpandCount() - count;
+	}
+	std::cerr << name << ": " << cfg.mapSize << "x" << cfg.mapSize << " expanded " << expanded / ab->queries.size()
+			  << " nodes per query\n";
+
+	return [ab, graph, pather, path]() {
+		const SAnyGoalBench::SQuery& q = ab->queries[ab->counter++ % ab->queries.size()];
+		ab->endNodes = q.endNodes;
+		float cost;
+		pather->FindBestPathToAnyGivenPoint((void*)(intptr_t)q.start, ab->endNodes, path.get(), &cost);
+		DoNotOptimize(path->data());
+	};
+}
+BENCH_KERNEL("pather/any_goal/mex", [](const SMapConfig& cfg) { return SetupAnyGoal(cfg, "pather/any_goal/mex", 24); });
+BENCH_KERNEL("pather/any_goal/defence", [](const SMapConfig& cfg) { return SetupAnyGoal(cfg, "pather/any_goal/defence", 4); });
+
+/*
+ * Threat rasterizers, one op = enemy enters and leaves threat map
+ */
+struct SThreatBench {
+	SThreatBench(const SMapConfig& cfg) : map(cfg) {
+		layerA.resize(map.width * map.height, THREAT_BASE);
+		layerB.resize(map.width * map.height, THREAT_BASE);
+		std::uniform_int_distribution<int> distX(1, map.width - 2), distZ(1, map.height - 2);
+		for (int i = 0; i < 256; ++i) {
+			enemies.push_back({distX(map.rng), distZ(map.rng)});
+		}
+	}
+	SSyntheticMap map;
+	std::vector<float> layerA;
+	std::vector<float> layerB;
+	std::vector<std::pair<int, int>> enemies;
+	unsigned counter = 0;
+};
+
+BENCH_KERNEL("threat/air", [](const SMapConfig& cfg) -> Op {
+	auto tb = std::make_shared<SThreatBench>(cfg);
+	return [tb]() {
+		const std::pair<int, int>& e = tb->enemies[tb->counter++ % tb->enemies.size()];
+		raster::AddThreat(&tb->layerA[0], tb->map.width, tb->map.height, e.first, e.second, 16, 100.f);
+		raster::DelThreat(&tb->layerA[0], tb->map.width, tb->map.height, e.first, e.second, 16, 100.f);
+	};
+});
+
+BENCH_KERNEL("threat/amph", [](const SMapConfig& cfg) -> Op {
+	auto tb = std::make_shared<SThreatBench>(cfg);
+	return [tb]() {
+		const std::pair<int, int>& e = tb->enemies[tb->counter++ % tb->enemies.size()];
+		const SSyntheticMap& map = tb->map;
+		auto isWater = [&map](int x, int z) { return map.IsWater(x, z); };
+		auto isShallow = [&map](int x, int z) { return map.Elevation(x, z) >= -SQUARE_SIZE * 5; };
+		raster::AddAmph(&tb->layerA[0], &tb->layerB[0], map.width, map.height, e.first, e.second, 16, 10, 100.f, isWater, isShallow);
+		raster::DelAmph(&tb->layerA[0], &tb->layerB[0], map.width, map.height, e.first, e.second, 16, 10, 100.f, isWater, isShallow);
+	};
+});
+
+BENCH_KERNEL("threat/cloak+shield", [](const SMapConfig& cfg) -> Op {
+	auto tb = std::make_shared<SThreatBench>(cfg);
+	return [tb]() {
+		const std::pair<int, int>& e = tb->enemies[tb->counter++ % tb->enemies.size()];
+		raster::AddCloak(&tb->layerA[0], tb->map.width, tb->map.height, e.first, e.second, 6);
+		raster::AddShield(&tb->layerB[0], tb->map.width, tb->map.height, e.first, e.second, 6, 3600.f);
+		raster::DelCloak(&tb->layerA[0], tb->map.width, tb->map.height, e.first, e.second, 6);
+		raster::DelShield(&tb->layerB[0], tb->map.width, tb->map.height, e.first, e.second, 6, 3600.f);
+	};
+});
+
+/*
+ * Region and corridor threat queries: 8 armies, per op one enemy moves (Del+Add of its circle),
+ * then 64 rectangles up to 48x48 (metal cluster safety), 64 circles up to radius 32 (retreat)
+ * and 64 segments across the map (path walk) are asked. "scan" reads layer cell by cell,
+ * "pyramid" is CThreatPyramid with lazy refresh of dirty tiles inside the op; segments are
+ * the same grid walk in both. Randomized test against brute force is test/ThreatPyramidTest.cpp.
+ */
+struct SPyramidBench {
+	struct SEnemy {
+		int x, z, range;
+		float threat;
+	};
+	struct SQuery {
+		int x1, z1, x2, z2;  // rectangle
+		float cx, cz, radius;  // circle
+		float sx1, sz1, sx2, sz2;  // segment
+	};
+
+	SPyramidBench(const SMapConfig& cfg) : tb(cfg) {
+		SSyntheticMap& map = tb.map;
+		std::uniform_int_distribution<int> range(2, 12), spread(-8, 8);
+		std::uniform_real_distribution<float> threat(1.f, 200.f);
+		// 8 armies of 32 units
+		for (unsigned i = 0; i < tb.enemies.size(); ++i) {
+			const std::pair<int, int>& army = tb.enemies[i / 32];
+			const int x = std::max(1, std::min(map.width - 2, army.first + spread(map.rng)));
+			const int z = std::max(1, std::min(map.height - 2, army.second + spread(map.rng)));
+			enemies.push_back({x, z, range(map.rng), threat(map.rng)});
+			Add(enemies.back());
+		}
+		pyramid.Init(&tb.layerA[0], map.width, map.height);
+		for (int i = 0; i < 64; ++i) {
+			queries.push_back(RandomQuery());
+		}
+	}
+
+	void Add(const SEnemy& e) {
+		raster::AddThreat(&tb.layerA[0], tb.map.width, tb.map.height, e.x, e.z, e.range, e.threat);
+		pyramid.MarkDirty(e.x - e.range, e.z - e.range, e.x + e.range + 1, e.z + e.range + 1);
+	}
+	void Del(const SEnemy& e) {
+		raster::DelThreat(&tb.layerA[0], tb.map.width, tb.map.height, e.x, e.z, e.range, e.threat);
+		pyramid.MarkDirty(e.x - e.range, e.z - e.range, e.x + e.range + 1, e.z + e.range + 1);
+	}
+	void Move() {
+		SEnemy& e = enemies[tb.counter++ % enemies.size()];
+		Del(e);
+		e.x = std::max(1, std::min(tb.map.width - 2, e.x + int(tb.counter % 3) - 1));
+		Add(e);
+	}
+
+	SQuery RandomQuery() {
+		const int w = tb.map.width, h = tb.map.height;
+		std::uniform_int_distribution<int> x(0, w - 1), z(0, h - 1), size(1, 48);
+		std::uniform_real_distribution<float> fx(0.f, w - 0.001f), fz(0.f, h - 0.001f), radius(0.f, 32.f);
+		SQuery q;
+		q.x1 = x(tb.map.rng);
+		q.z1 = z(tb.map.rng);
+		q.x2 = q.x1 + size(tb.map.rng);  // may cross the border
+		q.z2 = q.z1 + size(tb.map.rng);
+		q.cx = fx(tb.map.rng);
+		q.cz = fz(tb.map.rng);
+		q.radius = radius(tb.map.rng);
+		q.sx1 = fx(tb.map.rng);
+		q.sz1 = fz(tb.map.rng);
+		q.sx2 = fx(tb.map.rng);  // path leg across the map
+		q.sz2 = fz(tb.map.rng);
+		return q;
+	}
+
+	float ScanMaxInRect(int x1, int z1, int x2, int z2) const {
+		float best = std::numeric_limits<float>::lowest();
+		for (int z = std::max(z1, 0); z <= std::min(z2, tb.map.height - 1); ++z) {
+			for (int x = std::max(x1, 0); x <= std::min(x2, tb.map.width - 1); ++x) {
+				best = std::max(best, tb.layerA[z * tb.map.width + x]);
+			}
+		}
+		return best;
+	}
+	float ScanSumInCircle(float cx, float cz, float radius, int& outCount) const {
+		float sum = 0.f;
+		outCount = 0;
+		for (int z = std::max(0, int(cz - radius) - 1); z <= std::min(tb.map.height - 1, int(cz + radius) + 1); ++z) {
+			for (int x = std::max(0, int(cx - radius) - 1); x <= std::min(tb.map.width - 1, int(cx + radius) + 1); ++x) {
+				if (SQUARE(x + 0.5f - cx) + SQUARE(z + 0.5f - cz) <= SQUARE(radius)) {
+					sum += tb.layerA[z * tb.map.width + x];
+					++outCount;
+				}
+			}
+		}
+		return sum;
+	}
+	// Grid walk of Amanatides & Woo
+	float ScanMaxAlongSegment(float x1, float z1, float x2, float z2) const {
+		int x = int(x1), z = int(z1);
+		const int xEnd = int(x2), zEnd = int(z2);
+		const float dx = x2 - x1, dz = z2 - z1;
+		const int stepX = (dx > 0.f) ? 1 : -1, stepZ = (dz > 0.f) ? 1 : -1;
+		const float inf = std::numeric_limits<float>::infinity();
+		const float deltaX = (dx != 0.f) ? 1.f / std::fabs(dx) : inf;
+		const float deltaZ = (dz != 0.f) ? 1.f / std::fabs(dz) : inf;
+		float tMaxX = (dx != 0.f) ? ((dx > 0.f) ? (x + 1 - x1) : (x1 - x)) * deltaX : inf;
+		float tMaxZ = (dz != 0.f) ? ((dz > 0.f) ? (z + 1 - z1) : (z1 - z)) * deltaZ : inf;
+		float best = tb.layerA[z * tb.map.width + x];
+		for (int steps = std::abs(xEnd - x) + std::abs(zEnd - z); steps > 0; --steps) {
+			if (tMaxX < tMaxZ) {
+				x += stepX;
+				tMaxX += deltaX;
+			} else {
+				z += stepZ;
+				tMaxZ += deltaZ;
+			}
+			best = std::max(best, tb.layerA[z * tb.map.width + x]);
+		}
+		return best;
+	}
+
+	SThreatBench tb;
+	std::vector<SEnemy> enemies;
+	std::vector<SQuery> queries;
+	CThreatPyramid pyramid;
+};
+
+static Op SetupPyramid(const SMapConfig& cfg, bool isPyramid)
+{
+	auto pb = std::make_shared<SPyramidBench>(cfg);
+	if (isPyramid) {
+		return [pb]() {
+			pb->Move();
+			float result = 0.f;
+			int count;
+			for (const SPyramidBench::SQuery& q : pb->queries) {
+				result += pb->pyramid.GetMaxInRect(q.x1, q.z1, q.x2, q.z2);
+				result += pb->pyramid.GetSumInCircle(q.cx, q.cz, q.radius, count);
+				result += pb->pyramid.GetMaxAlongSegment(q.sx1, q.sz1, q.sx2, q.sz2);
+			}
+			DoNotOptimize(&result);
+		};
+	}
+	return [pb]() {
+		pb->Move();
+		float result = 0.f;
+		int count;
+		for (const SPyramidBench::SQuery& q : pb->queries) {
+			result += pb->ScanMaxInRect(q.x1, q.z1, q.x2, q.z2);
+			result += pb->ScanSumInCircle(q.cx, q.cz, q.radius, count);
+			result += pb->ScanMaxAlongSegment(q.sx1, q.sz1, q.sx2, q.sz2);
+		}
+		DoNotOptimize(&result);
+	};
+}
+BENCH_KERNEL("threat/query_scan", [](const SMapConfig& cfg) { return SetupPyramid(cfg, false); });
+BENCH_KERNEL("threat/query_pyramid", [](const SMapConfig& cfg) { return SetupPyramid(cfg, true); });
+
+/*
+ * Build site search by mask, South facing variant of CTerrainManager::FindBuildSiteByMask
+ * without engine's IsPossibleToBuildAt probe.
+ */
+struct SSiteBench {
+	struct SSearchOffset {
+		int dx, dy;
+		int qdist;
+	};
+
+	SSiteBench(const SMapConfig& cfg)
+		: rng(cfg.seed)
+		, mask(int2(0, 0), int2(10, 10), int2(4, 4), SBlockingMap::StructType::ENGY_MID, STRUCT_BIT(NONE))
+	{
+		blockingMap.columns = cfg.width / 2;
+		blockingMap.rows = cfg.height / 2;
+		SBlockingMap::SBlockCell cell = {0};
+		blockingMap.grid.resize(blockingMap.columns * blockingMap.rows, cell);
+		blockingMap.columnsLow = cfg.width / (GRID_RATIO_LOW * 2);
+		blockingMap.rowsLow = cfg.height / (GRID_RATIO_LOW * 2);
+		SBlockingMap::SBlockCellLow cellLow = {0};
+		blockingMap.gridLow.resize(blockingMap.columnsLow * blockingMap.rowsLow, cellLow);
+
+		// Dense base: ~1 structure per 12x12 cells
+		std::uniform_int_distribution<int> distX(0, blockingMap.columns - 8), distZ(0, blockingMap.rows - 8);
+		const int numStructs = blockingMap.columns * blockingMap.rows / 144;
+		for (int i = 0; i < numStructs; ++i) {
+			const int x0 = distX(rng), z0 = distZ(rng);
+			for (int z = z0; z < z0 + 8; ++z) {
+				for (int x = x0; x < x0 + 8; ++x) {
+					if ((x >= x0 + 2) && (x < x0 + 6) && (z >= z0 + 2) && (z < z0 + 6)) {
+						blockingMap.AddStruct(x, z, SBlockingMap::StructType::ENGY_LOW, STRUCT_BIT(ALL));
+					} else {
+						blockingMap.AddBlocker(x, z, SBlockingMap::StructType::ENGY_LOW);
+					}
+				}
+			}
+		}
+
+		endr = int(SEARCH_RADIUS / (SQUARE_SIZE * 2));
+		for (int y = 0; y < endr * 2; y++) {
+			for (int x = 0; x < endr * 2; x++) {
+				offsets.push_back({x - endr, y - endr, SQUARE(x - endr) + SQUARE(y - endr)});
+			}
+		}
+		std::sort(offsets.begin(), offsets.end(), [](const SSearchOffset& a, const SSearchOffset& b) {
+			return a.qdist < b.qdist;
+		});
+
+		std::uniform_real_distribution<float> posX(0.f, cfg.width * SQUARE_SIZE), posZ(0.f, cfg.height * SQUARE_SIZE);
+		for (int i = 0; i < 64; ++i) {
+			probes.push_back(AIFloat3(posX(rng), 0.f, posZ(rng)));
+		}
+	}
+
+	bool IsOpen(const int2& m1, const int2& m2, const int2& om, int notIgnore, SBlockingMap::StructMask structMask) {
+		for (int x = m1.x, xm = om.x; x < m2.x; x++, xm++) {
+			for (int z = m1.y, zm = om.y; z < m2.y; z++, zm++) {
+				switch (mask.GetTypeSouth(xm, zm)) {
+					case IBlockMask::BlockType::BLOCKED: {
+						if (blockingMap.IsStruct(x, z, structMask)) {
+							return false;
+						}
+						break;
+					}
+					case IBlockMask::BlockType::STRUCT: {
+						if (blockingMap.IsBlocked(x, z, notIgnore)) {
+							return false;
+						}
+						break;
+					}
+					case IBlockMask::BlockType::OPEN: { break; }
+				}
+			}
+		}
+		return true;
+	}
+
+	AIFloat3 FindSite(const AIFloat3& pos) {
+		const int xmsize = mask.GetXSize();
+		const int zmsize = mask.GetZSize();
+		const int xssize = 4;
+		const int zssize = 4;
+
+		int2 structCorner;
+		structCorner.x = int(pos.x / (SQUARE_SIZE * 2)) - (xssize / 2);
+		structCorner.y = int(pos.z / (SQUARE_SIZE * 2)) - (zssize / 2);
+		const int2& offset = mask.GetStructOffset(UNIT_FACING_SOUTH);
+		int2 maskCorner = structCorner - offset;
+		const int notIgnore = ~mask.GetIgnoreMask();
+		SBlockingMap::StructMask structMask = SBlockingMap::GetStructMask(mask.GetStructType());
+
+		for (int so = 0; so < endr * endr * 4; so++) {
+			int2 s1(structCorner.x + offsets[so].dx, structCorner.y + offsets[so].dy);
+			int2 s2(          s1.x + xssize,                   s1.y + zssize);
+			if (!blockingMap.IsInBounds(s1, s2)) {
+				continue;
+			}
+			int2 m1(maskCorner.x + offsets[so].dx, maskCorner.y + offsets[so].dy);
+			int2 m2(        m1.x + xmsize,                 m1.y + zmsize);
+			int2 om = m1;
+			blockingMap.Bound(m1, m2);
+			om = m1 - om;
+			if (IsOpen(m1, m2, om, notIgnore, structMask)) {
+				return AIFloat3((s1.x + s2.x) * SQUARE_SIZE, 0.f, (s1.y + s2.y) * SQUARE_SIZE);
+			}
+		}
+		return -RgtVector;
+	}
+
+	std::mt19937 rng;
+	SBlockingMap blockingMap;
+	CBlockRectangle mask;
+	int endr;
+	std::vector<SSearchOffset> offsets;
+	std::vector<AIFloat3> probes;
+	unsigned counter = 0;
+};
+
+BENCH_KERNEL("blocking/site_search", [](const SMapConfig& cfg) -> Op {
+	auto sb = std::make_shared<SSiteBench>(cfg);
+	return [sb]() {
+		AIFloat3 site = sb->FindSite(sb->probes[sb->counter++ % sb->probes.size()]);
+		DoNotOptimize(&site);
+	};
+});
+
+/*
+ * Metal spot clusterization, ~4 spots per map unit of width
+ */
+static std::vector<AIFloat3> MetalSpots(SSyntheticMap& map, int mapSize)
+{
+	return map.RandomPositions(mapSize * 4);
+}
+
+BENCH_KERNEL("cluster/hierarch", [](const SMapConfig& cfg) -> Op {
+	SSyntheticMap map(cfg);
+	std::vector<AIFloat3> spots = MetalSpots(map, cfg.mapSize);
+	const int nrows = spots.size();
+	auto distmatrix = std::make_shared<CRagMatrix>(nrows);
+	for (int i = 1; i < nrows; i++) {
+		for (int j = 0; j < i; j++) {
+			(*distmatrix)(i, j) = spots[i].distance2D(spots[j]);
+		}
+	}
+	return [distmatrix]() {
+		// Clusterize consumes the matrix
+		CRagMatrix matrix(*distmatrix);
+		CHierarchCluster clust;
+		const CHierarchCluster::Clusters& iclusters = clust.Clusterize(matrix, 400.f);
+		DoNotOptimize(iclusters.data());
+	};
+});
+
+BENCH_KERNEL("cluster/kmeans", [](const SMapConfig& cfg) -> Op {
+	auto map = std::make_shared<SSyntheticMap>(cfg);
+	auto units = std::make_shared<std::vector<AIFloat3>>(map->RandomPositions(cfg.mapSize * 25));
+	auto kmeans = std::make_shared<CKMeansCluster>((*units)[0]);
+	const int k = cfg.mapSize / 2 + 1;
+	return [units, kmeans, k]() {
+		kmeans->Iteration(*units, k);
+		DoNotOptimize(kmeans->GetMeans().data());
+	};
+});
+
+BENCH_KERNEL("math/enclose_circle", [](const SMapConfig& cfg) -> Op {
+	SSyntheticMap map(cfg);
+	auto points = std::make_shared<std::vector<AIFloat3>>(map.RandomPositions(cfg.mapSize * 16));
+	auto circle = std::make_shared<CEncloseCircle>();
+	return [points, circle]() {
+		circle->MakeCircle(*points);
+		DoNotOptimize(&circle->GetCenter());
+	};
+});
+
+BENCH_KERNEL("metal/triangulate", [](const SMapConfig& cfg) -> Op {
+	SSyntheticMap map(cfg);
+	auto spots = std::make_shared<std::vector<AIFloat3>>(MetalSpots(map, cfg.mapSize));
+	auto coords = std::make_shared<std::vector<double>>();
+	for (const AIFloat3& pos : *spots) {
+		coords->push_back(pos.x);
+		coords->push_back(pos.z);
+	}
+	return [spots, coords]() {
+		std::size_t numEdges = 0;
+		CMetalData::TriangulateGraph(*coords, [&spots](std::size_t A, std::size_t B) -> float {
+			return (*spots)[A].distance((*spots)[B]);
+		}, [&numEdges](std::size_t A, std::size_t B) {
+			++numEdges;
+		});
+		DoNotOptimize(&numEdges);
+	};
+});
+
+/*
+ * CCircuitAI::Save sections through real state serializers of CThreatMap/CEnemyUnit,
+ * CMetalManager, CEnergyGrid, CEconomyManager and CMilitaryManager; 2000 remembered enemies.
+ * Op is the THREAT load path: section table scan plus decode of records and layers.
+ * Budget is one frame at 30 fps, 33 ms. Round-trip test is test/SaveStateTest.cpp.
+ */
+struct SSaveBench {
+	SSaveBench(const SMapConfig& cfg) : rng(cfg.seed), dist(0.f, 100.f) {
+		threat.width = cfg.width * SQUARE_SIZE / SECTOR_SIZE + 2;
+		threat.height = cfg.height * SQUARE_SIZE / SECTOR_SIZE + 2;
+		threat.squareSize = SECTOR_SIZE;
+		for (std::vector<float>* layer : {&threat.airThreat, &threat.surfThreat, &threat.amphThreat, &threat.cloakThreat, &threat.shield}) {
+			layer->resize(threat.width * threat.height);
+			for (float& v : *layer) {
+				v = dist(rng);
+			}
+		}
+		threat.hostileUnits.resize(1600);
+		threat.peaceUnits.resize(400);
+		int unitId = 0;
+		for (std::vector<SEnemyState>* units : {&threat.hostileUnits, &threat.peaceUnits}) {
+			for (SEnemyState& e : *units) {
+				e.unitId = unitId++;
+				e.defId = (unitId % 7 == 0) ? -1 : unitId % 300;
+				e.lastSeen = unitId * 3;
+				e.cost = dist(rng);
+				e.pos = RandPos(cfg);
+				e.newPos = RandPos(cfg);
+				e.threat = dist(rng);
+				for (int& r : e.range) {
+					r = rng() % 1000;
+				}
+				e.losStatus = rng() % 16;
+			}
+		}
+
+		metal.markFrame = 1234;
+		for (int i = 0; i < 50; ++i) {
+			metal.markedMexes.push_back({i * 2, i});
+		}
+		for (int i = 0; i < 20; ++i) {
+			metal.clusters.push_back({unsigned(rng() % 5), unsigned(rng() % 5)});
+		}
+
+		energy.isValid.resize(60);
+		for (uint8_t& v : energy.isValid) {
+			v = rng() % 2;
+		}
+
+		economy.metalIncomes.resize(5);
+		economy.energyIncomes.resize(5);
+		for (unsigned i = 0; i < 5; ++i) {
+			economy.metalIncomes[i] = dist(rng);
+			economy.energyIncomes[i] = dist(rng);
+		}
+		economy.indexRes = 3;
+		economy.metalIncome = dist(rng);
+		economy.energyIncome = dist(rng);
+		economy.metalProduced = dist(rng);
+		economy.metalUsed = dist(rng);
+		economy.lastFacFrame = 900;
+
+		for (SMilitaryState::SEnemyInfo& info : military.enemyInfos) {
+			info = {dist(rng), dist(rng)};
+		}
+		military.enemyMobileCost = dist(rng);
+		military.mobileThreat = dist(rng);
+		military.staticThreat = dist(rng);
+		military.enemyPos = RandPos(cfg);
+		military.scoutIdx = 7;
+		military.defenceIdx = 11;
+		military.groups.resize(30);
+		for (SMilitaryState::SGroup& group : military.groups) {
+			group.units.resize(1 + rng() % 20);
+			for (int& id : group.units) {
+				id = rng() % unitId;
+			}
+			group.pos = RandPos(cfg);
+			for (float& c : group.roleCosts) {
+				c = dist(rng);
+			}
+			group.cost = dist(rng);
+			group.threat = dist(rng);
+		}
+
+		std::ostringstream buf(std::ios::binary);
+		CSaveWriter writer(buf);
+		writer.Write(SaveSection::THREAT, 1, [this](std::ostream& os) { threat.Save(os); });
+		writer.Write(SaveSection::METAL, 1, [this](std::ostream& os) { metal.Save(os); });
+		writer.Write(SaveSection::ENERGY, 1, [this](std::ostream& os) { energy.Save(os); });
+		writer.Write(SaveSection::ECONOMY, 1, [this](std::ostream& os) { economy.Save(os); });
+		writer.Write(SaveSection::MILITARY, 1, [this](std::ostream& os) { military.Save(os); });
+		data = buf.str();
+	}
+
+	AIFloat3 RandPos(const SMapConfig& cfg) {
+		return AIFloat3(dist(rng) * cfg.width, dist(rng), dist(rng) * cfg.height);
+	}
+
+	template<typename T> bool Load(SaveSection id, T& outState) const {
+		std::istringstream is(data, std::ios::binary);
+		CSaveReader reader(is);
+		return reader.IsValid() && reader.Read(id, 1, [&outState](std::istream& is) {
+			return outState.Load(is);
+		});
+	}
+
+	std::mt19937 rng;
+	std::uniform_real_distribution<float> dist;
+	SThreatState threat;
+	SMetalState metal;
+	SEnergyState energy;
+	SEconomyState economy;
+	SMilitaryState military;
+	std::string data;
+};
+
+BENCH_KERNEL("save/threat_load", [](const SMapConfig& cfg) -> Op {
+	auto sb = std::make_shared<SSaveBench>(cfg);
+	return [sb]() {
+		SThreatState state;
+		sb->Load(SaveSection::THREAT, state);
+		DoNotOptimize(state.airThreat.data());
+	};
+});
+
+/*
+ * CCircuitAI::teamUnits / enemyUnits workload: 5000 alive units of 32000 engine ids.
+ * One op is a round of 1000 erases and 1000 inserts (net zero, table returns to the
+ * same set of ids), 20000 lookups and 20 full scans, interleaved as events and
+ * update loops would do it.
+ */
+struct SUnitsBench {
+	struct SUnit {
+		int id;
+		float cost;
+	};
+	enum class Cmd: char {LOOKUP, ERASE, INSERT, SCAN};
+	struct SCmd {
+		Cmd cmd;
+		int id;
+	};
+
+	SUnitsBench(const SMapConfig& cfg) : units(MAX_UNITS) {
+		std::mt19937 rng(cfg.seed);
+		std::vector<int> ids(MAX_UNITS);
+		for (int i = 0; i < MAX_UNITS; ++i) {
+			ids[i] = i;
+			units[i] = {i, float(i % 97)};
+		}
+		std::shuffle(ids.begin(), ids.end(), rng);
+		alive.assign(ids.begin(), ids.begin() + NUM_ALIVE);
+		const std::vector<int> dead(ids.begin() + NUM_ALIVE, ids.begin() + NUM_ALIVE + NUM_CHURN);
+		const std::vector<int> gone(alive.begin(), alive.begin() + NUM_CHURN);
+
+		std::uniform_int_distribution<int> anyAlive(NUM_CHURN, NUM_ALIVE - 1);  // never churned
+		auto addLookups = [this, &anyAlive, &rng](int count) {
+			for (int i = 0; i < count; ++i) {
+				script.push_back({Cmd::LOOKUP, alive[anyAlive(rng)]});
+			}
+		};
+		// 1st half: gone -> dead, 2nd half: dead -> gone
+		for (int half = 0; half < 2; ++half) {
+			const std::vector<int>& out = (half == 0) ? gone : dead;
+			const std::vector<int>& in = (half == 0) ? dead : gone;
+			for (int i = 0; i < NUM_CHURN; ++i) {
+				script.push_back({Cmd::ERASE, out[i]});
+				addLookups(10);
+				script.push_back({Cmd::INSERT, in[i]});
+				addLookups(10);
+				if (i % 100 == 0) {
+					script.push_back({Cmd::SCAN, -1});
+				}
+			}
+		}
+	}
+
+	template<typename Table> void Fill(Table& table) {
+		for (int id : alive) {
+			table[id] = &units[id];
+		}
+	}
+
+	template<typename Table> float Run(Table& table) {
+		float sum = 0.f;
+		for (const SCmd& c : script) {
+			switch (c.cmd) {
+				case Cmd::LOOKUP: {
+					auto it = table.find(c.id);
+					sum += (it != table.end()) ? it->second->cost : 0.f;
+				} break;
+				case Cmd::ERASE: {
+					table.erase(c.id);
+				} break;
+				case Cmd::INSERT: {
+					table[c.id] = &units[c.id];
+				} break;
+				case Cmd::SCAN: {
+					for (auto& kv : table) {
+						sum += kv.second->cost;
+					}
+				} break;
+			}
+		}
+		return sum;
+	}
+
+	static constexpr int MAX_UNITS = 32000;
+	static constexpr int NUM_ALIVE = 5000;
+	static constexpr int NUM_CHURN = 1000;
+
+	std::vector<SUnit> units;
+	std::vector<int> alive;
+	std::vector<SCmd> script;
+};
+
+template<typename Table> static Op SetupUnits(const SMapConfig& cfg)
+{
+	auto ub = std::make_shared<SUnitsBench>(cfg);
+	auto table = std::make_shared<Table>();
+	ub->Fill(*table);
+	return [ub, table]() {
+		float sum = ub->Run(*table);
+		DoNotOptimize(&sum);
+	};
+}
+BENCH_KERNEL("units/std_map", SetupUnits<std::map<int, SUnitsBench::SUnit*>>);
+BENCH_KERNEL("units/slot_map", SetupUnits<CSlotMap<int, SUnitsBench::SUnit*>>);
+
+/*
+ * Event storm at the edge of LOS and radar: 2000 enemies, every frame 600 of them
+ * flicker through 4-12 engine events (enter/leave LOS and radar, damage),
+ * and 50 enemies out of LOS blink into LOS and out within the frame.
+ * Fake enemy and integer threat grid follow CThreatMap rules: entering LOS or radar
+ * and damage in LOS re-stamp the enemy's threat disk, leaving only clears the flag.
+ * One op is 30 frames and the threat update of the second; "direct" handles each event,
+ * "coalesced" records them into CEnemyEvents and applies net transitions once per frame
+ * as CCircuitAI::Update does. Equivalence test is test/EnemyEventsTest.cpp.
+ */
+struct SEventsBench {
+	struct SEnemy {
+		enum Mask: uint8_t {LOS = 0x01, RADAR = 0x02, STAMPED = 0x04};
+
+		int GetId() const { return id; }
+		bool IsInLOS() const { return status & LOS; }
+		bool IsInRadar() const { return status & RADAR; }
+
+		int id;
+		int x, z;  // in threat squares
+		uint8_t status;
+		int stampX, stampZ;
+	};
+	enum class Evt: char {ENTER_LOS, LEAVE_LOS, ENTER_RADAR, LEAVE_RADAR, DAMAGED};
+	struct SEvent {
+		Evt evt;
+		int id;
+	};
+	struct SFrame {
+		std::vector<std::pair<int, int>> moves;  // new position of each enemy
+		std::vector<SEvent> events;
+	};
+	struct SState {
+		std::vector<SEnemy> enemies;
+		std::vector<int> grid;
+	};
+
+	SEventsBench(const SMapConfig& cfg)
+		: width(cfg.width / 8)
+		, height(cfg.height / 8)
+	{
+		std::mt19937 rng(cfg.seed);
+		std::uniform_int_distribution<int> posX(0, width - 1), posZ(0, height - 1);
+		init.enemies.resize(NUM_ENEMIES);
+		for (int i = 0; i < NUM_ENEMIES; ++i) {
+			init.enemies[i] = {i, posX(rng), posZ(rng), 0, 0, 0};
+		}
+		init.grid.assign(width * height, 0);
+
+		// Engine side truth: events are always consistent with it
+		std::vector<uint8_t> truth(NUM_ENEMIES, 0);
+		std::uniform_int_distribution<int> anyEnemy(0, NUM_ENEMIES - 1), numEvents(4, 12), anyEvt(0, 4);
+		std::uniform_int_distribution<int> step(-1, 1);
+		std::vector<std::pair<int, int>> pos(NUM_ENEMIES);
+		for (int i = 0; i < NUM_ENEMIES; ++i) {
+			pos[i] = {init.enemies[i].x, init.enemies[i].z};
+		}
+		frames.resize(NUM_FRAMES);
+		for (SFrame& frame : frames) {
+			for (std::pair<int, int>& p : pos) {
+				p.first = std::min(std::max(p.first + step(rng), 0), width - 1);
+				p.second = std::min(std::max(p.second + step(rng), 0), height - 1);
+			}
+			frame.moves = pos;
+			for (int i = 0; i < NUM_FLICKER; ++i) {
+				const int id = anyEnemy(rng);
+				for (int n = numEvents(rng); n > 0; --n) {
+					uint8_t& t = truth[id];
+					switch (anyEvt(rng)) {
+						case 0: frame.events.push_back({(t & SEnemy::LOS) ? Evt::LEAVE_LOS : Evt::ENTER_LOS, id});
+							t ^= SEnemy::LOS; break;
+						case 1: frame.events.push_back({(t & SEnemy::RADAR) ? Evt::LEAVE_RADAR : Evt::ENTER_RADAR, id});
+							t ^= SEnemy::RADAR; break;
+						default: frame.events.push_back({Evt::DAMAGED, id}); break;
+					}
+				}
+			}
+			for (int i = 0; i < NUM_BLINK; ++i) {
+				const int id = anyEnemy(rng);
+				if (!(truth[id] & SEnemy::LOS)) {
+					frame.events.push_back({Evt::ENTER_LOS, id});
+					frame.events.push_back({Evt::LEAVE_LOS, id});
+				}
+			}
+		}
+	}
+
+	void Stamp(SState& state, SEnemy& e, int sign) {
+		const int x0 = e.stampX;
+		const int z0 = e.stampZ;
+		for (int z = std::max(z0 - RANGE, 0); z <= std::min(z0 + RANGE, height - 1); ++z) {
+			for (int x = std::max(x0 - RANGE, 0); x <= std::min(x0 + RANGE, width - 1); ++x) {
+				if ((x - x0) * (x - x0) + (z - z0) * (z - z0) <= RANGE * RANGE) {
+					state.grid[z * width + x] += sign * (RANGE + 1);
+				}
+			}
+		}
+	}
+	void Restamp(SState& state, SEnemy& e) {
+		if (e.status & SEnemy::STAMPED) {
+			Stamp(state, e, -1);
+		}
+		e.stampX = e.x;
+		e.stampZ = e.z;
+		e.status |= SEnemy::STAMPED;
+		Stamp(state, e, +1);
+	}
+	// CThreatMap::Update: moving units in radar or LOS re-stamped at new position
+	void Update(SState& state) {
+		for (SEnemy& e : state.enemies) {
+			if ((e.status & SEnemy::STAMPED) && (e.status & (SEnemy::LOS | SEnemy::RADAR))) {
+				Restamp(state, e);
+			}
+		}
+	}
+
+	// CThreatMap counterparts
+	void EnterLOS(SState& state, SEnemy& e) { e.status |= SEnemy::LOS; Restamp(state, e); }
+	void LeaveLOS(SState& state, SEnemy& e) { e.status &= ~SEnemy::LOS; }
+	void EnterRadar(SState& state, SEnemy& e) {
+		const bool wasInLOS = e.IsInLOS();
+		e.status |= SEnemy::RADAR;
+		if (!wasInLOS) {
+			Restamp(state, e);
+		}
+	}
+	void LeaveRadar(SState& state, SEnemy& e) { e.status &= ~SEnemy::RADAR; }
+	void Damaged(SState& state, SEnemy& e) {  // new threat, same position
+		if (e.IsInLOS() && (e.status & SEnemy::STAMPED)) {
+			Stamp(state, e, -1);
+			Stamp(state, e, +1);
+		}
+	}
+
+	void Move(SState& state, const SFrame& frame) {
+		for (int i = 0; i < NUM_ENEMIES; ++i) {
+			state.enemies[i].x = frame.moves[i].first;
+			state.enemies[i].z = frame.moves[i].second;
+		}
+	}
+
+	void RunDirect(SState& state) {
+		for (const SFrame& frame : frames) {
+			Move(state, frame);
+			for (const SEvent& ev : frame.events) {
+				SEnemy& e = state.enemies[ev.id];
+				switch (ev.evt) {
+					case Evt::ENTER_LOS: EnterLOS(state, e); break;
+					case Evt::LEAVE_LOS: LeaveLOS(state, e); break;
+					case Evt::ENTER_RADAR: EnterRadar(state, e); break;
+					case Evt::LEAVE_RADAR: LeaveRadar(state, e); break;
+					case Evt::DAMAGED: Damaged(state, e); break;
+				}
+			}
+		}
+		Update(state);
+	}
+
+	// CCircuitAI::ApplyEnemyEvents
+	void Apply(SState& state, const CEnemyEvents<SEnemy>::SRecord& r) {
+		using Events = CEnemyEvents<SEnemy>;
+		if (r.enemy == nullptr) {
+			return;
+		}
+		SEnemy& e = *r.enemy;
+		if (r.IsLeave(Events::LOS)) { LeaveLOS(state, e); }
+		if (r.IsEnter(Events::RADAR)) { EnterRadar(state, e); }
+		if (r.IsEnter(Events::LOS)) { EnterLOS(state, e); }
+		if (r.IsLeave(Events::RADAR)) { LeaveRadar(state, e); }
+		if (r.isDamaged) { Damaged(state, e); }
+	}
+
+	// CCircuitAI::EnemyEnterLOS, CCircuitAI::EnemyEnterRadar
+	void RunCoalesced(SState& state, CEnemyEvents<SEnemy>& events) {
+		using Events = CEnemyEvents<SEnemy>;
+		for (const SFrame& frame : frames) {
+			Move(state, frame);
+			for (const SEvent& ev : frame.events) {
+				SEnemy* e = &state.enemies[ev.id];
+				if ((ev.evt == Evt::ENTER_LOS) && !events.IsSighted(e)) {
+					Apply(state, events.Take(e, true));
+					EnterLOS(state, *e);
+					continue;
+				}
+				if ((ev.evt == Evt::ENTER_RADAR) && !events.IsSighted(e)) {
+					Apply(state, events.Take(e, !(events.GetState(e) & Events::LOS)));
+					EnterRadar(state, *e);
+					continue;
+				}
+				switch (ev.evt) {
+					case Evt::ENTER_LOS: events.EnterLOS(e); break;
+					case Evt::LEAVE_LOS: events.LeaveLOS(e); break;
+					case Evt::ENTER_RADAR: events.EnterRadar(e); break;
+					case Evt::LEAVE_RADAR: events.LeaveRadar(e); break;
+					case Evt::DAMAGED: events.Damaged(e); break;
+				}
+			}
+			for (const CEnemyEvents<SEnemy>::SRecord& r : events.GetRecords()) {
+				Apply(state, r);
+			}
+			events.Clear();
+		}
+		Update(state);
+	}
+
+	static constexpr int NUM_ENEMIES = 2000;
+	static constexpr int NUM_FLICKER = 600;
+	static constexpr int NUM_BLINK = 50;
+	static constexpr int NUM_FRAMES = 30;
+	static constexpr int RANGE = 6;  // in threat squares
+
+	int width, height;
+	SState init;
+	std::vector<SFrame> frames;
+};
+
+static Op SetupEvents(const SMapConfig& cfg, bool isCoalesced)
+{
+	auto eb = std::make_shared<SEventsBench>(cfg);
+	auto events = std::make_shared<CEnemyEvents<SEventsBench::SEnemy>>();
+	auto state = std::make_shared<SEventsBench::SState>();
+	return [eb, events, state, isCoalesced]() {
+		*state = eb->init;
+		if (isCoalesced) {
+			eb->RunCoalesced(*state, *events);
+		} else {
+			eb->RunDirect(*state);
+		}
+		DoNotOptimize(state->grid.data());
+	};
+}
+BENCH_KERNEL("events/direct", [](const SMapConfig& cfg) { return SetupEvents(cfg, false); });
+BENCH_KERNEL("events/coalesced", [](const SMapConfig& cfg) { return SetupEvents(cfg, true); });
+
+/*
+ * CScheduler::workTasks traffic: 8 AI threads push parallel tasks, worker pops them.
+ * Item mimics WorkTask: 2 shared_ptr and owner id. One op moves 8 * 20000 items.
+ * MPMC stress test is test/RingQueueTest.cpp.
+ */
+struct SQueueBench {
+	struct SItem {
+		std::shared_ptr<int> task;
+		std::shared_ptr<int> onComplete;
+		int producer;
+		int seq;
+	};
+
+	template<typename Queue> static void Run(Queue& queue, int numItems, std::vector<int>& received) {
+		std::vector<std::thread> producers;
+		auto task = std::make_shared<int>(0);
+		for (int p = 0; p < NUM_PRODUCERS; ++p) {
+			producers.emplace_back([&queue, &task, p, numItems]() {
+				for (int i = 0; i < numItems; ++i) {
+					queue.Push({task, nullptr, p, i});
+				}
+			});
+		}
+		for (int i = 0; i < NUM_PRODUCERS * numItems; ++i) {
+			SItem item = queue.Pop();
+			received[item.producer] += item.seq;
+		}
+		for (std::thread& t : producers) {
+			t.join();
+		}
+	}
+
+	static constexpr int NUM_PRODUCERS = 8;
+	static constexpr int NUM_ITEMS = 20000;
+};
+
+template<typename Queue> static Op SetupQueue(std::shared_ptr<Queue> queue)
+{
+	return [queue]() {
+		std::vector<int> received(SQueueBench::NUM_PRODUCERS, 0);
+		SQueueBench::Run(*queue, SQueueBench::NUM_ITEMS, received);
+		DoNotOptimize(received.data());
+	};
+}
+BENCH_KERNEL("queue/multi_queue", [](const SMapConfig& cfg) {
+	return SetupQueue(std::make_shared<CMultiQueue<SQueueBench::SItem>>());
+});
+// Capacity of CScheduler::workTasks: producers outrun consumer and block on full ring
+BENCH_KERNEL("queue/ring_queue", [](const SMapConfig& cfg) {
+	return SetupQueue(std::make_shared<CRingQueue<SQueueBench::SItem>>(4096));
+});
+// Ring never gets full, as with usual scheduler traffic of a few tasks per frame
+BENCH_KERNEL("queue/ring_queue/no_full", [](const SMapConfig& cfg) {
+	return SetupQueue(std::make_shared<CRingQueue<SQueueBench::SItem>>(SQueueBench::NUM_PRODUCERS * SQueueBench::NUM_ITEMS));
+});
+
+/*
+ * CFactoryManager::GetClosestHaven after a lost fight: 200 units retreat in one frame.
+ * Synthetic area layout: river cross splits map into 4 land areas, river sectors are
+ * invalid; flying units (nullptr area) reach any land. 64 havens behind factories.
+ * "linear" is the former scan with reachability test per haven, "indexed" is CHavenIndex
+ * right after UpdateAreaUsers (buckets rebuilt within the op).
+ * Index vs linear scan test is test/HavenIndexTest.cpp.
+ */
+struct SHavenBench {
+	SHavenBench(const SMapConfig& cfg)
+		: width(cfg.width * SQUARE_SIZE)
+		, height(cfg.height * SQUARE_SIZE)
+		, areas(4, STerrainMapArea(nullptr))
+	{
+		std::mt19937 rng(cfg.seed);
+		std::uniform_real_distribution<float> posX(0.f, width), posZ(0.f, height);
+		while (havens.size() < NUM_HAVENS) {
+			AIFloat3 pos(posX(rng), 0.f, posZ(rng));
+			if (GetArea(pos) != nullptr) {
+				havens.push_back(pos);
+			}
+		}
+		for (int i = 0; i < NUM_RETREATS; ++i) {
+			AIFloat3 pos(posX(rng), 0.f, posZ(rng));
+			retreats.push_back({(i % 10 == 0) ? nullptr : GetArea(pos), pos});
+		}
+	}
+
+	STerrainMapArea* GetArea(const AIFloat3& pos) {
+		const float band = width / 32;
+		if ((std::fabs(pos.x - width / 2) < band) || (std::fabs(pos.z - height / 2) < band)) {
+			return nullptr;  // river
+		}
+		return &areas[(pos.x < width / 2 ? 0 : 1) + (pos.z < height / 2 ? 0 : 2)];
+	}
+	// CTerrainManager::CanMoveToPos
+	bool CanMoveToPos(STerrainMapArea* area, const AIFloat3& pos) {
+		STerrainMapArea* dest = GetArea(pos);
+		return (dest != nullptr) && ((area == nullptr) || (area == dest));
+	}
+
+	AIFloat3 FindLinear(STerrainMapArea* area, const AIFloat3& position) {
+		float metric = std::numeric_limits<float>::max();
+		auto it = havens.begin(), havIt = havens.end();
+		for (; it != havens.end(); ++it) {
+			if (!CanMoveToPos(area, *it)) {
+				continue;
+			}
+			float qdist = it->SqDistance2D(position);
+			if (qdist < metric) {
+				havIt = it;
+				metric = qdist;
+			}
+		}
+		return (havIt != havens.end()) ? *havIt : AIFloat3(-RgtVector);
+	}
+
+	static constexpr unsigned NUM_HAVENS = 64;
+	static constexpr int NUM_RETREATS = 200;
+
+	float width, height;
+	std::vector<STerrainMapArea> areas;
+	std::vector<AIFloat3> havens;
+	std::vector<std::pair<STerrainMapArea*, AIFloat3>> retreats;
+};
+
+static std::shared_ptr<CHavenIndex> MakeHavenIndex(std::shared_ptr<SHavenBench> hb)
+{
+	SHavenBench* raw = hb.get();
+	auto index = std::make_shared<CHavenIndex>([raw](STerrainMapArea* area, const AIFloat3& pos) {
+		return raw->CanMoveToPos(area, pos);
+	});
+	for (const AIFloat3& hav : hb->havens) {
+		index->Add(hav);
+	}
+	return index;
+}
+
+BENCH_KERNEL("haven/linear", [](const SMapConfig& cfg) -> Op {
+	auto hb = std::make_shared<SHavenBench>(cfg);
+	return [hb]() {
+		float sum = 0.f;
+		for (const auto& r : hb->retreats) {
+			sum += hb->FindLinear(r.first, r.second).x;
+		}
+		DoNotOptimize(&sum);
+	};
+});
+BENCH_KERNEL("haven/indexed", [](const SMapConfig& cfg) -> Op {
+	auto hb = std::make_shared<SHavenBench>(cfg);
+	auto index = MakeHavenIndex(hb);
+	return [hb, index]() {
+		index->Invalidate();
+		float sum = 0.f;
+		for (const auto& r : hb->retreats) {
+			sum += index->FindClosest(r.first, r.second).x;
+		}
+		DoNotOptimize(&sum);
+	};
+});
+
+
+/*
+ * CTerrainData::UpdateAreas every 20 seconds: find changed sectors of height map and
+ * re-evaluate them. Sector = 8x8 cells (convertStoP = 64). Between checks a battle leaves
+ * 16 craters. "full_compare" is the former per-sector compare against the previous map,
+ * "tile_diff" is CHeightDiff; both re-evaluate only the changed sectors.
+ * Incremental vs full recompute test is test/HeightDiffTest.cpp.
+ */
+struct SHeightBench {
+	struct SSector {  // height-derived fields of STerrainMapSector
+		float minElevation;
+		float maxElevation;
+		float percentLand;
+
+		bool operator!=(const SSector& o) const {
+			return (minElevation != o.minElevation) || (maxElevation != o.maxElevation) || (percentLand != o.percentLand);
+		}
+	};
+
+	SHeightBench(const SMapConfig& cfg)
+		: width(cfg.width)
+		, height(cfg.height)
+		, sectorXSize(width / TILE)
+		, sectorZSize(height / TILE)
+		, rng(cfg.seed)
+	{
+		heightMap.resize(width * height);
+		std::uniform_real_distribution<float> phase(0.f, 6.28f);
+		const float px = phase(rng), pz = phase(rng);
+		for (int z = 0; z < height; ++z) {
+			for (int x = 0; x < width; ++x) {
+				heightMap[z * width + x] = 120.f * std::sin(x * 0.011f + px) * std::cos(z * 0.007f + pz) + 30.f;
+			}
+		}
+		sectors.resize(sectorXSize * sectorZSize);
+		for (int i = 0; i < sectorXSize * sectorZSize; ++i) {
+			sectors[i] = Evaluate(heightMap, i % sectorXSize, i / sectorXSize);
+		}
+	}
+
+	SSector Evaluate(const std::vector<float>& hm, int x, int z) const {
+		const int iMapH = z * TILE * width + x * TILE;
+		SSector s = {hm[iMapH], hm[iMapH], 0.f};
+		for (int zH = 0; zH < TILE; zH++) {
+			for (int xH = 0, iH = iMapH + zH * width; xH < TILE; xH++, iH++) {
+				if (hm[iH] >= 0) {
+					s.percentLand++;
+				}
+				s.minElevation = std::min(s.minElevation, hm[iH]);
+				s.maxElevation = std::max(s.maxElevation, hm[iH]);
+			}
+		}
+		s.percentLand *= 100.0 / (TILE * TILE);
+		return s;
+	}
+
+	bool IsSectorChanged(const std::vector<float>& hm, const std::vector<float>& prev, int x, int z) const {
+		const int iMapH = z * TILE * width + x * TILE;
+		for (int zH = 0; zH < TILE; zH++) {
+			for (int xH = 0, iH = iMapH + zH * width; xH < TILE; xH++, iH++) {
+				if (hm[iH] != prev[iH]) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void Crater(std::vector<float>& hm, int cx, int cz, int radius, float depth) const {
+		for (int z = std::max(0, cz - radius); z < std::min(height, cz + radius + 1); ++z) {
+			for (int x = std::max(0, cx - radius); x < std::min(width, cx + radius + 1); ++x) {
+				const float sqDist = SQUARE(x - cx) + SQUARE(z - cz);
+				if (sqDist <= SQUARE(radius)) {
+					hm[z * width + x] -= depth * (1.f - sqDist / SQUARE(radius));
+				}
+			}
+		}
+	}
+
+	std::vector<float> Perturb(const std::vector<float>& hm, int numCraters) {
+		std::vector<float> result = hm;
+		std::uniform_int_distribution<int> posX(0, width - 1), posZ(0, height - 1), radius(1, 12);
+		std::uniform_real_distribution<float> depth(1.f, 60.f);
+		for (int i = 0; i < numCraters; ++i) {
+			Crater(result, posX(rng), posZ(rng), radius(rng), depth(rng));
+		}
+		return result;
+	}
+
+	static constexpr int TILE = 8;
+
+	int width, height;
+	int sectorXSize, sectorZSize;
+	std::mt19937 rng;
+	std::vector<float> heightMap;
+	std::vector<SSector> sectors;
+};
+
+static Op SetupHeight(const SMapConfig& cfg, bool isDiff)
+{
+	auto hb = std::make_shared<SHeightBench>(cfg);
+	auto diff = std::make_shared<CHeightDiff>();
+	diff->Init(hb->heightMap, hb->width, hb->height, SHeightBench::TILE);
+	// Battle craters, previous map stays committed
+	auto next = std::make_shared<std::vector<float>>(hb->Perturb(hb->heightMap, 16));
+	if (isDiff) {
+		return [hb, diff, next]() {
+			int changed = 0;
+			for (const CHeightDiff::SRect& r : diff->Diff(*next)) {
+				for (int z = r.z1; z < r.z2; ++z) {
+					for (int x = r.x1; x < r.x2; ++x) {
+						hb->sectors[z * hb->sectorXSize + x] = hb->Evaluate(*next, x, z);
+						++changed;
+					}
+				}
+			}
+			DoNotOptimize(&changed);
+		};
+	}
+	return [hb, next]() {
+		int changed = 0;
+		for (int z = 0; z < hb->sectorZSize; ++z) {
+			for (int x = 0; x < hb->sectorXSize; ++x) {
+				if (hb->IsSectorChanged(*next, hb->heightMap, x, z)) {
+					hb->sectors[z * hb->sectorXSize + x] = hb->Evaluate(*next, x, z);
+					++changed;
+				}
+			}
+		}
+		DoNotOptimize(&changed);
+	};
+}
+BENCH_KERNEL("terrain/full_compare", [](const SMapConfig& cfg) { return SetupHeight(cfg, false); });
+BENCH_KERNEL("terrain/tile_diff", [](const SMapConfig& cfg) { return SetupHeight(cfg, true); });
+
+} // namespace bench
+
+} // namespace circuit
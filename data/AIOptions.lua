@@ -39,6 +39,22 @@ local options = {
 		section = 'performance',
 		def     = true,
 	},
+	{ -- bool
+		key     = 'profile',
+		name    = 'Frame-time profiler',
+		desc    = 'Collect per-subsystem timings (p50/p99/max), written to profile.csv and profile.json on release',
+		type    = 'bool',
+		section = 'performance',
+		def     = false,
+	},
+	{ -- bool
+		key     = 'trace',
+		name    = 'Timeline trace',
+		desc    = 'Record scheduler, worker thread and engine event timeline, written to trace.json (chrome://tracing, Perfetto) on release',
+		type    = 'bool',
+		section = 'performance',
+		def     = false,
+	},
 -- 	{ -- number (int->uint)
 -- 		key     = 'random_seed',
 -- 		name    = 'Random seed',
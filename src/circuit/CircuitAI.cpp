@@ -12,18 +12,22 @@
 #include "module/EconomyManager.h"
 #include "module/MilitaryManager.h"
 #include "resource/MetalManager.h"
+#include "resource/ReclaimData.h"
 #include "terrain/TerrainManager.h"
 #include "terrain/ThreatMap.h"
 #include "terrain/PathFinder.h"
 #include "task/PlayerTask.h"
 #include "unit/CircuitUnit.h"
 #include "unit/EnemyUnit.h"
+#include "util/Action.h"
 #include "util/GameAttribute.h"
+#include "util/Profiler.h"
+#include "util/SaveStream.h"
+#include "util/Tracer.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
-#ifdef DEBUG_VIS
+#include "json/json.h"
 #include "resource/EnergyGrid.h"
-#endif
 
 #include "AISEvents.h"
 #include "AISCommands.h"
@@ -41,6 +45,7 @@
 #include "WrappUnit.h"
 #include "WrappTeam.h"
 #include "OptionValues.h"
+#include "DataDirs.h"
 //#include "Info.h"
 //#include "Mod.h"
 #include "Cheats.h"
@@ -48,6 +53,7 @@
 
 #include <regex>
 #include <fstream>
+#include <sstream>
 
 namespace circuit {
 
@@ -64,6 +70,40 @@ using namespace springai;
 	#define PRINT_TOPIC(txt, topic)
 #endif
 
+static const char* GetEventName(int topic)
+{
+	switch (topic) {
+		case EVENT_INIT: return "EVENT_INIT";
+		case EVENT_RELEASE: return "EVENT_RELEASE";
+		case EVENT_UPDATE: return "EVENT_UPDATE";
+		case EVENT_MESSAGE: return "EVENT_MESSAGE";
+		case EVENT_UNIT_CREATED: return "EVENT_UNIT_CREATED";
+		case EVENT_UNIT_FINISHED: return "EVENT_UNIT_FINISHED";
+		case EVENT_UNIT_IDLE: return "EVENT_UNIT_IDLE";
+		case EVENT_UNIT_MOVE_FAILED: return "EVENT_UNIT_MOVE_FAILED";
+		case EVENT_UNIT_DAMAGED: return "EVENT_UNIT_DAMAGED";
+		case EVENT_UNIT_DESTROYED: return "EVENT_UNIT_DESTROYED";
+		case EVENT_UNIT_GIVEN: return "EVENT_UNIT_GIVEN";
+		case EVENT_UNIT_CAPTURED: return "EVENT_UNIT_CAPTURED";
+		case EVENT_ENEMY_ENTER_LOS: return "EVENT_ENEMY_ENTER_LOS";
+		case EVENT_ENEMY_LEAVE_LOS: return "EVENT_ENEMY_LEAVE_LOS";
+		case EVENT_ENEMY_ENTER_RADAR: return "EVENT_ENEMY_ENTER_RADAR";
+		case EVENT_ENEMY_LEAVE_RADAR: return "EVENT_ENEMY_LEAVE_RADAR";
+		case EVENT_ENEMY_DAMAGED: return "EVENT_ENEMY_DAMAGED";
+		case EVENT_ENEMY_DESTROYED: return "EVENT_ENEMY_DESTROYED";
+		case EVENT_WEAPON_FIRED: return "EVENT_WEAPON_FIRED";
+		case EVENT_PLAYER_COMMAND: return "EVENT_PLAYER_COMMAND";
+		case EVENT_SEISMIC_PING: return "EVENT_SEISMIC_PING";
+		case EVENT_COMMAND_FINISHED: return "EVENT_COMMAND_FINISHED";
+		case EVENT_LOAD: return "EVENT_LOAD";
+		case EVENT_SAVE: return "EVENT_SAVE";
+		case EVENT_ENEMY_CREATED: return "EVENT_ENEMY_CREATED";
+		case EVENT_ENEMY_FINISHED: return "EVENT_ENEMY_FINISHED";
+		case EVENT_LUA_MESSAGE: return "EVENT_LUA_MESSAGE";
+		default: return "EVENT_UNKNOWN";
+	}
+}
+
 std::unique_ptr<CGameAttribute> CCircuitAI::gameAttribute(nullptr);
 unsigned int CCircuitAI::gaCounter = 0;
 
@@ -76,6 +116,7 @@ CCircuitAI::CCircuitAI(OOAICallback* callback)
 		, uEnemyMark(0)
 		, kEnemyMark(0)
 		, actionIterator(0)
+		, actionBudget("CCircuitAI::ActionUpdate")
 		, isCheating(false)
 		, isAllyAware(true)
 		, isCommMerge(true)
@@ -143,6 +184,7 @@ void CCircuitAI::Resign(int newTeamId)
 
 int CCircuitAI::HandleGameEvent(int topic, const void* data)
 {
+	TRACE_SCOPE(GetEventName(topic), skirmishAIId);
 	int ret = ERROR_UNKNOWN;
 
 	switch (topic) {
@@ -534,7 +576,7 @@ int CCircuitAI::Init(int skirmishAIId, const struct SSkirmishAICallback* sAICall
 #endif
 
 	scheduler = std::make_shared<CScheduler>();
-	scheduler->Init(scheduler);
+	scheduler->Init(scheduler, skirmishAIId);
 
 	std::string cfgOption = InitOptions();  // Inits GameAttribute
 	float decloakRadius;
@@ -546,6 +588,7 @@ int CCircuitAI::Init(int skirmishAIId, const struct SSkirmishAICallback* sAICall
 		return ERROR_INIT;
 	}
 	setupManager->ReadConfig();
+	actionBudget.SetBudget(setupManager->GetConfig()["budget"].get("action", 2000).asInt());
 	if (!setupManager->PickCommander()) {
 		Release(RELEASE_COMMANDER);
 		return ERROR_INIT;
@@ -651,6 +694,7 @@ int CCircuitAI::Release(int reason)
 	}
 	teamUnits.clear();
 	garbage.clear();
+	enemyEvents.Clear();
 	for (auto& kv : enemyUnits) {
 		delete kv.second;
 	}
@@ -664,6 +708,9 @@ int CCircuitAI::Release(int reason)
 	defsById.clear();
 	defsByName.clear();
 
+	if ((gaCounter <= 1) && (CProfiler::IsEnabled() || CTracer::IsEnabled())) {
+		DumpDiagnostics();
+	}
 	DestroyGameAttribute();
 
 #ifdef DEBUG_VIS
@@ -677,6 +724,7 @@ int CCircuitAI::Release(int reason)
 
 int CCircuitAI::Update(int frame)
 {
+	PROFILE_SCOPE("CCircuitAI::Update");
 	lastFrame = frame;
 	if (isResigned) {
 		Release(RELEASE_RESIGN);
@@ -684,6 +732,8 @@ int CCircuitAI::Update(int frame)
 		return 0;
 	}
 
+	ApplyEnemyEvents();
+
 	if (!garbage.empty()) {
 		CCircuitUnit* unit = *garbage.begin();
 		UnitDestroyed(unit, nullptr);
@@ -940,43 +990,33 @@ int CCircuitAI::UnitCaptured(ICoreUnit::Id unitId, int oldTeamId, int newTeamId)
 
 int CCircuitAI::EnemyEnterLOS(CEnemyUnit* enemy)
 {
-	bool isKnownBefore = enemy->IsKnown() && (enemy->IsInRadar() || !enemy->GetCircuitDef()->IsMobile());
-
-	if (threatMap->EnemyEnterLOS(enemy)) {
-		militaryManager->AddEnemyCost(enemy);
-	}
-
-	if (isKnownBefore) {
-		return 0;  // signaling: OK
-	}
-	// Force unit's reaction
-	auto friendlies = std::move(callback->GetFriendlyUnitsIn(enemy->GetPos(), 500.0f));
-	if (friendlies.empty()) {
+	if (enemy->IsKnown() && enemyEvents.IsSighted(enemy)) {
+		enemyEvents.EnterLOS(enemy);
 		return 0;  // signaling: OK
 	}
-	for (Unit* f : friendlies) {
-		if (f == nullptr) {
-			continue;
-		}
-		CCircuitUnit* unit = GetTeamUnit(f->GetUnitId());
-		if ((unit != nullptr) && (unit->GetTask() != nullptr)) {
-			unit->ForceExecute();
-		}
-		delete f;
-	}
+	// First sight of the frame: position is readable only while visible
+	ApplyEnemyEvents(enemyEvents.Take(enemy, true));
+	ApplyEnemyEnterLOS(enemy);
 
 	return 0;  // signaling: OK
 }
 
 int CCircuitAI::EnemyLeaveLOS(CEnemyUnit* enemy)
 {
-	threatMap->EnemyLeaveLOS(enemy);
+	enemyEvents.LeaveLOS(enemy);
 
 	return 0;  // signaling: OK
 }
 
 int CCircuitAI::EnemyEnterRadar(CEnemyUnit* enemy)
 {
+	if (enemyEvents.IsSighted(enemy)) {
+		enemyEvents.EnterRadar(enemy);
+		return 0;  // signaling: OK
+	}
+	// Radar contact of enemy in LOS doesn't read position
+	const bool isSighted = !(enemyEvents.GetState(enemy) & EnemyEvents::LOS);
+	ApplyEnemyEvents(enemyEvents.Take(enemy, isSighted));
 	threatMap->EnemyEnterRadar(enemy);
 	enemy->SetLastSeen(-1);
 
@@ -985,21 +1025,24 @@ int CCircuitAI::EnemyEnterRadar(CEnemyUnit* enemy)
 
 int CCircuitAI::EnemyLeaveRadar(CEnemyUnit* enemy)
 {
-	threatMap->EnemyLeaveRadar(enemy);
-	enemy->SetLastSeen(lastFrame);
+	enemyEvents.LeaveRadar(enemy);
 
 	return 0;  // signaling: OK
 }
 
 int CCircuitAI::EnemyDamaged(CEnemyUnit* enemy)
 {
-	threatMap->EnemyDamaged(enemy);
+	enemyEvents.Damaged(enemy);
 
 	return 0;  // signaling: OK
 }
 
 int CCircuitAI::EnemyDestroyed(CEnemyUnit* enemy)
 {
+	enemyEvents.Forget(enemy);
+
+	economyManager->GetReclaimData()->MarkArea(enemy->GetPos(), SQUARE_SIZE * 8);  // wreck
+
 	if (threatMap->EnemyDestroyed(enemy)) {
 		militaryManager->DelEnemyCost(enemy);
 	}
@@ -1007,6 +1050,73 @@ int CCircuitAI::EnemyDestroyed(CEnemyUnit* enemy)
 	return 0;  // signaling: OK
 }
 
+void CCircuitAI::ApplyEnemyEvents()
+{
+	if (enemyEvents.IsEmpty()) {
+		return;
+	}
+	for (const EnemyEvents::SRecord& record : enemyEvents.GetRecords()) {
+		if (record.enemy != nullptr) {
+			ApplyEnemyEvents(record);
+		}
+	}
+	enemyEvents.Clear();
+}
+
+void CCircuitAI::ApplyEnemyEvents(const EnemyEvents::SRecord& record)
+{
+	CEnemyUnit* enemy = record.enemy;
+	if (enemy == nullptr) {
+		return;
+	}
+	// Order matches engine's: leave LOS into radar, radar contact before LOS, radar lost after LOS
+	if (record.IsLeave(EnemyEvents::LOS)) {
+		threatMap->EnemyLeaveLOS(enemy);
+	}
+	if (record.IsEnter(EnemyEvents::RADAR)) {
+		threatMap->EnemyEnterRadar(enemy);
+		enemy->SetLastSeen(-1);
+	}
+	if (record.IsEnter(EnemyEvents::LOS)) {
+		ApplyEnemyEnterLOS(enemy);
+	}
+	if (record.IsLeave(EnemyEvents::RADAR)) {
+		threatMap->EnemyLeaveRadar(enemy);
+		enemy->SetLastSeen(lastFrame);
+	}
+	if (record.isDamaged) {
+		threatMap->EnemyDamaged(enemy);
+	}
+}
+
+void CCircuitAI::ApplyEnemyEnterLOS(CEnemyUnit* enemy)
+{
+	bool isKnownBefore = enemy->IsKnown() && (enemy->IsInRadar() || !enemy->GetCircuitDef()->IsMobile());
+
+	if (threatMap->EnemyEnterLOS(enemy)) {
+		militaryManager->AddEnemyCost(enemy);
+	}
+
+	if (isKnownBefore) {
+		return;
+	}
+	// Force unit's reaction
+	auto friendlies = std::move(callback->GetFriendlyUnitsIn(enemy->GetPos(), 500.0f));
+	if (friendlies.empty()) {
+		return;
+	}
+	for (Unit* f : friendlies) {
+		if (f == nullptr) {
+			continue;
+		}
+		CCircuitUnit* unit = GetTeamUnit(f->GetUnitId());
+		if ((unit != nullptr) && (unit->GetTask() != nullptr)) {
+			unit->ForceExecute();
+		}
+		delete f;
+	}
+}
+
 int CCircuitAI::PlayerCommand(std::vector<CCircuitUnit*>& units)
 {
 	for (CCircuitUnit* unit : units) {
@@ -1034,6 +1144,7 @@ int CCircuitAI::PlayerCommand(std::vector<CCircuitUnit*>& units)
 int CCircuitAI::Load(std::istream& is)
 {
 	isLoadSave = true;
+	ApplyEnemyEvents();  // loaded threat overrides them
 
 	auto units = std::move(callback->GetTeamUnits());
 	for (Unit* u : units) {
@@ -1056,22 +1167,97 @@ int CCircuitAI::Load(std::istream& is)
 		}
 	}
 
-	for (auto& module : modules) {
-		is >> *module;
+	CSaveReader reader(is);
+	if (!reader.IsValid()) {
+		LOG("Save is not recognized, continue with fresh state");
+		return 0;  // signaling: OK
 	}
+	// NOTE: ThreatMap goes first, it re-registers remembered enemies
+	auto load = [this, &reader](SaveSection id, uint32_t version, const CSaveReader::LoadFunc& func) {
+		if (!reader.Read(id, version, func)) {
+			LOG("Save section %i (v%u) skipped", static_cast<int>(id), version);
+		}
+	};
+	load(SaveSection::THREAT, CThreatMap::SAVE_VERSION, [this](std::istream& is) {
+		return threatMap->Load(is);
+	});
+	load(SaveSection::METAL, CMetalManager::SAVE_VERSION, [this](std::istream& is) {
+		return metalManager->Load(is);
+	});
+	load(SaveSection::ENERGY, CEnergyGrid::SAVE_VERSION, [this](std::istream& is) {
+		return economyManager->GetEnergyGrid()->Load(is);
+	});
+	load(SaveSection::ECONOMY, CEconomyManager::SAVE_VERSION, [this](std::istream& is) {
+		is >> *economyManager;
+		return true;
+	});
+	load(SaveSection::MILITARY, CMilitaryManager::SAVE_VERSION, [this](std::istream& is) {
+		is >> *militaryManager;
+		return true;
+	});
 
 	return 0;  // signaling: OK
 }
 
 int CCircuitAI::Save(std::ostream& os)
 {
-	for (auto& module : modules) {
-		os << *module;
-	}
+	ApplyEnemyEvents();  // state of current frame
+
+	CSaveWriter writer(os);
+	writer.Write(SaveSection::THREAT, CThreatMap::SAVE_VERSION, [this](std::ostream& os) {
+		threatMap->Save(os);
+	});
+	writer.Write(SaveSection::METAL, CMetalManager::SAVE_VERSION, [this](std::ostream& os) {
+		metalManager->Save(os);
+	});
+	writer.Write(SaveSection::ENERGY, CEnergyGrid::SAVE_VERSION, [this](std::ostream& os) {
+		economyManager->GetEnergyGrid()->Save(os);
+	});
+	writer.Write(SaveSection::ECONOMY, CEconomyManager::SAVE_VERSION, [this](std::ostream& os) {
+		os << *economyManager;
+	});
+	writer.Write(SaveSection::MILITARY, CMilitaryManager::SAVE_VERSION, [this](std::ostream& os) {
+		os << *militaryManager;
+	});
+	if (!writer.IsGood()) {
+		return ERROR_SAVE;
+	}
+#ifdef DEBUG_SAVE
+	CheckSaveLoad();
+#endif
 
 	return 0;  // signaling: OK
 }
 
+#ifdef DEBUG_SAVE
+/*
+ * Round-trip of live modules: state loaded from own save must save the same bytes.
+ * NOTE: Energy grid is left out, its Load schedules link timeouts.
+ */
+void CCircuitAI::CheckSaveLoad()
+{
+	auto check = [this](const char* name, const CSaveWriter::SaveFunc& save, const CSaveReader::LoadFunc& load) {
+		std::stringstream saved;
+		save(saved);
+		if (!load(saved)) {
+			LOG("Save check: %s can't load own save", name);
+			return;
+		}
+		std::ostringstream resaved;
+		save(resaved);
+		if (resaved.str() != saved.str()) {
+			LOG("Save check: %s differs after load", name);
+		}
+	};
+	check("threat", [this](std::ostream& os) { threatMap->Save(os); },
+					[this](std::istream& is) { return threatMap->Load(is); });
+	check("metal", [this](std::ostream& os) { metalManager->Save(os); },
+				   [this](std::istream& is) { return metalManager->Load(is); });
+	check("economy", [this](std::ostream& os) { os << *economyManager; },
+					 [this](std::istream& is) { is >> *economyManager; return !is.fail(); });
+}
+#endif
+
 int CCircuitAI::LuaMessage(const char* inData)
 {
 	if (strncmp(inData, "DISABLE_CONTROL:", 16) == 0) {
@@ -1127,7 +1313,7 @@ CCircuitUnit* CCircuitAI::RegisterTeamUnit(ICoreUnit::Id unitId, Unit* u)
 void CCircuitAI::UnregisterTeamUnit(CCircuitUnit* unit)
 {
 	teamUnits.erase(unit->GetId());
-	defsById[unit->GetCircuitDef()->GetId()]->Dec();
+	unit->GetCircuitDef()->Dec();
 
 	(unit->GetTask() == nullptr) ? DeleteTeamUnit(unit) : unit->Dead();
 }
@@ -1181,7 +1367,7 @@ std::pair<CEnemyUnit*, bool> CCircuitAI::RegisterEnemyUnit(ICoreUnit::Id unitId,
 			CCircuitDef::Id unitDefId = unitDef->GetUnitDefId();
 			delete unitDef;
 			if ((unit->GetCircuitDef() == nullptr) || unit->GetCircuitDef()->GetId() != unitDefId) {
-				unit->SetCircuitDef(defsById[unitDefId]);
+				unit->SetCircuitDef(GetCircuitDef(unitDefId));
 				unit->SetCost(unit->GetUnit()->GetRulesParamFloat("comm_cost", unit->GetCost()));
 			}
 		}
@@ -1203,7 +1389,7 @@ std::pair<CEnemyUnit*, bool> CCircuitAI::RegisterEnemyUnit(ICoreUnit::Id unitId,
 			delete u;
 			return std::make_pair(nullptr, false);
 		}
-		cdef = defsById[unitDef->GetUnitDefId()];
+		cdef = GetCircuitDef(unitDef->GetUnitDefId());
 		delete unitDef;
 	}
 	unit = new CEnemyUnit(unitId, u, cdef);
@@ -1227,13 +1413,13 @@ CEnemyUnit* CCircuitAI::RegisterEnemyUnit(Unit* e)
 
 	if (unit != nullptr) {
 		if ((unit->GetCircuitDef() == nullptr) || unit->GetCircuitDef()->GetId() != unitDefId) {
-			unit->SetCircuitDef(defsById[unitDefId]);
+			unit->SetCircuitDef(GetCircuitDef(unitDefId));
 			unit->SetCost(unit->GetUnit()->GetRulesParamFloat("comm_cost", unit->GetCost()));
 		}
 		return nullptr;
 	}
 
-	CCircuitDef* cdef = defsById[unitDefId];
+	CCircuitDef* cdef = GetCircuitDef(unitDefId);
 	unit = new CEnemyUnit(unitId, e, cdef);
 	enemyUnits[unit->GetId()] = unit;
 	return unit;
@@ -1322,14 +1508,15 @@ void CCircuitAI::EnableControl(const std::string data)
 
 void CCircuitAI::ActionUpdate()
 {
+	PROFILE_SCOPE("CCircuitAI::ActionUpdate");
 	if (actionIterator >= actionUnits.size()) {
 		actionIterator = 0;
 	}
 
 	// stagger the Update's
-	unsigned int n = (actionUnits.size() / ACTION_UPDATE_RATE) + 1;
+	actionBudget.Start(actionUnits.size(), ACTION_UPDATE_RATE);
 
-	while ((actionIterator < actionUnits.size()) && (n != 0)) {
+	while ((actionIterator < actionUnits.size()) && actionBudget.IsAvailable()) {
 		CCircuitUnit* unit = actionUnits[actionIterator];
 		if (unit->IsDead()) {
 			actionUnits[actionIterator] = actionUnits.back();
@@ -1340,9 +1527,10 @@ void CCircuitAI::ActionUpdate()
 				unit->Update(this);
 			}
 			++actionIterator;
-			n--;
+			actionBudget.Done();
 		}
 	}
+	actionBudget.Finish();
 }
 
 std::string CCircuitAI::InitOptions()
@@ -1365,6 +1553,17 @@ std::string CCircuitAI::InitOptions()
 		isCommMerge = StringToBool(value);
 	}
 
+	value = options->GetValueByKey("profile");
+	if ((value != nullptr) && StringToBool(value)) {
+		CProfiler::SetEnabled(true);  // process-wide
+	}
+
+	value = options->GetValueByKey("trace");
+	if ((value != nullptr) && StringToBool(value)) {
+		CTracer::SetEnabled(true);  // process-wide
+		CTracer::SetThreadName("main");
+	}
+
 	value = options->GetValueByKey("config_file");
 	std::string cfgOption = ((value != nullptr) && strlen(value) > 0) ? value : "";
 
@@ -1400,30 +1599,16 @@ void CCircuitAI::InitUnitDefs(float& outDcr)
 	if (!gameAttribute->GetTerrainData().IsInitialized()) {
 		gameAttribute->GetTerrainData().Init(this);
 	}
-	Resource* res = callback->GetResourceByName("Metal");
-	outDcr = 0.f;
-	const std::vector<UnitDef*>& unitDefs = callback->GetUnitDefs();
-	for (UnitDef* ud : unitDefs) {
-		auto options = std::move(ud->GetBuildOptions());
-		std::unordered_set<CCircuitDef::Id> opts;
-		for (UnitDef* buildDef : options) {
-			opts.insert(buildDef->GetUnitDefId());
-			delete buildDef;
-		}
-		CCircuitDef* cdef = new CCircuitDef(this, ud, opts, res);
-
-		defsByName[ud->GetName()] = cdef;
-		defsById[cdef->GetId()] = cdef;
-
-		const float dcr = ud->GetDecloakDistance();
-		if (outDcr < dcr) {
-			outDcr = dcr;
-		}
+	CDefCatalog& defCatalog = gameAttribute->GetDefCatalog();
+	if (!defCatalog.IsInitialized()) {
+		defCatalog.Init(this, gameAttribute->GetTerrainData());
 	}
-	delete res;
-
-	for (auto& kv : GetCircuitDefs()) {
-		kv.second->Init(this);
+	outDcr = defCatalog.GetMaxDecloak();
+	defsById.reserve(defCatalog.GetDefs().size());
+	for (const CCircuitDef::SShared& data : defCatalog.GetDefs()) {
+		CCircuitDef* cdef = new CCircuitDef(this, &data);
+		defsByName[data.name.c_str()] = cdef;
+		defsById[cdef->GetId()] = cdef;
 	}
 }
 
@@ -1459,6 +1644,35 @@ void CCircuitAI::InitUnitDefs(float& outDcr)
 //	gameAttribute->GetMetalManager().DrawCentroids(GetDrawer());
 //}
 
+void CCircuitAI::DumpDiagnostics()
+{
+	static const size_t absPath_sizeMax = 2048;
+	char absPath[absPath_sizeMax];
+	DataDirs* datadirs = callback->GetDataDirs();
+	auto locate = [datadirs, &absPath](const char* filename) {
+		return datadirs->LocatePath(absPath, absPath_sizeMax, filename, true /*writable*/, true /*create*/, false /*dir*/, false /*common*/);
+	};
+	if (CProfiler::IsEnabled()) {
+		if (locate("profile.csv")) {
+			std::ofstream csvFileStream(absPath);
+			CProfiler::WriteCSV(csvFileStream);
+		}
+		if (locate("profile.json")) {
+			std::ofstream jsonFileStream(absPath);
+			CProfiler::WriteJSON(jsonFileStream);
+		}
+		CProfiler::Reset();
+	}
+	if (CTracer::IsEnabled()) {
+		if (locate("trace.json")) {
+			std::ofstream traceFileStream(absPath);
+			CTracer::WriteJSON(traceFileStream);
+		}
+		CTracer::Reset();
+	}
+	delete datadirs;
+}
+
 void CCircuitAI::CreateGameAttribute(unsigned int seed)
 {
 	if (gameAttribute == nullptr) {
@@ -1475,6 +1689,9 @@ void CCircuitAI::DestroyGameAttribute()
 		if (gameAttribute != nullptr) {
 			gameAttribute = nullptr;  // deletes singleton here;
 		}
+		// Return pooled memory between games
+		IUnitTask::GetPool().Trim();
+		IAction::GetPool().Trim();
 		gaCounter = 0;
 	} else {
 		gaCounter--;
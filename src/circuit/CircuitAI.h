@@ -10,7 +10,10 @@
 
 #include "unit/AllyTeam.h"
 #include "unit/CircuitDef.h"
+#include "unit/EnemyEvents.h"
 #include "util/Defines.h"
+#include "util/FrameBudget.h"
+#include "util/SlotMap.h"
 
 #include <memory>
 #include <unordered_map>
@@ -132,7 +135,7 @@ private:
 
 // ---- Units ---- BEGIN
 public:
-	using Units = std::map<ICoreUnit::Id, CCircuitUnit*>;
+	using Units = CSlotMap<ICoreUnit::Id, CCircuitUnit*>;
 private:
 	CCircuitUnit* GetOrRegTeamUnit(ICoreUnit::Id unitId);
 	CCircuitUnit* RegisterTeamUnit(ICoreUnit::Id unitId);
@@ -149,16 +152,23 @@ public:
 	CAllyUnit* GetFriendlyUnit(ICoreUnit::Id unitId) const { return allyTeam->GetFriendlyUnit(unitId); }
 	const CAllyTeam::Units& GetFriendlyUnits() const { return allyTeam->GetFriendlyUnits(); }
 
-	using EnemyUnits = std::map<ICoreUnit::Id, CEnemyUnit*>;
+	using EnemyUnits = CSlotMap<ICoreUnit::Id, CEnemyUnit*>;
+	using EnemyEvents = CEnemyEvents<CEnemyUnit>;
 private:
 	std::pair<CEnemyUnit*, bool> RegisterEnemyUnit(ICoreUnit::Id unitId, bool isInLOS = false);
 	CEnemyUnit* RegisterEnemyUnit(springai::Unit* e);
 	void UnregisterEnemyUnit(CEnemyUnit* unit);
 	void UpdateEnemyUnits();
+	// Net LOS/radar transitions and damage of the last frame, once per enemy
+	void ApplyEnemyEvents();
+	void ApplyEnemyEvents(const EnemyEvents::SRecord& record);
+	void ApplyEnemyEnterLOS(CEnemyUnit* enemy);
 public:
 	CEnemyUnit* GetEnemyUnit(springai::Unit* u) const { return GetEnemyUnit(u->GetUnitId()); }
 	CEnemyUnit* GetEnemyUnit(ICoreUnit::Id unitId) const;
 	const EnemyUnits& GetEnemyUnits() const { return enemyUnits; }
+	// Enemy remembered by save file, can be out of LOS and radar
+	CEnemyUnit* RestoreEnemyUnit(ICoreUnit::Id unitId) { return RegisterEnemyUnit(unitId).first; }
 
 	CAllyTeam* GetAllyTeam() const { return allyTeam; }
 
@@ -173,12 +183,14 @@ private:
 
 	Units teamUnits;  // owner
 	EnemyUnits enemyUnits;  // owner
+	EnemyEvents enemyEvents;
 	CAllyTeam* allyTeam;
 	int uEnemyMark;
 	int kEnemyMark;
 
 	std::vector<CCircuitUnit*> actionUnits;
 	unsigned int actionIterator;
+	CFrameBudget actionBudget;
 
 	std::set<CCircuitUnit*> garbage;
 // ---- Units ---- END
@@ -197,7 +209,7 @@ private:
 
 // ---- UnitDefs ---- BEGIN
 public:
-	using CircuitDefs = std::unordered_map<CCircuitDef::Id, CCircuitDef*>;
+	using CircuitDefs = CSlotMap<CCircuitDef::Id, CCircuitDef*>;
 	using NamedDefs = std::map<const char*, CCircuitDef*, cmp_str>;
 
 	const CircuitDefs& GetCircuitDefs() const { return defsById; }
@@ -219,6 +231,7 @@ public:
 	std::shared_ptr<CScheduler>& GetScheduler() { return scheduler; }
 	int GetLastFrame()    const { return lastFrame; }
 	int GetSkirmishAIId() const { return skirmishAIId; }
+	const struct SSkirmishAICallback* GetSkirmishAICallback() const { return sAICallback; }
 	int GetTeamId()       const { return teamId; }
 	int GetAllyTeamId()   const { return allyTeamId; }
 	springai::OOAICallback* GetCallback()   const { return callback; }
@@ -249,6 +262,9 @@ public:
 private:
 	// debug
 //	void DrawClusters();
+#ifdef DEBUG_SAVE
+	void CheckSaveLoad();
+#endif
 
 	bool isInitialized;
 	bool isLoadSave;
@@ -272,6 +288,7 @@ private:
 	static unsigned int gaCounter;
 	void CreateGameAttribute(unsigned int seed);
 	void DestroyGameAttribute();
+	void DumpDiagnostics();
 	std::shared_ptr<CScheduler> scheduler;
 	std::shared_ptr<CSetupManager> setupManager;
 	std::shared_ptr<CMetalManager> metalManager;
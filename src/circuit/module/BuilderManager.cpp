@@ -36,6 +36,7 @@
 #include "task/builder/GuardTask.h"
 #include "task/builder/BuildChain.h"
 #include "CircuitAI.h"
+#include "util/Profiler.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
@@ -52,6 +53,7 @@ CBuilderManager::CBuilderManager(CCircuitAI* circuit)
 		, buildTasksCount(0)
 		, buildPower(.0f)
 		, buildIterator(0)
+		, buildBudget("CBuilderManager::UpdateBuild")
 {
 	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CBuilderManager::Init, this));
 
@@ -133,6 +135,7 @@ CBuilderManager::CBuilderManager(CCircuitAI* circuit)
 
 	const Json::Value& root = circuit->GetSetupManager()->GetConfig();
 	const float builderRet = root["retreat"].get("builder", 0.8f).asFloat();
+	buildBudget.SetBudget(root["budget"].get("build", 1000).asInt());
 
 	CTerrainManager* terrainManager = circuit->GetTerrainManager();
 	const CCircuitAI::CircuitDefs& allDefs = circuit->GetCircuitDefs();
@@ -208,7 +211,10 @@ CBuilderManager::CBuilderManager(CCircuitAI* circuit)
 CBuilderManager::~CBuilderManager()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-	utils::free_clear(buildUpdates);
+	utils::free_clear(deadTasks);
+	for (const IUnitTask::Handle& handle : buildUpdates) {
+		delete IUnitTask::GetPool().Resolve(handle);
+	}
 	for (auto& kv1 : buildChains) {
 		for (auto& kv2 : kv1.second) {
 			delete kv2.second;
@@ -364,11 +370,15 @@ void CBuilderManager::Release()
 {
 	// NOTE: Release expected to be called on CCircuit::Release.
 	//       It doesn't stop scheduled GameTasks for that reason.
-	for (IUnitTask* task : buildUpdates) {
-		AbortTask(task);
+	for (const IUnitTask::Handle& handle : buildUpdates) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(handle);
+		if ((task != nullptr) && !task->IsDead()) {
+			AbortTask(task);
+		}
 		// NOTE: Do not delete task as other AbortTask may ask for it
 	}
 	buildUpdates.clear();
+	deadTasks.clear();
 }
 
 int CBuilderManager::UnitCreated(CCircuitUnit* unit, CCircuitUnit* builder)
@@ -503,7 +513,7 @@ void CBuilderManager::ActivateTask(IBuilderTask* task)
 		buildTasks[static_cast<IBuilderTask::BT>(task->GetBuildType())].insert(task);
 		buildTasksCount++;
 	}
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	task->Activate();
 }
 
@@ -544,7 +554,7 @@ IBuilderTask* CBuilderManager::EnqueueFactory(IBuilderTask::Priority priority,
 	if (isActive) {
 		buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::FACTORY)].insert(task);
 		buildTasksCount++;
-		buildUpdates.push_back(task);
+		buildUpdates.push_back(task->GetHandle());
 	} else {
 		task->Deactivate();
 	}
@@ -563,7 +573,7 @@ IBuilderTask* CBuilderManager::EnqueuePylon(IBuilderTask::Priority priority,
 	if (isActive) {
 		buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::PYLON)].insert(task);
 		buildTasksCount++;
-		buildUpdates.push_back(task);
+		buildUpdates.push_back(task->GetHandle());
 	} else {
 		task->Deactivate();
 	}
@@ -581,7 +591,7 @@ IBuilderTask* CBuilderManager::EnqueueRepair(IBuilderTask::Priority priority,
 	CBRepairTask* task = new CBRepairTask(this, priority, target, timeout);
 	buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::REPAIR)].insert(task);
 	buildTasksCount++;
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	repairedUnits[target->GetId()] = task;
 	return task;
 }
@@ -596,7 +606,7 @@ IBuilderTask* CBuilderManager::EnqueueReclaim(IBuilderTask::Priority priority,
 	IBuilderTask* task = new CBReclaimTask(this, priority, position, cost, timeout, radius, isMetal);
 	buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::RECLAIM)].insert(task);
 	buildTasksCount++;
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -611,7 +621,7 @@ IBuilderTask* CBuilderManager::EnqueueReclaim(IBuilderTask::Priority priority,
 	CBReclaimTask* task = new CBReclaimTask(this, priority, target, timeout);
 	buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::RECLAIM)].insert(task);
 	buildTasksCount++;
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	reclaimedUnits[target] = task;
 	return task;
 }
@@ -622,7 +632,7 @@ IBuilderTask* CBuilderManager::EnqueuePatrol(IBuilderTask::Priority priority,
 											 int timeout)
 {
 	IBuilderTask* task = new CBPatrolTask(this, priority, position, cost, timeout);
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -642,7 +652,7 @@ IBuilderTask* CBuilderManager::EnqueueTerraform(IBuilderTask::Priority priority,
 	if (isActive) {
 		buildTasks[static_cast<IBuilderTask::BT>(IBuilderTask::BuildType::TERRAFORM)].insert(task);
 		buildTasksCount++;
-		buildUpdates.push_back(task);
+		buildUpdates.push_back(task->GetHandle());
 	} else {
 		task->Deactivate();
 	}
@@ -654,21 +664,21 @@ IBuilderTask* CBuilderManager::EnqueueGuard(IBuilderTask::Priority priority,
 											int timeout)
 {
 	IBuilderTask* task = new CBGuardTask(this, priority, target, timeout);
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	return task;
 }
 
 IUnitTask* CBuilderManager::EnqueueWait(int timeout)
 {
 	CBWaitTask* task = new CBWaitTask(this, timeout);
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	return task;
 }
 
 CRetreatTask* CBuilderManager::EnqueueRetreat()
 {
 	CRetreatTask* task = new CRetreatTask(this);
-	buildUpdates.push_back(task);
+	buildUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -725,7 +735,7 @@ IBuilderTask* CBuilderManager::AddTask(IBuilderTask::Priority priority,
 	if (isActive) {
 		buildTasks[static_cast<IBuilderTask::BT>(type)].insert(task);
 		buildTasksCount++;
-		buildUpdates.push_back(task);
+		buildUpdates.push_back(task->GetHandle());
 	} else {
 		task->Deactivate();
 	}
@@ -753,6 +763,9 @@ void CBuilderManager::DequeueTask(IBuilderTask* task, bool done)
 			buildTasksCount--;
 		}
 	}
+	if (!task->IsDead()) {
+		deadTasks.push_back(task);
+	}
 	task->Dead();
 	task->Close(done);
 }
@@ -1173,26 +1186,31 @@ void CBuilderManager::Watchdog()
 void CBuilderManager::UpdateIdle()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CBuilderManager::UpdateIdle");
+	idleTask->GetNextSlice(idleSlice);
+	circuit->GetEconomyManager()->PrepareMexSpots(idleSlice);
 	idleTask->Update();
 }
 
 void CBuilderManager::UpdateBuild()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CBuilderManager::UpdateBuild");
+	// NOTE: Dead tasks are closed and out of all lists, their handles no longer resolve
+	utils::free_clear(deadTasks);
 	if (buildIterator >= buildUpdates.size()) {
 		buildIterator = 0;
 	}
 
 	int lastFrame = circuit->GetLastFrame();
 	// stagger the Update's
-	unsigned int n = (buildUpdates.size() / TEAM_SLOWUPDATE_RATE) + 1;
+	buildBudget.Start(buildUpdates.size(), TEAM_SLOWUPDATE_RATE);
 
-	while ((buildIterator < buildUpdates.size()) && (n != 0)) {
-		IUnitTask* task = buildUpdates[buildIterator];
-		if (task->IsDead()) {
+	while ((buildIterator < buildUpdates.size()) && buildBudget.IsAvailable()) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(buildUpdates[buildIterator]);
+		if ((task == nullptr) || task->IsDead()) {
 			buildUpdates[buildIterator] = buildUpdates.back();
 			buildUpdates.pop_back();
-			delete task;
 		} else {
 			int frame = task->GetLastTouched();
 			int timeout = task->GetTimeout();
@@ -1202,9 +1220,10 @@ void CBuilderManager::UpdateBuild()
 				task->Update();
 			}
 			++buildIterator;
-			n--;
+			buildBudget.Done();
 		}
 	}
+	buildBudget.Finish();
 }
 
 void CBuilderManager::UpdateAreaUsers()
@@ -12,6 +12,7 @@
 #include "task/builder/BuilderTask.h"
 #include "terrain/TerrainData.h"
 #include "unit/CircuitUnit.h"
+#include "util/FrameBudget.h"
 
 #include <map>
 #include <set>
@@ -162,10 +163,13 @@ private:
 	std::vector<std::set<IBuilderTask*>> buildTasks;  // UnitDef based tasks
 	unsigned int buildTasksCount;
 	float buildPower;
-	std::vector<IUnitTask*> buildUpdates;  // owner
+	std::vector<IUnitTask::Handle> buildUpdates;  // weak, stale handles of deleted tasks are skipped
+	std::vector<IUnitTask*> deadTasks;  // owner, deleted on next update
 	unsigned int buildIterator;
+	CFrameBudget buildBudget;
 
 	std::set<CCircuitUnit*> workers;
+	std::vector<CCircuitUnit*> idleSlice;  // builders that get tasks on this UpdateIdle
 
 	CCircuitDef* terraDef;
 	std::unordered_map<IBuilderTask::BT, std::unordered_map<CCircuitDef*, SBuildChain*>> buildChains;  // owner
@@ -12,9 +12,13 @@
 #include "setup/SetupManager.h"
 #include "resource/MetalManager.h"
 #include "resource/EnergyGrid.h"
+#include "resource/ReclaimData.h"
 #include "terrain/TerrainManager.h"
+#include "terrain/ThreatMap.h"
 #include "CircuitAI.h"
 #include "util/math/LagrangeInterPol.h"
+#include "util/Profiler.h"
+#include "util/SaveState.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
@@ -24,8 +28,6 @@
 #include "Map.h"
 #include "Resource.h"
 #include "Economy.h"
-#include "Feature.h"
-#include "FeatureDef.h"
 #include "Team.h"
 #include "Log.h"
 
@@ -38,10 +40,12 @@ using namespace springai;
 CEconomyManager::CEconomyManager(CCircuitAI* circuit)
 		: IModule(circuit)
 		, energyGrid(nullptr)
+		, reclaimData(nullptr)
 		, pylonDef(nullptr)
 		, mexDef(nullptr)
 		, storeDef(nullptr)
 		, mexCount(0)
+		, mexSpotsFrame(-1)
 		, lastFacFrame(-1)
 		, indexRes(0)
 		, metalIncome(.0f)
@@ -336,6 +340,7 @@ void CEconomyManager::ReadConfig()
 void CEconomyManager::Init()
 {
 	energyGrid = circuit->GetAllyTeam()->GetEnergyGrid().get();
+	reclaimData = circuit->GetAllyTeam()->GetReclaimData().get();
 
 	const size_t clSize = circuit->GetMetalManager()->GetClusters().size();
 	clusterInfos.resize(clSize, {nullptr, -FRAMES_PER_SEC});
@@ -439,6 +444,8 @@ int CEconomyManager::UnitDamaged(CCircuitUnit* unit, CEnemyUnit* attacker)
 
 int CEconomyManager::UnitDestroyed(CCircuitUnit* unit, CEnemyUnit* attacker)
 {
+	reclaimData->MarkArea(unit->GetPos(circuit->GetLastFrame()), SQUARE_SIZE * 8);  // wreck
+
 	auto search = destroyedHandler.find(unit->GetCircuitDef()->GetId());
 	if (search != destroyedHandler.end()) {
 		search->second(unit, attacker);
@@ -597,6 +604,39 @@ float CEconomyManager::GetEnergyUse()
 	return energyUse;
 }
 
+void CEconomyManager::Load(std::istream& is)
+{
+	// NOTE: Income history, so eco decisions right after load don't start from zero
+	SEconomyState state;
+	if (!state.Load(is) || (state.metalIncomes.size() != metalIncomes.size())
+		|| (state.energyIncomes.size() != energyIncomes.size()))
+	{
+		return;
+	}
+	metalIncomes = state.metalIncomes;
+	energyIncomes = state.energyIncomes;
+	indexRes = utils::clamp(state.indexRes, 0, INCOME_SAMPLES - 1);
+	metalIncome = state.metalIncome;
+	energyIncome = state.energyIncome;
+	metalProduced = state.metalProduced;
+	metalUsed = state.metalUsed;
+	lastFacFrame = state.lastFacFrame;
+}
+
+void CEconomyManager::Save(std::ostream& os) const
+{
+	SEconomyState state;
+	state.metalIncomes = metalIncomes;
+	state.energyIncomes = energyIncomes;
+	state.indexRes = indexRes;
+	state.metalIncome = metalIncome;
+	state.energyIncome = energyIncome;
+	state.metalProduced = metalProduced;
+	state.metalUsed = metalUsed;
+	state.lastFacFrame = lastFacFrame;
+	state.Save(os);
+}
+
 bool CEconomyManager::IsMetalEmpty()
 {
 	UpdateEconomy();
@@ -695,28 +735,18 @@ IBuilderTask* CEconomyManager::UpdateMetalTasks(const AIFloat3& position, CCircu
 		unsigned maxCount = builderManager->GetBuildPower() / cost * 8 + 2;
 		if (builderManager->GetTasks(IBuilderTask::BuildType::MEX).size() < maxCount) {
 			CMetalManager* metalManager = circuit->GetMetalManager();
-			CTerrainManager* terrainManager = circuit->GetTerrainManager();
 			const CMetalData::Metals& spots = metalManager->GetSpots();
-			Map* map = circuit->GetMap();
-			CMetalData::PointPredicate predicate;
-			if (unit != nullptr) {
-				CCircuitDef* mexDef = this->mexDef;
-				predicate = [this, &spots, map, mexDef, terrainManager, unit](int index) {
-					return (IsAllyOpenSpot(index) &&
-							terrainManager->CanBeBuiltAtSafe(mexDef, spots[index].position) &&  // hostile environment
-							terrainManager->CanBuildAtSafe(unit, spots[index].position) &&
-							map->IsPossibleToBuildAt(mexDef->GetUnitDef(), spots[index].position, UNIT_COMMAND_BUILD_NO_FACING));
-				};
-			} else {
-				CCircuitDef* mexDef = this->mexDef;
-				predicate = [this, &spots, map, mexDef, terrainManager, builderManager](int index) {
-					return (IsAllyOpenSpot(index) &&
-							terrainManager->CanBeBuiltAtSafe(mexDef, spots[index].position) &&  // hostile environment
-							builderManager->IsBuilderInArea(mexDef, spots[index].position) &&
-							map->IsPossibleToBuildAt(mexDef->GetUnitDef(), spots[index].position, UNIT_COMMAND_BUILD_NO_FACING));
-				};
+			CMetalData::PointPredicate predicate = MakeMexPredicate(unit);
+			auto it = mexSpots.end();
+			if ((unit != nullptr) && (mexSpotsFrame == circuit->GetLastFrame())) {
+				it = std::find_if(mexSpots.begin(), mexSpots.end(), [unit](const std::pair<CCircuitUnit*, int>& spot) {
+					return spot.first == unit;
+				});
 			}
-			int index = metalManager->GetMexToBuild(position, predicate);
+			// NOTE: Spot of batched run could be taken by another AI since then
+			int index = ((it != mexSpots.end()) && ((it->second < 0) || predicate(it->second)))
+					? it->second
+					: metalManager->GetMexToBuild(position, predicate);
 			if (index != -1) {
 				int cluster = metalManager->GetCluster(index);
 				if (!circuit->GetMilitaryManager()->HasDefence(cluster)) {
@@ -737,6 +767,61 @@ IBuilderTask* CEconomyManager::UpdateMetalTasks(const AIFloat3& position, CCircu
 	return task;
 }
 
+void CEconomyManager::PrepareMexSpots(const std::vector<CCircuitUnit*>& units)
+{
+	const int frame = circuit->GetLastFrame();
+	mexSpots.clear();
+	mexSpotsFrame = frame;
+	if ((units.size() < 2) || IsEnergyStalling() || !mexDef->IsAvailable(frame)) {
+		return;  // single builder asks UpdateMetalTasks directly
+	}
+	PROFILE_SCOPE("CEconomyManager::PrepareMexSpots");
+
+	CMetalManager* metalManager = circuit->GetMetalManager();
+	CThreatMap* threatMap = circuit->GetThreatMap();
+	struct SCandidate {
+		const std::vector<bool>* layer;  // safe clusters differ per threat layer
+		CCircuitUnit* unit;
+		AIFloat3 pos;
+	};
+	std::vector<SCandidate> candidates;
+	std::vector<int> starts;
+	for (CCircuitUnit* unit : units) {
+		// NOTE: Same throttle as MakeEconomyTasks: 1 request per cluster per second
+		const AIFloat3& pos = unit->GetPos(frame);
+		const int index = metalManager->FindNearestCluster(pos);
+		if ((index < 0) || (clusterInfos[index].metalFrame + FRAMES_PER_SEC >= frame)
+			|| (std::find(starts.begin(), starts.end(), index) != starts.end()))
+		{
+			continue;
+		}
+		starts.push_back(index);
+		threatMap->SetThreatType(unit);
+		candidates.push_back({&threatMap->GetSafeClusters(), unit, pos});
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const SCandidate& a, const SCandidate& b) {
+		return a.layer < b.layer;
+	});
+
+	std::vector<CMetalManager::SMexRequest> requests;
+	auto first = candidates.begin();
+	while (first != candidates.end()) {
+		auto last = std::find_if(first, candidates.end(), [first](const SCandidate& c) {
+			return c.layer != first->layer;
+		});
+		threatMap->SetThreatType(first->unit);
+		requests.clear();
+		for (auto it = first; it != last; ++it) {
+			requests.push_back({it->pos, MakeMexPredicate(it->unit), -1});
+		}
+		metalManager->GetMexToBuild(requests);
+		for (unsigned i = 0; i < requests.size(); ++i) {
+			mexSpots.push_back(std::make_pair((first + i)->unit, requests[i].result));
+		}
+		first = last;
+	}
+}
+
 IBuilderTask* CEconomyManager::UpdateReclaimTasks(const AIFloat3& position, CCircuitUnit* unit, bool isNear)
 {
 	CBuilderManager* builderManager = circuit->GetBuilderManager();
@@ -748,58 +833,36 @@ IBuilderTask* CEconomyManager::UpdateReclaimTasks(const AIFloat3& position, CCir
 		return nullptr;
 	}
 
-	std::vector<Feature*> features;
-	if (isNear) {
-		const float distance = unit->GetCircuitDef()->GetSpeed() * ((GetMetalPull() * 0.8f > GetAvgMetalIncome()) ? 300 : 30);
-		features = std::move(circuit->GetCallback()->GetFeaturesIn(position, distance));
-	} else {
-		features = std::move(circuit->GetCallback()->GetFeatures());
-	}
-	if (features.empty()) {
+	reclaimData->Update();
+	if (reclaimData->IsEmpty()) {
 		return nullptr;
 	}
+	const float distance = isNear
+			? unit->GetCircuitDef()->GetSpeed() * ((GetMetalPull() * 0.8f > GetAvgMetalIncome()) ? 300 : 30)
+			: std::numeric_limits<float>::max();
 
+	// Richest safe area instead of the nearest wreck: one area-reclaim task per battlefield
 	CTerrainManager* terrainManager = circuit->GetTerrainManager();
 	AIFloat3 pos;
-	float cost = .0f;
-	float minSqDist = std::numeric_limits<float>::max();
-	for (Feature* feature : features) {
-		AIFloat3 featPos = feature->GetPosition();
-		CTerrainManager::CorrectPosition(featPos);  // Impulsed flying feature
-		if (!terrainManager->CanBuildAtSafe(unit, featPos)) {
-			continue;
-		}
-		FeatureDef* featDef = feature->GetDef();
-		if (!featDef->IsReclaimable()) {
-			delete featDef;
-			continue;
-		}
-		float reclaimValue = featDef->GetContainedResource(metalRes)/* * feature->GetReclaimLeft()*/;
-		delete featDef;
-		if (reclaimValue < 1.0f) {
-			continue;
-		}
-		float sqDist = position.SqDistance2D(featPos);
-		if (sqDist < minSqDist) {
-			pos = featPos;
-			cost = reclaimValue;
-			minSqDist = sqDist;
-		}
-	}
+	float cost;
+	const bool isFound = reclaimData->FindRichestArea(position, distance,
+		[terrainManager, unit](const AIFloat3& areaPos) {
+			return terrainManager->CanBuildAtSafe(unit, areaPos);
+		}, pos, cost);
 	IBuilderTask* task = nullptr;
-	if (minSqDist < std::numeric_limits<float>::max()) {
+	if (isFound) {
+		const int areaIdx = reclaimData->GetAreaIndex(pos);
 		for (IBuilderTask* t : builderManager->GetTasks(IBuilderTask::BuildType::RECLAIM)) {
-			if (utils::is_equal_pos(pos, t->GetTaskPos())) {
+			if (reclaimData->GetAreaIndex(t->GetTaskPos()) == areaIdx) {
 				task = t;
 				break;
 			}
 		}
 		if (task == nullptr) {
 			task = builderManager->EnqueueReclaim(IBuilderTask::Priority::HIGH, pos, cost, FRAMES_PER_SEC * 300,
-												  8.0f/*unit->GetCircuitDef()->GetBuildDistance()*/);
+												  reclaimData->GetAreaRadius());
 		}
 	}
-	utils::free_clear(features);
 
 	return task;
 }
@@ -1236,6 +1299,29 @@ float CEconomyManager::GetStorage(Resource* res)
 	return economy->GetStorage(res) - HIDDEN_STORAGE;
 }
 
+std::function<bool (const int)> CEconomyManager::MakeMexPredicate(CCircuitUnit* unit)
+{
+	CTerrainManager* terrainManager = circuit->GetTerrainManager();
+	const CMetalData::Metals& spots = circuit->GetMetalManager()->GetSpots();
+	Map* map = circuit->GetMap();
+	CCircuitDef* mexDef = this->mexDef;
+	if (unit != nullptr) {
+		return [this, &spots, map, mexDef, terrainManager, unit](int index) {
+			return (IsAllyOpenSpot(index) &&
+					terrainManager->CanBeBuiltAtSafe(mexDef, spots[index].position) &&  // hostile environment
+					terrainManager->CanBuildAtSafe(unit, spots[index].position) &&
+					map->IsPossibleToBuildAt(mexDef->GetUnitDef(), spots[index].position, UNIT_COMMAND_BUILD_NO_FACING));
+		};
+	}
+	CBuilderManager* builderManager = circuit->GetBuilderManager();
+	return [this, &spots, map, mexDef, terrainManager, builderManager](int index) {
+		return (IsAllyOpenSpot(index) &&
+				terrainManager->CanBeBuiltAtSafe(mexDef, spots[index].position) &&  // hostile environment
+				builderManager->IsBuilderInArea(mexDef, spots[index].position) &&
+				map->IsPossibleToBuildAt(mexDef->GetUnitDef(), spots[index].position, UNIT_COMMAND_BUILD_NO_FACING));
+	};
+}
+
 void CEconomyManager::UpdateEconomy()
 {
 	if (ecoFrame + TEAM_SLOWUPDATE_RATE >= circuit->GetLastFrame()) {
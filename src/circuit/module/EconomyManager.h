@@ -14,6 +14,7 @@
 
 #include <set>
 #include <memory>
+#include <functional>
 
 namespace springai {
 	class Resource;
@@ -29,6 +30,7 @@ class IBuilderTask;
 class CLagrangeInterPol;
 class CGameTask;
 class CEnergyGrid;
+class CReclaimData;
 
 class CEconomyManager: public IModule {
 public:
@@ -48,6 +50,7 @@ public:
 	springai::Resource* GetMetalRes() const { return metalRes; }
 	springai::Resource* GetEnergyRes() const { return energyRes; }
 	CEnergyGrid* GetEnergyGrid() const { return energyGrid; }
+	CReclaimData* GetReclaimData() const { return reclaimData; }
 	CCircuitDef* GetMexDef() const { return mexDef; }
 	CCircuitDef* GetLowEnergy(const springai::AIFloat3& pos, float& outMake) const;
 	CCircuitDef* GetPylonDef() const { return pylonDef; }
@@ -79,6 +82,11 @@ public:
 
 	IBuilderTask* MakeEconomyTasks(const springai::AIFloat3& position, CCircuitUnit* unit = nullptr);
 	IBuilderTask* UpdateMetalTasks(const springai::AIFloat3& position, CCircuitUnit* unit = nullptr);
+	/*
+	 * Answer mex requests of builders that are about to get tasks with one metal Dijkstra
+	 * per threat layer, UpdateMetalTasks uses the spots within the same frame.
+	 */
+	void PrepareMexSpots(const std::vector<CCircuitUnit*>& units);
 	IBuilderTask* UpdateReclaimTasks(const springai::AIFloat3& position, CCircuitUnit* unit, bool isNear = true);
 	IBuilderTask* UpdateEnergyTasks(const springai::AIFloat3& position, CCircuitUnit* unit = nullptr);
 	IBuilderTask* UpdateFactoryTasks(const springai::AIFloat3& position, CCircuitUnit* unit = nullptr);
@@ -95,6 +103,7 @@ private:
 
 	float GetStorage(springai::Resource* res);
 	void UpdateEconomy();
+	std::function<bool (const int)> MakeMexPredicate(CCircuitUnit* unit);
 
 	Handlers2 createdHandler;
 	Handlers1 finishedHandler;
@@ -104,6 +113,7 @@ private:
 	springai::Resource* energyRes;
 	springai::Economy* economy;
 	CEnergyGrid* energyGrid;
+	CReclaimData* reclaimData;
 
 	struct SClusterInfo {
 		CCircuitUnit* factory;
@@ -121,6 +131,8 @@ private:
 	//       local spot's state descriptor needed for better expansion
 	std::vector<bool> openSpots;  // AI-local metal info
 	int mexCount;
+	std::vector<std::pair<CCircuitUnit*, int>> mexSpots;  // builder: spot index of batched run, -1 if none
+	int mexSpotsFrame;
 
 	std::set<CCircuitDef*> allEnergyDefs;
 	std::set<CCircuitDef*> availEnergyDefs;
@@ -185,6 +197,12 @@ private:
 
 	std::shared_ptr<CGameTask> morph;
 	std::set<CCircuitUnit*> morphees;
+
+public:
+	static constexpr uint32_t SAVE_VERSION = 1;
+private:
+	virtual void Load(std::istream& is) override;
+	virtual void Save(std::ostream& os) const override;
 };
 
 } // namespace circuit
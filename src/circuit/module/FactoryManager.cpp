@@ -18,6 +18,7 @@
 #include "task/static/ReclaimTask.h"
 #include "unit/FactoryData.h"
 #include "CircuitAI.h"
+#include "util/Profiler.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
@@ -40,6 +41,9 @@ CFactoryManager::CFactoryManager(CCircuitAI* circuit)
 		, assistDef(nullptr)
 		, bpRatio(1.f)
 		, reWeight(.5f)
+		, havenIndex([circuit](STerrainMapArea* area, const AIFloat3& position) {
+			return circuit->GetTerrainManager()->CanMoveToPos(area, position);
+		})
 {
 	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CFactoryManager::Init, this));
 
@@ -117,15 +121,8 @@ CFactoryManager::CFactoryManager(CCircuitAI* circuit)
 		if (!facs.empty()) {
 			factoryPower += unit->GetBuildSpeed();
 
-			bool isInHaven = false;
-			for (const AIFloat3& hav : havens) {
-				if (assPos.SqDistance2D(hav) < sqRadius) {
-					isInHaven = true;
-					break;
-				}
-			}
-			if (!isInHaven) {
-				havens.push_back(assPos);
+			if (!havenIndex.IsNear(assPos, sqRadius)) {
+				havenIndex.Add(assPos);
 				// TODO: Send HavenFinished message?
 			}
 		}
@@ -148,17 +145,8 @@ CFactoryManager::CFactoryManager(CCircuitAI* circuit)
 			if ((fac.nanos.erase(unit) == 0) || !fac.nanos.empty()) {
 				continue;
 			}
-			auto it = havens.begin();
-			while (it != havens.end()) {
-				if (it->SqDistance2D(assPos) < sqRadius) {
-//					it = havens.erase(it);  // NOTE: micro-opt
-					*it = havens.back();
-					havens.pop_back();
-					// TODO: Send HavenDestroyed message?
-				} else {
-					++it;
-				}
-			}
+			havenIndex.RemoveNear(assPos, sqRadius);
+			// TODO: Send HavenDestroyed message?
 		}
 		if (!assists[unit].empty()) {
 			factoryPower -= unit->GetBuildSpeed();
@@ -226,7 +214,10 @@ CFactoryManager::CFactoryManager(CCircuitAI* circuit)
 CFactoryManager::~CFactoryManager()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-	utils::free_clear(updateTasks);
+	utils::free_clear(deadTasks);
+	for (const IUnitTask::Handle& handle : updateTasks) {
+		delete IUnitTask::GetPool().Resolve(handle);
+	}
 }
 
 void CFactoryManager::ReadConfig()
@@ -512,11 +503,15 @@ void CFactoryManager::Release()
 {
 	// NOTE: Release expected to be called on CCircuit::Release.
 	//       It doesn't stop scheduled GameTasks for that reason.
-	for (IUnitTask* task : updateTasks) {
-		AbortTask(task);
+	for (const IUnitTask::Handle& handle : updateTasks) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(handle);
+		if ((task != nullptr) && !task->IsDead()) {
+			AbortTask(task);
+		}
 		// NOTE: Do not delete task as other AbortTask may ask for it
 	}
 	updateTasks.clear();
+	deadTasks.clear();
 }
 
 int CFactoryManager::UnitCreated(CCircuitUnit* unit, CCircuitUnit* builder)
@@ -607,14 +602,14 @@ CRecruitTask* CFactoryManager::EnqueueTask(CRecruitTask::Priority priority,
 {
 	CRecruitTask* task = new CRecruitTask(this, priority, buildDef, position, type, radius);
 	factoryTasks.push_back(task);
-	updateTasks.push_back(task);
+	updateTasks.push_back(task->GetHandle());
 	return task;
 }
 
 IUnitTask* CFactoryManager::EnqueueWait(bool stop, int timeout)
 {
 	CSWaitTask* task = new CSWaitTask(this, stop, timeout);
-	updateTasks.push_back(task);
+	updateTasks.push_back(task->GetHandle());
 	return task;
 }
 
@@ -624,7 +619,7 @@ IBuilderTask* CFactoryManager::EnqueueReclaim(IBuilderTask::Priority priority,
 											  int timeout)
 {
 	IBuilderTask* task = new CSReclaimTask(this, priority, position, .0f, timeout, radius);
-	updateTasks.push_back(task);
+	updateTasks.push_back(task->GetHandle());
 	return task;
 }
 
@@ -636,7 +631,7 @@ IBuilderTask* CFactoryManager::EnqueueRepair(IBuilderTask::Priority priority,
 		return it->second;
 	}
 	IBuilderTask* task = new CSRepairTask(this, priority, target);
-	updateTasks.push_back(task);
+	updateTasks.push_back(task->GetHandle());
 	repairedUnits[target->GetId()] = task;
 	return task;
 }
@@ -658,6 +653,9 @@ void CFactoryManager::DequeueTask(IUnitTask* task, bool done)
 			default: break;  // RECLAIM
 		}
 	}  // WAIT
+	if (!task->IsDead()) {
+		deadTasks.push_back(task);
+	}
 	task->Dead();
 	task->Close(done);
 }
@@ -779,41 +777,12 @@ CCircuitUnit* CFactoryManager::GetClosestFactory(AIFloat3 position)
 
 AIFloat3 CFactoryManager::GetClosestHaven(CCircuitUnit* unit) const
 {
-	if (havens.empty()) {
-		return -RgtVector;
-	}
-	float metric = std::numeric_limits<float>::max();
-	const AIFloat3& position = unit->GetPos(circuit->GetLastFrame());
-	CTerrainManager* terrainManager = circuit->GetTerrainManager();
-	auto it = havens.begin(), havIt = havens.end();
-	for (; it != havens.end(); ++it) {
-		if (!terrainManager->CanMoveToPos(unit->GetArea(), *it)) {
-			continue;
-		}
-		float qdist = it->SqDistance2D(position);
-		if (qdist < metric) {
-			havIt = it;
-			metric = qdist;
-		}
-	}
-	return (havIt != havens.end()) ? *havIt : AIFloat3(-RgtVector);
+	return havenIndex.FindClosest(unit->GetArea(), unit->GetPos(circuit->GetLastFrame()));
 }
 
 AIFloat3 CFactoryManager::GetClosestHaven(const AIFloat3& position) const
 {
-	if (havens.empty()) {
-		return -RgtVector;
-	}
-	float metric = std::numeric_limits<float>::max();
-	auto it = havens.begin(), havIt = havens.end();
-	for (; it != havens.end(); ++it) {
-		float qdist = it->SqDistance2D(position);
-		if (qdist < metric) {
-			havIt = it;
-			metric = qdist;
-		}
-	}
-	return (havIt != havens.end()) ? *havIt : AIFloat3(-RgtVector);
+	return havenIndex.FindClosest(position);
 }
 
 CRecruitTask* CFactoryManager::UpdateBuildPower(CCircuitUnit* unit)
@@ -1260,12 +1229,16 @@ void CFactoryManager::Watchdog()
 void CFactoryManager::UpdateIdle()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CFactoryManager::UpdateIdle");
 	idleTask->Update();
 }
 
 void CFactoryManager::UpdateFactory()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CFactoryManager::UpdateFactory");
+	// NOTE: Dead tasks are closed and out of all lists, their handles no longer resolve
+	utils::free_clear(deadTasks);
 	if (updateIterator >= updateTasks.size()) {
 		updateIterator = 0;
 	}
@@ -1275,11 +1248,10 @@ void CFactoryManager::UpdateFactory()
 	unsigned int n = (updateTasks.size() / TEAM_SLOWUPDATE_RATE) + 1;
 
 	while ((updateIterator < updateTasks.size()) && (n != 0)) {
-		IUnitTask* task = updateTasks[updateIterator];
-		if (task->IsDead()) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(updateTasks[updateIterator]);
+		if ((task == nullptr) || task->IsDead()) {
 			updateTasks[updateIterator] = updateTasks.back();
 			updateTasks.pop_back();
-			delete task;
 		} else {
 			int frame = task->GetLastTouched();
 			int timeout = task->GetTimeout();
@@ -10,9 +10,11 @@
 
 #include "module/UnitModule.h"
 #include "task/static/RecruitTask.h"
+#include "terrain/HavenIndex.h"
 #include "unit/CircuitUnit.h"
 
 #include <map>
+#include <set>
 
 namespace circuit {
 
@@ -68,6 +70,7 @@ public:
 	CCircuitDef* GetAssistDef() const { return assistDef; }
 	springai::AIFloat3 GetClosestHaven(CCircuitUnit* unit) const;
 	springai::AIFloat3 GetClosestHaven(const springai::AIFloat3& position) const;
+	void UpdateAreaUsers() { havenIndex.Invalidate(); }
 
 	CRecruitTask* UpdateBuildPower(CCircuitUnit* unit);
 	CRecruitTask* UpdateFirePower(CCircuitUnit* unit);
@@ -98,14 +101,15 @@ private:
 
 	std::map<CAllyUnit*, IBuilderTask*> unfinishedUnits;
 	std::vector<CRecruitTask*> factoryTasks;  // order matters
-	std::vector<IUnitTask*> updateTasks;  // owner
+	std::vector<IUnitTask::Handle> updateTasks;  // weak, stale handles of deleted tasks are skipped
+	std::vector<IUnitTask*> deadTasks;  // owner, deleted on next update
 	unsigned int updateIterator;
 	float factoryPower;
 
 	CCircuitDef* airpadDef;
 	CCircuitDef* assistDef;
 	std::map<CCircuitUnit*, std::set<CCircuitUnit*>> assists;  // nano 1:n factory
-	std::vector<springai::AIFloat3> havens;  // position behind factory
+	mutable CHavenIndex havenIndex;  // position behind factory, buckets are built by const lookups
 	std::map<ICoreUnit::Id, IBuilderTask*> repairedUnits;
 
 	CFactoryData* factoryData;
@@ -32,6 +32,8 @@
 #include "terrain/PathFinder.h"
 #include "unit/EnemyUnit.h"
 #include "CircuitAI.h"
+#include "util/Profiler.h"
+#include "util/SaveState.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
@@ -49,6 +51,7 @@ using namespace springai;
 CMilitaryManager::CMilitaryManager(CCircuitAI* circuit)
 		: IUnitModule(circuit)
 		, fightIterator(0)
+		, fightBudget("CMilitaryManager::UpdateFight")
 		, defenceIdx(0)
 		, scoutIdx(0)
 		, armyCost(0.f)
@@ -207,6 +210,7 @@ CMilitaryManager::CMilitaryManager(CCircuitAI* circuit)
 
 	const Json::Value& root = circuit->GetSetupManager()->GetConfig();
 	const float fighterRet = root["retreat"].get("fighter", 0.5f).asFloat();
+	fightBudget.SetBudget(root["budget"].get("fight", 1000).asInt());
 	const float commMod = root["quota"]["thr_mod"].get("comm", 1.f).asFloat();
 	float maxRadarDivCost = 0.f;
 	float maxSonarDivCost = 0.f;
@@ -277,7 +281,10 @@ CMilitaryManager::CMilitaryManager(CCircuitAI* circuit)
 CMilitaryManager::~CMilitaryManager()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-	utils::free_clear(fightUpdates);
+	utils::free_clear(deadTasks);
+	for (const IUnitTask::Handle& handle : fightUpdates) {
+		delete IUnitTask::GetPool().Resolve(handle);
+	}
 }
 
 void CMilitaryManager::ReadConfig()
@@ -458,11 +465,15 @@ void CMilitaryManager::Release()
 {
 	// NOTE: Release expected to be called on CCircuit::Release.
 	//       It doesn't stop scheduled GameTasks for that reason.
-	for (IUnitTask* task : fightUpdates) {
-		AbortTask(task);
+	for (const IUnitTask::Handle& handle : fightUpdates) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(handle);
+		if ((task != nullptr) && !task->IsDead()) {
+			AbortTask(task);
+		}
 		// NOTE: Do not delete task as other AbortTask may ask for it
 	}
 	fightUpdates.clear();
+	deadTasks.clear();
 }
 
 int CMilitaryManager::UnitCreated(CCircuitUnit* unit, CCircuitUnit* builder)
@@ -571,7 +582,7 @@ IFighterTask* CMilitaryManager::EnqueueTask(IFighterTask::FightType type)
 	}
 
 	fightTasks[static_cast<IFighterTask::FT>(type)].insert(task);
-	fightUpdates.push_back(task);
+	fightUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -581,7 +592,7 @@ IFighterTask* CMilitaryManager::EnqueueDefend(IFighterTask::FightType promote, f
 	IFighterTask* task = new CDefendTask(this, circuit->GetSetupManager()->GetBasePos(), defRadius,
 										 promote, promote, power, 1.0f / mod);
 	fightTasks[static_cast<IFighterTask::FT>(IFighterTask::FightType::DEFEND)].insert(task);
-	fightUpdates.push_back(task);
+	fightUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -590,7 +601,7 @@ IFighterTask* CMilitaryManager::EnqueueDefend(IFighterTask::FightType check, IFi
 	IFighterTask* task = new CDefendTask(this, circuit->GetSetupManager()->GetBasePos(), defRadius,
 										 check, promote, std::numeric_limits<float>::max(), 1.0f);
 	fightTasks[static_cast<IFighterTask::FT>(IFighterTask::FightType::DEFEND)].insert(task);
-	fightUpdates.push_back(task);
+	fightUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -598,14 +609,14 @@ IFighterTask* CMilitaryManager::EnqueueGuard(CCircuitUnit* vip)
 {
 	IFighterTask* task = new CFGuardTask(this, vip, 1.0f);
 	fightTasks[static_cast<IFighterTask::FT>(IFighterTask::FightType::GUARD)].insert(task);
-	fightUpdates.push_back(task);
+	fightUpdates.push_back(task->GetHandle());
 	return task;
 }
 
 CRetreatTask* CMilitaryManager::EnqueueRetreat()
 {
 	CRetreatTask* task = new CRetreatTask(this);
-	fightUpdates.push_back(task);
+	fightUpdates.push_back(task->GetHandle());
 	return task;
 }
 
@@ -614,6 +625,9 @@ void CMilitaryManager::DequeueTask(IFighterTask* task, bool done)
 	if (task->GetType() == IUnitTask::Type::FIGHTER) {
 		fightTasks[static_cast<IFighterTask::FT>(task->GetFightType())].erase(task);
 	}
+	if (!task->IsDead()) {
+		deadTasks.push_back(task);
+	}
 	task->Dead();
 	task->Close(done);
 }
@@ -1358,6 +1372,52 @@ void CMilitaryManager::MakeBaseDefence(const AIFloat3& pos)
 	}
 }
 
+void CMilitaryManager::Load(std::istream& is)
+{
+	SMilitaryState state;
+	if (!state.Load(is)) {
+		return;
+	}
+
+	for (unsigned i = 0; i < enemyInfos.size(); ++i) {
+		enemyInfos[i].cost = state.enemyInfos[i].cost;
+		enemyInfos[i].threat = state.enemyInfos[i].threat;
+	}
+	enemyMobileCost = state.enemyMobileCost;
+	mobileThreat = state.mobileThreat;
+	staticThreat = state.staticThreat;
+	enemyPos = state.enemyPos;
+	scoutIdx = std::min<unsigned int>(state.scoutIdx, scoutPath.size());
+	defenceIdx = std::min<unsigned int>(state.defenceIdx, clusterInfos.size());
+	enemyGroups.clear();
+	for (SMilitaryState::SGroup& g : state.groups) {
+		enemyGroups.emplace_back(g.pos);
+		SEnemyGroup& group = enemyGroups.back();
+		group.units = std::move(g.units);
+		group.roleCosts = g.roleCosts;
+		group.cost = g.cost;
+		group.threat = g.threat;
+	}
+}
+
+void CMilitaryManager::Save(std::ostream& os) const
+{
+	SMilitaryState state;
+	for (unsigned i = 0; i < enemyInfos.size(); ++i) {
+		state.enemyInfos[i] = {enemyInfos[i].cost, enemyInfos[i].threat};
+	}
+	state.enemyMobileCost = enemyMobileCost;
+	state.mobileThreat = mobileThreat;
+	state.staticThreat = staticThreat;
+	state.enemyPos = enemyPos;
+	state.scoutIdx = scoutIdx;
+	state.defenceIdx = defenceIdx;
+	for (const SEnemyGroup& group : enemyGroups) {
+		state.groups.push_back({group.units, group.pos, group.roleCosts, group.cost, group.threat});
+	}
+	state.Save(os);
+}
+
 void CMilitaryManager::Watchdog()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
@@ -1377,31 +1437,35 @@ void CMilitaryManager::Watchdog()
 void CMilitaryManager::UpdateIdle()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CMilitaryManager::UpdateIdle");
 	idleTask->Update();
 }
 
 void CMilitaryManager::UpdateFight()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	PROFILE_SCOPE("CMilitaryManager::UpdateFight");
+	// NOTE: Dead tasks are closed and out of all lists, their handles no longer resolve
+	utils::free_clear(deadTasks);
 	if (fightIterator >= fightUpdates.size()) {
 		fightIterator = 0;
 	}
 
 	// stagger the Update's
-	unsigned int n = (fightUpdates.size() / TEAM_SLOWUPDATE_RATE) + 1;
+	fightBudget.Start(fightUpdates.size(), TEAM_SLOWUPDATE_RATE);
 
-	while ((fightIterator < fightUpdates.size()) && (n != 0)) {
-		IUnitTask* task = fightUpdates[fightIterator];
-		if (task->IsDead()) {
+	while ((fightIterator < fightUpdates.size()) && fightBudget.IsAvailable()) {
+		IUnitTask* task = IUnitTask::GetPool().Resolve(fightUpdates[fightIterator]);
+		if ((task == nullptr) || task->IsDead()) {
 			fightUpdates[fightIterator] = fightUpdates.back();
 			fightUpdates.pop_back();
-			delete task;
 		} else {
 			task->Update();
 			++fightIterator;
-			n--;
+			fightBudget.Done();
 		}
 	}
+	fightBudget.Finish();
 }
 
 void CMilitaryManager::AddArmyCost(CCircuitUnit* unit)
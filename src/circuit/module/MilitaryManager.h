@@ -12,6 +12,7 @@
 #include "task/fighter/FighterTask.h"
 #include "unit/CircuitUnit.h"
 #include "unit/CircuitDef.h"
+#include "util/FrameBudget.h"
 
 #include <vector>
 #include <set>
@@ -137,8 +138,10 @@ private:
 	EHandlers destroyedHandler;
 
 	std::vector<std::set<IFighterTask*>> fightTasks;
-	std::vector<IUnitTask*> fightUpdates;  // owner
+	std::vector<IUnitTask::Handle> fightUpdates;  // weak, stale handles of deleted tasks are skipped
+	std::vector<IUnitTask*> deadTasks;  // owner, deleted on next update
 	unsigned int fightIterator;
+	CFrameBudget fightBudget;
 
 	CDefenceMatrix* defence;
 	unsigned int defenceIdx;
@@ -217,6 +220,16 @@ private:
 
 	std::shared_ptr<CGameTask> defend;
 	std::vector<std::pair<springai::AIFloat3, BuildVector>> buildDefence;
+
+public:
+	static constexpr uint32_t SAVE_VERSION = 1;
+private:
+	/*
+	 * Enemy estimate: costs, threats, groups and scout/defence cursors.
+	 * Fight tasks are not stored, units get new ones through UnitFinished on load.
+	 */
+	virtual void Load(std::istream& is) override;
+	virtual void Save(std::ostream& os) const override;
 };
 
 } // namespace circuit
@@ -12,10 +12,10 @@
 #include "setup/SetupManager.h"
 #include "terrain/TerrainManager.h"
 #include "CircuitAI.h"
+#include "util/SaveState.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
-#include "lemon/kruskal.h"
 
 #include "AISCommands.h"
 #include "Log.h"
@@ -23,47 +23,19 @@
 #include "Figure.h"
 #endif
 
+#include <algorithm>
+#include <numeric>
+
 namespace circuit {
 
 using namespace springai;
 
-class CEnergyGrid::SpanningLink : public lemon::MapBase<CEnergyGrid::OwnedGraph::Edge, bool> {
-public:
-	SpanningLink(const CEnergyGrid::SpanningTree& st, const std::vector<CEnergyLink>& links)
-		: spanningTree(st)
-		, links(links)
-	{}
-	Value operator[](Key k) const {
-		// NOTE: check for link.IsBeingBuilt solves vertex's pylon duplicates, but slows down grid construction
-		return (spanningTree.find(k) != spanningTree.end())
-				&& !links[CMetalData::Graph::id(k)].IsBeingBuilt();
-	}
-private:
-	const CEnergyGrid::SpanningTree& spanningTree;
-	const std::vector<CEnergyLink>& links;
-};
-
-class CEnergyGrid::DetectLink : public lemon::MapBase<CEnergyGrid::OwnedGraph::Edge, bool> {
-public:
-	DetectLink(const std::vector<CEnergyLink>& links) : links(links) {}
-	bool operator[](Key k) const {
-		const CEnergyLink& link = links[CMetalData::Graph::id(k)];
-		return !link.IsFinished() && link.IsValid();
-	}
-private:
-	const std::vector<CEnergyLink>& links;
-};
-
 CEnergyGrid::CEnergyGrid(CCircuitAI* circuit)
 		: circuit(circuit)
 		, markFrame(-1)
 		, isForceRebuild(false)
-		, ownedFilter(nullptr)
-		, ownedClusters(nullptr)
-		, edgeCosts(nullptr)
-		, spanningFilter(nullptr)
-		, spanningGraph(nullptr)
-		, spanningBfs(nullptr)
+		, frontierRoot(-1)
+		, isFrontierDirty(true)
 #ifdef DEBUG_VIS
 		, figureGridId(-1)
 		, figureInvalidId(-1)
@@ -91,14 +63,38 @@ CEnergyGrid::CEnergyGrid(CCircuitAI* circuit)
 CEnergyGrid::~CEnergyGrid()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
 
-	delete ownedFilter;
-	delete ownedClusters;
-	delete edgeCosts;
+void CEnergyGrid::Save(std::ostream& os) const
+{
+	SEnergyState state;
+	state.isValid.resize(links.size());
+	for (unsigned i = 0; i < links.size(); ++i) {
+		state.isValid[i] = links[i].IsValid();
+	}
+	state.Save(os);
+}
 
-	delete spanningFilter;
-	delete spanningGraph;
-	delete spanningBfs;
+bool CEnergyGrid::Load(std::istream& is)
+{
+	SEnergyState state;
+	if (!state.Load(is) || (state.isValid.size() != links.size())) {
+		return false;
+	}
+	for (unsigned i = 0; i < links.size(); ++i) {
+		CEnergyLink* link = &links[i];
+		link->SetValid(state.isValid[i]);
+		if (state.isValid[i]) {
+			continue;
+		}
+		// Same timeout as in CEconomyManager::UpdatePylonTasks, original timer is lost with save
+		circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>([link](CEnergyGrid* energyGrid) {
+			link->SetValid(true);
+			energyGrid->SetForceRebuild(true);
+		}, this), FRAMES_PER_SEC * 120);
+	}
+	SetForceRebuild(true);
+	return true;
 }
 
 void CEnergyGrid::ReadConfig()
@@ -122,22 +118,22 @@ void CEnergyGrid::Init()
 	const CMetalData::Clusters& clusters = metalManager->GetClusters();
 	const CMetalData::Graph& clusterGraph = metalManager->GetGraph();
 
-	ownedFilter = new OwnedFilter(clusterGraph, false);
-	ownedClusters = new OwnedGraph(clusterGraph, *ownedFilter);
-	edgeCosts = new CMetalData::WeightMap(clusterGraph);
-
-	spanningFilter = new SpanningLink(spanningTree, links);
-	spanningGraph = new SpanningGraph(metalManager->GetGraph(), *spanningFilter);
-	spanningBfs = new SpanningBFS(*spanningGraph);
-
 	linkedClusters.resize(clusters.size(), false);
-
+	treeEdges.resize(clusters.size());
+	isTreeEdge.resize(clusterGraph.edgeNum(), false);
+	predEdges.resize(clusters.size(), -1);
+	compIds.resize(clusters.size(), -1);
+
+	float maxRange = .0f;
+	for (auto& kv : pylonRanges) {
+		maxRange = std::max(maxRange, kv.second);
+	}
 	links.reserve(clusterGraph.edgeNum());
 	for (int i = 0; i < clusterGraph.edgeNum(); ++i) {
 		CMetalData::Graph::Edge edge = clusterGraph.edgeFromId(i);
 		int idx0 = clusterGraph.id(clusterGraph.u(edge));
 		int idx1 = clusterGraph.id(clusterGraph.v(edge));
-		links.emplace_back(idx0, clusters[idx0].position, idx1, clusters[idx1].position);
+		links.emplace_back(idx0, clusters[idx0].position, idx1, clusters[idx1].position, maxRange);
 	}
 }
 
@@ -166,7 +162,7 @@ void CEnergyGrid::Update()
 
 	circuit->GetMetalManager()->MarkAllyMexes(tmpMexes);
 	MarkClusters();
-	RebuildTree();
+	UpdateTree();
 
 	MarkAllyPylons(tmpPylons);
 	CheckGrid();
@@ -186,14 +182,24 @@ CEnergyLink* CEnergyGrid::GetLinkToBuild(CCircuitDef*& outDef, AIFloat3& outPos)
 		return nullptr;
 	}
 
-	DetectLink goal(links);
-	spanningBfs->init();
-	spanningBfs->addSource(spanningGraph->nodeFromId(index));
-	CMetalData::Graph::Edge target = spanningBfs->startEdge(goal);
-	if (target == lemon::INVALID) {
+	UpdateFrontier(index);
+
+	// Closest to the base unfinished link, links being built cut off their subtree
+	static std::vector<bool> blocked;  // NOTE: micro-opt
+	blocked.assign(linkedClusters.size(), false);
+	CEnergyLink* link = nullptr;
+	for (const SFrontier& f : frontier) {
+		const CEnergyLink& l = links[f.edgeIdx];
+		if (blocked[f.parent] || l.IsBeingBuilt()) {
+			blocked[f.child] = true;
+		} else if (!l.IsFinished() && l.IsValid()) {
+			link = &links[f.edgeIdx];
+			break;
+		}
+	}
+	if (link == nullptr) {
 		return nullptr;
 	}
-	CEnergyLink* link = &links[spanningGraph->id(target)];
 
 	/*
 	 * Find best build def and position
@@ -365,6 +371,9 @@ void CEnergyGrid::CheckGrid()
 			continue;
 		}
 		link.CheckConnection();
+		if (link.IsFinished()) {
+			UpdateEdge(edgeIdx, false);
+		}
 	}
 	linkPylons.clear();
 
@@ -374,6 +383,9 @@ void CEnergyGrid::CheckGrid()
 			continue;
 		}
 		link.CheckConnection();
+		if (!link.IsFinished()) {
+			UpdateEdge(edgeIdx, true);
+		}
 	}
 	unlinkPylons.clear();
 }
@@ -391,65 +403,308 @@ void CEnergyGrid::MarkClusters()
 	}
 }
 
-void CEnergyGrid::RebuildTree()
+float CEnergyGrid::GetEdgeCost(int edgeIdx) const
 {
-	if (linkClusters.empty() && unlinkClusters.empty() && !isForceRebuild) {
+	CMetalManager* metalManager = circuit->GetMetalManager();
+	const CMetalData::Graph::Edge edge = metalManager->GetGraph().edgeFromId(edgeIdx);
+	const float weight = metalManager->GetWeights()[edge];
+	const float width = circuit->GetTerrainManager()->GetTerrainWidth();
+	const float height = circuit->GetTerrainManager()->GetTerrainHeight();
+	const float baseWeight = width * width + height * height;
+	const float invBaseWeight = 1.0f / baseWeight;  // FIXME: only valid for 1 of the ally team
+
+	const CEnergyLink& link = links[edgeIdx];
+	if (link.IsFinished() || link.IsBeingBuilt()) {
+		// Mark used edges as const
+		return weight * invBaseWeight;
+	} else if (!link.IsValid()) {
+		return weight * baseWeight;
+	}
+	// Adjust weight by distance to base
+	const AIFloat3& basePos = circuit->GetSetupManager()->GetBasePos();
+	return weight * basePos.SqDistance2D(metalManager->GetCenters()[edge]) * invBaseWeight;
+}
+
+int CEnergyGrid::GetOpposite(int edgeIdx, int index) const
+{
+	const CEnergyLink& link = links[edgeIdx];
+	return (link.GetV0()->index == index) ? link.GetV1()->index : link.GetV0()->index;
+}
+
+bool CEnergyGrid::IsOwnedEdge(int edgeIdx) const
+{
+	const CEnergyLink& link = links[edgeIdx];
+	return linkedClusters[link.GetV0()->index] && linkedClusters[link.GetV1()->index];
+}
+
+void CEnergyGrid::AddTreeEdge(int edgeIdx)
+{
+	const CEnergyLink& link = links[edgeIdx];
+	treeEdges[link.GetV0()->index].push_back(edgeIdx);
+	treeEdges[link.GetV1()->index].push_back(edgeIdx);
+	isTreeEdge[edgeIdx] = true;
+	isFrontierDirty = true;
+}
+
+void CEnergyGrid::DelTreeEdge(int edgeIdx)
+{
+	const CEnergyLink& link = links[edgeIdx];
+	for (int index : {link.GetV0()->index, link.GetV1()->index}) {
+		std::vector<int>& edges = treeEdges[index];
+		auto it = std::find(edges.begin(), edges.end(), edgeIdx);
+		if (it != edges.end()) {
+			*it = edges.back();
+			edges.pop_back();
+		}
+	}
+	isTreeEdge[edgeIdx] = false;
+	isFrontierDirty = true;
+}
+
+void CEnergyGrid::InsertEdge(int edgeIdx)
+{
+	if (isTreeEdge[edgeIdx] || !IsOwnedEdge(edgeIdx)) {
 		return;
 	}
-	isForceRebuild = false;
+	const int idx0 = links[edgeIdx].GetV0()->index;
+	const int idx1 = links[edgeIdx].GetV1()->index;
+
+	// Find tree path idx0 -> idx1
+	static std::vector<int> queue;  // NOTE: micro-opt
+	queue.clear();
+	queue.push_back(idx0);
+	predEdges[idx0] = edgeIdx;  // any non-negative marks visited
+	for (unsigned i = 0; (i < queue.size()) && (predEdges[idx1] < 0); ++i) {
+		const int index = queue[i];
+		for (int e : treeEdges[index]) {
+			const int next = GetOpposite(e, index);
+			if (predEdges[next] < 0) {
+				predEdges[next] = e;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	if (predEdges[idx1] < 0) {
+		// Different trees, join them
+		AddTreeEdge(edgeIdx);
+	} else {
+		// Cycle: drop the most expensive edge
+		int maxEdge = edgeIdx;
+		float maxCost = GetEdgeCost(edgeIdx);
+		for (int index = idx1; index != idx0;) {
+			const int e = predEdges[index];
+			const float cost = GetEdgeCost(e);
+			if (cost > maxCost) {
+				maxCost = cost;
+				maxEdge = e;
+			}
+			index = GetOpposite(e, index);
+		}
+		if (maxEdge != edgeIdx) {
+			DelTreeEdge(maxEdge);
+			AddTreeEdge(edgeIdx);
+		}
+	}
+
+	for (int index : queue) {
+		predEdges[index] = -1;
+	}
+}
+
+void CEnergyGrid::ReconnectTree(const std::vector<int>& pieces)
+{
 	CMetalManager* metalManager = circuit->GetMetalManager();
 	const CMetalData::Graph& clusterGraph = metalManager->GetGraph();
 
-	// Remove destroyed edges
-	for (int index : unlinkClusters) {
-		OwnedGraph::Node node = ownedClusters->nodeFromId(index);
-		ownedClusters->disable(node);
-		OwnedGraph::IncEdgeIt edgeIt(*ownedClusters, node);
-		for (; edgeIt != lemon::INVALID; ++edgeIt) {
-			spanningTree.erase(edgeIt);
+	// Label pieces of the split tree
+	static std::vector<int> labeled;  // NOTE: micro-opt
+	labeled.clear();
+	for (unsigned comp = 0; comp < pieces.size(); ++comp) {
+		if (compIds[pieces[comp]] >= 0) {
+			continue;
+		}
+		const unsigned start = labeled.size();
+		labeled.push_back(pieces[comp]);
+		compIds[pieces[comp]] = comp;
+		for (unsigned i = start; i < labeled.size(); ++i) {
+			const int index = labeled[i];
+			for (int e : treeEdges[index]) {
+				const int next = GetOpposite(e, index);
+				if (compIds[next] < 0) {
+					compIds[next] = comp;
+					labeled.push_back(next);
+				}
+			}
 		}
 	}
-	unlinkClusters.clear();
 
-	// Add new edges to Kruskal graph
-	for (int index : linkClusters) {
-		CMetalData::Graph::Node node = clusterGraph.nodeFromId(index);
-		ownedClusters->enable(node);
-		CMetalData::Graph::IncEdgeIt edgeIt(clusterGraph, node);
+	// Kruskal over edges between pieces
+	static std::vector<std::pair<float, int>> candidates;  // NOTE: micro-opt
+	candidates.clear();
+	for (int index : labeled) {
+		CMetalData::Graph::IncEdgeIt edgeIt(clusterGraph, clusterGraph.nodeFromId(index));
 		for (; edgeIt != lemon::INVALID; ++edgeIt) {
-			int idx0 = clusterGraph.id(clusterGraph.oppositeNode(node, edgeIt));
-			if (linkedClusters[idx0]) {
-				CEnergyLink& link = links[clusterGraph.id(edgeIt)];
-				link.SetStartVertex(idx0);
+			const int edgeIdx = clusterGraph.id(edgeIt);
+			const int next = clusterGraph.id(clusterGraph.oppositeNode(clusterGraph.nodeFromId(index), edgeIt));
+			if ((index < next) && linkedClusters[next] && (compIds[next] >= 0) && (compIds[next] != compIds[index])) {
+				candidates.push_back(std::make_pair(GetEdgeCost(edgeIdx), edgeIdx));
 			}
 		}
 	}
+	std::sort(candidates.begin(), candidates.end());
+
+	std::vector<int> parents(pieces.size());
+	std::iota(parents.begin(), parents.end(), 0);
+	auto find = [&parents](int comp) {
+		while (parents[comp] != comp) {
+			comp = parents[comp] = parents[parents[comp]];
+		}
+		return comp;
+	};
+	for (const std::pair<float, int>& cand : candidates) {
+		const CEnergyLink& link = links[cand.second];
+		const int comp0 = find(compIds[link.GetV0()->index]);
+		const int comp1 = find(compIds[link.GetV1()->index]);
+		if (comp0 != comp1) {
+			parents[comp0] = comp1;
+			AddTreeEdge(cand.second);
+		}
+	}
+
+	for (int index : labeled) {
+		compIds[index] = -1;
+	}
+}
+
+void CEnergyGrid::LinkCluster(int index)
+{
+	const CMetalData::Graph& clusterGraph = circuit->GetMetalManager()->GetGraph();
+	CMetalData::Graph::Node node = clusterGraph.nodeFromId(index);
+	CMetalData::Graph::IncEdgeIt edgeIt(clusterGraph, node);
+	for (; edgeIt != lemon::INVALID; ++edgeIt) {
+		int idx0 = clusterGraph.id(clusterGraph.oppositeNode(node, edgeIt));
+		if (linkedClusters[idx0]) {
+			const int edgeIdx = clusterGraph.id(edgeIt);
+			links[edgeIdx].SetStartVertex(idx0);
+			InsertEdge(edgeIdx);
+		}
+	}
+}
+
+void CEnergyGrid::UnlinkCluster(int index)
+{
+	std::vector<int> pieces;
+	const std::vector<int> edges = treeEdges[index];
+	for (int edgeIdx : edges) {
+		pieces.push_back(GetOpposite(edgeIdx, index));
+		DelTreeEdge(edgeIdx);
+	}
+	if (pieces.size() > 1) {
+		ReconnectTree(pieces);
+	}
+}
+
+void CEnergyGrid::UpdateEdge(int edgeIdx, bool isCostUp)
+{
+	if (!IsOwnedEdge(edgeIdx)) {
+		return;
+	}
+	if (isTreeEdge[edgeIdx]) {
+		if (isCostUp) {
+			// Edge itself is a candidate to reconnect
+			DelTreeEdge(edgeIdx);
+			ReconnectTree({links[edgeIdx].GetV0()->index, links[edgeIdx].GetV1()->index});
+		}
+	} else if (!isCostUp) {
+		InsertEdge(edgeIdx);
+	}
+}
+
+void CEnergyGrid::UpdateTree()
+{
+	if (linkClusters.empty() && unlinkClusters.empty() && !isForceRebuild) {
+		return;
+	}
+
+	for (int index : unlinkClusters) {
+		UnlinkCluster(index);
+	}
+	unlinkClusters.clear();
+
+	for (int index : linkClusters) {
+		LinkCluster(index);
+	}
 	linkClusters.clear();
 
-	const CMetalData::WeightMap& weights = metalManager->GetWeights();
-	const CMetalData::CenterMap& centers = metalManager->GetCenters();
-	float width = circuit->GetTerrainManager()->GetTerrainWidth();
-	float height = circuit->GetTerrainManager()->GetTerrainHeight();
-	float baseWeight = width * width + height * height;
-	float invBaseWeight = 1.0f / baseWeight;  // FIXME: only valid for 1 of the ally team
-	const AIFloat3& basePos = circuit->GetSetupManager()->GetBasePos();
+	if (isForceRebuild) {
+		// Validity of unknown links has changed
+		isForceRebuild = false;
+		RebuildTree();
+	}
+}
 
-	for (const CMetalData::Graph::Edge edge : spanningTree) {
-		CEnergyLink& link = links[clusterGraph.id(edge)];
-		if (link.IsFinished() || link.IsBeingBuilt()) {
-			// Mark used edges as const
-			(*edgeCosts)[edge] = weights[edge] * invBaseWeight;
-		} else if (!link.IsValid()) {
-			(*edgeCosts)[edge] = weights[edge] * baseWeight;
-		} else {
-			// Adjust weight by distance to base
-			(*edgeCosts)[edge] = weights[edge] * basePos.SqDistance2D(centers[edge]) * invBaseWeight;
+void CEnergyGrid::RebuildTree()
+{
+	for (std::vector<int>& edges : treeEdges) {
+		edges.clear();
+	}
+	std::fill(isTreeEdge.begin(), isTreeEdge.end(), false);
+	isFrontierDirty = true;
+
+	// Build Kruskal's minimum spanning forest
+	std::vector<std::pair<float, int>> candidates;
+	for (unsigned edgeIdx = 0; edgeIdx < links.size(); ++edgeIdx) {
+		if (IsOwnedEdge(edgeIdx)) {
+			candidates.push_back(std::make_pair(GetEdgeCost(edgeIdx), edgeIdx));
 		}
 	}
+	std::sort(candidates.begin(), candidates.end());
 
-	// Build Kruskal's minimum spanning tree
-	spanningTree.clear();
-	lemon::kruskal(*ownedClusters, *edgeCosts, std::inserter(spanningTree, spanningTree.end()));
+	std::vector<int> parents(linkedClusters.size());
+	std::iota(parents.begin(), parents.end(), 0);
+	auto find = [&parents](int index) {
+		while (parents[index] != index) {
+			index = parents[index] = parents[parents[index]];
+		}
+		return index;
+	};
+	for (const std::pair<float, int>& cand : candidates) {
+		const CEnergyLink& link = links[cand.second];
+		const int idx0 = find(link.GetV0()->index);
+		const int idx1 = find(link.GetV1()->index);
+		if (idx0 != idx1) {
+			parents[idx0] = idx1;
+			AddTreeEdge(cand.second);
+		}
+	}
+}
+
+void CEnergyGrid::UpdateFrontier(int root)
+{
+	if ((frontierRoot == root) && !isFrontierDirty) {
+		return;
+	}
+	frontierRoot = root;
+	isFrontierDirty = false;
+
+	frontier.clear();
+	predEdges[root] = -2;  // visited
+	for (unsigned i = 0; i <= frontier.size(); ++i) {
+		const int index = (i == 0) ? root : frontier[i - 1].child;
+		for (int e : treeEdges[index]) {
+			const int next = GetOpposite(e, index);
+			if (predEdges[next] == -1) {
+				predEdges[next] = e;
+				frontier.push_back({e, index, next});
+			}
+		}
+	}
+
+	predEdges[root] = -1;
+	for (const SFrontier& f : frontier) {
+		predEdges[f.child] = -1;
+	}
 }
 
 #ifdef DEBUG_VIS
@@ -505,7 +760,11 @@ void CEnergyGrid::UpdateVis()
 	figureKruskalId = fig->DrawLine(ZeroVector, ZeroVector, 0.0f, false, FRAMES_PER_SEC * 300, 0);
 	const CMetalData::Clusters& clusters = circuit->GetMetalManager()->GetClusters();
 	const CMetalData::Graph& clusterGraph = circuit->GetMetalManager()->GetGraph();
-	for (const CMetalData::Graph::Edge edge : spanningTree) {
+	for (unsigned edgeIdx = 0; edgeIdx < isTreeEdge.size(); ++edgeIdx) {
+		if (!isTreeEdge[edgeIdx]) {
+			continue;
+		}
+		const CMetalData::Graph::Edge edge = clusterGraph.edgeFromId(edgeIdx);
 		const AIFloat3& posFrom = clusters[clusterGraph.id(clusterGraph.u(edge))].position;
 		const AIFloat3& posTo = clusters[clusterGraph.id(clusterGraph.v(edge))].position;
 		AIFloat3 pos0 = posFrom;
@@ -12,12 +12,13 @@
 #include "resource/MetalData.h"
 #include "unit/CircuitUnit.h"
 #include "unit/CircuitDef.h"
-#include "lemon/adaptors.h"
-#include "lemon/bfs.h"
 
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <deque>
+#include <iostream>
+#include <vector>
 
 namespace circuit {
 
@@ -41,6 +42,13 @@ public:
 
 	void SetAuthority(CCircuitAI* authority) { circuit = authority; }
 
+	static constexpr uint32_t SAVE_VERSION = 1;
+	/*
+	 * Links learned to be unbuildable. Pylons and finished links are re-read from ally units.
+	 */
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+
 private:
 	CCircuitAI* circuit;
 
@@ -62,24 +70,38 @@ private:
 	std::vector<int> unlinkClusters;
 	bool isForceRebuild;
 
-	class SpanningLink;
-	class DetectLink;
-	using OwnedFilter = CMetalData::Graph::NodeMap<bool>;
-	using OwnedGraph = lemon::FilterNodes<const CMetalData::Graph, OwnedFilter>;
-	using SpanningTree = std::set<CMetalData::Graph::Edge>;
-	using SpanningGraph = lemon::FilterEdges<const CMetalData::Graph, SpanningLink>;
-	using SpanningBFS = lemon::Bfs<SpanningGraph>;
-
-	SpanningTree spanningTree;
-	OwnedFilter* ownedFilter;
-	OwnedGraph* ownedClusters;
-	CMetalData::WeightMap* edgeCosts;
-
-	SpanningLink* spanningFilter;
-	SpanningGraph* spanningGraph;
-	SpanningBFS* spanningBfs;  // breadth-first search
+	/*
+	 * Minimum spanning forest over owned clusters is maintained incrementally:
+	 * inserted edge replaces the most expensive edge of the cycle it closes,
+	 * removed edge (or cluster) is replaced by the cheapest edges reconnecting the pieces.
+	 */
+	struct SFrontier {
+		int edgeIdx;
+		int parent;  // cluster closer to the base
+		int child;
+	};
+	std::vector<std::vector<int>> treeEdges;  // per cluster, edges of spanning forest
+	std::vector<bool> isTreeEdge;
+	std::vector<SFrontier> frontier;  // tree edges in BFS order from base cluster
+	int frontierRoot;
+	bool isFrontierDirty;
+	std::vector<int> predEdges;  // BFS scratch
+	std::vector<int> compIds;  // reconnect scratch
+
+	float GetEdgeCost(int edgeIdx) const;
+	int GetOpposite(int edgeIdx, int index) const;
+	bool IsOwnedEdge(int edgeIdx) const;
+	void AddTreeEdge(int edgeIdx);
+	void DelTreeEdge(int edgeIdx);
+	void InsertEdge(int edgeIdx);
+	void ReconnectTree(const std::vector<int>& pieces);
+	void LinkCluster(int index);
+	void UnlinkCluster(int index);
+	void UpdateEdge(int edgeIdx, bool isCostUp);
+	void UpdateFrontier(int root);
 
 	void MarkClusters();
+	void UpdateTree();
 	void RebuildTree();
 
 #ifdef DEBUG_VIS
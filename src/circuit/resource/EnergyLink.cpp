@@ -9,15 +9,18 @@
 #include "resource/EnergyLink.h"
 #include "util/utils.h"
 
-#include <queue>
+#include <algorithm>
+#include <limits>
 
 namespace circuit {
 
 using namespace springai;
 
-CEnergyLink::CEnergyLink(int idx0, const AIFloat3& P0, int idx1, const AIFloat3& P1)
+CEnergyLink::CEnergyLink(int idx0, const AIFloat3& P0, int idx1, const AIFloat3& P1, float cellSize)
 		: v0(new SVertex(idx0, P0))
 		, v1(new SVertex(idx1, P1))
+		, cellSize(std::max(cellSize, 64.f))
+		, maxRange(.0f)
 		, isBeingBuilt(false)
 		, isFinished(false)
 		, isValid(true)
@@ -41,17 +44,8 @@ void CEnergyLink::AddPylon(ICoreUnit::Id unitId, const AIFloat3& pos, float rang
 	}
 
 	SPylon* pylon0 = new SPylon(pos, range);
-
-	for (auto& kv : pylons) {
-		SPylon* pylon1 = kv.second;
-		float dist = range + pylon1->range;
-		if (pos.SqDistance2D(pylon1->pos) < dist * dist) {
-			pylon0->neighbors.insert(pylon1);
-			pylon1->neighbors.insert(pylon0);
-		}
-	}
-
 	pylons[unitId] = pylon0;
+	maxRange = std::max(maxRange, range);
 
 	float sqRange = range * range;
 	if (v0->pos.SqDistance2D(pos) < sqRange) {
@@ -60,6 +54,12 @@ void CEnergyLink::AddPylon(ICoreUnit::Id unitId, const AIFloat3& pos, float rang
 	if (v1->pos.SqDistance2D(pos) < sqRange) {
 		v1->pylons.insert(pylon0);
 	}
+
+	ResetNode(pylon0);
+	ForEachNeighbor(pylon0, [this, pylon0](SPylon* pylon1) {
+		Union(pylon0, pylon1);
+	});
+	InsertCell(pylon0);
 }
 
 bool CEnergyLink::RemovePylon(ICoreUnit::Id unitId)
@@ -70,11 +70,10 @@ bool CEnergyLink::RemovePylon(ICoreUnit::Id unitId)
 	}
 	SPylon* pylon0 = it->second;
 
-	for (SPylon* pylon1 : pylon0->neighbors) {
-		pylon1->neighbors.erase(pylon0);
-	}
+	EraseCell(pylon0);
 	v0->pylons.erase(pylon0);
 	v1->pylons.erase(pylon0);
+	Split(pylon0);
 	delete pylon0;
 
 	return it != pylons.erase(it);
@@ -82,34 +81,11 @@ bool CEnergyLink::RemovePylon(ICoreUnit::Id unitId)
 
 void CEnergyLink::CheckConnection()
 {
-	int i = 0;
-	std::set<SPylon*> visited;
-	std::queue<SPylon*> queue;
-
 	for (SPylon* p : v0->pylons) {
-		queue.push(p);
-	}
-
-	while (!queue.empty()) {
-		SPylon* q = queue.front();
-		queue.pop();
-		float dist = q->range;
-		if (v1->pos.SqDistance2D(q->pos) < dist * dist) {
+		if (Find(p)->touch == TOUCH_BOTH) {
 			isFinished = true;
 			return;
 		}
-
-		if (i++ > 1000) {
-			isValid = false;
-			break;
-		}
-
-		visited.insert(q);
-		for (SPylon* child : q->neighbors) {
-			if (visited.find(child) == visited.end()) {
-				queue.push(child);
-			}
-		}
 	}
 
 	isFinished = false;
@@ -127,37 +103,143 @@ CEnergyLink::SPylon* CEnergyLink::GetConnectionHead(SVertex* v0, const AIFloat3&
 	SPylon* winner = nullptr;
 	float minDist = std::numeric_limits<float>::max();
 
-	int i = 0;
-	std::set<SPylon*> visited;
-	std::queue<SPylon*> queue;
-
 	for (SPylon* p : v0->pylons) {
-		queue.push(p);
-	}
-
-	while (!queue.empty()) {
-		SPylon* q = queue.front();
-		queue.pop();
-		float dist = P1.distance2D(q->pos) - q->range;
-		if (dist < minDist) {
-			minDist = dist;
-			winner = q;
+		SPylon* root = Find(p);
+		if (std::find(roots.begin(), roots.end(), root) != roots.end()) {
+			continue;
 		}
+		roots.push_back(root);
 
-		if (i++ > 1000) {
-			isValid = false;
-			return winner;
+		for (SPylon* q : root->members) {
+			float dist = P1.distance2D(q->pos) - q->range;
+			if (dist < minDist) {
+				minDist = dist;
+				winner = q;
+			}
 		}
+	}
+	roots.clear();
+
+	return winner;
+}
 
-		visited.insert(q);
-		for (SPylon* child : q->neighbors) {
-			if (visited.find(child) == visited.end()) {
-				queue.push(child);
+void CEnergyLink::InsertCell(SPylon* pylon)
+{
+	const int x = pylon->pos.x / cellSize;
+	const int z = pylon->pos.z / cellSize;
+	cells[GetCellKey(x, z)].push_back(pylon);
+}
+
+void CEnergyLink::EraseCell(SPylon* pylon)
+{
+	const int x = pylon->pos.x / cellSize;
+	const int z = pylon->pos.z / cellSize;
+	auto it = cells.find(GetCellKey(x, z));
+	if (it == cells.end()) {
+		return;
+	}
+	std::vector<SPylon*>& cell = it->second;
+	auto itP = std::find(cell.begin(), cell.end(), pylon);
+	if (itP != cell.end()) {
+		*itP = cell.back();
+		cell.pop_back();
+	}
+	if (cell.empty()) {
+		cells.erase(it);
+	}
+}
+
+template<typename F>
+void CEnergyLink::ForEachNeighbor(SPylon* pylon0, F&& func)
+{
+	// Neighbors overlap: distance < range0 + range1 <= range0 + maxRange
+	const float radius = pylon0->range + maxRange;
+	const int x1 = std::max<int>((pylon0->pos.x - radius) / cellSize, 0);
+	const int x2 = (pylon0->pos.x + radius) / cellSize;
+	const int z1 = std::max<int>((pylon0->pos.z - radius) / cellSize, 0);
+	const int z2 = (pylon0->pos.z + radius) / cellSize;
+	for (int z = z1; z <= z2; ++z) {
+		for (int x = x1; x <= x2; ++x) {
+			auto it = cells.find(GetCellKey(x, z));
+			if (it == cells.end()) {
+				continue;
+			}
+			for (SPylon* pylon1 : it->second) {
+				const float dist = pylon0->range + pylon1->range;
+				if ((pylon1 != pylon0) && (pylon0->pos.SqDistance2D(pylon1->pos) < dist * dist)) {
+					func(pylon1);
+				}
 			}
 		}
 	}
+}
 
-	return winner;
+CEnergyLink::SPylon* CEnergyLink::Find(SPylon* pylon)
+{
+	SPylon* root = pylon;
+	while (root->parent != root) {
+		root = root->parent;
+	}
+	while (pylon->parent != root) {  // path compression
+		SPylon* next = pylon->parent;
+		pylon->parent = root;
+		pylon = next;
+	}
+	return root;
+}
+
+void CEnergyLink::Union(SPylon* pylon0, SPylon* pylon1)
+{
+	SPylon* root0 = Find(pylon0);
+	SPylon* root1 = Find(pylon1);
+	if (root0 == root1) {
+		return;
+	}
+	// Union by size, members of smaller component move into larger one
+	if (root0->members.size() < root1->members.size()) {
+		std::swap(root0, root1);
+	}
+	root1->parent = root0;
+	root0->members.insert(root0->members.end(), root1->members.begin(), root1->members.end());
+	root0->touch |= root1->touch;
+	std::vector<SPylon*>().swap(root1->members);
+	root1->touch = 0;
+}
+
+void CEnergyLink::ResetNode(SPylon* pylon)
+{
+	pylon->parent = pylon;
+	pylon->members.assign(1, pylon);
+	pylon->touch = 0;
+	if (v0->pylons.find(pylon) != v0->pylons.end()) {
+		pylon->touch |= TOUCH_V0;
+	}
+	if (v1->pylons.find(pylon) != v1->pylons.end()) {
+		pylon->touch |= TOUCH_V1;
+	}
+}
+
+void CEnergyLink::Split(SPylon* pylon)
+{
+	// NOTE: Union-find can't split, component of removed pylon is built anew from its members.
+	//       Neighbors are always in the same component, other components stay intact.
+	SPylon* root = Find(pylon);
+	splitPylons.clear();
+	for (SPylon* p : root->members) {
+		if (p != pylon) {
+			splitPylons.push_back(p);
+		}
+	}
+	for (SPylon* pylon0 : splitPylons) {
+		ResetNode(pylon0);
+	}
+	for (SPylon* pylon0 : splitPylons) {
+		ForEachNeighbor(pylon0, [this, pylon0](SPylon* pylon1) {
+			if (pylon0 < pylon1) {  // each pair once
+				Union(pylon0, pylon1);
+			}
+		});
+	}
 }
 
 } // namespace circuit
@@ -12,17 +12,22 @@
 
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace circuit {
 
 class CEnergyLink {
 public:
 	struct SPylon {
-		SPylon() : pos(-RgtVector), range(.0f) {}
-		SPylon(const springai::AIFloat3& p, float r) : pos(p), range(r) {}
+		SPylon() : pos(-RgtVector), range(.0f), parent(this), touch(0) {}
+		SPylon(const springai::AIFloat3& p, float r) : pos(p), range(r), parent(this), touch(0) {}
 		springai::AIFloat3 pos;
 		float range;
-		std::set<SPylon*> neighbors;
+		// Union-find node, members and touch are valid only for the root of a component
+		SPylon* parent;
+		std::vector<SPylon*> members;
+		int touch;  // TOUCH_V0 | TOUCH_V1 of the component
 	};
 	struct SVertex {
 		SVertex(int index, const springai::AIFloat3& pos) : index(index), pos(pos) {}
@@ -31,7 +36,10 @@ public:
 		springai::AIFloat3 pos;
 	};
 
-	CEnergyLink(int idx0, const springai::AIFloat3& P0, int idx1, const springai::AIFloat3& P1);
+	/*
+	 * @param cellSize  size of pylon lookup grid's cell, about the largest pylon range
+	 */
+	CEnergyLink(int idx0, const springai::AIFloat3& P0, int idx1, const springai::AIFloat3& P1, float cellSize);
 	virtual ~CEnergyLink();
 
 	void AddPylon(ICoreUnit::Id unitId, const springai::AIFloat3& pos, float range);
@@ -49,9 +57,26 @@ public:
 	SVertex* GetV1() const { return v1; }
 
 private:
+	enum TouchMask: int {TOUCH_V0 = 0x01, TOUCH_V1 = 0x02, TOUCH_BOTH = TOUCH_V0 | TOUCH_V1};
+
+	int GetCellKey(int x, int z) const { return (z << 16) | (x & 0xFFFF); }
+	void InsertCell(SPylon* pylon);
+	void EraseCell(SPylon* pylon);
+	template<typename F> void ForEachNeighbor(SPylon* pylon, F&& func);
+
+	SPylon* Find(SPylon* pylon);
+	void Union(SPylon* pylon0, SPylon* pylon1);
+	void ResetNode(SPylon* pylon);
+	void Split(SPylon* pylon);  // before pylon is removed
+
 	SVertex *v0, *v1;
 
 	std::map<ICoreUnit::Id, SPylon*> pylons;  // owner
+	std::unordered_map<int, std::vector<SPylon*>> cells;  // pylon lookup grid
+	float cellSize;
+	float maxRange;
+	std::vector<SPylon*> roots;  // GetConnectionHead scratch
+	std::vector<SPylon*> splitPylons;  // Split scratch
 	bool isBeingBuilt;
 	bool isFinished;
 	bool isValid;
@@ -11,6 +11,8 @@
 #include "terrain/ThreatMap.h"
 #include "CircuitAI.h"
 #include "util/math/RagMatrix.h"
+#include "util/Profiler.h"
+#include "util/SaveState.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 
@@ -19,59 +21,17 @@
 #include "Pathing.h"
 #include "Map.h"
 
+#include <algorithm>
+#include <functional>
+
 namespace circuit {
 
 using namespace springai;
 
-class CMetalManager::SafeCluster : public lemon::MapBase<ClusterGraph::Node, bool> {
-public:
-	SafeCluster(CThreatMap* tm, const CMetalData::Clusters& cs)
-		: threatMap(tm)
-		, clusters(cs)
-	{}
-	Value operator[](Key k) const {
-		return (*this)[CMetalData::Graph::id(k)];
-	}
-	Value operator[](int u) const {
-		return threatMap->GetThreatAt(clusters[u].position) <= THREAT_MIN;
-	}
-private:
-	CThreatMap* threatMap;
-	const CMetalData::Clusters& clusters;
-};
-
-class CMetalManager::DetectCluster : public lemon::MapBase<ClusterGraph::Node, bool> {
-public:
-	DetectCluster(CMetalManager* mgr, CMetalData::PointPredicate& pred, std::vector<int>& outIdxs)
-		: manager(mgr)
-		, predicate(pred)
-		, indices(outIdxs)
-	{}
-	bool operator[](Key k) const {
-		const int u = CMetalData::Graph::id(k);
-		if (manager->IsClusterQueued(u) || manager->IsClusterFinished(u)) {
-			return false;
-		}
-		for (int index : manager->GetClusters()[u].idxSpots) {
-			if (predicate(index)) {
-				indices.push_back(index);
-			}
-		}
-		return !indices.empty();
-	}
-private:
-	CMetalManager* manager;
-	CMetalData::PointPredicate predicate;
-	std::vector<int>& indices;
-};
-
 CMetalManager::CMetalManager(CCircuitAI* circuit, CMetalData* metalData)
 		: circuit(circuit)
 		, metalData(metalData)
 		, markFrame(-1)
-		, threatFilter(nullptr)
-		, filteredGraph(nullptr)
-		, shortPath(nullptr)
 {
 	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CMetalManager::Init, this));
 
@@ -85,10 +45,6 @@ CMetalManager::CMetalManager(CCircuitAI* circuit, CMetalData* metalData)
 CMetalManager::~CMetalManager()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-
-	delete threatFilter;
-	delete filteredGraph;
-	delete shortPath;
 }
 
 void CMetalManager::Init()
@@ -100,9 +56,30 @@ void CMetalManager::Init()
 		}
 	}
 
-	threatFilter = new SafeCluster(circuit->GetThreatMap(), GetClusters());
-	filteredGraph = new ClusterGraph(GetGraph(), *threatFilter);
-	shortPath = new ShortPath(*filteredGraph, GetWeights());
+	const CMetalData::Graph& graph = GetGraph();
+	const CMetalData::WeightMap& weights = GetWeights();
+	const int nodeNum = GetClusters().size();
+	csrOffsets.assign(nodeNum + 1, 0);
+	for (CMetalData::Graph::EdgeIt edgeIt(graph); edgeIt != lemon::INVALID; ++edgeIt) {
+		++csrOffsets[graph.id(graph.u(edgeIt)) + 1];
+		++csrOffsets[graph.id(graph.v(edgeIt)) + 1];
+	}
+	for (int i = 0; i < nodeNum; ++i) {
+		csrOffsets[i + 1] += csrOffsets[i];
+	}
+	csrEdges.resize(csrOffsets[nodeNum]);
+	std::vector<int> cursor(csrOffsets.begin(), csrOffsets.end() - 1);
+	for (CMetalData::Graph::EdgeIt edgeIt(graph); edgeIt != lemon::INVALID; ++edgeIt) {
+		const int u = graph.id(graph.u(edgeIt));
+		const int v = graph.id(graph.v(edgeIt));
+		const float weight = weights[edgeIt];
+		csrEdges[cursor[u]++] = {v, weight};
+		csrEdges[cursor[v]++] = {u, weight};
+	}
+
+	dists.resize(nodeNum);
+	owners.resize(nodeNum);
+	takenClusters.resize(nodeNum);
 }
 
 void CMetalManager::ParseMetalSpots()
@@ -310,6 +287,43 @@ void CMetalManager::MarkAllyMexes(const std::vector<CAllyUnit*>& mexes)
 	}
 }
 
+void CMetalManager::Save(std::ostream& os) const
+{
+	SMetalState state;
+	state.markFrame = markFrame;
+	for (const SMex& mex : markedMexes) {
+		state.markedMexes.push_back({mex.unitId, mex.index});
+	}
+	for (const SClusterInfo& info : clusterInfos) {
+		state.clusters.push_back({info.queuedCount, info.finishedCount});
+	}
+	state.Save(os);
+}
+
+bool CMetalManager::Load(std::istream& is)
+{
+	SMetalState state;
+	if (!state.Load(is) || (state.clusters.size() != clusterInfos.size())) {
+		return false;
+	}
+	for (const SMetalState::SMex& mex : state.markedMexes) {
+		if ((mex.index < 0) || (mex.index >= (int)metalInfos.size())) {
+			return false;
+		}
+	}
+
+	markFrame = state.markFrame;
+	markedMexes.clear();
+	for (const SMetalState::SMex& mex : state.markedMexes) {
+		markedMexes.push_back({mex.unitId, mex.index});
+	}
+	// NOTE: queuedCount follows builder tasks of this session, not the saved ones
+	for (unsigned i = 0; i < clusterInfos.size(); ++i) {
+		clusterInfos[i].finishedCount = state.clusters[i].finishedCount;
+	}
+	return true;
+}
+
 bool CMetalManager::IsMexInFinished(int index) const
 {
 	// NOTE: finishedCount updated on lazy MarkAllyMexes call, thus can be invalid
@@ -319,33 +333,159 @@ bool CMetalManager::IsMexInFinished(int index) const
 
 int CMetalManager::GetMexToBuild(const AIFloat3& pos, CMetalData::PointPredicate& predicate)
 {
-	int index = FindNearestCluster(pos);
-	if (index < 0 || !(*threatFilter)[index]) {
+	PROFILE_SCOPE("CMetalManager::GetMexToBuild");
+	const std::vector<bool>& isSafe = circuit->GetThreatMap()->GetSafeClusters();
+	const int start = FindNearestCluster(pos);
+	if ((start < 0) || !isSafe[start]) {
 		return -1;
 	}
 	MarkAllyMexes();
 
-	static std::vector<int> indices;  // NOTE: micro-opt
-	int result = -1;
-
-	DetectCluster goal(this, predicate, indices);
-	shortPath->init();
-	shortPath->addSource(filteredGraph->nodeFromId(index));
-	CMetalData::Graph::Node target = shortPath->start(goal);
-
-	if (target != lemon::INVALID) {
-		float sqMinDist = std::numeric_limits<float>::max();
-		for (int index : indices) {
-			float sqDist = GetSpots()[index].position.SqDistance2D(pos);
-			if (sqDist < sqMinDist) {
-				sqMinDist = sqDist;
-				result = index;
+	std::fill(dists.begin(), dists.end(), std::numeric_limits<float>::max());
+	queue.clear();
+	dists[start] = .0f;
+	queue.push_back({.0f, start, 0});
+
+	const CMetalData::Metals& spots = GetSpots();
+	while (!queue.empty()) {
+		std::pop_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
+		const SQueueItem item = queue.back();
+		queue.pop_back();
+		const int u = item.node;
+		if (item.dist > dists[u]) {
+			continue;  // stale
+		}
+
+		if (!IsClusterQueued(u) && !IsClusterFinished(u)) {
+			int result = -1;
+			float sqMinDist = std::numeric_limits<float>::max();
+			for (int index : GetClusters()[u].idxSpots) {
+				const float sqDist = spots[index].position.SqDistance2D(pos);
+				if ((sqDist < sqMinDist) && predicate(index)) {
+					sqMinDist = sqDist;
+					result = index;
+				}
+			}
+			if (result >= 0) {
+				return result;
+			}
+		}
+
+		for (int i = csrOffsets[u]; i < csrOffsets[u + 1]; ++i) {
+			const SCsrEdge& edge = csrEdges[i];
+			if (!isSafe[edge.node]) {
+				continue;
+			}
+			const float dist = item.dist + edge.weight;
+			if (dist < dists[edge.node]) {
+				dists[edge.node] = dist;
+				queue.push_back({dist, edge.node, 0});
+				std::push_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
 			}
 		}
 	}
+	return -1;
+}
+
+void CMetalManager::GetMexToBuild(std::vector<SMexRequest>& requests)
+{
+	PROFILE_SCOPE("CMetalManager::GetMexToBuild");
+	for (SMexRequest& request : requests) {
+		request.result = -1;
+	}
+	if (csrOffsets.empty()) {
+		return;
+	}
+	const std::vector<bool>& isSafe = circuit->GetThreatMap()->GetSafeClusters();
+	MarkAllyMexes();
 
-	indices.clear();
-	return result;
+	std::fill(dists.begin(), dists.end(), std::numeric_limits<float>::max());
+	std::fill(owners.begin(), owners.end(), -1);
+	std::fill(takenClusters.begin(), takenClusters.end(), false);
+	queue.clear();
+
+	// Requests that start at the same cluster share one source (group)
+	groups.clear();
+	groupLeft.clear();
+	int unsolved = 0;
+	for (unsigned i = 0; i < requests.size(); ++i) {
+		const int index = FindNearestCluster(requests[i].pos);
+		if ((index < 0) || !isSafe[index]) {
+			continue;
+		}
+		if (owners[index] < 0) {
+			owners[index] = groups.size();
+			dists[index] = .0f;
+			groups.emplace_back();
+			groupLeft.push_back(0);
+			queue.push_back({.0f, index, owners[index]});
+		}
+		groups[owners[index]].push_back(i);
+		++groupLeft[owners[index]];
+		++unsolved;
+	}
+	std::make_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
+
+	const CMetalData::Metals& spots = GetSpots();
+	while (!queue.empty() && (unsolved > 0)) {
+		std::pop_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
+		const SQueueItem item = queue.back();
+		queue.pop_back();
+		const int u = item.node;
+		if ((item.group != owners[u]) || (item.dist > dists[u]) || (groupLeft[item.group] == 0)) {
+			continue;  // stale
+		}
+
+		if (!takenClusters[u] && !IsClusterQueued(u) && !IsClusterFinished(u)) {
+			for (int reqIdx : groups[item.group]) {
+				SMexRequest& request = requests[reqIdx];
+				if (request.result >= 0) {
+					continue;
+				}
+				float sqMinDist = std::numeric_limits<float>::max();
+				for (int index : GetClusters()[u].idxSpots) {
+					const float sqDist = spots[index].position.SqDistance2D(request.pos);
+					if ((sqDist < sqMinDist) && request.predicate(index)) {
+						sqMinDist = sqDist;
+						request.result = index;
+					}
+				}
+				if (request.result >= 0) {
+					takenClusters[u] = true;
+					--groupLeft[item.group];
+					--unsolved;
+					break;
+				}
+			}
+			if (groupLeft[item.group] == 0) {
+				// Served group releases its region: other groups continue from their reached nodes
+				for (unsigned v = 0; v < owners.size(); ++v) {
+					if (owners[v] == item.group) {
+						owners[v] = -1;
+						dists[v] = std::numeric_limits<float>::max();
+					} else if ((owners[v] >= 0) && (groupLeft[owners[v]] > 0)) {
+						queue.push_back({dists[v], (int)v, owners[v]});
+					}
+				}
+				std::make_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
+				continue;
+			}
+		}
+
+		for (int i = csrOffsets[u]; i < csrOffsets[u + 1]; ++i) {
+			const SCsrEdge& edge = csrEdges[i];
+			if (!isSafe[edge.node]) {
+				continue;
+			}
+			const float dist = item.dist + edge.weight;
+			if (dist < dists[edge.node]) {
+				dists[edge.node] = dist;
+				owners[edge.node] = item.group;
+				queue.push_back({dist, edge.node, item.group});
+				std::push_heap(queue.begin(), queue.end(), std::greater<SQueueItem>());
+			}
+		}
+	}
 }
 
 } // namespace circuit
@@ -10,8 +10,8 @@
 
 #include "resource/MetalData.h"
 #include "unit/CircuitUnit.h"
-#include "lemon/adaptors.h"
-#include "lemon/dijkstra.h"
+
+#include <iostream>
 
 namespace circuit {
 
@@ -76,12 +76,34 @@ public:
 	bool IsMexInFinished(int index) const;
 	int GetCluster(int index) const { return metalInfos[index].clusterId; }
 
+	/*
+	 * Dijkstra over safe clusters from the nearest one: closest spot of the first
+	 * free cluster that passes predicate, -1 if none
+	 */
 	int GetMexToBuild(const springai::AIFloat3& pos, CMetalData::PointPredicate& predicate);
+	struct SMexRequest {
+		springai::AIFloat3 pos;
+		CMetalData::PointPredicate predicate;
+		int result;  // spot index, -1 if none
+	};
+	/*
+	 * Multi-source Dijkstra over safe clusters: all builders are served by one run,
+	 * every request gets a spot in the nearest free cluster of its own graph region.
+	 */
+	void GetMexToBuild(std::vector<SMexRequest>& requests);
 
 	float GetMinIncome() const { return metalData->GetMinIncome(); }
 	float GetAvgIncome() const { return metalData->GetAvgIncome(); }
 	float GetMaxIncome() const { return metalData->GetMaxIncome(); }
 
+	static constexpr uint32_t SAVE_VERSION = 1;
+	/*
+	 * Finished mexes and per-cluster counts as one consistent pair.
+	 * Open/queued state belongs to builder tasks and is rebuilt with them.
+	 */
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+
 private:
 	CCircuitAI* circuit;
 	CMetalData* metalData;
@@ -104,14 +126,29 @@ private:
 	};
 	std::deque<SMex> markedMexes;  // sorted by insertion
 
-	class SafeCluster;
-	class DetectCluster;
-	using ClusterGraph = lemon::FilterNodes<const CMetalData::Graph, SafeCluster>;
-	using ShortPath = lemon::Dijkstra<ClusterGraph, CMetalData::WeightMap>;
-
-	SafeCluster* threatFilter;
-	ClusterGraph* filteredGraph;
-	ShortPath* shortPath;
+	/*
+	 * Cluster graph in compressed sparse row form: edges of node u are csrEdges[csrOffsets[u]..csrOffsets[u + 1])
+	 */
+	struct SCsrEdge {
+		int node;
+		float weight;
+	};
+	std::vector<int> csrOffsets;
+	std::vector<SCsrEdge> csrEdges;
+
+	// Dijkstra scratch
+	struct SQueueItem {
+		float dist;
+		int node;
+		int group;
+		bool operator>(const SQueueItem& other) const { return dist > other.dist; }
+	};
+	std::vector<SQueueItem> queue;
+	std::vector<float> dists;
+	std::vector<int> owners;  // request group that reached the node
+	std::vector<bool> takenClusters;
+	std::vector<std::vector<int>> groups;  // requests that start at the same cluster
+	std::vector<int> groupLeft;  // unsolved requests of group
 };
 
 } // namespace circuit
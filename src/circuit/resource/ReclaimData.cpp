@@ -0,0 +1,323 @@
+/*
+ * ReclaimData.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "resource/ReclaimData.h"
+#include "module/EconomyManager.h"
+#include "terrain/TerrainManager.h"
+#include "CircuitAI.h"
+#include "util/Profiler.h"
+#include "util/Scheduler.h"
+#include "util/utils.h"
+
+#include "SSkirmishAICallback.h"
+#include "Resource.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace circuit {
+
+using namespace springai;
+
+#define CELL_SIZE		(SQUARE_SIZE * 32)
+#define FULL_INTERVAL	(FRAMES_PER_SEC * 2)
+
+CReclaimData::CReclaimData(CCircuitAI* circuit)
+		: circuit(circuit)
+		, reclaimCount(0)
+		, cellWidth(0)
+		, cellHeight(0)
+		, areaSize(1)
+		, areaWidth(0)
+		, areaHeight(0)
+		, updateFrame(-1)
+		, fullFrame(-FULL_INTERVAL)
+		, stamp(0)
+{
+	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CReclaimData::Init, this));
+}
+
+CReclaimData::~CReclaimData()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
+
+void CReclaimData::Init()
+{
+	cellWidth = CTerrainManager::GetTerrainWidth() / CELL_SIZE + 1;
+	cellHeight = CTerrainManager::GetTerrainHeight() / CELL_SIZE + 1;
+	cells.resize(cellWidth * cellHeight);
+
+	// Same resolution as threat map, so threat layer works as a mask
+	areaSize = circuit->GetTerrainManager()->GetConvertStoP();
+	areaWidth = CTerrainManager::GetTerrainWidth() / areaSize + 1;
+	areaHeight = CTerrainManager::GetTerrainHeight() / areaSize + 1;
+	density.resize(areaWidth * areaHeight, {.0f, .0f, .0f, 0});
+}
+
+void CReclaimData::MarkArea(const AIFloat3& pos, float radius)
+{
+	dirtyAreas.push_back({pos, radius, circuit->GetLastFrame()});
+}
+
+void CReclaimData::Update()
+{
+	const int frame = circuit->GetLastFrame();
+	if ((updateFrame >= frame) || cells.empty()) {
+		return;
+	}
+	updateFrame = frame;
+
+	PROFILE_SCOPE("CReclaimData::Update");
+	if (fullFrame + FULL_INTERVAL <= frame) {
+		fullFrame = frame;
+		RefreshAll();
+		dirtyAreas.clear();
+		return;
+	}
+
+	// NOTE: Wreck is created after UnitDestroyed event, check it next frame
+	auto it = dirtyAreas.begin();
+	while (it != dirtyAreas.end()) {
+		if (it->frame < frame) {
+			RefreshArea(it->pos, it->radius);
+			*it = dirtyAreas.back();
+			dirtyAreas.pop_back();
+		} else {
+			++it;
+		}
+	}
+}
+
+const CReclaimData::SFeature* CReclaimData::FindClosest(const AIFloat3& pos, float radius, const Filter& filter)
+{
+	if (IsEmpty()) {
+		return nullptr;
+	}
+
+	const SFeature* result = nullptr;
+	float minSqDist = SQUARE(radius);
+	const int cx = utils::clamp<int>(pos.x / CELL_SIZE, 0, cellWidth - 1);
+	const int cz = utils::clamp<int>(pos.z / CELL_SIZE, 0, cellHeight - 1);
+	const int maxRing = std::min<float>(radius / CELL_SIZE + 1, std::max(cellWidth, cellHeight));
+
+	// Rings of cells around pos, nearest first
+	for (int ring = 0; ring <= maxRing; ++ring) {
+		if ((ring > 0) && (SQUARE((ring - 1) * CELL_SIZE) >= minSqDist)) {
+			break;  // next ring can't be closer
+		}
+		for (int z = cz - ring; z <= cz + ring; ++z) {
+			if ((z < 0) || (z >= cellHeight)) {
+				continue;
+			}
+			const bool isEdgeRow = (z == cz - ring) || (z == cz + ring);
+			const int step = isEdgeRow ? 1 : std::max(ring * 2, 1);
+			for (int x = cx - ring; x <= cx + ring; x += step) {
+				if ((x < 0) || (x >= cellWidth)) {
+					continue;
+				}
+				for (unsigned index : cells[z * cellWidth + x]) {
+					const SFeature& feature = features[index];
+					const float sqDist = pos.SqDistance2D(feature.pos);
+					if ((sqDist < minSqDist) && filter(feature.pos)) {
+						minSqDist = sqDist;
+						result = &feature;
+					}
+				}
+			}
+		}
+	}
+	return result;
+}
+
+bool CReclaimData::FindRichestArea(const AIFloat3& pos, float radius, const Filter& filter,
+								   AIFloat3& outPos, float& outMetal) const
+{
+	if (IsEmpty()) {
+		return false;
+	}
+
+	const float sqRadius = SQUARE(radius);
+	const float extent = std::min<float>(radius, std::max(areaWidth, areaHeight) * areaSize);
+	const int x1 = std::max<int>((pos.x - extent) / areaSize, 0);
+	const int x2 = std::min<int>((pos.x + extent) / areaSize, areaWidth - 1);
+	const int z1 = std::max<int>((pos.z - extent) / areaSize, 0);
+	const int z2 = std::min<int>((pos.z + extent) / areaSize, areaHeight - 1);
+	const float distOffset = areaSize * 8.0f;  // don't overrate areas right under the builder
+
+	float bestScore = .0f;
+	for (int z = z1; z <= z2; ++z) {
+		for (int x = x1; x <= x2; ++x) {
+			const SDensity& area = density[z * areaWidth + x];
+			if (area.metal < 1.0f) {
+				continue;
+			}
+			const AIFloat3 centre(area.sumX / area.metal, 0.f, area.sumZ / area.metal);
+			const float sqDist = pos.SqDistance2D(centre);
+			if (sqDist > sqRadius) {
+				continue;
+			}
+			const float score = area.metal / (sqrtf(sqDist) + distOffset);
+			if ((score > bestScore) && filter(centre)) {
+				bestScore = score;
+				outPos = centre;
+				outMetal = area.metal;
+			}
+		}
+	}
+	return bestScore > .0f;
+}
+
+int CReclaimData::GetAreaIndex(const AIFloat3& pos) const
+{
+	const int x = utils::clamp<int>(pos.x / areaSize, 0, areaWidth - 1);
+	const int z = utils::clamp<int>(pos.z / areaSize, 0, areaHeight - 1);
+	return z * areaWidth + x;
+}
+
+void CReclaimData::RefreshAll()
+{
+	const SSkirmishAICallback* callback = circuit->GetSkirmishAICallback();
+	const int skirmishAIId = circuit->GetSkirmishAIId();
+
+	++stamp;
+	tmpIds.resize(callback->getFeatures(skirmishAIId, nullptr, 0));
+	tmpIds.resize(callback->getFeatures(skirmishAIId, tmpIds.data(), tmpIds.size()));
+	for (int featureId : tmpIds) {
+		auto it = featureIdxs.find(featureId);
+		if (it != featureIdxs.end()) {
+			features[it->second].mark = stamp;
+		} else {
+			InsertFeature(featureId);
+		}
+	}
+
+	// Backwards: swap-remove moves already checked feature
+	for (int i = features.size() - 1; i >= 0; --i) {
+		if (features[i].mark != stamp) {
+			RemoveFeature(i);
+		}
+	}
+	PROFILE_COUNT("CReclaimData::features", features.size());
+}
+
+void CReclaimData::RefreshArea(const AIFloat3& pos, float radius)
+{
+	const SSkirmishAICallback* callback = circuit->GetSkirmishAICallback();
+	const int skirmishAIId = circuit->GetSkirmishAIId();
+
+	// NOTE: Only new features, removed ones are handled by RefreshAll
+	float pos_posF3[3] = {pos.x, pos.y, pos.z};
+	tmpIds.resize(callback->getFeaturesIn(skirmishAIId, pos_posF3, radius, nullptr, 0));
+	tmpIds.resize(callback->getFeaturesIn(skirmishAIId, pos_posF3, radius, tmpIds.data(), tmpIds.size()));
+	for (int featureId : tmpIds) {
+		if (featureIdxs.find(featureId) == featureIdxs.end()) {
+			InsertFeature(featureId);
+		}
+	}
+}
+
+void CReclaimData::InsertFeature(int featureId)
+{
+	const SSkirmishAICallback* callback = circuit->GetSkirmishAICallback();
+	const int skirmishAIId = circuit->GetSkirmishAIId();
+
+	float return_posF3_out[3];
+	callback->Feature_getPosition(skirmishAIId, featureId, return_posF3_out);
+	AIFloat3 pos(return_posF3_out[0], return_posF3_out[1], return_posF3_out[2]);
+	CTerrainManager::CorrectPosition(pos);  // Impulsed flying feature
+	const float metal = GetDefMetal(callback->Feature_getDef(skirmishAIId, featureId));
+
+	const unsigned index = features.size();
+	features.push_back({featureId, pos, metal, stamp});
+	featureIdxs[featureId] = index;
+	if (metal >= 1.0f) {
+		InsertCell(index);
+		AddDensity(features[index], 1.f);
+		++reclaimCount;
+	}
+}
+
+void CReclaimData::RemoveFeature(unsigned index)
+{
+	if (features[index].metal >= 1.0f) {
+		EraseCell(index);
+		AddDensity(features[index], -1.f);
+		--reclaimCount;
+	}
+	featureIdxs.erase(features[index].featureId);
+
+	const unsigned last = features.size() - 1;
+	if (index != last) {
+		if (features[last].metal >= 1.0f) {
+			EraseCell(last);
+		}
+		features[index] = features[last];
+		featureIdxs[features[index].featureId] = index;
+		if (features[index].metal >= 1.0f) {
+			InsertCell(index);
+		}
+	}
+	features.pop_back();
+}
+
+float CReclaimData::GetDefMetal(int featureDefId)
+{
+	if (featureDefId < 0) {
+		return .0f;
+	}
+	if (featureDefId >= (int)defMetals.size()) {
+		defMetals.resize(featureDefId + 1, -1.f);
+	}
+	float& metal = defMetals[featureDefId];
+	if (metal < .0f) {
+		const SSkirmishAICallback* callback = circuit->GetSkirmishAICallback();
+		const int skirmishAIId = circuit->GetSkirmishAIId();
+		const int metalId = circuit->GetEconomyManager()->GetMetalRes()->GetResourceId();
+		metal = callback->FeatureDef_isReclaimable(skirmishAIId, featureDefId)
+				? callback->FeatureDef_getContainedResource(skirmishAIId, featureDefId, metalId)/* * feature->GetReclaimLeft()*/
+				: .0f;
+	}
+	return metal;
+}
+
+int CReclaimData::GetCellIndex(const AIFloat3& pos) const
+{
+	const int x = utils::clamp<int>(pos.x / CELL_SIZE, 0, cellWidth - 1);
+	const int z = utils::clamp<int>(pos.z / CELL_SIZE, 0, cellHeight - 1);
+	return z * cellWidth + x;
+}
+
+void CReclaimData::InsertCell(unsigned index)
+{
+	cells[GetCellIndex(features[index].pos)].push_back(index);
+}
+
+void CReclaimData::EraseCell(unsigned index)
+{
+	std::vector<unsigned>& cell = cells[GetCellIndex(features[index].pos)];
+	auto it = std::find(cell.begin(), cell.end(), index);
+	if (it != cell.end()) {
+		*it = cell.back();
+		cell.pop_back();
+	}
+}
+
+void CReclaimData::AddDensity(const SFeature& feature, float sign)
+{
+	SDensity& area = density[GetAreaIndex(feature.pos)];
+	area.count += (sign > .0f) ? 1 : -1;
+	if (area.count <= 0) {
+		area = {.0f, .0f, .0f, 0};  // no float drift on empty areas
+		return;
+	}
+	area.metal += sign * feature.metal;
+	area.sumX += sign * feature.metal * feature.pos.x;
+	area.sumZ += sign * feature.metal * feature.pos.z;
+}
+
+} // namespace circuit
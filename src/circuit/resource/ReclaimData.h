@@ -0,0 +1,117 @@
+/*
+ * ReclaimData.h
+ *
+ *  Table of visible features with reclaim value and grid index
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_RESOURCE_RECLAIMDATA_H_
+#define SRC_CIRCUIT_RESOURCE_RECLAIMDATA_H_
+
+#include "AIFloat3.h"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace circuit {
+
+class CCircuitAI;
+
+/*
+ * Engine has no feature events, so table is synced by periodic full diff
+ * and by area refresh where units died (wrecks). Feature defs are evaluated once.
+ * Queries use raw callback ids only: no Feature/FeatureDef wrappers per decision.
+ */
+class CReclaimData {
+public:
+	struct SFeature {
+		int featureId;
+		springai::AIFloat3 pos;
+		float metal;  // reclaim value, < 1 for not reclaimable (trees, rocks without metal)
+		int mark;  // refresh stamp
+	};
+	using Filter = std::function<bool (const springai::AIFloat3& pos)>;
+
+	CReclaimData(CCircuitAI* circuit);
+	virtual ~CReclaimData();
+
+private:
+	void Init();
+
+public:
+	void SetAuthority(CCircuitAI* authority) { circuit = authority; }
+
+	/*
+	 * Wreck may appear around position
+	 */
+	void MarkArea(const springai::AIFloat3& pos, float radius);
+	void Update();
+
+	/*
+	 * Closest reclaimable feature within radius that passes filter, nullptr if none.
+	 * Filter is called only for candidates closer than the best one so far.
+	 */
+	const SFeature* FindClosest(const springai::AIFloat3& pos, float radius, const Filter& filter);
+	/*
+	 * Area (threat map square) within radius with best metal per travel distance,
+	 * filter is applied to metal-weighted centre of the area.
+	 * @return false if none
+	 */
+	bool FindRichestArea(const springai::AIFloat3& pos, float radius, const Filter& filter,
+						 springai::AIFloat3& outPos, float& outMetal) const;
+	float GetAreaMetal(const springai::AIFloat3& pos) const { return density.empty() ? .0f : density[GetAreaIndex(pos)].metal; }
+	int GetAreaIndex(const springai::AIFloat3& pos) const;
+	float GetAreaRadius() const { return areaSize; }  // covers area from its centre
+
+	bool IsEmpty() const { return reclaimCount == 0; }
+
+private:
+	void RefreshAll();
+	void RefreshArea(const springai::AIFloat3& pos, float radius);
+	void InsertFeature(int featureId);
+	void RemoveFeature(unsigned index);
+	float GetDefMetal(int featureDefId);
+
+	int GetCellIndex(const springai::AIFloat3& pos) const;
+	void InsertCell(unsigned index);
+	void EraseCell(unsigned index);
+	void AddDensity(const SFeature& feature, float sign);
+
+	CCircuitAI* circuit;
+
+	std::vector<SFeature> features;
+	std::unordered_map<int, unsigned> featureIdxs;  // featureId: index in features
+	std::vector<float> defMetals;  // by featureDefId, < 0 if unknown
+	unsigned reclaimCount;
+
+	std::vector<std::vector<unsigned>> cells;  // reclaimable features only
+	int cellWidth;
+	int cellHeight;
+
+	struct SDensity {
+		float metal;
+		float sumX, sumZ;  // metal-weighted position
+		int count;
+	};
+	std::vector<SDensity> density;  // reclaim metal at threat map resolution
+	int areaSize;
+	int areaWidth;
+	int areaHeight;
+
+	struct SArea {
+		springai::AIFloat3 pos;
+		float radius;
+		int frame;
+	};
+	std::vector<SArea> dirtyAreas;
+	std::vector<int> tmpIds;  // callback buffer
+	int updateFrame;
+	int fullFrame;
+	int stamp;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_RESOURCE_RECLAIMDATA_H_
@@ -0,0 +1,251 @@
+/*
+ * ConfigCompiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "setup/ConfigCompiler.h"
+#include "json/json.h"
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <cstring>
+
+namespace circuit {
+
+namespace {
+
+const char MAGIC[4] = {'C', 'C', 'F', 'G'};
+const uint32_t NO_KEY = 0xFFFFFFFF;
+
+struct SHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t hash;
+	uint32_t numNodes;
+	uint32_t stringSize;
+};
+
+struct SNode {
+	uint32_t type;  // Json::ValueType
+	uint32_t key;  // member name of parent object, NO_KEY for array elements and root
+	union {
+		int64_t integer;
+		uint64_t uinteger;
+		double real;
+		uint32_t string;
+		bool boolean;
+		struct {
+			uint32_t first;
+			uint32_t count;
+		} children;
+	};
+};
+
+class CStringTable {
+public:
+	uint32_t Add(const std::string& str) {
+		auto it = offsets.find(str);
+		if (it != offsets.end()) {
+			return it->second;
+		}
+		const uint32_t offset = data.size();
+		data.insert(data.end(), str.begin(), str.end());
+		data.push_back('\0');
+		offsets[str] = offset;
+		return offset;
+	}
+	const std::vector<char>& GetData() const { return data; }
+
+private:
+	std::vector<char> data;
+	std::unordered_map<std::string, uint32_t> offsets;
+};
+
+} // namespace
+
+uint64_t CConfigCompiler::Hash(const char* data, std::size_t size, uint64_t seed)
+{
+	uint64_t hash = seed;
+	for (std::size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+uint64_t CConfigCompiler::HashSource(const std::string& name, const std::string& content, uint64_t seed)
+{
+	return Hash(content, Hash(name, seed));
+}
+
+void CConfigCompiler::Merge(Json::Value& a, const Json::Value& b, const OverrideFunc& onOverride)
+{
+	if (!a.isObject() || !b.isObject()) {
+		return;
+	}
+
+	for (const auto& key : b.getMemberNames()) {
+		if (a[key].isObject()) {
+			Merge(a[key], b[key], onOverride);
+		} else {
+			if (!a[key].isNull()) {
+				// TODO: Make path for key
+				onOverride(key);
+			}
+			a[key] = b[key];
+		}
+	}
+}
+
+void CConfigCompiler::Compile(const Json::Value& root, uint64_t hash, Blob& outBlob)
+{
+	std::vector<SNode> nodes;
+	CStringTable strings;
+	std::deque<std::pair<const Json::Value*, uint32_t>> queue;  // value: node index
+
+	auto makeNode = [&nodes, &strings](const Json::Value& value, uint32_t key) {
+		SNode node;
+		std::memset(&node, 0, sizeof(node));
+		node.type = value.type();
+		node.key = key;
+		switch (value.type()) {
+			case Json::intValue:     node.integer = value.asLargestInt(); break;
+			case Json::uintValue:    node.uinteger = value.asLargestUInt(); break;
+			case Json::realValue:    node.real = value.asDouble(); break;
+			case Json::stringValue:  node.string = strings.Add(value.asString()); break;
+			case Json::booleanValue: node.boolean = value.asBool(); break;
+			default: break;  // null, children are filled on dequeue
+		}
+		nodes.push_back(node);
+	};
+
+	makeNode(root, NO_KEY);
+	queue.push_back(std::make_pair(&root, 0));
+	while (!queue.empty()) {
+		const Json::Value& value = *queue.front().first;
+		const uint32_t index = queue.front().second;
+		queue.pop_front();
+		if (!value.isObject() && !value.isArray()) {
+			continue;
+		}
+
+		const uint32_t first = nodes.size();
+		if (value.isObject()) {
+			for (const std::string& key : value.getMemberNames()) {
+				const Json::Value& child = value[key];
+				queue.push_back(std::make_pair(&child, (uint32_t)nodes.size()));
+				makeNode(child, strings.Add(key));
+			}
+		} else {
+			for (const Json::Value& child : value) {
+				queue.push_back(std::make_pair(&child, (uint32_t)nodes.size()));
+				makeNode(child, NO_KEY);
+			}
+		}
+		nodes[index].children.first = first;
+		nodes[index].children.count = nodes.size() - first;
+	}
+
+	SHeader header;
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.hash = hash;
+	header.numNodes = nodes.size();
+	header.stringSize = strings.GetData().size();
+
+	const std::size_t nodesSize = nodes.size() * sizeof(SNode);
+	outBlob.resize(sizeof(SHeader) + nodesSize + header.stringSize);
+	char* dst = outBlob.data();
+	std::memcpy(dst, &header, sizeof(SHeader));
+	std::memcpy(dst + sizeof(SHeader), nodes.data(), nodesSize);
+	std::memcpy(dst + sizeof(SHeader) + nodesSize, strings.GetData().data(), header.stringSize);
+}
+
+bool CConfigCompiler::Decompile(const Blob& blob, uint64_t hash, Json::Value& outRoot)
+{
+	uint64_t blobHash;
+	if (!ReadHash(blob, blobHash) || (blobHash != hash)) {
+		return false;
+	}
+	SHeader header;
+	std::memcpy(&header, blob.data(), sizeof(SHeader));
+	const std::size_t nodesSize = (std::size_t)header.numNodes * sizeof(SNode);
+	if ((header.numNodes == 0) || (header.stringSize == 0)
+		|| (blob.size() != sizeof(SHeader) + nodesSize + header.stringSize)
+		|| (blob.back() != '\0'))
+	{
+		return false;
+	}
+	// NOTE: Blob's storage is not aligned for SNode
+	std::vector<SNode> nodes(header.numNodes);
+	std::memcpy(nodes.data(), blob.data() + sizeof(SHeader), nodesSize);
+	const char* strings = blob.data() + sizeof(SHeader) + nodesSize;
+
+	auto isString = [&header](uint32_t offset) { return offset < header.stringSize; };
+
+	// Children always follow parent, so single forward pass fills whole tree
+	std::vector<Json::Value*> values(nodes.size(), nullptr);
+	outRoot = Json::Value();
+	values[0] = &outRoot;
+	for (uint32_t i = 0; i < nodes.size(); ++i) {
+		const SNode& node = nodes[i];
+		Json::Value* value = values[i];
+		if ((value == nullptr) || (node.type > Json::objectValue)) {
+			return false;
+		}
+		switch (node.type) {
+			case Json::intValue:     *value = Json::Value(Json::LargestInt(node.integer)); break;
+			case Json::uintValue:    *value = Json::Value(Json::LargestUInt(node.uinteger)); break;
+			case Json::realValue:    *value = Json::Value(node.real); break;
+			case Json::booleanValue: *value = Json::Value(node.boolean); break;
+			case Json::stringValue: {
+				if (!isString(node.string)) {
+					return false;
+				}
+				*value = Json::Value(strings + node.string);
+			} break;
+			case Json::arrayValue:
+			case Json::objectValue: {
+				const uint64_t end = (uint64_t)node.children.first + node.children.count;
+				if ((node.children.count > 0) && ((node.children.first <= i) || (end > nodes.size()))) {
+					return false;
+				}
+				*value = Json::Value(static_cast<Json::ValueType>(node.type));  // keeps empty containers
+				if (node.type == Json::arrayValue) {
+					value->resize(node.children.count);
+					for (uint32_t j = 0; j < node.children.count; ++j) {
+						values[node.children.first + j] = &(*value)[j];
+					}
+				} else {
+					for (uint32_t j = node.children.first; j < end; ++j) {
+						if (!isString(nodes[j].key)) {
+							return false;
+						}
+						values[j] = &(*value)[strings + nodes[j].key];
+					}
+				}
+			} break;
+			default: break;  // null
+		}
+	}
+	return true;
+}
+
+bool CConfigCompiler::ReadHash(const Blob& blob, uint64_t& outHash)
+{
+	if (blob.size() < sizeof(SHeader)) {
+		return false;
+	}
+	SHeader header;
+	std::memcpy(&header, blob.data(), sizeof(SHeader));
+	if ((std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) || (header.version != VERSION)) {
+		return false;
+	}
+	outHash = header.hash;
+	return true;
+}
+
+} // namespace circuit
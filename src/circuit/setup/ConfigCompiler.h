@@ -0,0 +1,61 @@
+/*
+ * ConfigCompiler.h
+ *
+ *  Flat binary form of merged JSON config
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_SETUP_CONFIGCOMPILER_H_
+#define SRC_CIRCUIT_SETUP_CONFIGCOMPILER_H_
+
+#include "json/json-forwards.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Blob: header, node table, string table. Nodes are laid out breadth-first,
+ * so children of array or object occupy contiguous index range; object keys
+ * and string values are offsets into deduplicated null-terminated string table.
+ * Header keeps hash of JSON sources: stale blob is rejected, not applied.
+ * NOTE: Native endianness, blob is produced and read by the same platform.
+ */
+class CConfigCompiler {
+public:
+	static constexpr uint32_t VERSION = 1;
+	using Blob = std::vector<char>;
+	using OverrideFunc = std::function<void (const std::string& key)>;
+
+	/*
+	 * FNV-1a, chain calls through seed to hash several sources
+	 */
+	static uint64_t Hash(const char* data, std::size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+	static uint64_t Hash(const std::string& str, uint64_t seed = 0xcbf29ce484222325ULL) {
+		return Hash(str.data(), str.size(), seed);
+	}
+	/*
+	 * Identity of config part, chain in the order parts are merged
+	 */
+	static uint64_t HashSource(const std::string& name, const std::string& content, uint64_t seed = 0xcbf29ce484222325ULL);
+
+	/*
+	 * Merge config part b into a, objects recursively, other values are replaced
+	 */
+	static void Merge(Json::Value& a, const Json::Value& b, const OverrideFunc& onOverride);
+
+	static void Compile(const Json::Value& root, uint64_t hash, Blob& outBlob);
+	/*
+	 * @return false on wrong magic, version or hash, or malformed blob
+	 */
+	static bool Decompile(const Blob& blob, uint64_t hash, Json::Value& outRoot);
+	static bool ReadHash(const Blob& blob, uint64_t& outHash);
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_SETUP_CONFIGCOMPILER_H_
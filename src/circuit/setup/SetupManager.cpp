@@ -7,9 +7,11 @@
 
 #include "setup/SetupManager.h"
 #include "setup/SetupData.h"
+#include "setup/ConfigCompiler.h"
 #include "resource/MetalManager.h"
 #include "terrain/TerrainManager.h"
 #include "CircuitAI.h"
+#include "util/GameAttribute.h"
 #include "util/Scheduler.h"
 #include "util/utils.h"
 #include "json/json.h"
@@ -31,6 +33,8 @@ namespace circuit {
 
 using namespace springai;
 
+#define CONFIG_BIN	"config.bin"  // output of circuit_config_compile
+
 CSetupManager::CSetupManager(CCircuitAI* circuit, CSetupData* setupData)
 		: circuit(circuit)
 		, setupData(setupData)
@@ -54,7 +58,6 @@ CSetupManager::CSetupManager(CCircuitAI* circuit, CSetupData* setupData)
 CSetupManager::~CSetupManager()
 {
 	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-	delete config;
 }
 
 void CSetupManager::DisabledUnits(const char* setupScript)
@@ -102,17 +105,12 @@ void CSetupManager::DisabledUnits(const char* setupScript)
 
 bool CSetupManager::OpenConfig(const std::string& cfgOption)
 {
-	bool isOk = LoadConfig(cfgOption);
-	if (isOk) {
-		OverrideConfig();
-	}
-	return isOk;
+	return LoadConfig(cfgOption);
 }
 
 void CSetupManager::CloseConfig()
 {
-	delete config;
-	config = nullptr;
+	config = nullptr;  // parsed config stays in CGameAttribute for other AIs
 }
 
 bool CSetupManager::HasStartBoxes() const
@@ -555,19 +553,28 @@ bool CSetupManager::LoadConfig(const std::string& cfgOption)
 	const char* name = info->GetValueByKey("shortName");
 	delete info;
 
+	Sources overrides;
+	OptionValues* options = circuit->GetSkirmishAI()->GetOptionValues();
+	for (const char* key : {"factory", "behaviour"}) {
+		const char* value = options->GetValueByKey(key);
+		if (value != nullptr) {
+			overrides.push_back(std::make_pair(key, value));
+		}
+	}
+
 	std::string dirname;
+	Sources sources;
 
 	/*
 	 * Try startscript specific config
 	 */
 	configName = "startscript";
-	OptionValues* options = circuit->GetSkirmishAI()->GetOptionValues();
 	const char* value = options->GetValueByKey("JSON");
 	std::string cfgStr = ((value != nullptr) && strlen(value) > 0) ? value : "";
 	delete options;
 	if (!cfgStr.empty()) {
-		config = ParseConfig(cfgStr, configName);
-		if (config != nullptr) {
+		sources.push_back(std::make_pair(configName, cfgStr));
+		if (BuildConfig("", sources, overrides)) {
 			return true;
 		}
 	}
@@ -579,8 +586,7 @@ bool CSetupManager::LoadConfig(const std::string& cfgOption)
 	dirname = std::string("LuaRules/Configs/") + name + "/" + version + "/";
 	configName = utils::MakeFileSystemCompatible(map->GetName()) + ".json";
 
-	config = ReadConfig(dirname, {configName});
-	if (config != nullptr) {
+	if (ReadConfig(dirname, {configName}, sources) && BuildConfig(dirname, sources, overrides)) {
 		return true;
 	}
 
@@ -603,8 +609,7 @@ bool CSetupManager::LoadConfig(const std::string& cfgOption)
 	configName = "config";
 	dirname = configName + SLASH;
 	if (LocatePath(dirname)) {
-		config = ReadConfig(dirname, cfgNames);
-		if (config != nullptr) {
+		if (ReadConfig(dirname, cfgNames, sources) && BuildConfig(dirname, sources, overrides)) {
 			return true;
 		}
 	} else {
@@ -615,13 +620,12 @@ bool CSetupManager::LoadConfig(const std::string& cfgOption)
 	 * Locate develop config: to run ./spring from source dir
 	 */
 	dirname = std::string("AI/Skirmish/") + name + "/data/" + configName + "/";
-	config = ReadConfig(dirname, cfgNames);
-	return (config != nullptr);
+	return ReadConfig(dirname, cfgNames, sources) && BuildConfig(dirname, sources, overrides);
 }
 
-Json::Value* CSetupManager::ReadConfig(const std::string& dirname, const std::vector<std::string>& cfgNames)
+bool CSetupManager::ReadConfig(const std::string& dirname, const std::vector<std::string>& cfgNames, Sources& outSources)
 {
-	Json::Value* cfg = nullptr;
+	outSources.clear();
 	File* file = circuit->GetCallback()->GetFile();
 
 	for (const std::string& name : cfgNames) {
@@ -631,75 +635,109 @@ Json::Value* CSetupManager::ReadConfig(const std::string& dirname, const std::ve
 			circuit->LOG("No config file! (%s)", filename.c_str());
 			continue;
 		}
-		char* value = new char [fileSize + 1];
-		file->GetContent(filename.c_str(), value, fileSize);
-		value[fileSize] = 0;
-		std::string cfgStr(value);
-		delete[] value;
-		cfg = ParseConfig(cfgStr, name, cfg);
+		std::string cfgStr(fileSize, '\0');
+		file->GetContent(filename.c_str(), &cfgStr[0], fileSize);
+		cfgStr.resize(strlen(cfgStr.c_str()));
+		outSources.push_back(std::make_pair(name, cfgStr));
 	}
 
 	delete file;
-	return cfg;
+	return !outSources.empty();
 }
 
-Json::Value* CSetupManager::ParseConfig(const std::string& cfgStr, const std::string& cfgName, Json::Value* cfg)
+bool CSetupManager::BuildConfig(const std::string& dirname, const Sources& sources, const Sources& overrides)
 {
-	Json::CharReader* reader = Json::CharReaderBuilder().newCharReader();
-	JSONCPP_STRING errs;
-	Json::Value json;
-	bool ok = reader->parse(cfgStr.c_str(), cfgStr.c_str() + cfgStr.size(), &json, &errs);
-	delete reader;
-	if (!ok) {
-		circuit->LOG("Malformed config format! (%s)\n%s", cfgName.c_str(), errs.c_str());
-		return nullptr;
+	uint64_t hash = CConfigCompiler::Hash(nullptr, 0);
+	for (const auto& src : sources) {
+		hash = CConfigCompiler::HashSource(src.first, src.second, hash);
+	}
+	// NOTE: Overrides are applied on top of compiled config, so they are part of cache key only
+	uint64_t key = hash;
+	for (const auto& src : overrides) {
+		key = CConfigCompiler::HashSource(src.first, src.second, key);
 	}
 
-	if (cfg == nullptr) {
-		cfg = new Json::Value;
-		*cfg = json;
-	} else {
-		UpdateJson(*cfg, json);
+	CGameAttribute* gameAttribute = circuit->GetGameAttribute();
+	config = gameAttribute->GetConfig(key);
+	if (config != nullptr) {
+		return true;
+	}
+
+	std::shared_ptr<Json::Value> cfg = std::make_shared<Json::Value>();
+	if (!LoadCompiled(dirname, hash, *cfg) && !ParseConfig(sources, *cfg)) {
+		return false;
 	}
-	return cfg;
+	OverrideConfig(*cfg, overrides);
+	config = cfg;
+	gameAttribute->SetConfig(key, config);
+	return true;
 }
 
-void CSetupManager::UpdateJson(Json::Value& a, Json::Value& b) {
-	if (!a.isObject() || !b.isObject()) {
-		return;
+bool CSetupManager::LoadCompiled(const std::string& dirname, uint64_t hash, Json::Value& outCfg)
+{
+	if (dirname.empty()) {
+		return false;
+	}
+	File* file = circuit->GetCallback()->GetFile();
+	const std::string filename = dirname + CONFIG_BIN;
+	const int fileSize = file->GetSize(filename.c_str());
+	CConfigCompiler::Blob blob;
+	if (fileSize > 0) {
+		blob.resize(fileSize);
+		file->GetContent(filename.c_str(), blob.data(), fileSize);
 	}
+	delete file;
 
-	for (const auto& key : b.getMemberNames()) {
-		if (a[key].isObject()) {
-			UpdateJson(a[key], b[key]);
-		} else {
-			if (!a[key].isNull()) {
-				// TODO: Make path for key
-				circuit->LOG("Config override: %s", key.c_str());
-			}
-			a[key] = b[key];
-		}
+	if (blob.empty()) {
+		return false;
 	}
+	if (!CConfigCompiler::Decompile(blob, hash, outCfg)) {
+		circuit->LOG("Compiled config doesn't match json, ignored (%s)", filename.c_str());
+		return false;
+	}
+	return true;
 }
 
-void CSetupManager::OverrideConfig()
+bool CSetupManager::ParseConfig(const Sources& sources, Json::Value& outCfg)
 {
 	Json::CharReader* reader = Json::CharReaderBuilder().newCharReader();
-	Json::Value json;
-	OptionValues* options = circuit->GetSkirmishAI()->GetOptionValues();
+	bool isEmpty = true;
+	for (const auto& src : sources) {
+		const std::string& cfgStr = src.second;
+		JSONCPP_STRING errs;
+		Json::Value json;
+		bool ok = reader->parse(cfgStr.c_str(), cfgStr.c_str() + cfgStr.size(), &json, &errs);
+		if (!ok) {
+			circuit->LOG("Malformed config format! (%s)\n%s", src.first.c_str(), errs.c_str());
+			// NOTE: Malformed part drops parts before it
+			isEmpty = true;
+			continue;
+		}
 
-	const char* value = options->GetValueByKey("factory");
-	if ((value != nullptr) && reader->parse(value, value + strlen(value), &json, nullptr)) {
-		(*config)["factory"] = json;
+		if (isEmpty) {
+			outCfg = json;
+			isEmpty = false;
+		} else {
+			CConfigCompiler::Merge(outCfg, json, [this](const std::string& key) {
+				circuit->LOG("Config override: %s", key.c_str());
+			});
+		}
 	}
+	delete reader;
+	return !isEmpty;
+}
 
-	value = options->GetValueByKey("behaviour");
-	if ((value != nullptr) && reader->parse(value, value + strlen(value), &json, nullptr)) {
-		(*config)["behaviour"] = json;
+void CSetupManager::OverrideConfig(Json::Value& cfg, const Sources& overrides)
+{
+	Json::CharReader* reader = Json::CharReaderBuilder().newCharReader();
+	for (const auto& src : overrides) {
+		const std::string& value = src.second;
+		Json::Value json;
+		if (reader->parse(value.c_str(), value.c_str() + value.size(), &json, nullptr)) {
+			cfg[src.first] = json;
+		}
 	}
-
 	delete reader;
-	delete options;
 }
 
 } // namespace circuit
@@ -14,6 +14,7 @@
 #include "AIFloat3.h"
 
 #include <functional>
+#include <memory>
 
 namespace circuit {
 
@@ -81,15 +82,20 @@ public:
 private:
 	void FindStart();
 	bool LocatePath(std::string& filename);
+	using Sources = std::vector<std::pair<std::string, std::string>>;  // name: content
 	bool LoadConfig(const std::string& cfgOption);
-	Json::Value* ReadConfig(const std::string& dirName, const std::vector<std::string>& cfgNames);
-	Json::Value* ParseConfig(const std::string& cfgStr, const std::string& cfgName, Json::Value* cfg = nullptr);
-	void UpdateJson(Json::Value& a, Json::Value& b);
-	void OverrideConfig();
+	bool ReadConfig(const std::string& dirName, const std::vector<std::string>& cfgNames, Sources& outSources);
+	/*
+	 * Same sources and overrides parsed by another AI are taken from CGameAttribute
+	 */
+	bool BuildConfig(const std::string& dirName, const Sources& sources, const Sources& overrides);
+	bool LoadCompiled(const std::string& dirName, uint64_t hash, Json::Value& outCfg);
+	bool ParseConfig(const Sources& sources, Json::Value& outCfg);
+	void OverrideConfig(Json::Value& cfg, const Sources& overrides);
 
 	CCircuitAI* circuit;
 	CSetupData* setupData;
-	Json::Value* config;  // owner;
+	std::shared_ptr<const Json::Value> config;
 	std::string configName;
 
 	CCircuitUnit* commander;
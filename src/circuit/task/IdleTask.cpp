@@ -27,12 +27,12 @@ CIdleTask::~CIdleTask()
 void CIdleTask::AssignTo(CCircuitUnit* unit)
 {
 	unit->SetTask(this);
-	units.insert(unit);
+	idleUnits.insert(unit);
 }
 
 void CIdleTask::RemoveAssignee(CCircuitUnit* unit)
 {
-	if (units.erase(unit) > 0) {
+	if (idleUnits.erase(unit) > 0) {
 		updateUnits.erase(unit);
 	}
 
@@ -45,10 +45,7 @@ void CIdleTask::Execute(CCircuitUnit* unit)
 
 void CIdleTask::Update()
 {
-	if (updateUnits.empty()) {
-		updateUnits = units;  // copy units
-		updateSlice = updateUnits.size() / TEAM_SLOWUPDATE_RATE;
-	}
+	Refill();
 
 	auto it = updateUnits.begin();
 	unsigned int i = 0;
@@ -65,9 +62,29 @@ void CIdleTask::Update()
 	}
 }
 
-void CIdleTask::Close(bool done)
+void CIdleTask::GetNextSlice(std::vector<CCircuitUnit*>& units)
 {
+	Refill();
 	units.clear();
+	for (CCircuitUnit* unit : updateUnits) {
+		units.push_back(unit);
+		if (units.size() >= updateSlice) {
+			break;
+		}
+	}
+}
+
+void CIdleTask::Refill()
+{
+	if (updateUnits.empty()) {
+		updateUnits = idleUnits;  // copy units
+		updateSlice = updateUnits.size() / TEAM_SLOWUPDATE_RATE;
+	}
+}
+
+void CIdleTask::Close(bool done)
+{
+	idleUnits.clear();
 	updateUnits.clear();
 }
 
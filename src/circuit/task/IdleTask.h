@@ -10,6 +10,9 @@
 
 #include "task/UnitTask.h"
 
+#include <set>
+#include <vector>
+
 namespace circuit {
 
 class CIdleTask: public IUnitTask {
@@ -28,7 +31,16 @@ public:
 	virtual void OnUnitDamaged(CCircuitUnit* unit, CEnemyUnit* attacker) override;
 	virtual void OnUnitDestroyed(CCircuitUnit* unit, CEnemyUnit* attacker) override;
 
+	/*
+	 * Units that next Update() assigns, lets manager batch queries for them
+	 */
+	void GetNextSlice(std::vector<CCircuitUnit*>& units);
+
 private:
+	void Refill();
+
+	// NOTE: Holds every idle unit, hundreds at once: node set instead of small flat Units
+	std::set<CCircuitUnit*> idleUnits;
 	std::set<CCircuitUnit*> updateUnits;
 	unsigned int updateSlice;
 };
@@ -111,18 +111,19 @@ void CRetreatTask::Execute(CCircuitUnit* unit)
 		endPos = repairer->GetPos(frame);
 		range = pathfinder->GetSquareSize();
 	} else {
-		CFactoryManager* factoryManager = circuit->GetFactoryManager();
-		endPos = factoryManager->GetClosestHaven(unit);
-		if (!utils::is_valid(endPos)) {
-			endPos = circuit->GetSetupManager()->GetBasePos();
-		}
-		range = factoryManager->GetAssistDef()->GetBuildDistance() * 0.6f + pathfinder->GetSquareSize();
+		endPos = GetHaven(unit);
+		range = circuit->GetFactoryManager()->GetAssistDef()->GetBuildDistance() * 0.6f + pathfinder->GetSquareSize();
 	}
 	std::shared_ptr<F3Vec> pPath = std::make_shared<F3Vec>();
 
 	const float minThreat = circuit->GetThreatMap()->GetUnitThreat(unit) * 0.125f;
 	pathfinder->SetMapData(unit, circuit->GetThreatMap(), frame);
-	pathfinder->MakePath(*pPath, startPos, endPos, range, minThreat);
+	if (repairer != nullptr) {
+		pathfinder->MakePath(*pPath, startPos, endPos, range, minThreat);
+	} else {
+		// Many damaged units head for the same haven
+		pathfinder->MakeFlowPath(*pPath, startPos, endPos, range, minThreat);
+	}
 
 	if (pPath->empty()) {
 		pPath->push_back(endPos);
@@ -190,13 +191,9 @@ void CRetreatTask::OnUnitIdle(CCircuitUnit* unit)
 		return;
 	}
 
-	CFactoryManager* factoryManager = circuit->GetFactoryManager();
-	AIFloat3 haven = (repairer != nullptr) ? repairer->GetPos(frame) : factoryManager->GetClosestHaven(unit);
-	if (!utils::is_valid(haven)) {
-		haven = circuit->GetSetupManager()->GetBasePos();
-	}
+	const AIFloat3& haven = (repairer != nullptr) ? repairer->GetPos(frame) : GetHaven(unit);
 
-	const float maxDist = factoryManager->GetAssistDef()->GetBuildDistance();
+	const float maxDist = circuit->GetFactoryManager()->GetAssistDef()->GetBuildDistance();
 	const AIFloat3& unitPos = unit->GetPos(frame);
 	if (unitPos.SqDistance2D(haven) > maxDist * maxDist) {
 		// TODO: push MoveAction into unit? to avoid enemy fire
@@ -278,12 +275,8 @@ void CRetreatTask::CheckRepairer(CCircuitUnit* unit)
 		endPos = repairer->GetPos(frame);
 		range = pathfinder->GetSquareSize();
 	} else {
-		CFactoryManager* factoryManager = circuit->GetFactoryManager();
-		endPos = factoryManager->GetClosestHaven(unit);
-		if (!utils::is_valid(endPos)) {
-			endPos = circuit->GetSetupManager()->GetBasePos();
-		}
-		range = factoryManager->GetAssistDef()->GetBuildDistance() * 0.6f + pathfinder->GetSquareSize();
+		endPos = GetHaven(unit);
+		range = circuit->GetFactoryManager()->GetAssistDef()->GetBuildDistance() * 0.6f + pathfinder->GetSquareSize();
 	}
 
 //	CTerrainManager::CorrectPosition(startPos);
@@ -304,4 +297,25 @@ void CRetreatTask::CheckRepairer(CCircuitUnit* unit)
 	}
 }
 
+AIFloat3 CRetreatTask::GetHaven(CCircuitUnit* unit) const
+{
+	CCircuitAI* circuit = manager->GetCircuit();
+	CFactoryManager* factoryManager = circuit->GetFactoryManager();
+	const AIFloat3& haven = factoryManager->GetClosestHaven(unit);
+	if (!utils::is_valid(haven)) {
+		return circuit->GetSetupManager()->GetBasePos();
+	}
+
+	// NOTE: Mean threat over repair area, single enemy range edge shouldn't discard haven
+	CThreatMap* threatMap = circuit->GetThreatMap();
+	threatMap->SetThreatType(unit);
+	const float radius = factoryManager->GetAssistDef()->GetBuildDistance();
+	const float area = M_PI * SQUARE(radius / threatMap->GetSquareSize());
+	const float maxThreat = std::max(threatMap->GetUnitThreat(unit), THREAT_MIN);
+	if (threatMap->GetSumThreatInCircle(haven, radius) > maxThreat * area) {
+		return circuit->GetSetupManager()->GetBasePos();
+	}
+	return haven;
+}
+
 } // namespace circuit
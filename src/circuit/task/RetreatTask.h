@@ -37,6 +37,11 @@ public:
 	CCircuitUnit* GetRepairer() const { return repairer; }
 
 private:
+	/*
+	 * Closest haven unless enemy covers its repair area, base otherwise
+	 */
+	springai::AIFloat3 GetHaven(CCircuitUnit* unit) const;
+
 	CCircuitUnit* repairer;
 };
 
@@ -16,6 +16,12 @@ namespace circuit {
 
 using namespace springai;
 
+IUnitTask::Pool& IUnitTask::GetPool()
+{
+	static Pool pool;
+	return pool;
+}
+
 IUnitTask::IUnitTask(ITaskManager* mgr, Priority priority, Type type, int timeout)
 		: manager(mgr)
 		, priority(priority)
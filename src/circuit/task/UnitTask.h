@@ -8,9 +8,10 @@
 #ifndef SRC_CIRCUIT_TASK_UNITTASK_H_
 #define SRC_CIRCUIT_TASK_UNITTASK_H_
 
-#include "AIFloat3.h"
+#include "util/ObjectPool.h"
+#include "util/SmallSet.h"
 
-#include <set>
+#include "AIFloat3.h"
 
 namespace springai {
 	class Unit;
@@ -27,6 +28,13 @@ public:
 	enum class Priority: char {LOW = 0, NORMAL = 1, HIGH = 2, NOW = 99};
 	enum class Type: char {NIL, PLAYER, IDLE, WAIT, RETREAT, BUILDER, FACTORY, FIGHTER};
 	enum class State: char {ROAM, ENGAGE, DISENGAGE, REGROUP};
+	using Units = CSmallSet<CCircuitUnit*, 16>;  // typical squad fits inline
+	using Pool = CObjectPool<IUnitTask>;
+	using Handle = Pool::SHandle;
+
+	static Pool& GetPool();
+	static void* operator new(std::size_t size) { return GetPool().Allocate(size); }
+	static void operator delete(void* ptr) { GetPool().Deallocate(ptr); }
 
 protected:
 	IUnitTask(ITaskManager* mgr, Priority priority, Type type, int timeout);
@@ -51,7 +59,7 @@ public:
 	virtual void OnUnitDestroyed(CCircuitUnit* unit, CEnemyUnit* attacker) = 0;
 	void OnUnitMoveFailed(CCircuitUnit* unit);
 
-	const std::set<CCircuitUnit*>& GetAssignees() const { return units; }
+	const Units& GetAssignees() const { return units; }
 	Priority GetPriority() const { return priority; }
 	Type GetType() const { return type; }
 	ITaskManager* GetManager() const { return manager; }
@@ -61,6 +69,11 @@ public:
 
 	void Dead() { isDead = true; }
 	bool IsDead() const { return isDead; }
+	/*
+	 * Weak reference: IUnitTask::GetPool().Resolve(handle) is nullptr once task is deleted
+	 * NOTE: Managers keep tasks by handle, every task must fit CObjectPool::MAX_SIZE (largest is ~600 bytes)
+	 */
+	Handle GetHandle() const { return GetPool().GetHandle(dynamic_cast<const void*>(this)); }
 
 	friend std::ostream& operator<<(std::ostream& os, const IUnitTask& data);
 	friend std::istream& operator>>(std::istream& is, IUnitTask& data);
@@ -69,7 +82,7 @@ protected:
 	virtual void Save(std::ostream& os) const;
 
 	ITaskManager* manager;
-	std::set<CCircuitUnit*> units;
+	Units units;
 	Priority priority;
 	Type type;
 	State state;
@@ -58,7 +58,7 @@ IBuilderTask::IBuilderTask(ITaskManager* mgr, Priority priority,
 		, facing(UNIT_COMMAND_BUILD_NO_FACING)
 		, nextTask(nullptr)
 		, buildFails(0)
-		, unitIt(units.end())
+		, unitIdx(0)
 {
 	savedIncome = manager->GetCircuit()->GetEconomyManager()->GetAvgMetalIncome();
 }
@@ -76,6 +76,10 @@ bool IBuilderTask::CanAssignTo(CCircuitUnit* unit) const
 void IBuilderTask::AssignTo(CCircuitUnit* unit)
 {
 	IUnitTask::AssignTo(unit);
+	// keep update index on the same unit
+	if (unsigned(units.find(unit) - units.begin()) < unitIdx) {
+		++unitIdx;
+	}
 
 	ShowAssignee(unit);
 	if (!utils::is_valid(position)) {
@@ -90,8 +94,9 @@ void IBuilderTask::AssignTo(CCircuitUnit* unit)
 
 void IBuilderTask::RemoveAssignee(CCircuitUnit* unit)
 {
-	if ((units.find(unit) == unitIt) && (unitIt != units.end())) {
-		++unitIt;
+	auto it = units.find(unit);
+	if ((it != units.end()) && (unsigned(it - units.begin()) < unitIdx)) {
+		--unitIdx;
 	}
 	IUnitTask::RemoveAssignee(unit);
 
@@ -198,11 +203,10 @@ void IBuilderTask::Update()
 	if (units.empty()) {
 		return;
 	}
-	if (unitIt == units.end()) {
-		unitIt = units.begin();
+	if (unitIdx >= units.size()) {
+		unitIdx = 0;
 	}
-	CCircuitUnit* unit = *unitIt;
-	++unitIt;
+	CCircuitUnit* unit = units[unitIdx++];
 
 	const float sqDist = unit->GetPos(circuit->GetLastFrame()).SqDistance2D(GetPosition());
 	if (sqDist <= SQUARE(unit->GetCircuitDef()->GetBuildDistance())) {
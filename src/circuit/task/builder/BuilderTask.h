@@ -126,7 +126,7 @@ protected:
 	float savedIncome;
 	int buildFails;
 
-	decltype(units)::const_iterator unitIt;  // update iterator
+	unsigned int unitIdx;  // update index into units
 };
 
 } // namespace circuit
@@ -16,7 +16,7 @@ namespace circuit {
 CBGuardTask::CBGuardTask(ITaskManager* mgr, Priority priority, CCircuitUnit* vip, int timeout)
 		: IBuilderTask(mgr, priority, nullptr, vip->GetPos(mgr->GetCircuit()->GetLastFrame()),
 					   Type::BUILDER, BuildType::GUARD, 0.f, 0.f, timeout)
-		, vipId(vip->GetId())
+		, vipHandle(mgr->GetCircuit()->GetTeamUnits().GetHandle(vip->GetId()))
 {
 }
 
@@ -50,7 +50,7 @@ void CBGuardTask::RemoveAssignee(CCircuitUnit* unit)
 void CBGuardTask::Execute(CCircuitUnit* unit)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
+	CCircuitUnit* vip = circuit->GetTeamUnits().Resolve(vipHandle);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
 			unit->GetUnit()->ExecuteCustomCommand(CMD_PRIORITY, {ClampPriority()});
@@ -64,7 +64,7 @@ void CBGuardTask::Execute(CCircuitUnit* unit)
 void CBGuardTask::OnUnitIdle(CCircuitUnit* unit)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
+	CCircuitUnit* vip = circuit->GetTeamUnits().Resolve(vipHandle);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
 			unit->GetUnit()->Guard(vip->GetUnit());
@@ -28,7 +28,7 @@ public:
 	virtual void OnUnitIdle(CCircuitUnit* unit) override;
 
 private:
-	ICoreUnit::Id vipId;
+	CCircuitUnit::Handle vipHandle;
 };
 
 } // namespace circuit
@@ -235,7 +235,8 @@ void CAntiHeavyTask::Update()
 	pathfinder->SetMapData(leader, circuit->GetThreatMap(), frame);
 	if (leader->GetCircuitDef()->IsRoleMine()) {
 		position = circuit->GetSetupManager()->GetBasePos();
-		pathfinder->MakePath(*pPath, startPos, position, pathfinder->GetSquareSize() * 4);
+		// Mine squads share the base as destination
+		pathfinder->MakeFlowPath(*pPath, startPos, position, pathfinder->GetSquareSize() * 4);
 	} else {
 		circuit->GetMilitaryManager()->FindBestPos(*pPath, startPos, leader->GetArea());
 	}
@@ -282,7 +282,13 @@ CEnemyUnit* CArtilleryTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos,
 		fallback(circuit, pos, path, pathfinder);
 		return nullptr;
 	}
-	if (threatMap->GetThreatAt(path.back()) > THREAT_MIN) {
+	// CMicroPather::CheckSafety-style walk: path shouldn't cross threat above the one it starts in
+	const float maxThreat = std::max(threatMap->GetThreatAt(pos), THREAT_MIN);
+	bool isSafe = (threatMap->GetThreatAt(path.back()) <= THREAT_MIN);
+	for (unsigned i = 1; isSafe && (i < path.size()); ++i) {
+		isSafe = (threatMap->GetMaxThreatAlongSegment(path[i - 1], path[i]) <= maxThreat);
+	}
+	if (!isSafe) {
 		fallback(circuit, pos, path, pathfinder);
 	} else {
 		position = path.back();
@@ -205,7 +205,8 @@ void CAttackTask::Update()
 
 			CPathFinder* pathfinder = circuit->GetPathfinder();
 			pathfinder->SetMapData(leader, circuit->GetThreatMap(), frame);
-			pathfinder->MakePath(*pPath, startPos, endPos, pathfinder->GetSquareSize());
+			// All idle attack squads gather at commander
+			pathfinder->MakeFlowPath(*pPath, startPos, endPos, pathfinder->GetSquareSize());
 
 			if ((pPath->size() > 2) && (startPos.SqDistance2D(endPos) > SQUARE(500.f))) {
 				ActivePath();
@@ -136,14 +136,14 @@ void CDefendTask::Update()
 
 void CDefendTask::Merge(ISquadTask* task)
 {
-	const std::set<CCircuitUnit*>& rookies = task->GetAssignees();
+	const Units& rookies = task->GetAssignees();
 	for (CCircuitUnit* unit : rookies) {
 		unit->SetTask(this);
 	}
 	units.insert(rookies.begin(), rookies.end());
 	maxPower = std::max(maxPower, static_cast<CDefendTask*>(task)->GetMaxPower());
 	attackPower += task->GetAttackPower();
-	const std::set<CCircuitUnit*>& sh = task->GetShields();
+	const Units& sh = task->GetShields();
 	shields.insert(sh.begin(), sh.end());
 }
 
@@ -41,7 +41,7 @@ public:
 	CEnemyUnit* GetTarget() const { return target; }
 	void ClearTarget() { target = nullptr; }  // Only for ~CEnemyUnit
 
-	const std::set<CCircuitUnit*>& GetShields() const { return shields; }
+	const Units& GetShields() const { return shields; }
 
 protected:
 	void SetTarget(CEnemyUnit* enemy);
@@ -53,8 +53,8 @@ protected:
 	float powerMod;
 	CEnemyUnit* target;
 
-	std::set<CCircuitUnit*> cowards;
-	std::set<CCircuitUnit*> shields;
+	Units cowards;
+	Units shields;
 };
 
 } // namespace circuit
@@ -16,7 +16,7 @@ using namespace springai;
 
 CFGuardTask::CFGuardTask(ITaskManager* mgr, CCircuitUnit* vip, float maxPower)
 		: IFighterTask(mgr, FightType::GUARD, 1.f)
-		, vipId(vip->GetId())
+		, vipHandle(mgr->GetCircuit()->GetTeamUnits().GetHandle(vip->GetId()))
 		, maxPower(maxPower)
 {
 }
@@ -34,7 +34,7 @@ bool CFGuardTask::CanAssignTo(CCircuitUnit* unit) const
 void CFGuardTask::Execute(CCircuitUnit* unit)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
+	CCircuitUnit* vip = circuit->GetTeamUnits().Resolve(vipHandle);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
 			unit->GetUnit()->Guard(vip->GetUnit());
@@ -48,7 +48,7 @@ void CFGuardTask::Execute(CCircuitUnit* unit)
 void CFGuardTask::OnUnitIdle(CCircuitUnit* unit)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
+	CCircuitUnit* vip = circuit->GetTeamUnits().Resolve(vipHandle);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
 			unit->GetUnit()->Guard(vip->GetUnit());
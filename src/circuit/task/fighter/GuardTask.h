@@ -25,7 +25,7 @@ public:
 	virtual void OnUnitIdle(CCircuitUnit* unit) override;
 
 private:
-	ICoreUnit::Id vipId;
+	CCircuitUnit::Handle vipHandle;
 	float maxPower;
 };
 
@@ -78,7 +78,7 @@ void ISquadTask::RemoveAssignee(CCircuitUnit* unit)
 
 void ISquadTask::Merge(ISquadTask* task)
 {
-	const std::set<CCircuitUnit*>& rookies = task->GetAssignees();
+	const Units& rookies = task->GetAssignees();
 	bool isActive = static_cast<ITravelAction*>(leader->End())->IsActive();
 	for (CCircuitUnit* unit : rookies) {
 		unit->SetTask(this);
@@ -91,7 +91,7 @@ void ISquadTask::Merge(ISquadTask* task)
 	}
 	units.insert(rookies.begin(), rookies.end());
 	attackPower += task->GetAttackPower();
-	const std::set<CCircuitUnit*>& sh = task->GetShields();
+	const Units& sh = task->GetShields();
 	shields.insert(sh.begin(), sh.end());
 
 	FindLeader(rookies.begin(), rookies.end());
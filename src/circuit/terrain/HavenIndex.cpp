@@ -0,0 +1,109 @@
+/*
+ * HavenIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "terrain/HavenIndex.h"
+#include "util/utils.h"
+
+namespace circuit {
+
+using namespace springai;
+using namespace nanoflann;
+
+CHavenIndex::SBucket::SBucket(std::vector<AIFloat3>&& pts)
+		: points(std::move(pts))
+		, adaptor(points)
+		, tree(2 /*dim*/, adaptor, KDTreeSingleIndexAdaptorParams(4 /*max leaf*/))
+{
+	tree.buildIndex();
+}
+
+CHavenIndex::CHavenIndex(Reachable isReachable)
+		: isReachable(isReachable)
+{
+}
+
+CHavenIndex::~CHavenIndex()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
+
+void CHavenIndex::Add(const AIFloat3& position)
+{
+	havens.push_back(position);
+	Invalidate();
+}
+
+void CHavenIndex::RemoveNear(const AIFloat3& position, float sqRadius)
+{
+	auto it = havens.begin();
+	while (it != havens.end()) {
+		if (it->SqDistance2D(position) < sqRadius) {
+//			it = havens.erase(it);  // NOTE: micro-opt
+			*it = havens.back();
+			havens.pop_back();
+			Invalidate();
+		} else {
+			++it;
+		}
+	}
+}
+
+bool CHavenIndex::IsNear(const AIFloat3& position, float sqRadius) const
+{
+	for (const AIFloat3& hav : havens) {
+		if (position.SqDistance2D(hav) < sqRadius) {
+			return true;
+		}
+	}
+	return false;
+}
+
+AIFloat3 CHavenIndex::FindClosest(STerrainMapArea* area, const AIFloat3& position)
+{
+	if (havens.empty()) {
+		return -RgtVector;
+	}
+	std::unique_ptr<SBucket>& bucket = buckets[area];
+	if (bucket == nullptr) {
+		std::vector<AIFloat3> points;
+		for (const AIFloat3& hav : havens) {
+			if (isReachable(area, hav)) {
+				points.push_back(hav);
+			}
+		}
+		bucket.reset(new SBucket(std::move(points)));
+	}
+	return FindClosest(*bucket, position);
+}
+
+AIFloat3 CHavenIndex::FindClosest(const AIFloat3& position)
+{
+	if (havens.empty()) {
+		return -RgtVector;
+	}
+	if (any == nullptr) {
+		any.reset(new SBucket(std::vector<AIFloat3>(havens)));
+	}
+	return FindClosest(*any, position);
+}
+
+AIFloat3 CHavenIndex::FindClosest(const SBucket& bucket, const AIFloat3& position) const
+{
+	if (bucket.points.empty()) {
+		return -RgtVector;
+	}
+	float query_pt[2] = {position.x, position.z};
+	int ret_index;
+	float out_dist_sqr;
+
+	if (bucket.tree.knnSearch(&query_pt[0], 1, &ret_index, &out_dist_sqr) > 0) {
+		return bucket.points[ret_index];
+	}
+	return -RgtVector;
+}
+
+} // namespace circuit
@@ -0,0 +1,94 @@
+/*
+ * HavenIndex.h
+ *
+ *  Havens bucketed by movement area, KD-tree per bucket
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_HAVENINDEX_H_
+#define SRC_CIRCUIT_TERRAIN_HAVENINDEX_H_
+
+#include "AIFloat3.h"
+
+#include "kdtree/nanoflann.hpp"
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace circuit {
+
+struct STerrainMapArea;
+
+/*
+ * Bucket of an area holds only havens reachable from it, so lookup of a retreating unit
+ * is one nearest-neighbour query without reachability tests.
+ * Buckets are built lazily on the first query of the area: havens or areas change
+ * rarely (nano built/lost, UpdateAreaUsers), while retreats come in bursts after a fight.
+ */
+class CHavenIndex {
+public:
+	using Reachable = std::function<bool (STerrainMapArea* area, const springai::AIFloat3& position)>;
+
+	CHavenIndex(Reachable isReachable);
+	virtual ~CHavenIndex();
+
+	void Add(const springai::AIFloat3& position);
+	/*
+	 * Remove all havens within radius
+	 */
+	void RemoveNear(const springai::AIFloat3& position, float sqRadius);
+	bool IsNear(const springai::AIFloat3& position, float sqRadius) const;
+	/*
+	 * Drop buckets: area pointers are not valid after UpdateAreaUsers
+	 */
+	void Invalidate() { buckets.clear(); any.reset(); }
+
+	bool IsEmpty() const { return havens.empty(); }
+	const std::vector<springai::AIFloat3>& GetHavens() const { return havens; }
+
+	/*
+	 * Closest haven reachable from area
+	 * @return -RgtVector if none
+	 */
+	springai::AIFloat3 FindClosest(STerrainMapArea* area, const springai::AIFloat3& position);
+	/*
+	 * Closest haven regardless of area
+	 */
+	springai::AIFloat3 FindClosest(const springai::AIFloat3& position);
+
+private:
+	struct SPointAdaptor {
+		const std::vector<springai::AIFloat3>& pts;
+		SPointAdaptor(const std::vector<springai::AIFloat3>& v) : pts(v) {}
+		inline size_t kdtree_get_point_count() const { return pts.size(); }
+		inline float kdtree_get_pt(const size_t idx, const size_t dim) const {
+			return (dim == 0) ? pts[idx].x : pts[idx].z;
+		}
+		template <class BBOX>
+		bool kdtree_get_bbox(BBOX& /* bb */) const { return false; }
+	};
+	using HavenTree = nanoflann::KDTreeSingleIndexAdaptor<
+			nanoflann::L2_Simple_Adaptor<float, SPointAdaptor>,
+			SPointAdaptor,
+			2 /* dim */, int>;
+	struct SBucket {
+		SBucket(std::vector<springai::AIFloat3>&& pts);
+		std::vector<springai::AIFloat3> points;
+		SPointAdaptor adaptor;
+		HavenTree tree;
+	};
+
+	springai::AIFloat3 FindClosest(const SBucket& bucket, const springai::AIFloat3& position) const;
+
+	Reachable isReachable;
+	std::vector<springai::AIFloat3> havens;
+	std::unordered_map<STerrainMapArea*, std::unique_ptr<SBucket>> buckets;
+	std::unique_ptr<SBucket> any;  // all havens
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_TERRAIN_HAVENINDEX_H_
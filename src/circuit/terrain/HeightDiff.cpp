@@ -0,0 +1,116 @@
+/*
+ * HeightDiff.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "terrain/HeightDiff.h"
+#include "util/utils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace circuit {
+
+#define FNV_OFFSET	0xcbf29ce484222325ULL
+#define FNV_PRIME	0x100000001b3ULL
+
+CHeightDiff::CHeightDiff()
+		: width(0)
+		, height(0)
+		, tileSize(1)
+		, tilesX(0)
+		, tilesZ(0)
+{
+}
+
+CHeightDiff::~CHeightDiff()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
+
+void CHeightDiff::Init(const std::vector<float>& heightMap, int width, int height, int tileSize)
+{
+	this->width = width;
+	this->height = height;
+	this->tileSize = tileSize;
+	tilesX = (width + tileSize - 1) / tileSize;
+	tilesZ = (height + tileSize - 1) / tileSize;
+	Hash(heightMap, hashes);
+	nextHashes = hashes;
+	dirtyRects.clear();
+}
+
+const std::vector<CHeightDiff::SRect>& CHeightDiff::Diff(const std::vector<float>& heightMap)
+{
+	Hash(heightMap, nextHashes);
+
+	// Runs of dirty tiles within a row; run continues rectangle of the previous row if
+	// it has exactly the same span, otherwise it opens a new rectangle
+	dirtyRects.clear();
+	openRects.clear();
+	for (int z = 0; z < tilesZ; ++z) {
+		nextOpenRects.clear();
+		const int iRow = z * tilesX;
+		int x = 0;
+		while (x < tilesX) {
+			if (hashes[iRow + x] == nextHashes[iRow + x]) {
+				++x;
+				continue;
+			}
+			const int x1 = x;
+			while ((x < tilesX) && (hashes[iRow + x] != nextHashes[iRow + x])) {
+				++x;
+			}
+			auto it = std::find_if(openRects.begin(), openRects.end(), [this, x1, x](int i) {
+				return (dirtyRects[i].x1 == x1) && (dirtyRects[i].x2 == x);
+			});
+			if (it != openRects.end()) {
+				dirtyRects[*it].z2 = z + 1;
+				nextOpenRects.push_back(*it);
+			} else {
+				nextOpenRects.push_back(dirtyRects.size());
+				dirtyRects.push_back({x1, z, x, z + 1});
+			}
+		}
+		openRects.swap(nextOpenRects);
+	}
+	return dirtyRects;
+}
+
+void CHeightDiff::Commit()
+{
+	hashes.swap(nextHashes);
+	dirtyRects.clear();
+}
+
+void CHeightDiff::Hash(const std::vector<float>& heightMap, std::vector<uint64_t>& outHashes) const
+{
+	// FNV-1a on 64-bit words (see CConfigCompiler::Hash), map is read row by row:
+	// each row of cells updates hashes of the whole row of tiles.
+	// Each step is a bijection of hash, so a tile with one changed word is always dirty.
+	outHashes.assign(tilesX * tilesZ, FNV_OFFSET);
+	for (int z = 0; z < height; ++z) {
+		uint64_t* tileHash = &outHashes[(z / tileSize) * tilesX];
+		const float* cell = &heightMap[z * width];
+		for (int x = 0; x < width; x += tileSize) {
+			uint64_t hash = *tileHash;
+			const int xEnd = std::min(x + tileSize, width);
+			int xc = x;
+			for (; xc + 1 < xEnd; xc += 2) {  // pair of cells per step, half the multiply chain
+				uint64_t bits;
+				std::memcpy(&bits, &cell[xc], sizeof(bits));
+				hash = (hash ^ bits) * FNV_PRIME;
+			}
+			if (xc < xEnd) {
+				uint32_t bits;
+				std::memcpy(&bits, &cell[xc], sizeof(bits));
+				hash = (hash ^ bits) * FNV_PRIME;
+			}
+			*tileHash++ = hash;
+		}
+	}
+}
+
+} // namespace circuit
@@ -0,0 +1,71 @@
+/*
+ * HeightDiff.h
+ *
+ *  Tiled diff of height map: hash per tile, dirty rectangles of changed tiles
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_HEIGHTDIFF_H_
+#define SRC_CIRCUIT_TERRAIN_HEIGHTDIFF_H_
+
+#include <vector>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Height map changes locally (craters, terraform), while CTerrainData re-evaluated every
+ * sector against the previous map. Tile hashes of the committed map are kept instead:
+ * Diff reads new map once, and adjacent dirty tiles merge into few rectangles, so
+ * sector and area re-evaluation touches only them.
+ * CTerrainData uses tile == sector, rectangles are in sector coordinates then.
+ * NOTE: Diff and Commit are not thread-safe, caller serializes them (isUpdating).
+ */
+class CHeightDiff {
+public:
+	struct SRect {
+		int x1, z1;  // inclusive, in tiles
+		int x2, z2;  // exclusive, in tiles
+	};
+
+	CHeightDiff();
+	virtual ~CHeightDiff();
+
+	/*
+	 * @param width, height of heightMap in cells
+	 * @param tileSize in cells
+	 */
+	void Init(const std::vector<float>& heightMap, int width, int height, int tileSize);
+	/*
+	 * Hashes tiles of heightMap and compares them with committed ones
+	 * @return dirty rectangles, empty if heightMap didn't change
+	 */
+	const std::vector<SRect>& Diff(const std::vector<float>& heightMap);
+	/*
+	 * Heights of last Diff become the committed state
+	 */
+	void Commit();
+
+	const std::vector<SRect>& GetDirtyRects() const { return dirtyRects; }
+	int GetTileSize() const { return tileSize; }
+	int GetTilesX() const { return tilesX; }
+	int GetTilesZ() const { return tilesZ; }
+
+private:
+	void Hash(const std::vector<float>& heightMap, std::vector<uint64_t>& outHashes) const;
+
+	int width, height;
+	int tileSize;
+	int tilesX, tilesZ;
+	std::vector<uint64_t> hashes;  // committed
+	std::vector<uint64_t> nextHashes;  // of last Diff
+	std::vector<SRect> dirtyRects;
+	// Diff scratch: indices of rectangles that end at current row
+	std::vector<int> openRects;
+	std::vector<int> nextOpenRects;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_TERRAIN_HEIGHTDIFF_H_
@@ -52,12 +52,15 @@
 #include <limits>
 #include <array>
 #include <functional>
+#include <algorithm>
 //#undef NDEBUG
 #include <cassert>
 
 //#define USE_ASSERTIONS
 //#define DEBUG_PATH
 
+#define GOAL_BUCKET		16  // side of goal bucket in nodes
+
 using namespace NSMicroPather;
 
 class OpenQueueBH {
@@ -191,6 +194,7 @@ CMicroPather::CMicroPather(Graph* _graph, int sizeX, int sizeY)
 		, pathNodeCount(0)
 		, frame(0)
 		, checksum(0)
+		, expandCount(0)
 {
 //	@param allocate		The block size that the node cache is allocated from. In some
 //						cases setting this parameter will improve the perfomance of the pather.
@@ -223,6 +227,8 @@ CMicroPather::CMicroPather(Graph* _graph, int sizeX, int sizeY)
 	offsets[5] = - mapSizeX + 1;
 	offsets[6] = + mapSizeX - 1;
 	offsets[7] = + mapSizeX + 1;
+
+	goalCells.assign((mapSizeX / GOAL_BUCKET + 1) * (mapSizeY / GOAL_BUCKET + 1), -1);
 }
 
 CMicroPather::~CMicroPather()
@@ -357,6 +363,64 @@ float CMicroPather::LeastCostEstimateLocal(int nodeStartIndex)
 	return DiagonalDistance(xStart, yStart, xEndNode, yEndNode);
 }
 
+void CMicroPather::PrepareGoals(std::vector<void*>& endNodes)
+{
+	// Goals are grouped by GOAL_BUCKET x GOAL_BUCKET squares of map,
+	// only bounding box of goals is kept per square
+	const int bucketsX = mapSizeX / GOAL_BUCKET + 1;
+	goalBuckets.clear();
+	for (void*& endNode : endNodes) {
+		FixNode(&endNode);
+		const int index = (size_t)endNode;
+		PathNode* tempEndNode = &pathNodeMem[index];
+		if (tempEndNode->isEndNode) {  // rings of close targets overlap
+			continue;
+		}
+		tempEndNode->isEndNode = 1;
+		const int y = index / mapSizeX;
+		const int x = index - y * mapSizeX;
+		int& b = goalCells[(y / GOAL_BUCKET) * bucketsX + x / GOAL_BUCKET];
+		if (b < 0) {
+			b = goalBuckets.size();
+			goalBuckets.push_back({x, y, x, y});
+			continue;
+		}
+		SGoalBucket& bucket = goalBuckets[b];
+		bucket.x1 = std::min(bucket.x1, x);
+		bucket.y1 = std::min(bucket.y1, y);
+		bucket.x2 = std::max(bucket.x2, x);
+		bucket.y2 = std::max(bucket.y2, y);
+	}
+	for (const SGoalBucket& bucket : goalBuckets) {
+		goalCells[(bucket.y1 / GOAL_BUCKET) * bucketsX + bucket.x1 / GOAL_BUCKET] = -1;
+	}
+}
+
+void CMicroPather::UnmarkGoals(const std::vector<void*>& endNodes)
+{
+	for (void* endNode : endNodes) {
+		pathNodeMem[(size_t)endNode].isEndNode = 0;
+	}
+}
+
+float CMicroPather::LeastCostEstimateGoals(int nodeStartIndex)
+{
+	const int yStart = nodeStartIndex / mapSizeX;
+	const int xStart = nodeStartIndex - yStart * mapSizeX;
+
+	// DiagonalDistance is a norm, so distance to a set is consistent (least cost estimate
+	// over goals is). Boxes of buckets are a superset of goals: cheap, a bit less informed.
+	// Same as DiagonalDistance to the closest point of box, but in fixed point 1/10000:
+	// integer min keeps the loop free of float conversions.
+	int leastCost = std::numeric_limits<int>::max();
+	for (const SGoalBucket& bucket : goalBuckets) {
+		const int dx = std::max(bucket.x1 - xStart, 0) + std::max(xStart - bucket.x2, 0);
+		const int dy = std::max(bucket.y1 - yStart, 0) + std::max(yStart - bucket.y2, 0);
+		leastCost = std::min(leastCost, 10000 * (dx + dy) - 5858 * std::min(dx, dy));
+	}
+	return leastCost * 1e-4f;
+}
+
 inline float CMicroPather::DiagonalDistance(int xStart, int yStart, int xEnd, int yEnd)
 {
 	const int dx = abs(xStart - xEnd);
@@ -490,6 +554,7 @@ int CMicroPather::Solve(void* startNode, void* endNode, std::vector<void*>* path
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		if (node == endPathNode) {
 			GoalReached(node, startNode, endNode, path);
@@ -570,7 +635,7 @@ int CMicroPather::Solve(void* startNode, void* endNode, std::vector<void*>* path
 	return NO_SOLUTION;
 }
 
-int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*>& endNodes, std::vector<void*>& targets, std::vector<void*>* path, float* cost)
+int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*>& endNodes, std::vector<void*>* path, float* cost)
 {
 	assert(!isRunning);
 	isRunning = true;
@@ -583,24 +648,7 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 	}
 
 	{
-		// select best goal node
-		void* endNode = endNodes[0];
-		const int yStart = (size_t)startNode / mapSizeX;
-		const int xStart = (size_t)startNode - yStart * mapSizeX;
-
-		float leastCost = std::numeric_limits<float>::max();
-		for (void*& target : targets) {
-			FixNode(&target);
-			const int y = (size_t)target / mapSizeX;
-			const int x = (size_t)target - y * mapSizeX;
-			const float cost = DiagonalDistance(xStart, yStart, x, y);
-
-			if (leastCost > cost) {
-				leastCost = cost;
-				endNode = target;
-			}
-		}
-		FixStartEndNode(&startNode, &endNode);
+		FixNode(&startNode);
 
 		if (!canMoveArray[(size_t)startNode]) {
 			// L("Pather: trying to move from a blocked start pos");
@@ -618,7 +666,10 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 	OpenQueueBH open(heapArrayMem);
 
 	{
-		const float estToGoal = LeastCostEstimateLocal((size_t)startNode);
+		// mark the endNodes
+		PrepareGoals(endNodes);
+
+		const float estToGoal = LeastCostEstimateGoals((size_t)startNode);
 
 		PathNode* tempStartNode = &pathNodeMem[(size_t) startNode];
 		tempStartNode->Reuse(frame);
@@ -627,15 +678,9 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 		open.Push(tempStartNode);
 	}
 
-	// mark the endNodes
-	for (unsigned i = 0; i < endNodes.size(); i++) {
-		FixNode(&endNodes[i]);
-		PathNode* tempEndNode = &pathNodeMem[(size_t) endNodes[i]];
-		tempEndNode->isEndNode = 1;
-	}
-
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		if (node->isEndNode) {
 			void* theEndNode = (void*) ((((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode));
@@ -645,10 +690,7 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 			isRunning = false;
 
 			// unmark the endNodes
-			for (unsigned i = 0; i < endNodes.size(); i++) {
-				PathNode* tempEndNode = &pathNodeMem[(size_t) endNodes[i]];
-				tempEndNode->isEndNode = 0;
-			}
+			UnmarkGoals(endNodes);
 
 			return SOLVED;
 		} else {
@@ -702,10 +744,15 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 					continue;
 				}
 
+				// estimate of a node doesn't change within search, it is computed on first touch only
+				const float estToGoal = (directNode->costFromStart < FLT_BIG / 2.0f)
+						? directNode->totalCost - directNode->costFromStart
+						: LeastCostEstimateGoals(indexEnd);
+
 				// it's better, update its data
 				directNode->parent = node;
 				directNode->costFromStart = newCost;
-				directNode->totalCost = newCost + LeastCostEstimateLocal(indexEnd);
+				directNode->totalCost = newCost + estToGoal;
 
 				#ifdef USE_ASSERTIONS
 				assert(((size_t) indexEnd) == ((((size_t) directNode) - ((size_t) pathNodeMem)) / sizeof(PathNode)));
@@ -724,16 +771,13 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*
 	}
 
 	// unmark the endNodes
-	for (unsigned i = 0; i < endNodes.size(); i++) {
-		PathNode* tempEndNode = &pathNodeMem[(size_t)endNodes[i]];
-		tempEndNode->isEndNode = 0;
-	}
+	UnmarkGoals(endNodes);
 
 	isRunning = false;
 	return NO_SOLUTION;
 }
 
-int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<void*>& endNodes, std::vector<void*>& targets, std::vector<void*>* path, float* cost)
+int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<void*>& endNodes, std::vector<void*>* path, float* cost)
 {
 	assert(!isRunning);
 	isRunning = true;
@@ -746,24 +790,7 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 	}
 
 	{
-		// select best goal node
-		void* endNode = endNodes[0];
-		const int yStart = (size_t)startNode / mapSizeX;
-		const int xStart = (size_t)startNode - yStart * mapSizeX;
-
-		float leastCost = std::numeric_limits<float>::max();
-		for (void*& target : targets) {
-			FixNode(&target);
-			const int y = (size_t)target / mapSizeX;
-			const int x = (size_t)target - y * mapSizeX;
-			const float cost = DiagonalDistance(xStart, yStart, x, y);
-
-			if (leastCost > cost) {
-				leastCost = cost;
-				endNode = target;
-			}
-		}
-		FixStartEndNode(&startNode, &endNode);
+		FixNode(&startNode);
 
 		if (!canMoveArray[(size_t)startNode]) {
 			// L("Pather: trying to move from a blocked start pos");
@@ -781,7 +808,10 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 	OpenQueueBH open(heapArrayMem);
 
 	{
-		const float estToGoal = LeastCostEstimateLocal((size_t)startNode);
+		// mark the endNodes
+		PrepareGoals(endNodes);
+
+		const float estToGoal = LeastCostEstimateGoals((size_t)startNode);
 
 		PathNode* tempStartNode = &pathNodeMem[(size_t) startNode];
 		tempStartNode->Reuse(frame);
@@ -790,13 +820,6 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 		open.Push(tempStartNode);
 	}
 
-	// mark the endNodes
-	for (unsigned i = 0; i < endNodes.size(); i++) {
-		FixNode(&endNodes[i]);
-		PathNode* tempEndNode = &pathNodeMem[(size_t) endNodes[i]];
-		tempEndNode->isEndNode = 1;
-	}
-
 	static std::array<std::function<bool (float diff)>, 2> peakCheck = {
 		[](float diff) { return diff > 0; },
 		[](float diff) { return diff < 0; }
@@ -804,6 +827,7 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		if (node->isEndNode) {
 			void* theEndNode = (void*) ((((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode));
@@ -813,10 +837,7 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 			isRunning = false;
 
 			// unmark the endNodes
-			for (unsigned i = 0; i < endNodes.size(); i++) {
-				PathNode* tempEndNode = &pathNodeMem[(size_t) endNodes[i]];
-				tempEndNode->isEndNode = 0;
-			}
+			UnmarkGoals(endNodes);
 
 			return SOLVED;
 		} else {
@@ -878,10 +899,15 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 					}
 				}
 
+				// estimate of a node doesn't change within search, it is computed on first touch only
+				const float estToGoal = (directNode->costFromStart < FLT_BIG / 2.0f)
+						? directNode->totalCost - directNode->costFromStart
+						: LeastCostEstimateGoals(indexEnd);
+
 				// it's better, update its data
 				directNode->parent = node;
 				directNode->costFromStart = newCost;
-				directNode->totalCost = newCost + LeastCostEstimateLocal(indexEnd);
+				directNode->totalCost = newCost + estToGoal;
 				directNode->checkIdx = checkIdx;
 
 				#ifdef USE_ASSERTIONS
@@ -901,10 +927,7 @@ int CMicroPather::FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<v
 	}
 
 	// unmark the endNodes
-	for (unsigned i = 0; i < endNodes.size(); i++) {
-		PathNode* tempEndNode = &pathNodeMem[(size_t)endNodes[i]];
-		tempEndNode->isEndNode = 0;
-	}
+	UnmarkGoals(endNodes);
 
 	isRunning = false;
 	return NO_SOLUTION;
@@ -967,6 +990,7 @@ int CMicroPather::FindBestPathToPointOnRadius(void* startNode, void* endNode, st
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		int indexStart = (((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode);
 		int ystart = indexStart / mapSizeX;
@@ -1117,6 +1141,7 @@ int CMicroPather::FindBestPathToPointOnRadius(void* startNode, void* endNode, st
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		int indexStart = (((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode);
 		int ystart = indexStart / mapSizeX;
@@ -1268,6 +1293,7 @@ int CMicroPather::FindBestCostToPointOnRadius(void* startNode, void* endNode, fl
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		int indexStart = (((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode);
 		int ystart = indexStart / mapSizeX;
@@ -1416,6 +1442,7 @@ int CMicroPather::FindDirectCostToPointOnRadius(void* startNode, void* endNode,
 
 	while (!open.Empty()) {
 		PathNode* node = open.Pop();
+		++expandCount;
 
 		int indexStart = (((size_t) node) - ((size_t) pathNodeMem)) / sizeof(PathNode);
 		int ystart = indexStart / mapSizeX;
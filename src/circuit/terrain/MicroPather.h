@@ -245,6 +245,10 @@ namespace NSMicroPather {
 			  * and a quick way to see if 2 paths are the same.
 			  */
 			unsigned Checksum() const { return checksum; }
+			/**
+			  * Total number of nodes popped from open queue by all searches, for profiling.
+			  */
+			unsigned GetExpandCount() const { return expandCount; }
 
 			// Tournesol's stuff
 			unsigned int* lockUpCount;
@@ -256,9 +260,13 @@ namespace NSMicroPather {
 			int xEndNode, yEndNode;
 			bool isRunning;
 			void SetMapData(bool* canMoveArray, float* costArray);
-			int FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*>& endNodes, std::vector<void*>& targets,
+			/*
+			 * Path to the closest of endNodes, heuristic is the least estimate over all of them
+			 * (admissible and consistent, first reached goal is the best one).
+			 */
+			int FindBestPathToAnyGivenPoint(void* startNode, std::vector<void*>& endNodes,
 											std::vector<void*>* path, float* cost);
-			int FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<void*>& endNodes, std::vector<void*>& targets,
+			int FindBestPathToAnyGivenPointSafe(void* startNode, std::vector<void*>& endNodes,
 											std::vector<void*>* path, float* cost);
 			int FindBestPathToPointOnRadius(void* startNode, void* endNode, std::vector<void*>* path, float* cost, int radius);
 			int FindBestPathToPointOnRadius(void* startNode, void* endNode, std::vector<void*>* path, float* cost, int radius, float threat);
@@ -269,6 +277,12 @@ namespace NSMicroPather {
 			void GoalReached(PathNode* node, void* start, void* end, std::vector<void*> *path);
 			float CheckSafety(PathNode* node);
 			float LeastCostEstimateLocal(int nodeStartIndex);
+			/*
+			 * Marks endNodes and groups them into buckets for LeastCostEstimateGoals
+			 */
+			void PrepareGoals(std::vector<void*>& endNodes);
+			void UnmarkGoals(const std::vector<void*>& endNodes);
+			float LeastCostEstimateGoals(int nodeStartIndex);
 			static inline float DiagonalDistance(int xStart, int yStart, int xEnd, int yEnd);
 			void FixStartEndNode(void** startNode, void** endNode);
 			void FixNode(void** Node);
@@ -288,6 +302,14 @@ namespace NSMicroPather {
 			unsigned pathNodeCount;			// the # of PathNodes in use
 			unsigned frame;					// incremented with every solve, used to determine if cached data needs to be refreshed
 			unsigned checksum;				// the checksum of the last successful "Solve".
+			unsigned expandCount;			// nodes expanded since construction
+
+			// Goals of FindBestPathToAnyGivenPoint
+			struct SGoalBucket {
+				int x1, y1, x2, y2;			// bounding box of goals
+			};
+			std::vector<int> goalCells;		// bucket of GOAL_BUCKET square, -1 between searches
+			std::vector<SGoalBucket> goalBuckets;
 	};
 }
 
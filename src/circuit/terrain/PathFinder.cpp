@@ -11,6 +11,7 @@
 #include "terrain/TerrainManager.h"
 #include "terrain/ThreatMap.h"
 #include "unit/CircuitUnit.h"
+#include "util/Profiler.h"
 #include "util/utils.h"
 #ifdef DEBUG_VIS
 #include "CircuitAI.h"
@@ -21,17 +22,30 @@
 #include "Figure.h"
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
 namespace circuit {
 
 using namespace springai;
 using namespace NSMicroPather;
 
+#define PATH_CACHE_SIZE		256
+#define PATH_CACHE_TOLERANCE	0.1f
+#define PATH_CACHE_EPOCHS		4
+#define FLOW_FIELD_SIZE		8
+
 std::vector<int> CPathFinder::blockArray;
 
 CPathFinder::CPathFinder(CTerrainData* terrainData)
 		: terrainData(terrainData)
 		, airMoveArray(nullptr)
 		, isUpdated(true)
+		, mapMoveArray(nullptr)
+		, mapCostArray(nullptr)
+		, mapThreatMap(nullptr)
 #ifdef DEBUG_VIS
 		, isVis(false)
 		, toggleFrame(-1)
@@ -160,26 +174,117 @@ void CPathFinder::UpdateAreaUsers(CTerrainManager* terrainManager)
 		}
 	}
 	micropather->Reset();
+
+	pathCache.clear();
+	pathCacheIdxs.clear();
+	flowFields.clear();
 }
 
 void CPathFinder::SetMapData(CCircuitUnit* unit, CThreatMap* threatMap, int frame)
+{
+	bool* moveArray;
+	float* costArray;
+	GetMapData(unit, threatMap, frame, moveArray, costArray);
+	micropather->SetMapData(moveArray, costArray);
+	mapMoveArray = moveArray;
+	mapCostArray = costArray;
+	mapThreatMap = threatMap;
+}
+
+void CPathFinder::PullString(CCircuitUnit* unit, CThreatMap* threatMap, int frame, const F3Vec& posPath, std::vector<int>& outCorners)
+{
+	PROFILE_SCOPE("CPathFinder::PullString");
+	outCorners.clear();
+	if (posPath.empty()) {
+		return;
+	}
+	bool* moveArray;
+	float* costArray;
+	GetMapData(unit, threatMap, frame, moveArray, costArray);
+
+	static std::vector<std::pair<int, int>> nodes;  // NOTE: micro-opt
+	nodes.clear();
+	for (const AIFloat3& pos : posPath) {
+		int x, y;
+		Pos2XY(pos, &x, &y);
+		nodes.push_back(std::make_pair(utils::clamp(x, 1, pathMapXSize - 2), utils::clamp(y, 1, pathMapYSize - 2)));
+	}
+
+	const int lastIdx = nodes.size() - 1;
+	outCorners.push_back(0);
+	int anchor = 0;
+	// Max threat of path nodes after anchor
+	float maxCost = costArray[nodes[std::min(1, lastIdx)].second * pathMapXSize + nodes[std::min(1, lastIdx)].first];
+	for (int i = 1; i < lastIdx; ++i) {
+		// Can anchor see the waypoint after i?
+		const std::pair<int, int>& next = nodes[i + 1];
+		const float nextMaxCost = std::max(maxCost, costArray[next.second * pathMapXSize + next.first]);
+		if (IsStraightPath(nodes[anchor].first, nodes[anchor].second, next.first, next.second,
+			moveArray, costArray, nextMaxCost))
+		{
+			maxCost = nextMaxCost;
+			continue;
+		}
+		outCorners.push_back(i);
+		anchor = i;
+		maxCost = costArray[next.second * pathMapXSize + next.first];
+	}
+	if (lastIdx > 0) {
+		outCorners.push_back(lastIdx);
+	}
+	PROFILE_COUNT("CPathFinder::droppedWaypoints", posPath.size() - outCorners.size());
+}
+
+void CPathFinder::GetMapData(CCircuitUnit* unit, CThreatMap* threatMap, int frame, bool*& outMoveArray, float*& outCostArray)
 {
 	CCircuitDef* cdef = unit->GetCircuitDef();
 	STerrainMapMobileType::Id mobileTypeId = cdef->GetMobileId();
-	bool* moveArray = (mobileTypeId < 0) ? airMoveArray : moveArrays[mobileTypeId];
-	float* costArray;
+	outMoveArray = (mobileTypeId < 0) ? airMoveArray : moveArrays[mobileTypeId];
 	if ((unit->GetPos(frame).y < .0f) && !cdef->IsSonarStealth()) {
-		costArray = threatMap->GetAmphThreatArray();  // cloak doesn't work under water
+		outCostArray = threatMap->GetAmphThreatArray();  // cloak doesn't work under water
 	} else if (unit->GetUnit()->IsCloaked()) {
-		costArray = threatMap->GetCloakThreatArray();
+		outCostArray = threatMap->GetCloakThreatArray();
 	} else if (cdef->IsAbleToFly()) {
-		costArray = threatMap->GetAirThreatArray();
+		outCostArray = threatMap->GetAirThreatArray();
 	} else if (cdef->IsAmphibious()) {
-		costArray = threatMap->GetAmphThreatArray();
+		outCostArray = threatMap->GetAmphThreatArray();
 	} else {
-		costArray = threatMap->GetSurfThreatArray();
+		outCostArray = threatMap->GetSurfThreatArray();
 	}
-	micropather->SetMapData(moveArray, costArray);
+}
+
+/*
+ * Bresenham line, diagonal step also requires both side cells (no corner cutting).
+ * Start cell is not checked: it is on the path already and unit may stand on blocked one.
+ */
+bool CPathFinder::IsStraightPath(int x0, int y0, int x1, int y1, const bool* moveArray, const float* costArray, float maxCost) const
+{
+	auto isOpen = [this, moveArray, costArray, maxCost](int x, int y) {
+		const int index = y * pathMapXSize + x;
+		return moveArray[index] && (costArray[index] <= maxCost);
+	};
+	const int dx = std::abs(x1 - x0);
+	const int dy = -std::abs(y1 - y0);
+	const int sx = (x0 < x1) ? 1 : -1;
+	const int sy = (y0 < y1) ? 1 : -1;
+	int err = dx + dy;
+	while ((x0 != x1) || (y0 != y1)) {
+		const int e2 = 2 * err;
+		const bool isStepX = (e2 >= dy);
+		const bool isStepY = (e2 <= dx);
+		if (isStepX) {
+			err += dy;
+			x0 += sx;
+		}
+		if (isStepY) {
+			err += dx;
+			y0 += sy;
+		}
+		if (!isOpen(x0, y0) || (isStepX && isStepY && (!isOpen(x0 - sx, y0) || !isOpen(x0, y0 - sy)))) {
+			return false;
+		}
+	}
+	return true;
 }
 
 void* CPathFinder::XY2Node(int x, int y)
@@ -222,6 +327,7 @@ void CPathFinder::Pos2XY(AIFloat3 pos, int* x, int* y)
  */
 float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos, int radius)
 {
+	PROFILE_SCOPE("CPathFinder::MakePath");
 	path.clear();
 
 	CTerrainData::CorrectPosition(startPos);
@@ -236,6 +342,15 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
 
 	radius /= squareSize;
 
+	const SPathKey key = {sy * pathMapXSize + sx, ey * pathMapXSize + ex, radius, mapMoveArray, mapCostArray, -1.f};
+	if (GetCachedPath(key, posPath, pathCost)) {
+#ifdef DEBUG_VIS
+		UpdateVis(posPath);
+#endif
+		return pathCost;
+	}
+	const unsigned expandCount = micropather->GetExpandCount();
+
 	if (micropather->FindBestPathToPointOnRadius(XY2Node(sx, sy), XY2Node(ex, ey), &path, &pathCost, radius) == CMicroPather::SOLVED) {
 		posPath.reserve(path.size());
 
@@ -248,6 +363,7 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
 			mypos.y = map->GetElevationAt(mypos.x, mypos.z);
 			posPath.push_back(mypos);
 		}
+		PutCachedPath(key, posPath, pathCost, micropather->GetExpandCount() - expandCount);
 	}
 
 #ifdef DEBUG_VIS
@@ -259,6 +375,7 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
 
 float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos, int radius, float threat)
 {
+	PROFILE_SCOPE("CPathFinder::MakePath(threat)");
 	path.clear();
 
 	CTerrainData::CorrectPosition(startPos);
@@ -273,6 +390,15 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
 
 	radius /= squareSize;
 
+	const SPathKey key = {sy * pathMapXSize + sx, ey * pathMapXSize + ex, radius, mapMoveArray, mapCostArray, threat};
+	if (GetCachedPath(key, posPath, pathCost)) {
+#ifdef DEBUG_VIS
+		UpdateVis(posPath);
+#endif
+		return pathCost;
+	}
+	const unsigned expandCount = micropather->GetExpandCount();
+
 	if (micropather->FindBestPathToPointOnRadius(XY2Node(sx, sy), XY2Node(ex, ey), &path, &pathCost, radius, threat) == CMicroPather::SOLVED) {
 		posPath.reserve(path.size());
 
@@ -285,6 +411,7 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
 			mypos.y = map->GetElevationAt(mypos.x, mypos.z);
 			posPath.push_back(mypos);
 		}
+		PutCachedPath(key, posPath, pathCost, micropather->GetExpandCount() - expandCount);
 	}
 
 #ifdef DEBUG_VIS
@@ -299,6 +426,7 @@ float CPathFinder::MakePath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos
  */
 float CPathFinder::PathCost(const springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius)
 {
+	PROFILE_SCOPE("CPathFinder::PathCost");
 	CTerrainData::CorrectPosition(endPos);
 
 	float pathCost = 0.0f;
@@ -320,6 +448,7 @@ float CPathFinder::PathCost(const springai::AIFloat3& startPos, springai::AIFloa
  */
 float CPathFinder::PathCostDirect(const springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius)
 {
+	PROFILE_SCOPE("CPathFinder::PathCostDirect");
 	CTerrainData::CorrectPosition(endPos);
 
 	float pathCost = -1.0f;
@@ -338,6 +467,7 @@ float CPathFinder::PathCostDirect(const springai::AIFloat3& startPos, springai::
 
 float CPathFinder::FindBestPath(F3Vec& posPath, AIFloat3& startPos, float maxRange, F3Vec& possibleTargets, bool safe)
 {
+	PROFILE_SCOPE("CPathFinder::FindBestPath");
 	float pathCost = 0.0f;
 
 	// <maxRange> must always be >= squareSize, otherwise
@@ -454,8 +584,8 @@ float CPathFinder::FindBestPath(F3Vec& posPath, AIFloat3& startPos, float maxRan
 
 	CTerrainData::CorrectPosition(startPos);
 
-	int result = safe ? micropather->FindBestPathToAnyGivenPointSafe(Pos2Node(startPos), endNodes, nodeTargets, &path, &pathCost) :
-						micropather->FindBestPathToAnyGivenPoint(Pos2Node(startPos), endNodes, nodeTargets, &path, &pathCost);
+	int result = safe ? micropather->FindBestPathToAnyGivenPointSafe(Pos2Node(startPos), endNodes, &path, &pathCost) :
+						micropather->FindBestPathToAnyGivenPoint(Pos2Node(startPos), endNodes, &path, &pathCost);
 	if (result == CMicroPather::SOLVED) {
 		posPath.reserve(path.size());
 
@@ -483,6 +613,310 @@ float CPathFinder::FindBestPathToRadius(F3Vec& posPath, AIFloat3& startPos, floa
 	return FindBestPath(posPath, startPos, radiusAroundTarget, posTargets);
 }
 
+/*
+ * radius is in full res.
+ * returns the path cost.
+ */
+float CPathFinder::MakeFlowPath(F3Vec& posPath, AIFloat3& startPos, AIFloat3& endPos, int radius, float threat)
+{
+	PROFILE_SCOPE("CPathFinder::MakeFlowPath");
+	if (mapThreatMap == nullptr) {
+		return MakePath(posPath, startPos, endPos, radius, threat);
+	}
+
+	CTerrainData::CorrectPosition(startPos);
+	CTerrainData::CorrectPosition(endPos);
+
+	int ex, ey;
+	Pos2XY(endPos, &ex, &ey);
+	int sx, sy;
+	Pos2XY(startPos, &sx, &sy);
+
+	// Units differ in threat they ignore, round it down so they can share a field
+	const float fieldThreat = (threat < THREAT_BASE) ? .0f : std::exp2(std::floor(std::log2(threat)));
+	SFlowField& field = GetFlowField(ey * pathMapXSize + ex, std::max(radius / squareSize, 1), fieldThreat);
+	const std::vector<float>& dists = field.dists;
+	const int offsets[] = {-1, 1, -pathMapXSize, pathMapXSize,
+			-pathMapXSize - 1, -pathMapXSize + 1, pathMapXSize - 1, pathMapXSize + 1};
+
+	// Descend along the gradient: next node is the one with least cost to goal through it
+	static std::vector<int> nodes;  // NOTE: micro-opt
+	nodes.clear();
+	int node = sy * pathMapXSize + sx;
+	float pathCost = .0f;
+	nodes.push_back(node);
+	while (dists[node] > .0f) {
+		int bestNode = -1;
+		float bestCost = std::numeric_limits<float>::max();
+		float bestStep = .0f;
+		for (int i = 0; i < 8; ++i) {
+			const int next = node + offsets[i];
+			if (!field.moveArray[next] || (dists[next] == std::numeric_limits<float>::max())) {
+				continue;
+			}
+			const float nodeCost = field.costs[next];
+			const float stepCost = (i > 3) ? nodeCost * SQRT_2 : nodeCost;
+			if (stepCost + dists[next] < bestCost) {
+				bestCost = stepCost + dists[next];
+				bestStep = stepCost;
+				bestNode = next;
+			}
+		}
+		if ((bestNode < 0) || (nodes.size() > dists.size())) {
+			// Start is cut off from destination
+			return MakePath(posPath, startPos, endPos, radius, threat);
+		}
+		pathCost += bestStep;
+		node = bestNode;
+		nodes.push_back(node);
+	}
+
+	posPath.reserve(posPath.size() + nodes.size());
+	Map* map = terrainData->GetMap();
+	for (int index : nodes) {
+		float3 mypos = Node2Pos((void*) static_cast<intptr_t>(index));
+		mypos.y = map->GetElevationAt(mypos.x, mypos.z);
+		posPath.push_back(mypos);
+	}
+
+#ifdef DEBUG_VIS
+	UpdateVis(posPath);
+#endif
+
+	return pathCost;
+}
+
+CPathFinder::SFlowField& CPathFinder::GetFlowField(int goalNode, int radius, float threat)
+{
+	const int epoch = mapThreatMap->GetEpoch();
+	auto it = std::find_if(flowFields.begin(), flowFields.end(), [&](const SFlowField& field) {
+		return (field.goalNode == goalNode) && (field.radius == radius) && (field.moveArray == mapMoveArray)
+			&& (field.costArray == mapCostArray) && (field.threat == threat) && (field.threatMap == mapThreatMap);
+	});
+	if (it != flowFields.end()) {
+		flowFields.splice(flowFields.begin(), flowFields, it);
+		if (it->epoch != epoch) {
+			it->epoch = epoch;
+			UpdateFlowField(*it);
+		} else {
+			PROFILE_COUNT("CPathFinder::flowFieldHit", 1);
+		}
+		return *it;
+	}
+
+	if (flowFields.size() >= FLOW_FIELD_SIZE) {
+		flowFields.pop_back();
+	}
+	flowFields.push_front({goalNode, radius, mapMoveArray, mapCostArray, threat, mapThreatMap, epoch, {}, {}});
+	SFlowField& field = flowFields.front();
+	FillFlowField(field);
+	return field;
+}
+
+/*
+ * Reverse Dijkstra: seeds are passable nodes within radius of goal.
+ * Step into node costs the same as in CMicroPather::FindBestPathToPointOnRadius.
+ */
+void CPathFinder::FillFlowField(SFlowField& field)
+{
+	PROFILE_SCOPE("CPathFinder::FillFlowField");
+	std::vector<float>& costs = field.costs;
+	costs.resize(pathMapXSize * pathMapYSize);
+	for (unsigned node = 0; node < costs.size(); ++node) {
+		costs[node] = std::max(THREAT_BASE, field.costArray[node] - field.threat);
+	}
+	std::vector<float>& dists = field.dists;
+	dists.assign(pathMapXSize * pathMapYSize, std::numeric_limits<float>::max());
+
+	flowQueue.clear();
+	int gx, gy;
+	Node2XY((void*) static_cast<intptr_t>(field.goalNode), &gx, &gy);
+	const int sqRadius = SQUARE(field.radius);
+	for (int y = std::max(gy - field.radius, 1); y <= std::min(gy + field.radius, pathMapYSize - 2); ++y) {
+		for (int x = std::max(gx - field.radius, 1); x <= std::min(gx + field.radius, pathMapXSize - 2); ++x) {
+			const int node = y * pathMapXSize + x;
+			if (field.moveArray[node] && (SQUARE(x - gx) + SQUARE(y - gy) <= sqRadius)) {
+				dists[node] = .0f;
+				flowQueue.push_back(std::make_pair(.0f, node));
+			}
+		}
+	}
+	// min-heap, all seeds are 0 so it's a heap already
+	SpreadFlowField(field);
+}
+
+/*
+ * Node's dist depends only on costs of nodes it enters on the way to goal, and those are closer to goal.
+ * Nodes closer than any node with changed cost keep their dist, the rest is spread again from them.
+ * Threat the field ignores clamps most of cell changes away, and threat changes far from goal
+ * re-spread only the far part of field.
+ */
+void CPathFinder::UpdateFlowField(SFlowField& field)
+{
+	PROFILE_SCOPE("CPathFinder::UpdateFlowField");
+	std::vector<float>& costs = field.costs;
+	std::vector<float>& dists = field.dists;
+	float minDist = std::numeric_limits<float>::max();
+	for (unsigned node = 0; node < costs.size(); ++node) {
+		const float cost = std::max(THREAT_BASE, field.costArray[node] - field.threat);
+		if (cost != costs[node]) {
+			costs[node] = cost;
+			minDist = std::min(minDist, dists[node]);
+		}
+	}
+	if (minDist == std::numeric_limits<float>::max()) {
+		PROFILE_COUNT("CPathFinder::flowFieldHit", 1);
+		return;
+	}
+
+	// Seeds (0) are always kept
+	for (float& dist : dists) {
+		if ((dist >= minDist) && (dist > .0f)) {
+			dist = std::numeric_limits<float>::max();
+		}
+	}
+	const int offsets[] = {-1, 1, -pathMapXSize, pathMapXSize,
+			-pathMapXSize - 1, -pathMapXSize + 1, pathMapXSize - 1, pathMapXSize + 1};
+	flowQueue.clear();
+	for (int node = 0; node < (int)dists.size(); ++node) {
+		if (dists[node] == std::numeric_limits<float>::max()) {
+			continue;
+		}
+		// Kept node is passable, thus not on the border
+		for (int i = 0; i < 8; ++i) {
+			const int prev = node + offsets[i];
+			if (field.moveArray[prev] && (dists[prev] == std::numeric_limits<float>::max())) {
+				flowQueue.push_back(std::make_pair(dists[node], node));
+				break;
+			}
+		}
+	}
+	std::make_heap(flowQueue.begin(), flowQueue.end(), std::greater<FlowItem>());
+	SpreadFlowField(field);
+}
+
+void CPathFinder::SpreadFlowField(SFlowField& field)
+{
+	std::vector<float>& dists = field.dists;
+	const std::vector<float>& costs = field.costs;
+	const int offsets[] = {-1, 1, -pathMapXSize, pathMapXSize,
+			-pathMapXSize - 1, -pathMapXSize + 1, pathMapXSize - 1, pathMapXSize + 1};
+
+	while (!flowQueue.empty()) {
+		std::pop_heap(flowQueue.begin(), flowQueue.end(), std::greater<FlowItem>());
+		const FlowItem item = flowQueue.back();
+		flowQueue.pop_back();
+		const int node = item.second;
+		if (item.first > dists[node]) {
+			continue;  // stale
+		}
+		// Unit at prev enters node
+		const float nodeCost = costs[node];
+		for (int i = 0; i < 8; ++i) {
+			const int prev = node + offsets[i];
+			if (!field.moveArray[prev]) {
+				continue;
+			}
+			const float dist = item.first + ((i > 3) ? nodeCost * SQRT_2 : nodeCost);
+			if (dist < dists[prev]) {
+				dists[prev] = dist;
+				flowQueue.push_back(std::make_pair(dist, prev));
+				std::push_heap(flowQueue.begin(), flowQueue.end(), std::greater<FlowItem>());
+			}
+		}
+	}
+}
+
+std::size_t CPathFinder::SPathKeyHash::operator()(const SPathKey& key) const
+{
+	std::size_t seed = std::hash<int>()(key.startNode);
+	auto combine = [&seed](std::size_t value) {
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	};
+	combine(std::hash<int>()(key.endNode));
+	combine(std::hash<int>()(key.radius));
+	combine(std::hash<const bool*>()(key.moveArray));
+	combine(std::hash<const float*>()(key.costArray));
+	combine(std::hash<float>()(key.threat));
+	return seed;
+}
+
+bool CPathFinder::GetCachedPath(const SPathKey& key, F3Vec& posPath, float& pathCost)
+{
+	auto it = pathCacheIdxs.find(key);
+	if ((it == pathCacheIdxs.end()) || (mapThreatMap == nullptr)) {
+		PROFILE_COUNT("CPathFinder::cacheMiss", 1);
+		return false;
+	}
+	SPathEntry& entry = *it->second;
+	const int updateNum = mapThreatMap->GetUpdateNum();
+	if (entry.updateNum != updateNum) {
+		// Threat changed since caching: accept path if threat along it is about the same.
+		// Threat off the path isn't checked, so a detour may outlive what it avoided: it expires
+		// after PATH_CACHE_EPOCHS, path close to the straight-line lower bound stays.
+		bool isValid = (mapThreatMap->GetEpoch() - entry.epoch <= PATH_CACHE_EPOCHS)
+			|| (entry.pathCost <= GetCostLowerBound(key) * (1.f + PATH_CACHE_TOLERANCE));
+		if (isValid) {
+			const float threatSum = GetThreatSum(entry.posPath, key.costArray);
+			isValid = std::fabs(threatSum - entry.threatSum) <= std::max(entry.threatSum * PATH_CACHE_TOLERANCE, THREAT_MIN);
+		}
+		if (!isValid) {
+			pathCache.erase(it->second);
+			pathCacheIdxs.erase(it);
+			PROFILE_COUNT("CPathFinder::cacheMiss", 1);
+			return false;
+		}
+		entry.updateNum = updateNum;
+	}
+
+	pathCache.splice(pathCache.begin(), pathCache, it->second);
+	posPath.insert(posPath.end(), entry.posPath.begin(), entry.posPath.end());
+	pathCost = entry.pathCost;
+	PROFILE_COUNT("CPathFinder::cacheHit", 1);
+	PROFILE_COUNT("CPathFinder::savedExpansions", entry.expansions);
+	return true;
+}
+
+void CPathFinder::PutCachedPath(const SPathKey& key, const F3Vec& posPath, float pathCost, unsigned expansions)
+{
+	if (mapThreatMap == nullptr) {
+		return;
+	}
+	auto it = pathCacheIdxs.find(key);
+	if (it != pathCacheIdxs.end()) {
+		pathCache.erase(it->second);
+		pathCacheIdxs.erase(it);
+	} else if (pathCache.size() >= PATH_CACHE_SIZE) {
+		pathCacheIdxs.erase(pathCache.back().key);
+		pathCache.pop_back();
+	}
+	pathCache.push_front({key, posPath, pathCost, GetThreatSum(posPath, key.costArray),
+		mapThreatMap->GetUpdateNum(), mapThreatMap->GetEpoch(), expansions});
+	pathCacheIdxs[key] = pathCache.begin();
+}
+
+float CPathFinder::GetThreatSum(const F3Vec& posPath, const float* costArray) const
+{
+	float threatSum = .0f;
+	for (const AIFloat3& pos : posPath) {
+		const int x = int(pos.x / squareSize) + 1;
+		const int y = int(pos.z / squareSize) + 1;
+		threatSum += costArray[y * pathMapXSize + x] - THREAT_BASE;
+	}
+	return threatSum;
+}
+
+float CPathFinder::GetCostLowerBound(const SPathKey& key) const
+{
+	// Node costs are >= THREAT_BASE per step, path ends within radius of endNode
+	const int sy = key.startNode / pathMapXSize;
+	const int sx = key.startNode - sy * pathMapXSize;
+	const int ey = key.endNode / pathMapXSize;
+	const int ex = key.endNode - ey * pathMapXSize;
+	const float dist = sqrtf(SQUARE(sx - ex) + SQUARE(sy - ey));
+	return std::max(dist - key.radius, .0f) * THREAT_BASE;
+}
+
 #ifdef DEBUG_VIS
 void CPathFinder::SetMapData(CThreatMap* threatMap)
 {
@@ -493,6 +927,9 @@ void CPathFinder::SetMapData(CThreatMap* threatMap)
 	bool* moveArray = (mobileTypeId < 0) ? airMoveArray : moveArrays[mobileTypeId];
 	float* costArray[] = {threatMap->GetAirThreatArray(), threatMap->GetSurfThreatArray(), threatMap->GetAmphThreatArray(), threatMap->GetCloakThreatArray()};
 	micropather->SetMapData(moveArray, costArray[dbgType]);
+	mapMoveArray = moveArray;
+	mapCostArray = costArray[dbgType];
+	mapThreatMap = threatMap;
 }
 
 void CPathFinder::UpdateVis(const F3Vec& path)
@@ -12,6 +12,9 @@
 #include "terrain/MicroPather.h"
 #include "util/Defines.h"
 
+#include <list>
+#include <unordered_map>
+
 namespace circuit {
 
 class CTerrainData;
@@ -39,10 +42,22 @@ public:
 	void Pos2XY(springai::AIFloat3 pos, int* x, int* y);
 
 	void SetMapData(CCircuitUnit* unit, CThreatMap* threatMap, int frame);
+	/*
+	 * String pulling: indices of posPath waypoints where unit has to turn.
+	 * Straight line between consecutive corners is passable for unit and
+	 * not more threatened than the original path between them.
+	 */
+	void PullString(CCircuitUnit* unit, CThreatMap* threatMap, int frame, const F3Vec& posPath, std::vector<int>& outCorners);
 
 	unsigned Checksum() const { return micropather->Checksum(); }
 	float MakePath(F3Vec& posPath, springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius);
 	float MakePath(F3Vec& posPath, springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius, float threat);
+	/*
+	 * Path by gradient descent over shared flow field (reverse Dijkstra from endPos).
+	 * Field is reused by all units with the same destination, move type and threat layer
+	 * until next threat map update. Falls back to MakePath when start is not reachable.
+	 */
+	float MakeFlowPath(F3Vec& posPath, springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius, float threat = .0f);
 	float PathCost(const springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius);
 	float PathCostDirect(const springai::AIFloat3& startPos, springai::AIFloat3& endPos, int radius);
 	float FindBestPath(F3Vec& posPath, springai::AIFloat3& startPos, float myMaxRange, F3Vec& possibleTargets, bool safe = true);
@@ -51,6 +66,9 @@ public:
 	int GetSquareSize() const { return squareSize; }
 
 private:
+	void GetMapData(CCircuitUnit* unit, CThreatMap* threatMap, int frame, bool*& outMoveArray, float*& outCostArray);
+	bool IsStraightPath(int x0, int y0, int x1, int y1, const bool* moveArray, const float* costArray, float maxCost) const;
+
 	CTerrainData* terrainData;
 
 	NSMicroPather::CMicroPather* micropather;
@@ -65,6 +83,73 @@ private:
 
 	std::vector<void*> path;
 
+	/*
+	 * LRU cache of MakePath results. Squads of the same move type re-request paths
+	 * between the same sectors every few seconds, cached path is reused while threat along it
+	 * stays within tolerance. Detour that stays longer than PATH_CACHE_EPOCHS threat updates expires,
+	 * threat it avoided may be gone. Cleared when passability changes (UpdateAreaUsers).
+	 */
+	struct SPathKey {
+		int startNode;
+		int endNode;
+		int radius;
+		const bool* moveArray;  // move type
+		const float* costArray;  // threat layer
+		float threat;  // < 0 for MakePath without threat
+
+		bool operator==(const SPathKey& other) const {
+			return (startNode == other.startNode) && (endNode == other.endNode) && (radius == other.radius)
+				&& (moveArray == other.moveArray) && (costArray == other.costArray) && (threat == other.threat);
+		}
+	};
+	struct SPathKeyHash {
+		std::size_t operator()(const SPathKey& key) const;
+	};
+	struct SPathEntry {
+		SPathKey key;
+		F3Vec posPath;
+		float pathCost;
+		float threatSum;  // over path nodes, when cached
+		int updateNum;  // threat epoch of threatSum
+		int epoch;  // CThreatMap::GetEpoch when cached
+		unsigned expansions;  // spent by search
+	};
+	using PathCache = std::list<SPathEntry>;  // most recent first
+
+	bool GetCachedPath(const SPathKey& key, F3Vec& posPath, float& pathCost);
+	void PutCachedPath(const SPathKey& key, const F3Vec& posPath, float pathCost, unsigned expansions);
+	float GetThreatSum(const F3Vec& posPath, const float* costArray) const;
+	float GetCostLowerBound(const SPathKey& key) const;
+
+	struct SFlowField {
+		int goalNode;
+		int radius;
+		const bool* moveArray;
+		const float* costArray;
+		float threat;
+		const CThreatMap* threatMap;
+		int epoch;
+		std::vector<float> dists;  // cost to goal, FLT_MAX if unreachable
+		std::vector<float> costs;  // cost to enter node, as of dists
+	};
+	/*
+	 * On new threat epoch field is updated only beyond the closest node with changed cost
+	 */
+	SFlowField& GetFlowField(int goalNode, int radius, float threat);
+	void FillFlowField(SFlowField& field);
+	void UpdateFlowField(SFlowField& field);
+	void SpreadFlowField(SFlowField& field);
+
+	std::list<SFlowField> flowFields;  // most recent first
+	using FlowItem = std::pair<float, int>;  // dist, node
+	std::vector<FlowItem> flowQueue;  // min-heap of SpreadFlowField
+
+	PathCache pathCache;
+	std::unordered_map<SPathKey, PathCache::iterator, SPathKeyHash> pathCacheIdxs;
+	bool* mapMoveArray;  // set by SetMapData
+	float* mapCostArray;
+	CThreatMap* mapThreatMap;
+
 #ifdef DEBUG_VIS
 private:
 	bool isVis;
@@ -51,6 +51,7 @@ CTerrainData::CTerrainData()
 		, sectorZSize(0)
 		, gameAttribute(nullptr)
 		, pHeightMap(&heightMap0)
+		, isAreaChanged(true)
 		, isUpdating(false)
 		, aiToUpdate(0)
 //		, isClusterizing(false)
@@ -263,6 +264,8 @@ void CTerrainData::Init(CCircuitAI* circuit)
 	const int slopeMapXSize = sectorXSize * convertStoSM;
 	const int heightMapXSize = sectorXSize * convertStoHM;
 
+	heightDiff.Init(standardHeightMap, heightMapXSize, sectorZSize * convertStoHM, convertStoHM);  // tile = sector
+
 	minElevation = 0;
 	percentLand = 0.0;
 
@@ -633,6 +636,16 @@ void CTerrainData::CheckHeightMap()
 
 void CTerrainData::UpdateAreas()
 {
+	/*
+	 *  Find changed sectors
+	 */
+	const std::vector<float>& standardHeightMap = (pHeightMap.load() == &heightMap0) ? heightMap1 : heightMap0;
+	const std::vector<CHeightDiff::SRect>& dirtyRects = heightDiff.Diff(standardHeightMap);
+	isAreaChanged = !dirtyRects.empty();
+	if (!isAreaChanged) {
+		return;  // areaData stays as is, users still refresh blocking and build areas
+	}
+
 	/*
 	 *  Assign areaData references
 	 */
@@ -680,8 +693,6 @@ void CTerrainData::UpdateAreas()
 	 *  Updating sector & determining sectors for immobileType
 	 */
 	const std::vector<float>& standardSlopeMap = slopeMap;
-	const std::vector<float>& standardHeightMap = (pHeightMap.load() == &heightMap0) ? heightMap1 : heightMap0;
-	const std::vector<float>& prevHeightMap = *pHeightMap.load();
 	const int convertStoSM = convertStoP / 16;  // * for conversion, / for reverse conversion
 	const int convertStoHM = convertStoP / 8;  // * for conversion, / for reverse conversion
 	const int slopeMapXSize = sectorXSize * convertStoSM;
@@ -689,78 +700,66 @@ void CTerrainData::UpdateAreas()
 
 	float tmpPercentLand = std::round(percentLand * (sectorXSize * convertStoHM * sectorZSize * convertStoHM) / 100.0);
 
-	auto isSectorHeightChanged = [&standardHeightMap, &prevHeightMap, convertStoHM, heightMapXSize](int iMap) {
-		for (int zH = 0; zH < convertStoHM; zH++) {
-			for (int xH = 0, iH = iMap + zH * heightMapXSize + xH; xH < convertStoHM; xH++, iH = iMap + zH * heightMapXSize + xH) {
-				if (standardHeightMap[iH] != prevHeightMap[iH]) {
-					return true;
-				}
-			}
-		}
-		return false;
-	};
-	std::set<int> changedSectors;
-
-	for (int z = 0; z < sectorZSize; z++) {
-		for (int x = 0; x < sectorXSize; x++) {
-			int iMapH = ((z * convertStoHM) * heightMapXSize) + x * convertStoHM;
-			if (!isSectorHeightChanged(iMapH)) {
-				continue;
-			}
-
-			int i = (z * sectorXSize) + x;
-			changedSectors.insert(i);
-
-			int xi = sector[i].position.x / SQUARE_SIZE;
-			int zi = sector[i].position.z / SQUARE_SIZE;
-			sector[i].position.y = standardHeightMap[zi * heightMapXSize + xi];
-
-			sector[i].maxSlope = .0f;
-			int iMapS = ((z * convertStoSM) * slopeMapXSize) + x * convertStoSM;
-			for (int zS = 0; zS < convertStoSM; zS++) {
-				for (int xS = 0, iS = iMapS + zS * slopeMapXSize + xS; xS < convertStoSM; xS++, iS = iMapS + zS * slopeMapXSize + xS) {
-					if (sector[i].maxSlope < standardSlopeMap[iS]) {
-						sector[i].maxSlope = standardSlopeMap[iS];
+	std::vector<int> changedSectors;
+
+	for (const CHeightDiff::SRect& rect : dirtyRects) {
+		for (int z = rect.z1; z < rect.z2; z++) {
+			for (int x = rect.x1; x < rect.x2; x++) {
+				int iMapH = ((z * convertStoHM) * heightMapXSize) + x * convertStoHM;
+				int i = (z * sectorXSize) + x;
+				changedSectors.push_back(i);
+
+				int xi = sector[i].position.x / SQUARE_SIZE;
+				int zi = sector[i].position.z / SQUARE_SIZE;
+				sector[i].position.y = standardHeightMap[zi * heightMapXSize + xi];
+
+				sector[i].maxSlope = .0f;
+				int iMapS = ((z * convertStoSM) * slopeMapXSize) + x * convertStoSM;
+				for (int zS = 0; zS < convertStoSM; zS++) {
+					for (int xS = 0, iS = iMapS + zS * slopeMapXSize + xS; xS < convertStoSM; xS++, iS = iMapS + zS * slopeMapXSize + xS) {
+						if (sector[i].maxSlope < standardSlopeMap[iS]) {
+							sector[i].maxSlope = standardSlopeMap[iS];
+						}
 					}
 				}
-			}
 
-			float prevPercentLand = std::round(sector[i].percentLand * (convertStoHM * convertStoHM) / 100.0);
-			sector[i].percentLand = .0f;
-			sector[i].minElevation = standardHeightMap[iMapH];
-			sector[i].maxElevation = standardHeightMap[iMapH];
-			for (int zH = 0; zH < convertStoHM; zH++) {
-				for (int xH = 0, iH = iMapH + zH * heightMapXSize + xH; xH < convertStoHM; xH++, iH = iMapH + zH * heightMapXSize + xH) {
-					if (standardHeightMap[iH] >= 0) {
-						sector[i].percentLand++;
-					}
+				float prevPercentLand = std::round(sector[i].percentLand * (convertStoHM * convertStoHM) / 100.0);
+				sector[i].percentLand = .0f;
+				sector[i].minElevation = standardHeightMap[iMapH];
+				sector[i].maxElevation = standardHeightMap[iMapH];
+				for (int zH = 0; zH < convertStoHM; zH++) {
+					for (int xH = 0, iH = iMapH + zH * heightMapXSize + xH; xH < convertStoHM; xH++, iH = iMapH + zH * heightMapXSize + xH) {
+						if (standardHeightMap[iH] >= 0) {
+							sector[i].percentLand++;
+						}
 
-					if (sector[i].minElevation > standardHeightMap[iH]) {
-						sector[i].minElevation = standardHeightMap[iH];
-						if (minElevation > standardHeightMap[iH]) {
-							minElevation = standardHeightMap[iH];
+						if (sector[i].minElevation > standardHeightMap[iH]) {
+							sector[i].minElevation = standardHeightMap[iH];
+							if (minElevation > standardHeightMap[iH]) {
+								minElevation = standardHeightMap[iH];
+							}
+						} else if (sector[i].maxElevation < standardHeightMap[iH]) {
+							sector[i].maxElevation = standardHeightMap[iH];
 						}
-					} else if (sector[i].maxElevation < standardHeightMap[iH]) {
-						sector[i].maxElevation = standardHeightMap[iH];
 					}
 				}
-			}
 
-			if (sector[i].percentLand != prevPercentLand) {
-				tmpPercentLand += sector[i].percentLand - prevPercentLand;
-			}
-			sector[i].percentLand *= 100.0 / (convertStoHM * convertStoHM);
+				if (sector[i].percentLand != prevPercentLand) {
+					tmpPercentLand += sector[i].percentLand - prevPercentLand;
+				}
+				sector[i].percentLand *= 100.0 / (convertStoHM * convertStoHM);
 
-			sector[i].isWater = (sector[i].percentLand <= 50.0);
+				sector[i].isWater = (sector[i].percentLand <= 50.0);
 
-			for (auto& it : immobileType) {
-				if ((it.canHover && (it.maxElevation >= sector[i].maxElevation) && !waterIsAVoid) ||
-					(it.canFloat && (it.maxElevation >= sector[i].maxElevation) && !waterIsHarmful) ||
-					((it.minElevation <= sector[i].minElevation) && (it.maxElevation >= sector[i].maxElevation) && (!waterIsHarmful || (sector[i].minElevation >= 0))))
-				{
-					it.sector[i] = &sector[i];
-				} else {
-					it.sector.erase(i);
+				for (auto& it : immobileType) {
+					if ((it.canHover && (it.maxElevation >= sector[i].maxElevation) && !waterIsAVoid) ||
+						(it.canFloat && (it.maxElevation >= sector[i].maxElevation) && !waterIsHarmful) ||
+						((it.minElevation <= sector[i].minElevation) && (it.maxElevation >= sector[i].maxElevation) && (!waterIsHarmful || (sector[i].minElevation >= 0))))
+					{
+						it.sector[i] = &sector[i];
+					} else {
+						it.sector.erase(i);
+					}
 				}
 			}
 		}
@@ -923,8 +922,11 @@ void CTerrainData::DidUpdateAreaUsers()
 		return;
 	}
 
-	pAreaData = GetNextAreaData();
-	pHeightMap = (pHeightMap.load() == &heightMap0) ? &heightMap1 : &heightMap0;
+	if (isAreaChanged) {
+		pAreaData = GetNextAreaData();
+		pHeightMap = (pHeightMap.load() == &heightMap0) ? &heightMap1 : &heightMap0;
+		heightDiff.Commit();
+	}
 	isUpdating = false;
 
 #ifdef DEBUG_VIS
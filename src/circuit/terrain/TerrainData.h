@@ -19,6 +19,8 @@
 #ifndef SRC_CIRCUIT_TERRAIN_TERRAINDATA_H_
 #define SRC_CIRCUIT_TERRAIN_TERRAINDATA_H_
 
+#include "terrain/HeightDiff.h"
+
 #include "AIFloat3.h"
 
 #include <map>
@@ -215,6 +217,9 @@ private:
 public:
 	void DidUpdateAreaUsers();
 	SAreaData* GetNextAreaData() {
+		if (!isAreaChanged) {  // height map didn't change, users refresh against current areas
+			return pAreaData.load();
+		}
 		return (pAreaData.load() == &areaData0) ? &areaData1 : &areaData0;
 	}
 
@@ -226,6 +231,8 @@ private:
 	std::vector<float> heightMap1;
 	std::atomic<std::vector<float>*> pHeightMap;
 	std::vector<float> slopeMap;
+	CHeightDiff heightDiff;  // tiles of *pHeightMap
+	bool isAreaChanged;  // last UpdateAreas rebuilt next areaData
 	bool isUpdating;
 	int aiToUpdate;
 // ---- Threaded areas updater ---- END
@@ -12,6 +12,7 @@
 #include "terrain/PathFinder.h"
 #include "module/EconomyManager.h"
 #include "module/BuilderManager.h"  // Only for UpdateAreaUsers
+#include "module/FactoryManager.h"  // Only for UpdateAreaUsers
 #include "resource/MetalManager.h"
 #include "setup/SetupManager.h"
 #include "CircuitAI.h"
@@ -1359,6 +1360,7 @@ void CTerrainManager::UpdateAreaUsers(int interval)
 	}
 
 	circuit->GetBuilderManager()->UpdateAreaUsers();
+	circuit->GetFactoryManager()->UpdateAreaUsers();
 
 	// stagger area update
 	auto updatePath = [this]() {
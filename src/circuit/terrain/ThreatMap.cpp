@@ -7,17 +7,24 @@
  */
 
 #include "terrain/ThreatMap.h"
+#include "terrain/ThreatRaster.h"
 #include "terrain/TerrainManager.h"
+#include "resource/MetalManager.h"
 #include "setup/SetupManager.h"
 #include "unit/CircuitUnit.h"
 #include "unit/EnemyUnit.h"
+#include "util/Profiler.h"
+#include "util/SaveState.h"
 #include "util/utils.h"
 #include "json/json.h"
 
 #include "OOAICallback.h"
+#include "SSkirmishAICallback.h"
 #include "Mod.h"
 #include "Map.h"
 
+#include <algorithm>
+
 //#undef NDEBUG
 #include <cassert>
 
@@ -48,6 +55,14 @@ CThreatMap::CThreatMap(CCircuitAI* circuit, float decloakRadius)
 	cloakThreat.resize(mapSize, THREAT_BASE);
 	threatArray = &surfThreat[0];
 	shield.resize(mapSize, 0.f);
+	airPyramid.Init(&airThreat[0], width, height);
+	surfPyramid.Init(&surfThreat[0], width, height);
+	amphPyramid.Init(&amphThreat[0], width, height);
+	updateNum = 0;
+	epoch = 0;
+	for (SSafeClusters& safe : safeClusters) {
+		safe.updateNum = -1;
+	}
 
 	Map* map = circuit->GetMap();
 	int mapWidth = map->GetWidth();
@@ -61,6 +76,7 @@ CThreatMap::CThreatMap(CCircuitAI* circuit, float decloakRadius)
 	sonarMap = std::move(map->GetSonarMap());
 	radarResConv = SQUARE_SIZE << radarMipLevel;
 	losMap = std::move(map->GetLosMap());
+	isSonarDirty = isLosDirty = false;
 	losWidth = mapWidth >> losMipLevel;
 	losResConv = SQUARE_SIZE << losMipLevel;
 
@@ -111,9 +127,13 @@ CThreatMap::~CThreatMap()
 
 void CThreatMap::Update()
 {
+	PROFILE_SCOPE("CThreatMap::Update");
+	++updateNum;
+	++epoch;
 //	radarMap = std::move(circuit->GetMap()->GetRadarMap());
-	sonarMap = std::move(circuit->GetMap()->GetSonarMap());
-	losMap = std::move(circuit->GetMap()->GetLosMap());
+	// NOTE: Map::GetLosMap() allocates and copies whole grid each call,
+	//       while only positions of units that left radar and LOS are tested
+	isSonarDirty = isLosDirty = true;
 //	currMaxThreat = .0f;
 
 	// account for moving units
@@ -173,11 +193,28 @@ void CThreatMap::Update()
 	}
 
 	// decay whole threatMap to compensate for precision errors
-	for (int index = 0; index < mapSize; ++index) {
-		airThreat[index]  = std::max<float>(airThreat[index]  - THREAT_DECAY, THREAT_BASE);
-		surfThreat[index] = std::max<float>(surfThreat[index] - THREAT_DECAY, THREAT_BASE);
-		amphThreat[index] = std::max<float>(amphThreat[index] - THREAT_DECAY, THREAT_BASE);
-		// except for cloakThreat
+	// NOTE: Cells at THREAT_BASE don't change, only tiles with remaining threat go dirty
+	auto decay = [](float& threat) {
+		const float value = std::max<float>(threat - THREAT_DECAY, THREAT_BASE);
+		if (value == threat) {
+			return false;
+		}
+		threat = value;
+		return true;
+	};
+	for (int z = 0, index = 0; z < height; ++z) {
+		for (int x = 0; x < width; ++x, ++index) {
+			if (decay(airThreat[index])) {
+				airPyramid.MarkDirty(x, z);
+			}
+			if (decay(surfThreat[index])) {
+				surfPyramid.MarkDirty(x, z);
+			}
+			if (decay(amphThreat[index])) {
+				amphPyramid.MarkDirty(x, z);
+			}
+			// except for cloakThreat
+		}
 	}
 //	airMetal    = std::max(airMetal    - THREAT_DECAY, .0f);
 //	staticMetal = std::max(staticMetal - THREAT_DECAY, .0f);
@@ -392,20 +429,183 @@ float CThreatMap::GetThreatAt(CCircuitUnit* unit, const AIFloat3& position) cons
 	return surfThreat[z * width + x] - THREAT_BASE;
 }
 
+float CThreatMap::GetMaxThreatInRect(const AIFloat3& lt, const AIFloat3& rb)
+{
+	int x1, z1, x2, z2;
+	PosToXZ(lt, x1, z1);
+	PosToXZ(rb, x2, z2);
+	const float max = GetPyramid().GetMaxInRect(std::min(x1, x2), std::min(z1, z2), std::max(x1, x2), std::max(z1, z2));
+	return std::max(max - THREAT_BASE, 0.f);
+}
+
+float CThreatMap::GetSumThreatInCircle(const AIFloat3& position, float radius)
+{
+	int count;
+	const float sum = GetPyramid().GetSumInCircle(position.x / squareSize + 1, position.z / squareSize + 1,
+												  radius / squareSize, count);
+	return std::max(sum - count * THREAT_BASE, 0.f);
+}
+
+float CThreatMap::GetMaxThreatAlongSegment(const AIFloat3& start, const AIFloat3& end)
+{
+	const float max = GetPyramid().GetMaxAlongSegment(start.x / squareSize + 1, start.z / squareSize + 1,
+													  end.x / squareSize + 1, end.z / squareSize + 1);
+	return std::max(max - THREAT_BASE, 0.f);
+}
+
+const std::vector<bool>& CThreatMap::GetSafeClusters()
+{
+	const int layer = (threatArray == &airThreat[0]) ? 0 : (threatArray == &amphThreat[0]) ? 2 : 1;
+	SSafeClusters& safe = safeClusters[layer];
+	const CMetalData::Clusters& clusters = circuit->GetMetalManager()->GetClusters();
+	if ((safe.updateNum == updateNum) && (safe.isSafe.size() == clusters.size())) {
+		return safe.isSafe;
+	}
+	safe.updateNum = updateNum;
+
+	// NOTE: Cluster is safe when none of its spots is under threat, i.e. max over their bounding box
+	const CMetalData::Metals& spots = circuit->GetMetalManager()->GetSpots();
+	safe.isSafe.resize(clusters.size());
+	for (unsigned i = 0; i < clusters.size(); ++i) {
+		AIFloat3 lt = clusters[i].position;
+		AIFloat3 rb = lt;
+		for (int index : clusters[i].idxSpots) {
+			const AIFloat3& pos = spots[index].position;
+			lt.x = std::min(lt.x, pos.x);
+			lt.z = std::min(lt.z, pos.z);
+			rb.x = std::max(rb.x, pos.x);
+			rb.z = std::max(rb.z, pos.z);
+		}
+		safe.isSafe[i] = (GetMaxThreatInRect(lt, rb) <= THREAT_MIN);
+	}
+	return safe.isSafe;
+}
+
 float CThreatMap::GetUnitThreat(CCircuitUnit* unit) const
 {
 	float health = unit->GetUnit()->GetHealth() + unit->GetShieldPower() * 2.0f;
 	return unit->GetDamage() * sqrtf(std::max(health, 0.f));  // / unit->GetUnit()->GetMaxHealth();
 }
 
+void CThreatMap::Save(std::ostream& os) const
+{
+	SThreatState state;
+	state.width = width;
+	state.height = height;
+	state.squareSize = squareSize;
+	auto saveUnits = [](const CCircuitAI::EnemyUnits& units, std::vector<SEnemyState>& outUnits) {
+		outUnits.resize(units.size());
+		unsigned i = 0;
+		for (auto& kv : units) {
+			kv.second->Save(outUnits[i++]);
+		}
+	};
+	saveUnits(hostileUnits, state.hostileUnits);
+	saveUnits(peaceUnits, state.peaceUnits);
+	state.airThreat = airThreat;
+	state.surfThreat = surfThreat;
+	state.amphThreat = amphThreat;
+	state.cloakThreat = cloakThreat;
+	state.shield = shield;
+	state.Save(os);
+}
+
+bool CThreatMap::Load(std::istream& is)
+{
+	SThreatState state;
+	if (!state.Load(is) || (state.width != width) || (state.height != height) || (state.squareSize != squareSize)) {
+		return false;
+	}
+	for (const std::vector<float>* layer : {&state.airThreat, &state.surfThreat, &state.amphThreat, &state.cloakThreat, &state.shield}) {
+		if (layer->size() != airThreat.size()) {
+			return false;
+		}
+	}
+
+	// NOTE: Reconcile with circuit->GetEnemyUnits(): enemies reported by events before Load get saved state,
+	//       saved enemies that are gone are dropped, reported ones absent in save stay as they are.
+	//       Saved layers hold exactly the saved enemies, on any difference layers are rebuilt from units.
+	bool isExact = true;
+	CCircuitAI::EnemyUnits loadedHostile, loadedPeace;
+	auto loadUnits = [this, &isExact](const std::vector<SEnemyState>& states, CCircuitAI::EnemyUnits& units) {
+		for (const SEnemyState& es : states) {
+			CEnemyUnit* e = circuit->RestoreEnemyUnit(es.unitId);  // registered one or new
+			if (e == nullptr) {
+				isExact = false;
+				continue;
+			}
+			e->SetCircuitDef((es.defId < 0) ? nullptr : circuit->GetCircuitDef(es.defId));
+			e->Load(es);
+			units[es.unitId] = e;
+		}
+	};
+	loadUnits(state.hostileUnits, loadedHostile);
+	loadUnits(state.peaceUnits, loadedPeace);
+	auto keepUnits = [&](const CCircuitAI::EnemyUnits& units, CCircuitAI::EnemyUnits& outUnits) {
+		for (auto& kv : units) {
+			if ((loadedHostile.count(kv.first) == 0) && (loadedPeace.count(kv.first) == 0)) {
+				outUnits[kv.first] = kv.second;
+				isExact = false;
+			}
+		}
+	};
+	keepUnits(hostileUnits, loadedHostile);
+	keepUnits(peaceUnits, loadedPeace);
+	hostileUnits.clear();
+	for (auto& kv : loadedHostile) {
+		hostileUnits[kv.first] = kv.second;
+	}
+	peaceUnits.clear();
+	for (auto& kv : loadedPeace) {
+		peaceUnits[kv.first] = kv.second;
+	}
+
+	// NOTE: Copy in place, pyramids and threatArray point into layers
+	if (isExact) {
+		std::copy(state.airThreat.begin(), state.airThreat.end(), airThreat.begin());
+		std::copy(state.surfThreat.begin(), state.surfThreat.end(), surfThreat.begin());
+		std::copy(state.amphThreat.begin(), state.amphThreat.end(), amphThreat.begin());
+		std::copy(state.cloakThreat.begin(), state.cloakThreat.end(), cloakThreat.begin());
+		std::copy(state.shield.begin(), state.shield.end(), shield.begin());
+	} else {
+		std::fill(airThreat.begin(), airThreat.end(), THREAT_BASE);
+		std::fill(surfThreat.begin(), surfThreat.end(), THREAT_BASE);
+		std::fill(amphThreat.begin(), amphThreat.end(), THREAT_BASE);
+		std::fill(cloakThreat.begin(), cloakThreat.end(), THREAT_BASE);
+		std::fill(shield.begin(), shield.end(), 0.f);
+		for (auto& kv : hostileUnits) {
+			if (!kv.second->IsHidden()) {
+				AddEnemyUnit(kv.second);
+			}
+		}
+		for (auto& kv : peaceUnits) {
+			if (!kv.second->IsHidden()) {
+				AddDecloaker(kv.second);
+			}
+		}
+	}
+
+	airPyramid.MarkAllDirty();
+	surfPyramid.MarkAllDirty();
+	amphPyramid.MarkAllDirty();
+	++updateNum;
+	return true;
+}
+
 inline void CThreatMap::PosToXZ(const AIFloat3& pos, int& x, int& z) const
 {
 	x = (int)pos.x / squareSize + 1;
 	z = (int)pos.z / squareSize + 1;
 }
 
+CThreatPyramid& CThreatMap::GetPyramid()
+{
+	return (threatArray == &airThreat[0]) ? airPyramid : (threatArray == &amphThreat[0]) ? amphPyramid : surfPyramid;
+}
+
 void CThreatMap::AddEnemyUnit(const CEnemyUnit* e)
 {
+	++updateNum;
 	CCircuitDef* cdef = e->GetCircuitDef();
 	if (cdef == nullptr) {
 		AddEnemyUnitAll(e);
@@ -427,6 +627,7 @@ void CThreatMap::AddEnemyUnit(const CEnemyUnit* e)
 
 void CThreatMap::DelEnemyUnit(const CEnemyUnit* e)
 {
+	++updateNum;
 	CCircuitDef* cdef = e->GetCircuitDef();
 	if (cdef == nullptr) {
 		DelEnemyUnitAll(e);
@@ -467,31 +668,8 @@ void CThreatMap::AddEnemyAir(const CEnemyUnit* e)
 
 	const float threat = e->GetThreat()/* - THREAT_DECAY*/;
 	const int range = e->GetRange(CCircuitDef::ThreatType::AIR);
-	const int rangeSq = SQUARE(range);
-
-	const int beginX = std::max(int(posx - range + 1),          1);
-	const int endX   = std::min(int(posx + range    ),  width - 1);
-	const int beginZ = std::max(int(posz - range + 1),          1);
-	const int endZ   = std::min(int(posz + range    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
-			airThreat[index] += heat;
-
-//			currSumThreat += heat;
-		}
-	}
-
-//	currAvgThreat = currSumThreat / landThreat.size();
+	raster::AddThreat(&airThreat[0], width, height, posx, posz, range, threat);
+	MarkDirty(airPyramid, posx, posz, range);
 }
 
 void CThreatMap::DelEnemyAir(const CEnemyUnit* e)
@@ -501,36 +679,8 @@ void CThreatMap::DelEnemyAir(const CEnemyUnit* e)
 
 	const float threat = e->GetThreat()/* + THREAT_DECAY*/;
 	const int range = e->GetRange(CCircuitDef::ThreatType::AIR);
-	const int rangeSq = SQUARE(range);
-
-	// Threat circles are large and often have appendix, decrease it by 1 for micro-optimization
-	const int beginX = std::max(int(posx - range + 1),          1);
-	const int endX   = std::min(int(posx + range    ),  width - 1);
-	const int beginZ = std::max(int(posz - range + 1),          1);
-	const int endZ   = std::min(int(posz + range    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			// MicroPather cannot deal with negative costs
-			// (which may arise due to floating-point drift)
-			// nor with zero-cost nodes (see MP::SetMapData,
-			// threat is not used as an additive overlay)
-			const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
-			airThreat[index] = std::max<float>(airThreat[index] - heat, THREAT_BASE);
-
-//			currSumThreat -= heat;
-		}
-	}
-
-//	currAvgThreat = currSumThreat / landThreat.size();
+	raster::DelThreat(&airThreat[0], width, height, posx, posz, range, threat);
+	MarkDirty(airPyramid, posx, posz, range);
 }
 
 void CThreatMap::AddEnemyAmph(const CEnemyUnit* e)
@@ -541,36 +691,18 @@ void CThreatMap::AddEnemyAmph(const CEnemyUnit* e)
 
 	const float threat = e->GetThreat()/* - THREAT_DECAY*/;
 	const int rangeLand = e->GetRange(CCircuitDef::ThreatType::LAND);
-	const int rangeLandSq = SQUARE(rangeLand);
 	const int rangeWater = e->GetRange(CCircuitDef::ThreatType::WATER);
-	const int rangeWaterSq = SQUARE(rangeWater);
-	const int range = std::max(rangeLand, rangeWater);
 	const std::vector<STerrainMapSector>& sector = areaData->sector;
-
-	const int beginX = std::max(int(posx - range + 1),          1);
-	const int endX   = std::min(int(posx + range    ),  width - 1);
-	const int beginZ = std::max(int(posz - range + 1),          1);
-	const int endZ   = std::min(int(posz + range    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-
-			const int sum = dxSq + dzSq;
-			const int index = z * width + x;
-			const int idxSec = (z - 1) * widthSec + (x - 1);
-			const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
-			bool isWaterThreat = (sum <= rangeWaterSq) && sector[idxSec].isWater;
-			if (isWaterThreat || ((sum <= rangeLandSq) && (sector[idxSec].position.y >= -SQUARE_SIZE * 5)))
-			{
-				amphThreat[index] += heat;
-			}
-			if (isWaterThreat || (sum <= rangeLandSq)) {
-				surfThreat[index] += heat;
-			}
-		}
-	}
+	auto isWater = [&sector, widthSec](int x, int z) {
+		return sector[(z - 1) * widthSec + (x - 1)].isWater;
+	};
+	auto isShallow = [&sector, widthSec](int x, int z) {
+		return sector[(z - 1) * widthSec + (x - 1)].position.y >= -SQUARE_SIZE * 5;
+	};
+	raster::AddAmph(&amphThreat[0], &surfThreat[0], width, height, posx, posz,
+			rangeLand, rangeWater, threat, isWater, isShallow);
+	MarkDirty(amphPyramid, posx, posz, std::max(rangeLand, rangeWater));
+	MarkDirty(surfPyramid, posx, posz, std::max(rangeLand, rangeWater));
 }
 
 void CThreatMap::DelEnemyAmph(const CEnemyUnit* e)
@@ -581,36 +713,18 @@ void CThreatMap::DelEnemyAmph(const CEnemyUnit* e)
 
 	const float threat = e->GetThreat()/* + THREAT_DECAY*/;
 	const int rangeLand = e->GetRange(CCircuitDef::ThreatType::LAND);
-	const int rangeLandSq = SQUARE(rangeLand);
 	const int rangeWater = e->GetRange(CCircuitDef::ThreatType::WATER);
-	const int rangeWaterSq = SQUARE(rangeWater);
-	const int range = std::max(rangeLand, rangeWater);
 	const std::vector<STerrainMapSector>& sector = areaData->sector;
-
-	const int beginX = std::max(int(posx - range + 1),          1);
-	const int endX   = std::min(int(posx + range    ),  width - 1);
-	const int beginZ = std::max(int(posz - range + 1),          1);
-	const int endZ   = std::min(int(posz + range    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-
-			const int sum = dxSq + dzSq;
-			const int index = z * width + x;
-			const int idxSec = (z - 1) * widthSec + (x - 1);
-			const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
-			bool isWaterThreat = (sum <= rangeWaterSq) && sector[idxSec].isWater;
-			if (isWaterThreat || ((sum <= rangeLandSq) && (sector[idxSec].position.y >= -SQUARE_SIZE * 5)))
-			{
-				amphThreat[index] = std::max<float>(amphThreat[index] - heat, THREAT_BASE);
-			}
-			if (isWaterThreat || (sum <= rangeLandSq)) {
-				surfThreat[index] = std::max<float>(surfThreat[index] - heat, THREAT_BASE);
-			}
-		}
-	}
+	auto isWater = [&sector, widthSec](int x, int z) {
+		return sector[(z - 1) * widthSec + (x - 1)].isWater;
+	};
+	auto isShallow = [&sector, widthSec](int x, int z) {
+		return sector[(z - 1) * widthSec + (x - 1)].position.y >= -SQUARE_SIZE * 5;
+	};
+	raster::DelAmph(&amphThreat[0], &surfThreat[0], width, height, posx, posz,
+			rangeLand, rangeWater, threat, isWater, isShallow);
+	MarkDirty(amphPyramid, posx, posz, std::max(rangeLand, rangeWater));
+	MarkDirty(surfPyramid, posx, posz, std::max(rangeLand, rangeWater));
 }
 
 void CThreatMap::AddDecloaker(const CEnemyUnit* e)
@@ -618,30 +732,9 @@ void CThreatMap::AddDecloaker(const CEnemyUnit* e)
 	int posx, posz;
 	PosToXZ(e->GetPos(), posx, posz);
 
-	const float threatCloak = 16 * THREAT_BASE;
-	const int rangeCloak = e->GetRange(CCircuitDef::ThreatType::CLOAK);
-	const int rangeCloakSq = SQUARE(rangeCloak);
-
 	// For small decloak ranges full range shouldn't hit performance
-	const int beginX = std::max(int(posx - rangeCloak + 1),          1);
-	const int endX   = std::min(int(posx + rangeCloak    ),  width - 1);
-	const int beginZ = std::max(int(posz - rangeCloak + 1),          1);
-	const int endZ   = std::min(int(posz + rangeCloak    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeCloakSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float heat = threatCloak * (1.0f - 0.5f * sqrtf(sum) / rangeCloak);
-			cloakThreat[index] += heat;
-		}
-	}
+	const int rangeCloak = e->GetRange(CCircuitDef::ThreatType::CLOAK);
+	raster::AddCloak(&cloakThreat[0], width, height, posx, posz, rangeCloak);
 }
 
 void CThreatMap::DelDecloaker(const CEnemyUnit* e)
@@ -649,30 +742,8 @@ void CThreatMap::DelDecloaker(const CEnemyUnit* e)
 	int posx, posz;
 	PosToXZ(e->GetPos(), posx, posz);
 
-	const float threatCloak = 16 * THREAT_BASE;
 	const int rangeCloak = e->GetRange(CCircuitDef::ThreatType::CLOAK);
-	const int rangeCloakSq = SQUARE(rangeCloak);
-
-	// For small decloak ranges full range shouldn't hit performance
-	const int beginX = std::max(int(posx - rangeCloak + 1),          1);
-	const int endX   = std::min(int(posx + rangeCloak    ),  width - 1);
-	const int beginZ = std::max(int(posz - rangeCloak + 1),          1);
-	const int endZ   = std::min(int(posz + rangeCloak    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int dxSq = SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			const int dzSq = SQUARE(posz - z);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeCloakSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float heat = threatCloak * (1.0f - 0.5f * sqrtf(sum) / rangeCloak);
-			cloakThreat[index] = std::max<float>(cloakThreat[index] - heat, THREAT_BASE);
-		}
-	}
+	raster::DelCloak(&cloakThreat[0], width, height, posx, posz, rangeCloak);
 }
 
 void CThreatMap::AddShield(const CEnemyUnit* e)
@@ -682,22 +753,7 @@ void CThreatMap::AddShield(const CEnemyUnit* e)
 
 	const float shieldVal = e->GetShieldPower();
 	const int rangeShield = e->GetRange(CCircuitDef::ThreatType::SHIELD);
-	const int rangeShieldSq = SQUARE(rangeShield);
-
-	const int beginX = std::max(int(posx - rangeShield + 1),          1);
-	const int endX   = std::min(int(posx + rangeShield    ),  width - 1);
-	const int beginZ = std::max(int(posz - rangeShield + 1),          1);
-	const int endZ   = std::min(int(posz + rangeShield    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int rrx = rangeShieldSq - SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			if (SQUARE(posz - z) > rrx) {
-				continue;
-			}
-			shield[z * width + x] += shieldVal;
-		}
-	}
+	raster::AddShield(&shield[0], width, height, posx, posz, rangeShield, shieldVal);
 }
 
 void CThreatMap::DelShield(const CEnemyUnit* e)
@@ -707,23 +763,7 @@ void CThreatMap::DelShield(const CEnemyUnit* e)
 
 	const float shieldVal = e->GetShieldPower();
 	const int rangeShield = e->GetRange(CCircuitDef::ThreatType::SHIELD);
-	const int rangeShieldSq = SQUARE(rangeShield);
-
-	const int beginX = std::max(int(posx - rangeShield + 1),          1);
-	const int endX   = std::min(int(posx + rangeShield    ),  width - 1);
-	const int beginZ = std::max(int(posz - rangeShield + 1),          1);
-	const int endZ   = std::min(int(posz + rangeShield    ), height - 1);
-
-	for (int x = beginX; x < endX; ++x) {
-		const int rrx = rangeShieldSq - SQUARE(posx - x);
-		for (int z = beginZ; z < endZ; ++z) {
-			if (SQUARE(posz - z) > rrx) {
-				continue;
-			}
-			const int index = z * width + x;
-			shield[index] = std::max(shield[index] - shieldVal, 0.f);
-		}
-	}
+	raster::DelShield(&shield[0], width, height, posx, posz, rangeShield, shieldVal);
 }
 
 void CThreatMap::SetEnemyUnitRange(CEnemyUnit* e) const
@@ -775,7 +815,7 @@ float CThreatMap::GetEnemyUnitThreat(CEnemyUnit* enemy) const
 	return enemy->GetDamage() * sqrtf(health + shield[z * width + x] * 2.0f);  // / unit->GetUnit()->GetMaxHealth();
 }
 
-bool CThreatMap::IsInLOS(const AIFloat3& pos) const
+bool CThreatMap::IsInLOS(const AIFloat3& pos)
 {
 	// res = 1 << Mod->GetLosMipLevel();
 	// the value for the full resolution position (x, z) is at index ((z * width + x) / res)
@@ -786,6 +826,10 @@ bool CThreatMap::IsInLOS(const AIFloat3& pos) const
 	if (pos.y < -SQUARE_SIZE * 5) {  // Mod->GetRequireSonarUnderWater() = true
 		const int x = (int)pos.x / radarResConv;
 		const int z = (int)pos.z / radarResConv;
+		if (isSonarDirty) {
+			FillLosMap(sonarMap.data(), sonarMap.size(), true);
+			isSonarDirty = false;
+		}
 		if (sonarMap[z * radarWidth + x] <= 0) {
 			return false;
 		}
@@ -793,9 +837,28 @@ bool CThreatMap::IsInLOS(const AIFloat3& pos) const
 	// convert from world coordinates to losmap coordinates
 	const int x = (int)pos.x / losResConv;
 	const int z = (int)pos.z / losResConv;
+	if (isLosDirty) {
+		FillLosMap(losMap.data(), losMap.size(), false);
+		isLosDirty = false;
+	}
 	return losMap[z * losWidth + x] > 0;
 }
 
+/*
+ * Raw callback writes into persistent buffer, no allocation
+ */
+void CThreatMap::FillLosMap(int* data, int size, bool isSonar)
+{
+	PROFILE_SCOPE("CThreatMap::FillLosMap");
+	const SSkirmishAICallback* callback = circuit->GetSkirmishAICallback();
+	const int skirmishAIId = circuit->GetSkirmishAIId();
+	if (isSonar) {
+		callback->Map_getSonarMap(skirmishAIId, data, size);
+	} else {
+		callback->Map_getLosMap(skirmishAIId, data, size);
+	}
+}
+
 //bool CThreatMap::IsInRadar(const AIFloat3& pos) const
 //{
 //	// the value for the full resolution position (x, z) is at index ((z * width + x) / res)
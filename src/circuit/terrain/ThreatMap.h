@@ -9,8 +9,10 @@
 #ifndef SRC_CIRCUIT_TERRAIN_THREATMAP_H_
 #define SRC_CIRCUIT_TERRAIN_THREATMAP_H_
 
+#include "terrain/ThreatPyramid.h"
 #include "CircuitAI.h"
 
+#include <iostream>
 #include <map>
 #include <vector>
 
@@ -42,6 +44,20 @@ public:
 	void SetThreatType(CCircuitUnit* unit);
 	float GetThreatAt(const springai::AIFloat3& position) const;
 	float GetThreatAt(CCircuitUnit* unit, const springai::AIFloat3& position) const;
+	/*
+	 * Region and corridor queries on the layer selected by SetThreatType (see CThreatPyramid).
+	 * Rectangle is given by corners, returned threat is relative to THREAT_BASE as in GetThreatAt.
+	 */
+	float GetMaxThreatInRect(const springai::AIFloat3& lt, const springai::AIFloat3& rb);
+	float GetSumThreatInCircle(const springai::AIFloat3& position, float radius);
+	float GetMaxThreatAlongSegment(const springai::AIFloat3& start, const springai::AIFloat3& end);
+	/*
+	 * Metal clusters with threat <= THREAT_MIN on the layer selected by SetThreatType.
+	 * Evaluated lazily, once per threat change.
+	 */
+	const std::vector<bool>& GetSafeClusters();
+	int GetUpdateNum() const { return updateNum; }  // threat epoch
+	int GetEpoch() const { return epoch; }  // number of full updates
 
 	float* GetAirThreatArray() { return &airThreat[0]; }
 	float* GetSurfThreatArray() { return &surfThreat[0]; }
@@ -54,6 +70,14 @@ public:
 	int GetSquareSize() const { return squareSize; }
 	int GetMapSize() const { return mapSize; }
 
+	static constexpr uint32_t SAVE_VERSION = 1;
+	/*
+	 * Enemy memory and threat layers. Layers are stored as is instead of
+	 * re-rasterizing every enemy on load, they stay consistent with restored units.
+	 */
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+
 private:
 	/*
 	 * http://stackoverflow.com/questions/872544/precision-of-floating-point
@@ -64,6 +88,10 @@ private:
 	SAreaData* areaData;
 
 	inline void PosToXZ(const springai::AIFloat3& pos, int& x, int& z) const;
+	CThreatPyramid& GetPyramid();
+	void MarkDirty(CThreatPyramid& pyramid, int posx, int posz, int range) {
+		pyramid.MarkDirty(posx - range, posz - range, posx + range + 1, posz + range + 1);
+	}
 
 	void AddEnemyUnit(const CEnemyUnit* e);
 	void DelEnemyUnit(const CEnemyUnit* e);
@@ -83,7 +111,8 @@ private:
 	int GetShieldRange(const CCircuitDef* edef) const;
 	float GetEnemyUnitThreat(CEnemyUnit* enemy) const;
 
-	bool IsInLOS(const springai::AIFloat3& pos) const;
+	bool IsInLOS(const springai::AIFloat3& pos);
+	void FillLosMap(int* data, int size, bool isSonar);
 //	bool IsInRadar(const springai::AIFloat3& pos) const;
 
 //	float currAvgThreat;
@@ -106,11 +135,24 @@ private:
 	Threats cloakThreat;
 	Threats shield;
 	float* threatArray;
+	CThreatPyramid airPyramid;  // region queries, refreshed lazily from dirty tiles
+	CThreatPyramid surfPyramid;
+	CThreatPyramid amphPyramid;
+	int updateNum;  // bumped on any threat change
+	int epoch;  // bumped by Update
+	struct SSafeClusters {
+		std::vector<bool> isSafe;
+		int updateNum;
+	};
+	SSafeClusters safeClusters[3];  // air, surf, amph
 	// TODO: shield-map - units under shield should get threat boost
 
 //	std::vector<int> radarMap;
+	// NOTE: Filled in place on the first query after Update, only if needed
 	std::vector<int> sonarMap;
 	std::vector<int> losMap;
+	bool isSonarDirty;
+	bool isLosDirty;
 	int radarWidth;
 	int radarResConv;
 	int losWidth;
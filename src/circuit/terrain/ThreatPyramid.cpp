@@ -0,0 +1,323 @@
+/*
+ * ThreatPyramid.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "terrain/ThreatPyramid.h"
+#include "util/utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace circuit {
+
+constexpr int CThreatPyramid::TILE_LEVEL;
+constexpr int CThreatPyramid::SCAN_LEVEL;
+
+CThreatPyramid::CThreatPyramid()
+		: layer(nullptr)
+		, width(0)
+		, height(0)
+		, tileLevel(0)
+		, isDirty(false)
+{
+}
+
+CThreatPyramid::~CThreatPyramid()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
+
+void CThreatPyramid::Init(const float* layer, int width, int height)
+{
+	this->layer = layer;
+	this->width = width;
+	this->height = height;
+
+	levels.clear();
+	levels.push_back({width, height, layer, {}});
+	int w = width, h = height;
+	while ((w > 1) || (h > 1)) {
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+		levels.push_back({w, h, nullptr, std::vector<float>(w * h)});
+	}
+	for (unsigned k = 1; k < levels.size(); ++k) {
+		levels[k].max = levels[k].data.data();
+	}
+	rowSums.assign((width + 1) * height, 0.0);
+
+	tileLevel = std::min<int>(TILE_LEVEL, levels.size() - 1);
+	dirtyTiles.resize(levels[tileLevel].width * levels[tileLevel].height);
+	MarkAllDirty();
+}
+
+void CThreatPyramid::MarkDirty(int x1, int z1, int x2, int z2)
+{
+	x1 = std::max(x1, 0);
+	z1 = std::max(z1, 0);
+	x2 = std::min(x2, width);
+	z2 = std::min(z2, height);
+	if ((x1 >= x2) || (z1 >= z2)) {
+		return;
+	}
+	const int tileWidth = levels[tileLevel].width;
+	for (int tz = z1 >> tileLevel; tz <= (z2 - 1) >> tileLevel; ++tz) {
+		for (int tx = x1 >> tileLevel; tx <= (x2 - 1) >> tileLevel; ++tx) {
+			dirtyTiles[tz * tileWidth + tx] = 1;
+		}
+	}
+	isDirty = true;
+}
+
+void CThreatPyramid::MarkAllDirty()
+{
+	std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+	isDirty = true;
+}
+
+float CThreatPyramid::GetMaxInRect(int x1, int z1, int x2, int z2)
+{
+	Refresh();
+	const SRect rect = {std::max(x1, 0), std::max(z1, 0), std::min(x2, width - 1), std::min(z2, height - 1)};
+	float best = std::numeric_limits<float>::lowest();
+	if ((rect.x1 > rect.x2) || (rect.z1 > rect.z2)) {
+		return best;
+	}
+	const int k = GetStartLevel(rect);
+	for (int z = rect.z1 >> k; z <= rect.z2 >> k; ++z) {
+		for (int x = rect.x1 >> k; x <= rect.x2 >> k; ++x) {
+			MaxInRect(k, x, z, rect, best);
+		}
+	}
+	return best;
+}
+
+float CThreatPyramid::GetSumInCircle(float cx, float cz, float radius, int& outCount)
+{
+	Refresh();
+	double sum = 0.0;
+	outCount = 0;
+	if (radius < 0.f) {
+		return sum;
+	}
+	const float sqRadius = SQUARE(radius);
+	const int z1 = std::max(int(std::ceil(cz - radius - 0.5f)), 0);
+	const int z2 = std::min(int(std::floor(cz + radius - 0.5f)), height - 1);
+	for (int z = z1; z <= z2; ++z) {
+		const float dzSq = SQUARE(z + 0.5f - cz);
+		if (dzSq > sqRadius) {
+			continue;
+		}
+		// Span of row within circle, ends are corrected by the exact test against sqrt rounding
+		auto isInside = [cx, sqRadius, dzSq](int x) {
+			return SQUARE(x + 0.5f - cx) + dzSq <= sqRadius;
+		};
+		const float dx = std::sqrt(sqRadius - dzSq);
+		int x1 = utils::clamp(int(std::ceil(cx - dx - 0.5f)), 0, width - 1);
+		int x2 = utils::clamp(int(std::floor(cx + dx - 0.5f)), 0, width - 1);
+		while ((x1 > 0) && isInside(x1 - 1)) --x1;
+		while ((x1 <= x2) && !isInside(x1)) ++x1;
+		while ((x2 < width - 1) && isInside(x2 + 1)) ++x2;
+		while ((x2 >= x1) && !isInside(x2)) --x2;
+		if (x1 <= x2) {
+			const double* row = &rowSums[z * (width + 1)];
+			sum += row[x2 + 1] - row[x1];
+			outCount += x2 - x1 + 1;
+		}
+	}
+	return sum;
+}
+
+float CThreatPyramid::GetMaxAlongSegment(float x1, float z1, float x2, float z2)
+{
+	// Grid walk of Amanatides & Woo
+	x1 = utils::clamp(x1, 0.f, float(width));
+	z1 = utils::clamp(z1, 0.f, float(height));
+	x2 = utils::clamp(x2, 0.f, float(width));
+	z2 = utils::clamp(z2, 0.f, float(height));
+	int x = std::min(int(x1), width - 1);
+	int z = std::min(int(z1), height - 1);
+	const int xEnd = std::min(int(x2), width - 1);
+	const int zEnd = std::min(int(z2), height - 1);
+	const float dx = x2 - x1, dz = z2 - z1;
+	const int stepX = (dx > 0.f) ? 1 : -1;
+	const int stepZ = (dz > 0.f) ? 1 : -1;
+	const float inf = std::numeric_limits<float>::infinity();
+	const float deltaX = (dx != 0.f) ? 1.f / std::fabs(dx) : inf;
+	const float deltaZ = (dz != 0.f) ? 1.f / std::fabs(dz) : inf;
+	float tMaxX = (dx != 0.f) ? ((dx > 0.f) ? (x + 1 - x1) : (x1 - x)) * deltaX : inf;
+	float tMaxZ = (dz != 0.f) ? ((dz > 0.f) ? (z + 1 - z1) : (z1 - z)) * deltaZ : inf;
+	float best = layer[z * width + x];
+	for (int steps = std::abs(xEnd - x) + std::abs(zEnd - z); steps > 0; --steps) {
+		if (tMaxX < tMaxZ) {
+			x += stepX;
+			tMaxX += deltaX;
+		} else {
+			z += stepZ;
+			tMaxZ += deltaZ;
+		}
+		best = std::max(best, layer[z * width + x]);
+	}
+	return best;
+}
+
+void CThreatPyramid::Refresh()
+{
+	if (!isDirty) {
+		return;
+	}
+	isDirty = false;
+
+	// Dirty tiles bottom-up within a tile, rows from the first dirty tile
+	dirtyCur.clear();
+	const int tileSize = 1 << tileLevel;
+	const int tileWidth = levels[tileLevel].width;
+	const int tileHeight = levels[tileLevel].height;
+	for (int tz = 0; tz < tileHeight; ++tz) {
+		int rowBegin = -1;
+		for (int tx = 0; tx < tileWidth; ++tx) {
+			const int i = tz * tileWidth + tx;
+			if (!dirtyTiles[i]) {
+				continue;
+			}
+			dirtyTiles[i] = 0;
+			dirtyCur.push_back(i);
+			if (rowBegin < 0) {
+				rowBegin = tx * tileSize;
+			}
+			for (int k = 1; k <= tileLevel; ++k) {
+				const int shift = tileLevel - k;
+				const int xEnd = std::min((tx + 1) << shift, levels[k].width);
+				const int zEnd = std::min((tz + 1) << shift, levels[k].height);
+				for (int z = tz << shift; z < zEnd; ++z) {
+					for (int x = tx << shift; x < xEnd; ++x) {
+						Build(k, x, z);
+					}
+				}
+			}
+		}
+		if (rowBegin >= 0) {
+			const int zEnd = std::min((tz + 1) * tileSize, height);
+			for (int z = tz * tileSize; z < zEnd; ++z) {
+				BuildRow(z, rowBegin);
+			}
+		}
+	}
+
+	// Ancestors of dirty tiles, each once
+	for (unsigned k = tileLevel + 1; k < levels.size(); ++k) {
+		const int childWidth = levels[k - 1].width;
+		const int levelWidth = levels[k].width;
+		dirtyMark.assign(levelWidth * levels[k].height, 0);
+		dirtyNext.clear();
+		for (int i : dirtyCur) {
+			const int x = (i % childWidth) >> 1;
+			const int z = (i / childWidth) >> 1;
+			const int j = z * levelWidth + x;
+			if (!dirtyMark[j]) {
+				dirtyMark[j] = 1;
+				dirtyNext.push_back(j);
+				Build(k, x, z);
+			}
+		}
+		dirtyCur.swap(dirtyNext);
+	}
+}
+
+void CThreatPyramid::Build(int level, int x, int z)
+{
+	const SLevel& child = levels[level - 1];
+	SLevel& lv = levels[level];
+	const int xEnd = std::min(x * 2 + 2, child.width);
+	const int zEnd = std::min(z * 2 + 2, child.height);
+	if ((xEnd - x * 2 == 2) && (zEnd - z * 2 == 2)) {  // not on the odd border
+		const float* row0 = &child.max[z * 2 * child.width + x * 2];
+		const float* row1 = row0 + child.width;
+		lv.data[z * lv.width + x] = std::max(std::max(row0[0], row0[1]), std::max(row1[0], row1[1]));
+		return;
+	}
+	float max = std::numeric_limits<float>::lowest();
+	for (int cz = z * 2; cz < zEnd; ++cz) {
+		for (int cx = x * 2; cx < xEnd; ++cx) {
+			max = std::max(max, child.max[cz * child.width + cx]);
+		}
+	}
+	lv.data[z * lv.width + x] = max;
+}
+
+void CThreatPyramid::BuildRow(int z, int x)
+{
+	const float* cell = &layer[z * width];
+	double* row = &rowSums[z * (width + 1)];
+	for (; x < width; ++x) {
+		row[x + 1] = row[x] + cell[x];
+	}
+}
+
+int CThreatPyramid::GetStartLevel(const SRect& rect) const
+{
+	const int extent = std::max(rect.x2 - rect.x1, rect.z2 - rect.z1) + 1;
+	const int top = levels.size() - 1;
+	int k = 0;
+	while (((1 << k) < extent) && (k < top)) {
+		++k;
+	}
+	return k;
+}
+
+void CThreatPyramid::MaxInRect(int level, int x, int z, const SRect& rect, float& best) const
+{
+	const SLevel& lv = levels[level];
+	const float max = lv.max[z * lv.width + x];
+	if (max <= best) {
+		return;
+	}
+	const SRect b = GetBounds(level, x, z);
+	if ((b.x2 < rect.x1) || (b.x1 > rect.x2) || (b.z2 < rect.z1) || (b.z1 > rect.z2)) {
+		return;
+	}
+	if ((b.x1 >= rect.x1) && (b.x2 <= rect.x2) && (b.z1 >= rect.z1) && (b.z2 <= rect.z2)) {
+		best = max;
+		return;
+	}
+	if (level <= SCAN_LEVEL) {
+		const int xEnd = std::min(b.x2, rect.x2);
+		const int zEnd = std::min(b.z2, rect.z2);
+		for (int cz = std::max(b.z1, rect.z1); cz <= zEnd; ++cz) {
+			for (int cx = std::max(b.x1, rect.x1); cx <= xEnd; ++cx) {
+				best = std::max(best, layer[cz * width + cx]);
+			}
+		}
+		return;
+	}
+
+	// Children in descending order of max: best is found early and prunes the rest
+	const SLevel& child = levels[level - 1];
+	const int xEnd = std::min(x * 2 + 2, child.width);
+	const int zEnd = std::min(z * 2 + 2, child.height);
+	int children[4];
+	float maxes[4];
+	int num = 0;
+	for (int cz = z * 2; cz < zEnd; ++cz) {
+		for (int cx = x * 2; cx < xEnd; ++cx) {
+			const int index = cz * child.width + cx;
+			const float childMax = child.max[index];
+			int i = num++;
+			for (; (i > 0) && (maxes[i - 1] < childMax); --i) {
+				maxes[i] = maxes[i - 1];
+				children[i] = children[i - 1];
+			}
+			maxes[i] = childMax;
+			children[i] = index;
+		}
+	}
+	for (int i = 0; i < num; ++i) {
+		MaxInRect(level - 1, children[i] % child.width, children[i] / child.width, rect, best);
+	}
+}
+
+} // namespace circuit
@@ -0,0 +1,104 @@
+/*
+ * ThreatPyramid.h
+ *
+ *  Max mip pyramid and row sums over a threat layer for region and corridor queries
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_THREATPYRAMID_H_
+#define SRC_CIRCUIT_TERRAIN_THREATPYRAMID_H_
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Max: level 0 is the layer itself (not copied), cell of level k covers 2^k x 2^k cells.
+ * Query descends from the smallest level that holds the rectangle in 2x2 nodes, takes
+ * covered nodes as is, skips nodes that can't raise max found so far (children go in
+ * descending order of max), and scans only 4x4 blocks cut by the border.
+ * Sum: prefix sums of rows, circle is one span per row.
+ * Segment: grid walk over cells it crosses, O(length); at threat map resolution pyramid
+ * descent along a segment costs more than reading its cells.
+ * Rasterizers mark bounding boxes dirty at tile granularity; first query after changes
+ * rebuilds dirty tiles, their ancestors and their rows only.
+ * Coordinates are cells of layer; segment and circle use continuous cell space where
+ * cell (x, z) is the square [x, x+1] x [z, z+1].
+ */
+class CThreatPyramid {
+public:
+	CThreatPyramid();
+	virtual ~CThreatPyramid();
+
+	void Init(const float* layer, int width, int height);
+	/*
+	 * Cells [x1, x2) x [z1, z2) changed, clipped to layer
+	 */
+	void MarkDirty(int x1, int z1, int x2, int z2);
+	void MarkAllDirty();
+	void MarkDirty(int x, int z) {  // single cell, must be in layer
+		dirtyTiles[(z >> tileLevel) * levels[tileLevel].width + (x >> tileLevel)] = 1;
+		isDirty = true;
+	}
+
+	/*
+	 * Max over cells [x1, x2] x [z1, z2], inclusive, clipped to layer
+	 * @return lowest float if rectangle is empty
+	 */
+	float GetMaxInRect(int x1, int z1, int x2, int z2);
+	/*
+	 * Sum over cells with center within radius
+	 * @param outCount number of summed cells
+	 */
+	float GetSumInCircle(float cx, float cz, float radius, int& outCount);
+	/*
+	 * Max over cells crossed by segment, ends are clamped into layer
+	 */
+	float GetMaxAlongSegment(float x1, float z1, float x2, float z2);
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+
+private:
+	struct SLevel {
+		int width, height;
+		const float* max;  // layer for level 0
+		std::vector<float> data;
+	};
+	struct SRect {
+		int x1, z1, x2, z2;  // inclusive
+	};
+	static constexpr int TILE_LEVEL = 3;  // dirty tile = 8x8 cells
+	static constexpr int SCAN_LEVEL = 2;  // border nodes of 4x4 cells are scanned cell by cell
+
+	void Refresh();
+	void Build(int level, int x, int z);
+	void BuildRow(int z, int x);
+	SRect GetBounds(int level, int x, int z) const {
+		return {x << level, z << level, std::min((x + 1) << level, width) - 1, std::min((z + 1) << level, height) - 1};
+	}
+	/*
+	 * Smallest level where rectangle spans at most 2x2 nodes
+	 */
+	int GetStartLevel(const SRect& rect) const;
+	void MaxInRect(int level, int x, int z, const SRect& rect, float& best) const;
+
+	const float* layer;
+	int width, height;
+	int tileLevel;
+	std::vector<SLevel> levels;
+	std::vector<double> rowSums;  // (width + 1) per row, sum of cells [0, x)
+	std::vector<uint8_t> dirtyTiles;  // cells of tileLevel
+	// Refresh scratch
+	std::vector<uint8_t> dirtyMark;
+	std::vector<int> dirtyCur;
+	std::vector<int> dirtyNext;
+	bool isDirty;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_TERRAIN_THREATPYRAMID_H_
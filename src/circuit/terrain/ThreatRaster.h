@@ -0,0 +1,144 @@
+/*
+ * ThreatRaster.h
+ *
+ *  Threat layer rasterizers, free of unit/engine state so circuit_bench can drive them
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_THREATRASTER_H_
+#define SRC_CIRCUIT_TERRAIN_THREATRASTER_H_
+
+#include "util/Defines.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace circuit {
+
+namespace raster {
+
+/*
+ * Visit every cell of a layer (width x height, with 1-cell pathfinder edges) within range of (posx, posz).
+ * Threat circles are large and often have appendix, decrease it by 1 for micro-optimization.
+ * @param func void(int index, int x, int z, int distSq)
+ */
+template<typename F>
+inline void Circle(int posx, int posz, int range, int width, int height, F&& func)
+{
+	const int rangeSq = SQUARE(range);
+
+	const int beginX = std::max(int(posx - range + 1),          1);
+	const int endX   = std::min(int(posx + range    ),  width - 1);
+	const int beginZ = std::max(int(posz - range + 1),          1);
+	const int endZ   = std::min(int(posz + range    ), height - 1);
+
+	for (int x = beginX; x < endX; ++x) {
+		const int dxSq = SQUARE(posx - x);
+		for (int z = beginZ; z < endZ; ++z) {
+			const int sum = dxSq + SQUARE(posz - z);
+			if (sum > rangeSq) {
+				continue;
+			}
+			func(z * width + x, x, z, sum);
+		}
+	}
+}
+
+inline void AddThreat(float* layer, int width, int height, int posx, int posz, int range, float threat)
+{
+	Circle(posx, posz, range, width, height, [layer, range, threat](int index, int x, int z, int sum) {
+		layer[index] += threat * (1.5f - 1.0f * sqrtf(sum) / range);
+	});
+}
+
+inline void DelThreat(float* layer, int width, int height, int posx, int posz, int range, float threat)
+{
+	Circle(posx, posz, range, width, height, [layer, range, threat](int index, int x, int z, int sum) {
+		// MicroPather cannot deal with negative costs
+		// (which may arise due to floating-point drift)
+		// nor with zero-cost nodes (see MP::SetMapData,
+		// threat is not used as an additive overlay)
+		const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
+		layer[index] = std::max<float>(layer[index] - heat, THREAT_BASE);
+	});
+}
+
+/*
+ * @param isWater bool(int x, int z)
+ * @param isShallow bool(int x, int z), land threat reaches amphibious units
+ */
+template<typename W, typename S>
+inline void AddAmph(float* amph, float* surf, int width, int height, int posx, int posz,
+		int rangeLand, int rangeWater, float threat, W&& isWater, S&& isShallow)
+{
+	const int rangeLandSq = SQUARE(rangeLand);
+	const int rangeWaterSq = SQUARE(rangeWater);
+	const int range = std::max(rangeLand, rangeWater);
+	Circle(posx, posz, range, width, height, [&](int index, int x, int z, int sum) {
+		const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
+		const bool isWaterThreat = (sum <= rangeWaterSq) && isWater(x, z);
+		if (isWaterThreat || ((sum <= rangeLandSq) && isShallow(x, z))) {
+			amph[index] += heat;
+		}
+		if (isWaterThreat || (sum <= rangeLandSq)) {
+			surf[index] += heat;
+		}
+	});
+}
+
+template<typename W, typename S>
+inline void DelAmph(float* amph, float* surf, int width, int height, int posx, int posz,
+		int rangeLand, int rangeWater, float threat, W&& isWater, S&& isShallow)
+{
+	const int rangeLandSq = SQUARE(rangeLand);
+	const int rangeWaterSq = SQUARE(rangeWater);
+	const int range = std::max(rangeLand, rangeWater);
+	Circle(posx, posz, range, width, height, [&](int index, int x, int z, int sum) {
+		const float heat = threat * (1.5f - 1.0f * sqrtf(sum) / range);
+		const bool isWaterThreat = (sum <= rangeWaterSq) && isWater(x, z);
+		if (isWaterThreat || ((sum <= rangeLandSq) && isShallow(x, z))) {
+			amph[index] = std::max<float>(amph[index] - heat, THREAT_BASE);
+		}
+		if (isWaterThreat || (sum <= rangeLandSq)) {
+			surf[index] = std::max<float>(surf[index] - heat, THREAT_BASE);
+		}
+	});
+}
+
+inline void AddCloak(float* layer, int width, int height, int posx, int posz, int range)
+{
+	const float threatCloak = 16 * THREAT_BASE;
+	Circle(posx, posz, range, width, height, [layer, range, threatCloak](int index, int x, int z, int sum) {
+		layer[index] += threatCloak * (1.0f - 0.5f * sqrtf(sum) / range);
+	});
+}
+
+inline void DelCloak(float* layer, int width, int height, int posx, int posz, int range)
+{
+	const float threatCloak = 16 * THREAT_BASE;
+	Circle(posx, posz, range, width, height, [layer, range, threatCloak](int index, int x, int z, int sum) {
+		const float heat = threatCloak * (1.0f - 0.5f * sqrtf(sum) / range);
+		layer[index] = std::max<float>(layer[index] - heat, THREAT_BASE);
+	});
+}
+
+inline void AddShield(float* layer, int width, int height, int posx, int posz, int range, float value)
+{
+	Circle(posx, posz, range, width, height, [layer, value](int index, int x, int z, int sum) {
+		layer[index] += value;
+	});
+}
+
+inline void DelShield(float* layer, int width, int height, int posx, int posz, int range, float value)
+{
+	Circle(posx, posz, range, width, height, [layer, value](int index, int x, int z, int sum) {
+		layer[index] = std::max(layer[index] - value, 0.f);
+	});
+}
+
+} // namespace raster
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_TERRAIN_THREATRASTER_H_
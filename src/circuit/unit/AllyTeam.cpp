@@ -9,6 +9,7 @@
 #include "unit/FactoryData.h"
 #include "resource/MetalManager.h"
 #include "resource/EnergyGrid.h"
+#include "resource/ReclaimData.h"
 #include "setup/DefenceMatrix.h"
 #include "setup/SetupManager.h"
 #include "terrain/PathFinder.h"
@@ -67,6 +68,7 @@ void CAllyTeam::Init(CCircuitAI* circuit)
 	}
 
 	energyGrid = std::make_shared<CEnergyGrid>(circuit);
+	reclaimData = std::make_shared<CReclaimData>(circuit);
 	defence = std::make_shared<CDefenceMatrix>(circuit);
 	pathfinder = std::make_shared<CPathFinder>(&circuit->GetGameAttribute()->GetTerrainData());
 	factoryData = std::make_shared<CFactoryData>(circuit);
@@ -88,6 +90,7 @@ void CAllyTeam::Release()
 
 	metalManager = nullptr;
 	energyGrid = nullptr;
+	reclaimData = nullptr;
 	defence = nullptr;
 	pathfinder = nullptr;
 	factoryData = nullptr;
@@ -150,6 +153,7 @@ void CAllyTeam::DelegateAuthority(CCircuitAI* curOwner)
 		if (circuit->IsInitialized() && (circuit != curOwner) && (circuit->GetAllyTeamId() == curOwner->GetAllyTeamId())) {
 			metalManager->SetAuthority(circuit);
 			energyGrid->SetAuthority(circuit);
+			reclaimData->SetAuthority(circuit);
 			circuit->GetScheduler()->RunOnRelease(std::make_shared<CGameTask>(&CAllyTeam::DelegateAuthority, this, circuit));
 			break;
 		}
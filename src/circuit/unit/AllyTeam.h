@@ -23,6 +23,7 @@ namespace circuit {
 class CCircuitAI;
 class CMetalManager;
 class CEnergyGrid;
+class CReclaimData;
 class CDefenceMatrix;
 class CPathFinder;
 class CFactoryData;
@@ -69,6 +70,7 @@ public:
 
 	std::shared_ptr<CMetalManager>& GetMetalManager() { return metalManager; }
 	std::shared_ptr<CEnergyGrid>& GetEnergyGrid() { return energyGrid; }
+	std::shared_ptr<CReclaimData>& GetReclaimData() { return reclaimData; }
 	std::shared_ptr<CDefenceMatrix>& GetDefenceMatrix() { return defence; }
 	std::shared_ptr<CPathFinder>& GetPathfinder() { return pathfinder; }
 	std::shared_ptr<CFactoryData>& GetFactoryData() { return factoryData; }
@@ -91,6 +93,7 @@ private:
 
 	std::shared_ptr<CMetalManager> metalManager;
 	std::shared_ptr<CEnergyGrid> energyGrid;
+	std::shared_ptr<CReclaimData> reclaimData;
 	std::shared_ptr<CDefenceMatrix> defence;
 	std::shared_ptr<CPathFinder> pathfinder;
 	std::shared_ptr<CFactoryData> factoryData;
@@ -6,10 +6,12 @@
  */
 
 #include "unit/CircuitDef.h"
+#include "unit/DefCatalog.h"
 #include "CircuitAI.h"
-#include "util/GameAttribute.h"
 #include "util/utils.h"
 
+#include "WrappUnitDef.h"
+#include "WrappWeaponMount.h"
 #include "WeaponMount.h"
 #include "WeaponDef.h"
 #include "Damage.h"
@@ -18,6 +20,7 @@
 #include "Map.h"
 
 #include <regex>
+#include <cassert>
 
 namespace circuit {
 
@@ -63,28 +66,19 @@ CCircuitDef::FireName CCircuitDef::fireNames = {
 	{"open",   CCircuitDef::FireType::OPEN},
 };
 
-CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<Id>& buildOpts, Resource* res)
-		: def(def)
-		, mainRole(RoleType::SCOUT)
-		, enemyRole(RoleMask::NONE)
-		, role(RoleMask::NONE)
+CCircuitDef::SShared::SShared(CCircuitAI* circuit, UnitDef* def, std::unordered_set<Id>& buildOpts, Resource* res)
+		: role(RoleMask::NONE)
 		, buildOptions(buildOpts)
-		, count(0)
-		, buildCounts(0)
-		, sinceFrame(-1)
 		, isAttacker(false)
 		, hasDGunAA(false)
-		, dgunMount(nullptr)
-		, shieldMount(nullptr)
-		, weaponMount(nullptr)
-		, pwrDmg(.0f)
-		, thrDmg(.0f)
+		, dgunMountId(-1)
+		, shieldMountId(-1)
+		, weaponMountId(-1)
+		, dmg(.0f)
 		, aoe(.0f)
 		, power(.0f)
-		, threat(.0f)
 		, minRange(.0f)
 		, maxRange({.0f})
-		, threatRange({0})
 		, shieldRadius(.0f)
 		, maxShield(.0f)
 		, reloadTime(0)
@@ -98,11 +92,9 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 		, isLander(false)
 		, stockCost(.0f)
 		, jumpRange(.0f)
-		, retreat(-1.f)
-		, height(-1.f)
-		, topOffset(-1.f)
 {
 	id = def->GetUnitDefId();
+	name = def->GetName();
 
 	buildDistance = def->GetBuildDistance();
 	buildSpeed    = def->GetBuildSpeed();
@@ -122,6 +114,7 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 	cloakCost = std::max(def->GetCloakCost(), def->GetCloakCostMoving());
 	buildTime = def->GetBuildTime();
 //	altitude  = def->GetWantedHeight();
+	decloakDistance = def->GetDecloakDistance();
 
 	MoveData* md = def->GetMoveData();
 	isSubmarine = (md == nullptr) ? false : md->IsSubMarine();
@@ -154,7 +147,7 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 	bool isDynamic = false;
 	if (customParams.find("level") != customParams.end()) {
 		isDynamic = customParams.find("dynamic_comm") != customParams.end();
-		AddRole(RoleType::COMM);
+		role |= GetMask(static_cast<RoleT>(RoleType::COMM));
 	}
 
 	it = customParams.find("midposoffset");
@@ -188,12 +181,11 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 			auto mounts = std::move(def->GetWeaponMounts());
 			for (WeaponMount* mount : mounts) {
 				WeaponDef* wd = mount->GetWeaponDef();
-				if ((shieldMount == nullptr) && wd->IsShield()) {
-					shieldMount = mount;  // NOTE: Unit may have more than 1 shield
-				} else {
-					delete mount;
+				if ((shieldMountId < 0) && wd->IsShield()) {
+					shieldMountId = mount->GetWeaponMountId();  // NOTE: Unit may have more than 1 shield
 				}
 				delete wd;
+				delete mount;
 			}
 		}
 		// NOTE: Aspis (mobile shield) has 10 damage for some reason, break
@@ -206,7 +198,7 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 		if (it != customParams.end()) {
 			stockCost = utils::string_to_float(it->second);
 		}
-		AddAttribute(AttrType::STOCK);
+		role |= GetMask(static_cast<RoleT>(AttrType::STOCK));
 		delete stockDef;
 	}
 
@@ -218,9 +210,8 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 	float bestDGunReload = std::numeric_limits<float>::max();
 	float bestWpRange = std::numeric_limits<float>::max();
 	float dps = .0f;  // TODO: split dps like ranges on air, land, water
-	float dmg = .0f;
-	WeaponMount* bestDGunMnt = nullptr;
-	WeaponMount* bestWpMnt = nullptr;
+	int bestDGunMntId = -1;
+	int bestWpMntId = -1;
 	bool canTargetAir = false;
 	bool canTargetLand = false;
 	bool canTargetWater = false;
@@ -341,26 +332,19 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 			// NOTE: Disable commander's dgun, because no usage atm
 			if (customParams.find("manualfire") == customParams.end()) {
 				bestDGunReload = reloadTime;
-				delete bestDGunMnt;
-				bestDGunMnt = mount;
+				bestDGunMntId = mount->GetWeaponMountId();
 				hasDGunAA |= (weaponCat & circuit->GetAirCategory()) && isAirWeapon;
-			} else {  // FIXME: Dynamo com workaround
-				delete mount;
-			}
+			}  // FIXME: Dynamo com workaround
 		} else if (wd->IsShield()) {
-			if (shieldMount == nullptr) {
-				shieldMount = mount;  // NOTE: Unit may have more than 1 shield
-			} else {
-				delete mount;
+			if (shieldMountId < 0) {
+				shieldMountId = mount->GetWeaponMountId();  // NOTE: Unit may have more than 1 shield
 			}
 		} else if (range < bestWpRange) {
-			delete bestWpMnt;
-			bestWpMnt = mount;
+			bestWpMntId = mount->GetWeaponMountId();
 			bestWpRange = range;
-		} else {
-			delete mount;
 		}
 		delete wd;
+		delete mount;
 	}
 	if (isDynamic) {  // FIXME: Dynamo com workaround
 		dps /= mounts.size();
@@ -371,10 +355,10 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
  		reloadTime = minReloadTime * FRAMES_PER_SEC;
 	}
 	if (bestDGunReload < std::numeric_limits<float>::max()) {
-		dgunMount = bestDGunMnt;
+		dgunMountId = bestDGunMntId;
 	}
 	if (bestWpRange < std::numeric_limits<float>::max()) {
-		weaponMount = bestWpMnt;
+		weaponMountId = bestWpMntId;
 	}
 
 	isAttacker = dps > .1f;
@@ -422,37 +406,27 @@ CCircuitDef::CCircuitDef(CCircuitAI* circuit, UnitDef* def, std::unordered_set<I
 
 	// TODO: Include projectile-speed/range, armor
 	//       health /= def->GetArmoredMultiple();
-	thrDmg = pwrDmg = dmg = sqrtf(dps) * std::pow(dmg, 0.25f) * THREAT_MOD;
-	threat = power = dmg * sqrtf(def->GetHealth() + maxShield * 2.0f);
-}
-
-CCircuitDef::~CCircuitDef()
-{
-	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
-	delete def;
-	delete dgunMount;
-	delete shieldMount;
-	delete weaponMount;
+	dmg = sqrtf(dps) * std::pow(dmg, 0.25f) * THREAT_MOD;
+	power = dmg * sqrtf(def->GetHealth() + maxShield * 2.0f);
 }
 
-void CCircuitDef::Init(CCircuitAI* circuit)
+void CCircuitDef::SShared::Init(const CDefCatalog& catalog, CTerrainData& terrainData)
 {
-	CTerrainData& terrainData = circuit->GetGameAttribute()->GetTerrainData();
 	assert(terrainData.IsInitialized());
 
-	if (IsAbleToFly()) {
+	if (isAbleToFly) {
 
 	} else if (!IsMobile()) {  // for immobile units
 
-		immobileTypeId = terrainData.udImmobileType[GetId()];
+		immobileTypeId = terrainData.udImmobileType[id];
 		// If a unit can build mobile units then it will inherit mobileType from it's options
 		std::map<STerrainMapMobileType::Id, float> mtUsability;
-		for (CCircuitDef::Id buildId : GetBuildOptions()) {
-			CCircuitDef* bdef = circuit->GetCircuitDef(buildId);
-			if ((bdef == nullptr) || !bdef->IsMobile() || !bdef->IsAttacker()) {
+		for (CCircuitDef::Id buildId : buildOptions) {
+			const SShared* bdata = catalog.GetShared(buildId);
+			if ((bdata == nullptr) || !bdata->IsMobile() || !bdata->IsAttacker()) {
 				continue;
 			}
-			STerrainMapMobileType::Id mtId = terrainData.udMobileType[bdef->GetId()];
+			STerrainMapMobileType::Id mtId = terrainData.udMobileType[bdata->id];
 			if ((mtId < 0) || (mtUsability.find(mtId) != mtUsability.end())) {
 				continue;
 			}
@@ -471,21 +445,67 @@ void CCircuitDef::Init(CCircuitAI* circuit)
 
 	} else {  // for mobile units
 
-		mobileTypeId = terrainData.udMobileType[GetId()];
+		mobileTypeId = terrainData.udMobileType[id];
 	}
 
 	if (IsMobile()) {
 		if (mobileTypeId >= 0) {
 			STerrainMapMobileType& mt = terrainData.areaData0.mobileType[mobileTypeId];
-			isAmphibious = ((mt.minElevation < -SQUARE_SIZE * 5) || (mt.maxElevation < SQUARE_SIZE * 5)) && !IsFloater();
+			isAmphibious = ((mt.minElevation < -SQUARE_SIZE * 5) || (mt.maxElevation < SQUARE_SIZE * 5)) && !isFloater;
 		}
 	} else {
 		if (immobileTypeId >= 0) {
 			STerrainMapImmobileType& it = terrainData.areaData0.immobileType[immobileTypeId];
-			isAmphibious = ((it.minElevation < -SQUARE_SIZE * 5) || (it.maxElevation < SQUARE_SIZE * 5)) && !IsFloater();
+			isAmphibious = ((it.minElevation < -SQUARE_SIZE * 5) || (it.maxElevation < SQUARE_SIZE * 5)) && !isFloater;
 		}
 	}
-	isLander = !IsFloater() && !IsAbleToFly() && !IsAmphibious() && !IsSubmarine();
+	isLander = !isFloater && !isAbleToFly && !isAmphibious && !isSubmarine;
+}
+
+CCircuitDef::CCircuitDef(CCircuitAI* circuit, const SShared* data)
+		: data(data)
+		, mainRole(RoleType::SCOUT)
+		, enemyRole(RoleMask::NONE)
+		, role(data->role)
+		, count(0)
+		, buildCounts(0)
+		, maxThisUnit(data->maxThisUnit)
+		, sinceFrame(-1)
+		, dgunMount(nullptr)
+		, shieldMount(nullptr)
+		, weaponMount(nullptr)
+		, pwrDmg(data->dmg)
+		, thrDmg(data->dmg)
+		, power(data->power)
+		, threat(data->power)
+		, threatRange({0})
+		, fireState(data->fireState)
+		, reloadTime(data->reloadTime)
+		, retreat(-1.f)
+		, height(-1.f)
+		, topOffset(-1.f)
+{
+	// NOTE: Wrappers are bound to skirmishAIId, so they can't be shared
+	const int skirmishAIId = circuit->GetSkirmishAIId();
+	def = WrappUnitDef::GetInstance(skirmishAIId, data->id);
+	if (data->dgunMountId >= 0) {
+		dgunMount = WrappWeaponMount::GetInstance(skirmishAIId, data->id, data->dgunMountId);
+	}
+	if (data->shieldMountId >= 0) {
+		shieldMount = WrappWeaponMount::GetInstance(skirmishAIId, data->id, data->shieldMountId);
+	}
+	if (data->weaponMountId >= 0) {
+		weaponMount = WrappWeaponMount::GetInstance(skirmishAIId, data->id, data->weaponMountId);
+	}
+}
+
+CCircuitDef::~CCircuitDef()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+	delete def;
+	delete dgunMount;
+	delete shieldMount;
+	delete weaponMount;
 }
 
 bool CCircuitDef::IsYTargetable(float elevation, float posY) {
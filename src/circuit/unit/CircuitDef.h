@@ -21,6 +21,8 @@ namespace springai {
 
 namespace circuit {
 
+class CDefCatalog;
+
 class CCircuitDef {
 public:
 	using Id = int;
@@ -72,14 +74,81 @@ public:
 	static AttrName& GetAttrNames() { return attrNames; }
 	static FireName& GetFireNames() { return fireNames; }
 
+	/*
+	 * Engine-derived part of def, equal for all AIs of the process.
+	 * Built once by CDefCatalog, CCircuitDef keeps per-AI state on top of it.
+	 */
+	struct SShared {
+		SShared(CCircuitAI* circuit, springai::UnitDef* def, std::unordered_set<Id>& buildOpts, springai::Resource* res);
+		void Init(const CDefCatalog& catalog, CTerrainData& terrainData);
+
+		bool IsMobile() const { return speed > .1f; }
+		bool IsAttacker() const { return isAttacker; }
+
+		Id id;
+		std::string name;
+		RoleM role;  // initial, config adds more
+		std::unordered_set<Id> buildOptions;
+		float buildDistance;
+		float buildSpeed;
+		int maxThisUnit;
+
+		bool isAttacker;
+		bool hasDGun;
+		bool hasDGunAA;
+		int dgunMountId;  // -1 if none
+		int shieldMountId;
+		int weaponMountId;
+		float dmg;  // initial pwrDmg and thrDmg
+		float aoe;
+		float power;  // initial power and threat
+		float minRange;
+		std::array<float, static_cast<RangeT>(RangeType::_SIZE_)> maxRange;
+		float shieldRadius;
+		float maxShield;
+		FireType fireState;
+		int reloadTime;
+		int category;
+		int targetCategory;
+		int noChaseCategory;
+
+		STerrainMapImmobileType::Id immobileTypeId;
+		STerrainMapMobileType::Id   mobileTypeId;
+
+		bool hasAntiAir;
+		bool hasAntiLand;
+		bool hasAntiWater;
+
+		bool isPlane;
+		bool isFloater;
+		bool isSubmarine;
+		bool isAmphibious;
+		bool isLander;
+		bool isSonarStealth;
+		bool isTurnLarge;
+		bool isAbleToFly;
+		bool isAbleToCloak;
+		bool isAbleToJump;
+
+		float speed;
+		float losRadius;
+		float cost;
+		float cloakCost;
+		float stockCost;
+		float buildTime;
+		float jumpRange;
+		float decloakDistance;
+
+		springai::AIFloat3 midPosOffset;
+	};
+
 	CCircuitDef(const CCircuitDef& that) = delete;
 	CCircuitDef& operator=(const CCircuitDef&) = delete;
-	CCircuitDef(CCircuitAI* circuit, springai::UnitDef* def, std::unordered_set<Id>& buildOpts, springai::Resource* res);
+	CCircuitDef(CCircuitAI* circuit, const SShared* data);
 	virtual ~CCircuitDef();
 
-	void Init(CCircuitAI* circuit);
-
-	Id GetId() const { return id; }
+	const SShared* GetShared() const { return data; }
+	Id GetId() const { return data->id; }
 	springai::UnitDef* GetUnitDef() const { return def; }
 
 	void SetMainRole(RoleType type) { mainRole = type; }
@@ -127,10 +196,10 @@ public:
 	bool IsReturnFire() const { return fireState == FireType::RETURN; }
 	bool IsOpenFire()   const { return fireState == FireType::OPEN; }
 
-	const std::unordered_set<Id>& GetBuildOptions() const { return buildOptions; }
-	float GetBuildDistance() const { return buildDistance; }
-	float GetBuildSpeed() const { return buildSpeed; }
-	inline bool CanBuild(Id buildDefId) const {	return buildOptions.find(buildDefId) != buildOptions.end(); }
+	const std::unordered_set<Id>& GetBuildOptions() const { return data->buildOptions; }
+	float GetBuildDistance() const { return data->buildDistance; }
+	float GetBuildSpeed() const { return data->buildSpeed; }
+	inline bool CanBuild(Id buildDefId) const {	return data->buildOptions.find(buildDefId) != data->buildOptions.end(); }
 	inline bool CanBuild(CCircuitDef* buildDef) const { return CanBuild(buildDef->GetId()); }
 	int GetCount() const { return count; }
 
@@ -141,8 +210,8 @@ public:
 //	CCircuitDef  operator++(int);  // postfix (C++): dummy parameter, returns a value
 	CCircuitDef& operator--();     // prefix  (--C): no parameter, returns a reference
 //	CCircuitDef  operator--(int);  // postfix (C--): dummy parameter, returns a value
-	bool operator==(const CCircuitDef& rhs) { return id == rhs.id; }
-	bool operator!=(const CCircuitDef& rhs) { return id != rhs.id; }
+	bool operator==(const CCircuitDef& rhs) { return data->id == rhs.data->id; }
+	bool operator!=(const CCircuitDef& rhs) { return data->id != rhs.data->id; }
 
 	void SetMaxThisUnit(int value) { maxThisUnit = value; }
 	int GetMaxThisUnit() const { return maxThisUnit; }
@@ -154,26 +223,26 @@ public:
 	void DecBuild() { --buildCounts; }
 	int GetBuildCount() const { return buildCounts; }
 
-	bool HasDGun() const { return hasDGun; }
-	bool HasDGunAA() const { return hasDGunAA; }
+	bool HasDGun() const { return data->hasDGun; }
+	bool HasDGunAA() const { return data->hasDGunAA; }
 	springai::WeaponMount* GetDGunMount() const { return dgunMount; }
 	springai::WeaponMount* GetShieldMount() const { return shieldMount; }
 	springai::WeaponMount* GetWeaponMount() const { return weaponMount; }
 	float GetPwrDamage() const { return pwrDmg; }  // ally
 	float GetThrDamage() const { return thrDmg; }  // enemy
-	float GetAoe() const { return aoe; }
+	float GetAoe() const { return data->aoe; }
 	float GetPower() const { return power; }
 	float GetThreat() const { return threat; }
-	float GetMinRange() const { return minRange; }
-	float GetMaxRange(RangeType type = RangeType::MAX) const { return maxRange[static_cast<RangeT>(type)]; }
+	float GetMinRange() const { return data->minRange; }
+	float GetMaxRange(RangeType type = RangeType::MAX) const { return data->maxRange[static_cast<RangeT>(type)]; }
 	int GetThreatRange(ThreatType type = ThreatType::MAX) const { return threatRange[static_cast<ThreatT>(type)]; }
-	float GetShieldRadius() const { return shieldRadius; }
-	float GetMaxShield() const { return maxShield; }
+	float GetShieldRadius() const { return data->shieldRadius; }
+	float GetMaxShield() const { return data->maxShield; }
 	int GetFireState() const { return fireState; }
 	int GetReloadTime() const { return reloadTime; }
-	int GetCategory() const { return category; }
-	int GetTargetCategory() const { return targetCategory; }
-	int GetNoChaseCategory() const { return noChaseCategory; }
+	int GetCategory() const { return data->category; }
+	int GetTargetCategory() const { return data->targetCategory; }
+	int GetNoChaseCategory() const { return data->noChaseCategory; }
 
 	void ModPower(float mod) { pwrDmg *= mod; power *= mod; }
 	void ModThreat(float mod) { thrDmg *= mod; threat *= mod; }
@@ -181,114 +250,71 @@ public:
 	void SetFireState(FireType ft) { fireState = ft; }
 	void SetReloadTime(int time) { reloadTime = time; }
 
-	STerrainMapImmobileType::Id GetImmobileId() const { return immobileTypeId; }
-	STerrainMapMobileType::Id GetMobileId() const { return mobileTypeId; }
-
-	bool IsAttacker()   const { return isAttacker; }
-	bool HasAntiAir()   const { return hasAntiAir; }
-	bool HasAntiLand()  const { return hasAntiLand; }
-	bool HasAntiWater() const { return hasAntiWater; }
-
-	bool IsMobile()       const { return speed > .1f; }
-	bool IsAbleToFly()    const { return isAbleToFly; }
-	bool IsPlane()        const { return isPlane; }
-	bool IsFloater()      const { return isFloater; }
-	bool IsSubmarine()    const { return isSubmarine; }
-	bool IsAmphibious()   const { return isAmphibious; }
-	bool IsLander()       const { return isLander; }
-	bool IsSonarStealth() const { return isSonarStealth; }
-	bool IsTurnLarge()    const { return isTurnLarge; }
-	bool IsAbleToCloak()  const { return isAbleToCloak; }
-	bool IsAbleToJump()   const { return isAbleToJump; }
-	bool IsAssistable()   const { return buildTime < 1e6f; }
-
-	float GetSpeed()     const { return speed; }
-	float GetLosRadius() const { return losRadius; }
-	float GetCost()      const { return cost; }
-	float GetCloakCost() const { return cloakCost; }
-	float GetStockCost() const { return stockCost; }
-	float GetBuildTime() const { return buildTime; }
+	STerrainMapImmobileType::Id GetImmobileId() const { return data->immobileTypeId; }
+	STerrainMapMobileType::Id GetMobileId() const { return data->mobileTypeId; }
+
+	bool IsAttacker()   const { return data->isAttacker; }
+	bool HasAntiAir()   const { return data->hasAntiAir; }
+	bool HasAntiLand()  const { return data->hasAntiLand; }
+	bool HasAntiWater() const { return data->hasAntiWater; }
+
+	bool IsMobile()       const { return data->IsMobile(); }
+	bool IsAbleToFly()    const { return data->isAbleToFly; }
+	bool IsPlane()        const { return data->isPlane; }
+	bool IsFloater()      const { return data->isFloater; }
+	bool IsSubmarine()    const { return data->isSubmarine; }
+	bool IsAmphibious()   const { return data->isAmphibious; }
+	bool IsLander()       const { return data->isLander; }
+	bool IsSonarStealth() const { return data->isSonarStealth; }
+	bool IsTurnLarge()    const { return data->isTurnLarge; }
+	bool IsAbleToCloak()  const { return data->isAbleToCloak; }
+	bool IsAbleToJump()   const { return data->isAbleToJump; }
+	bool IsAssistable()   const { return data->buildTime < 1e6f; }
+
+	float GetSpeed()     const { return data->speed; }
+	float GetLosRadius() const { return data->losRadius; }
+	float GetCost()      const { return data->cost; }
+	float GetCloakCost() const { return data->cloakCost; }
+	float GetStockCost() const { return data->stockCost; }
+	float GetBuildTime() const { return data->buildTime; }
 //	float GetAltitude()  const { return altitude; }
-	float GetJumpRange() const { return jumpRange; }
+	float GetJumpRange() const { return data->jumpRange; }
 
 	void SetRetreat(float value) { retreat = value; }
 	float GetRetreat()   const { return retreat; }
 
 	bool IsYTargetable(float elevation, float posY);
-	const springai::AIFloat3& GetMidPosOffset() const { return midPosOffset; }
+	const springai::AIFloat3& GetMidPosOffset() const { return data->midPosOffset; }
 
 private:
 	static RoleName roleNames;
 	static AttrName attrNames;
 	static FireName fireNames;
 
-	Id id;
+	const SShared* data;  // owned by CDefCatalog
 	springai::UnitDef* def;  // owner
 	RoleType mainRole;
 	RoleM enemyRole;
 	RoleM role;
-	std::unordered_set<Id> buildOptions;
-	float buildDistance;
-	float buildSpeed;
 	int count;
 	int buildCounts;  // number of builder defs able to build this def;
 	int maxThisUnit;
 	int sinceFrame;
 
-	bool isAttacker;
-	bool hasDGun;
-	bool hasDGunAA;
 	springai::WeaponMount* dgunMount;
 	springai::WeaponMount* shieldMount;
 	springai::WeaponMount* weaponMount;
 	float pwrDmg;  // ally damage
 	float thrDmg;  // enemy damage
-	float aoe;  // radius
 	float power;  // ally max threat
 	float threat;  // enemy max threat
-	float minRange;
-	std::array<float, static_cast<RangeT>(RangeType::_SIZE_)> maxRange;
 	std::array<int, static_cast<ThreatT>(ThreatType::_SIZE_)> threatRange;
-	float shieldRadius;
-	float maxShield;
 	FireType fireState;
 	int reloadTime;  // frames in ticks
-	int category;
-	int targetCategory;
-	int noChaseCategory;
-
-	STerrainMapImmobileType::Id immobileTypeId;
-	STerrainMapMobileType::Id   mobileTypeId;
-
-	bool hasAntiAir;  // air layer
-	bool hasAntiLand;  // surface (water and land)
-	bool hasAntiWater;  // under water
-
-	// TODO: Use bit field?
-	bool isPlane;  // no hover attack
-	bool isFloater;
-	bool isSubmarine;
-	bool isAmphibious;
-	bool isLander;
-	bool isSonarStealth;
-	bool isTurnLarge;
-	bool isAbleToFly;
-	bool isAbleToCloak;
-	bool isAbleToJump;
-
-	float speed;
-	float losRadius;
-	float cost;
-	float cloakCost;
-	float stockCost;
-	float buildTime;
-//	float altitude;
-	float jumpRange;
 	float retreat;
 
 	float height;
 	float topOffset;  // top point offset in water
-	springai::AIFloat3 midPosOffset;
 };
 
 inline CCircuitDef& CCircuitDef::operator++()
@@ -10,6 +10,7 @@
 
 #include "unit/AllyUnit.h"
 #include "util/ActionList.h"
+#include "util/SlotMap.h"
 
 namespace springai {
 	class Weapon;
@@ -53,6 +54,9 @@ struct STerrainMapArea;
 
 class CCircuitUnit: public CAllyUnit, public CActionList {
 public:
+	// Weak reference into CCircuitAI::GetTeamUnits(), survives engine reusing the id
+	using Handle = CSlotMap<Id, CCircuitUnit*>::SHandle;
+
 	CCircuitUnit(const CCircuitUnit& that) = delete;
 	CCircuitUnit& operator=(const CCircuitUnit&) = delete;
 	CCircuitUnit(Id unitId, springai::Unit* unit, CCircuitDef* cdef);
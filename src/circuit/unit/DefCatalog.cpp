@@ -0,0 +1,63 @@
+/*
+ * DefCatalog.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "unit/DefCatalog.h"
+#include "terrain/TerrainData.h"
+#include "CircuitAI.h"
+#include "util/utils.h"
+
+#include "OOAICallback.h"
+#include "Resource.h"
+
+namespace circuit {
+
+using namespace springai;
+
+CDefCatalog::CDefCatalog()
+		: maxDecloak(.0f)
+		, isInitialized(false)
+{
+}
+
+CDefCatalog::~CDefCatalog()
+{
+	PRINT_DEBUG("Execute: %s\n", __PRETTY_FUNCTION__);
+}
+
+void CDefCatalog::Init(CCircuitAI* circuit, CTerrainData& terrainData)
+{
+	Resource* res = circuit->GetCallback()->GetResourceByName("Metal");
+	auto unitDefs = std::move(circuit->GetCallback()->GetUnitDefs());
+	// NOTE: defs must not reallocate, CCircuitDef keeps pointers
+	defs.reserve(unitDefs.size());
+	for (UnitDef* ud : unitDefs) {
+		auto options = std::move(ud->GetBuildOptions());
+		std::unordered_set<CCircuitDef::Id> opts;
+		for (UnitDef* buildDef : options) {
+			opts.insert(buildDef->GetUnitDefId());
+			delete buildDef;
+		}
+		defIdxs[ud->GetUnitDefId()] = defs.size();
+		defs.emplace_back(circuit, ud, opts, res);
+		maxDecloak = std::max(maxDecloak, defs.back().decloakDistance);
+		delete ud;
+	}
+	delete res;
+
+	for (CCircuitDef::SShared& data : defs) {
+		data.Init(*this, terrainData);
+	}
+	isInitialized = true;
+}
+
+const CCircuitDef::SShared* CDefCatalog::GetShared(CCircuitDef::Id unitDefId) const
+{
+	auto it = defIdxs.find(unitDefId);
+	return (it != defIdxs.end()) ? &defs[it->second] : nullptr;
+}
+
+} // namespace circuit
@@ -0,0 +1,53 @@
+/*
+ * DefCatalog.h
+ *
+ *  Process-wide table of immutable CCircuitDef data
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UNIT_DEFCATALOG_H_
+#define SRC_CIRCUIT_UNIT_DEFCATALOG_H_
+
+#include "unit/CircuitDef.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace circuit {
+
+class CCircuitAI;
+class CTerrainData;
+
+/*
+ * Weapons, ranges, threat and build options don't depend on AI instance,
+ * so the first AI evaluates them and others only wrap the result.
+ * NOTE: Categories of CCircuitAI are derived from game's category names, equal for all AIs.
+ */
+class CDefCatalog {
+public:
+	using Defs = std::vector<CCircuitDef::SShared>;
+
+	CDefCatalog();
+	virtual ~CDefCatalog();
+
+	/*
+	 * @param terrainData  must be initialized
+	 */
+	void Init(CCircuitAI* circuit, CTerrainData& terrainData);
+	bool IsInitialized() const { return isInitialized; }
+
+	const Defs& GetDefs() const { return defs; }
+	const CCircuitDef::SShared* GetShared(CCircuitDef::Id unitDefId) const;
+	float GetMaxDecloak() const { return maxDecloak; }
+
+private:
+	Defs defs;
+	std::unordered_map<CCircuitDef::Id, unsigned> defIdxs;  // unitDefId: index in defs
+	float maxDecloak;
+	bool isInitialized;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UNIT_DEFCATALOG_H_
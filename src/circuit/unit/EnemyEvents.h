@@ -0,0 +1,128 @@
+/*
+ * EnemyEvents.h
+ *
+ *  Per-frame accumulator of enemy LOS, radar and damage events
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UNIT_ENEMYEVENTS_H_
+#define SRC_CIRCUIT_UNIT_ENEMYEVENTS_H_
+
+#include "util/SlotMap.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Engine reports every LOS/radar edge: army at the edge of LOS flickers
+ * enter/leave several times within one frame. Events only update visibility bits
+ * of the record; net transitions (state at first event vs last event) are applied
+ * once by the consumer, so threat layers are touched once per enemy per frame.
+ * Records keep order of the first event of the frame.
+ * NOTE: Consumer applies enters right away until one of them reads enemy's position
+ *       (see Take, IsSighted): position is readable only while enemy is visible, even if it
+ *       leaves within the frame. Engine doesn't move units between events of one frame,
+ *       so enters after the sighting can't move its threat and are coalesced.
+ * T is CEnemyUnit, or any type with GetId(), IsInLOS() and IsInRadar().
+ */
+template <typename T>
+class CEnemyEvents {
+public:
+	enum Mask: uint8_t {NONE = 0x00, LOS = 0x01, RADAR = 0x02};
+
+	struct SRecord {
+		T* enemy;  // nullptr if destroyed within frame
+		uint8_t initState;  // Mask at the first event
+		uint8_t state;  // Mask after the last event
+		bool isSighted;  // position was read out of batch this frame
+		bool isDamaged;
+
+		bool IsEnter(Mask m) const { return !(initState & m) && (state & m); }
+		bool IsLeave(Mask m) const { return (initState & m) && !(state & m); }
+	};
+
+	void EnterLOS(T* enemy) { Touch(enemy).state |= LOS; }
+	void LeaveLOS(T* enemy) { Touch(enemy).state &= ~LOS; }
+	void EnterRadar(T* enemy) { Touch(enemy).state |= RADAR; }
+	void LeaveRadar(T* enemy) { Touch(enemy).state &= ~RADAR; }
+	void Damaged(T* enemy) { Touch(enemy).isDamaged = true; }
+
+	/*
+	 * Enemy is destroyed, its pending transitions are dropped
+	 */
+	void Forget(T* enemy) {
+		auto it = index.find(enemy->GetId());
+		if (it != index.end()) {
+			records[it->second].enemy = nullptr;
+			index.erase(it);
+		}
+	}
+	/*
+	 * Removes pending events of enemy to apply them and an enter out of batch,
+	 * later events of the frame start a new record at the same place
+	 * @param isSighted  applied enter reads position (all but radar contact of enemy in LOS)
+	 * @return record with enemy == nullptr if there were no events
+	 */
+	SRecord Take(T* enemy, bool isSighted) {
+		auto it = index.find(enemy->GetId());
+		if (it == index.end()) {
+			index[enemy->GetId()] = records.size();
+			records.push_back(SRecord{nullptr, NONE, NONE, isSighted, false});
+			return SRecord{nullptr, NONE, NONE, false, false};
+		}
+		SRecord& pending = records[it->second];
+		SRecord record = pending;
+		pending.enemy = nullptr;
+		pending.isSighted |= isSighted;
+		return record;
+	}
+	bool IsSighted(const T* enemy) const {
+		auto it = index.find(enemy->GetId());
+		return (it != index.end()) && records[it->second].isSighted;
+	}
+
+	/*
+	 * State with pending events applied
+	 */
+	uint8_t GetState(const T* enemy) const {
+		auto it = index.find(enemy->GetId());
+		return ((it != index.end()) && (records[it->second].enemy != nullptr))
+				? records[it->second].state
+				: StateOf(enemy);
+	}
+
+	bool IsEmpty() const { return index.empty(); }
+	const std::vector<SRecord>& GetRecords() const { return records; }
+	void Clear() {
+		records.clear();
+		index.clear();
+	}
+
+private:
+	SRecord& Touch(T* enemy) {
+		auto it = index.find(enemy->GetId());
+		if (it == index.end()) {
+			index[enemy->GetId()] = records.size();
+			records.push_back(SRecord{enemy, StateOf(enemy), StateOf(enemy), false, false});
+			return records.back();
+		}
+		SRecord& record = records[it->second];
+		if (record.enemy == nullptr) {  // taken
+			record = SRecord{enemy, StateOf(enemy), StateOf(enemy), record.isSighted, false};
+		}
+		return record;
+	}
+	static uint8_t StateOf(const T* enemy) {
+		return (enemy->IsInLOS() ? LOS : NONE) | (enemy->IsInRadar() ? RADAR : NONE);
+	}
+
+	std::vector<SRecord> records;
+	CSlotMap<int, unsigned> index;  // enemy id: index of record
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UNIT_ENEMYEVENTS_H_
@@ -7,6 +7,7 @@
 
 #include "unit/EnemyUnit.h"
 #include "task/fighter/FighterTask.h"
+#include "util/SaveState.h"
 #include "util/utils.h"
 
 namespace circuit {
@@ -80,4 +81,28 @@ void CEnemyUnit::SetNewPos(const AIFloat3& p) {
 	CTerrainData::CorrectPosition(newPos);
 }
 
+void CEnemyUnit::Save(SEnemyState& state) const
+{
+	state.unitId = id;
+	state.defId = (circuitDef == nullptr) ? -1 : circuitDef->GetId();
+	state.lastSeen = lastSeen;
+	state.cost = cost;
+	state.pos = pos;
+	state.newPos = newPos;
+	state.threat = threat;
+	state.range = range;
+	state.losStatus = losStatus;
+}
+
+void CEnemyUnit::Load(const SEnemyState& state)
+{
+	lastSeen = state.lastSeen;
+	cost = state.cost;
+	pos = state.pos;
+	newPos = state.newPos;
+	threat = state.threat;
+	range = state.range;
+	losStatus = state.losStatus;
+}
+
 } // namespace circuit
@@ -10,15 +10,17 @@
 
 #include "unit/CoreUnit.h"
 #include "unit/CircuitDef.h"
-
-#include <set>
+#include "util/SmallSet.h"
 
 namespace circuit {
 
 class IFighterTask;
+struct SEnemyState;
 
 class CEnemyUnit: public ICoreUnit {
 public:
+	using Tasks = CSmallSet<IFighterTask*, 4>;
+
 	CEnemyUnit(const CEnemyUnit& that) = delete;
 	CEnemyUnit& operator=(const CEnemyUnit&) = delete;
 	CEnemyUnit(Id unitId, springai::Unit* unit, CCircuitDef* cdef);
@@ -28,7 +30,7 @@ public:
 
 	void BindTask(IFighterTask* task) { tasks.insert(task); }
 	void UnbindTask(IFighterTask* task) { tasks.erase(task); }
-	const std::set<IFighterTask*>& GetTasks() const { return tasks; }
+	const Tasks& GetTasks() const { return tasks; }
 
 	void SetLastSeen(int frame) { lastSeen = frame; }
 	int GetLastSeen() const { return lastSeen; }
@@ -53,8 +55,15 @@ public:
 	void SetRange(CCircuitDef::ThreatType t, int r) { range[static_cast<CCircuitDef::ThreatT>(t)] = r; }
 	int GetRange(CCircuitDef::ThreatType t = CCircuitDef::ThreatType::MAX) const { return range[static_cast<CCircuitDef::ThreatT>(t)]; }
 
+	/*
+	 * Memory of enemy: last seen position, threat, ranges, cost and LOS state.
+	 * Def is restored by caller before Load, cost depends on it.
+	 */
+	void Save(SEnemyState& state) const;
+	void Load(const SEnemyState& state);
+
 private:
-	std::set<IFighterTask*> tasks;
+	Tasks tasks;
 	int lastSeen;
 
 	float cost;
@@ -50,11 +50,13 @@ void CMoveAction::Update(CCircuitAI* circuit)
 											  {pos.x, pos.y, pos.z},
 											  UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY,
 											  frame + FRAMES_PER_SEC * 60);
-		unit->GetUnit()->ExecuteCustomCommand(CMD_WANTED_SPEED, {stepSpeed});
+		if (IsNewSpeed(stepSpeed)) {
+			unit->GetUnit()->ExecuteCustomCommand(CMD_WANTED_SPEED, {stepSpeed});
+		}
 
 		constexpr short options = UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY;
 		for (int i = 2; (step < pathMaxIndex) && (i < 4); ++i) {
-			step = std::min(step + increment, pathMaxIndex);
+			step = GetNextStep(step, pathMaxIndex);
 			const AIFloat3& pos = (*pPath)[step];
 //			unit->GetUnit()->MoveTo(pos, options, frame + FRAMES_PER_SEC * 60 * i);
 			unit->GetUnit()->ExecuteCustomCommand(CMD_RAW_MOVE,
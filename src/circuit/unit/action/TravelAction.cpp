@@ -8,17 +8,27 @@
 #include "unit/action/TravelAction.h"
 #include "unit/CircuitUnit.h"
 #include "unit/CircuitDef.h"
+#include "unit/UnitManager.h"
+#include "terrain/PathFinder.h"
+#include "CircuitAI.h"
 #include "util/utils.h"
 
+#include <algorithm>
+
 namespace circuit {
 
 using namespace springai;
 
+#define RESEND_INTERVAL		(FRAMES_PER_SEC * 5)
+
 ITravelAction::ITravelAction(CCircuitUnit* owner, Type type, int squareSize, float speed)
 		: IUnitAction(owner, type)
 		, speed(speed)
 		, pathIterator(0)
 		, isForce(true)
+		, sentSpeed(-1.f)
+		, sentStep(-1)
+		, sentFrame(-1)
 {
 	CCircuitUnit* unit = static_cast<CCircuitUnit*>(ownerList);
 	CCircuitDef* cdef = unit->GetCircuitDef();
@@ -40,6 +50,7 @@ ITravelAction::ITravelAction(CCircuitUnit* owner, Type type, const std::shared_p
 		: ITravelAction(owner, type, squareSize, speed)
 {
 	this->pPath = pPath;
+	PullString();
 }
 
 ITravelAction::~ITravelAction()
@@ -52,6 +63,9 @@ void ITravelAction::SetPath(const std::shared_ptr<F3Vec>& pPath, float speed)
 	this->pPath = pPath;
 	this->speed = speed;
 	isForce = true;
+	sentSpeed = -1.f;
+	sentStep = -1;
+	PullString();
 }
 
 int ITravelAction::CalcSpeedStep(int frame, float& stepSpeed)
@@ -59,15 +73,18 @@ int ITravelAction::CalcSpeedStep(int frame, float& stepSpeed)
 	CCircuitUnit* unit = static_cast<CCircuitUnit*>(ownerList);
 	const AIFloat3& pos = unit->GetPos(frame);
 	int pathMaxIndex = pPath->size() - 1;
+	if (!corners.empty() && (corners.back() != pathMaxIndex)) {
+		corners.clear();  // path was changed in place
+	}
 
 	int lastStep = pathIterator;
 	float sqDistToStep = pos.SqDistance2D((*pPath)[pathIterator]);
-	int step = std::min(pathIterator + increment, pathMaxIndex);
+	int step = GetNextStep(pathIterator, pathMaxIndex);
 	float sqNextDistToStep = pos.SqDistance2D((*pPath)[step]);
 	while ((sqNextDistToStep < sqDistToStep) && (pathIterator <  pathMaxIndex)) {
 		pathIterator = step;
 		sqDistToStep = sqNextDistToStep;
-		step = std::min(pathIterator + increment, pathMaxIndex);
+		step = GetNextStep(pathIterator, pathMaxIndex);
 		sqNextDistToStep = pos.SqDistance2D((*pPath)[step]);
 	}
 
@@ -76,10 +93,48 @@ int ITravelAction::CalcSpeedStep(int frame, float& stepSpeed)
 	} else {
 		stepSpeed = speed;
 	}
+	// Don't resend the same target, unless engine could drop it
+	if (!isForce && (step == sentStep) && (frame < sentFrame + RESEND_INTERVAL)) {
+		return -1;
+	}
 	pathIterator = step;
 
 	isForce = false;
+	sentStep = step;
+	sentFrame = frame;
 	return pathMaxIndex;
 }
 
+int ITravelAction::GetNextStep(int step, int pathMaxIndex) const
+{
+	if (corners.empty()) {
+		return std::min(step + increment, pathMaxIndex);
+	}
+	auto it = std::upper_bound(corners.begin(), corners.end(), step);
+	return (it != corners.end()) ? *it : pathMaxIndex;
+}
+
+bool ITravelAction::IsNewSpeed(float stepSpeed)
+{
+	if (stepSpeed == sentSpeed) {
+		return false;
+	}
+	sentSpeed = stepSpeed;
+	return true;
+}
+
+void ITravelAction::PullString()
+{
+	corners.clear();
+	if ((pPath == nullptr) || (pPath->size() < 3)) {
+		return;
+	}
+	CCircuitUnit* unit = static_cast<CCircuitUnit*>(ownerList);
+	if (unit->GetManager() == nullptr) {
+		return;
+	}
+	CCircuitAI* circuit = unit->GetManager()->GetCircuit();
+	circuit->GetPathfinder()->PullString(unit, circuit->GetThreatMap(), circuit->GetLastFrame(), *pPath, corners);
+}
+
 } // namespace circuit
@@ -12,6 +12,7 @@
 #include "util/Defines.h"
 
 #include <memory>
+#include <vector>
 
 namespace circuit {
 
@@ -24,14 +25,29 @@ public:
 	void SetPath(const std::shared_ptr<F3Vec>& pPath, float speed = NO_SPEED_LIMIT);
 
 protected:
+	/*
+	 * @return -1 if unit already has the order, otherwise caller sends move to pathIterator
+	 */
 	int CalcSpeedStep(int frame, float& stepSpeed);
+	int GetNextStep(int step, int pathMaxIndex) const;
+	/*
+	 * CMD_WANTED_SPEED is needed only if speed differs from the last one sent
+	 */
+	bool IsNewSpeed(float stepSpeed);
 
 	std::shared_ptr<F3Vec> pPath;
+	std::vector<int> corners;  // indices of pPath to move by, empty to use increment
 	float speed;
 	int pathIterator;
 	int increment;
 	int minSqDist;
 	bool isForce;
+	float sentSpeed;
+	int sentStep;  // path index of the last target sent, -1 if none
+	int sentFrame;
+
+private:
+	void PullString();
 };
 
 } // namespace circuit
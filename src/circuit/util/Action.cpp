@@ -10,6 +10,12 @@
 
 namespace circuit {
 
+IAction::Pool& IAction::GetPool()
+{
+	static Pool pool;
+	return pool;
+}
+
 IAction::IAction(CActionList* owner)
 		: ownerList(owner)
 		, isFinished(false)
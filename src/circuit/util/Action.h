@@ -9,12 +9,22 @@
 #ifndef SRC_CIRCUIT_UTIL_ACTION_H_
 #define SRC_CIRCUIT_UTIL_ACTION_H_
 
+#include "util/ObjectPool.h"
+
 namespace circuit {
 
 class CActionList;
 class CCircuitAI;
 
 class IAction {
+public:
+	using Pool = CObjectPool<IAction>;
+	using Handle = Pool::SHandle;
+
+	static Pool& GetPool();
+	static void* operator new(std::size_t size) { return GetPool().Allocate(size); }
+	static void operator delete(void* ptr) { GetPool().Deallocate(ptr); }
+
 protected:
 	IAction(CActionList* owner);
 public:
@@ -30,6 +40,7 @@ public:
 	bool IsBlocking() const { return isBlocking; }
 	void SetActive(bool value) { isActive = value; }
 	bool IsActive() const { return isActive; }
+	Handle GetHandle() const { return GetPool().GetHandle(dynamic_cast<const void*>(this)); }
 
 protected:
 	CActionList* ownerList;
@@ -0,0 +1,71 @@
+/*
+ * FrameBudget.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "util/FrameBudget.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <string>
+
+namespace circuit {
+
+CFrameBudget::CFrameBudget(const char* name)
+		: budget(clock::duration::zero())
+		, count(0)
+		, quota(0)
+		, processed(0)
+		, debt(0)
+		, isExpired(false)
+{
+	const std::string prefix(name);
+	overrunId = CProfiler::RegisterScope((prefix + "::overrun").c_str());
+	overrunTimeId = CProfiler::RegisterScope((prefix + "::overrunUs").c_str());
+	deferId = CProfiler::RegisterScope((prefix + "::deferred").c_str());
+}
+
+void CFrameBudget::Start(unsigned count, unsigned rate)
+{
+	this->count = count;
+	// Debt can't exceed one full cycle
+	debt = std::min(debt, count);
+	quota = count / rate + 1 + debt;
+	processed = 0;
+	isExpired = false;
+	t0 = clock::now();
+}
+
+bool CFrameBudget::IsAvailable()
+{
+	if (processed >= quota) {
+		return false;
+	}
+	if ((processed == 0) || (budget <= clock::duration::zero())) {
+		return true;
+	}
+	isExpired = (clock::now() - t0 >= budget);
+	return !isExpired;
+}
+
+void CFrameBudget::Finish()
+{
+	// Loop may stop at the end of items (cycle wrap), debt is kept only for budget stops
+	debt = isExpired ? std::min(quota - processed, count) : 0;
+
+	if ((budget <= clock::duration::zero()) || !CProfiler::IsEnabled()) {
+		return;
+	}
+	const clock::duration elapsed = clock::now() - t0;
+	if (elapsed > budget) {
+		CProfiler::Count(overrunId, 1);
+		CProfiler::Count(overrunTimeId, std::chrono::duration_cast<std::chrono::microseconds>(elapsed - budget).count());
+	}
+	if (debt > 0) {
+		CProfiler::Count(deferId, debt);
+	}
+}
+
+} // namespace circuit
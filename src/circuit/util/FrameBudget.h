@@ -0,0 +1,61 @@
+/*
+ * FrameBudget.h
+ *
+ *  Time budget governor for staggered per-frame update loops
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_FRAMEBUDGET_H_
+#define SRC_CIRCUIT_UTIL_FRAMEBUDGET_H_
+
+#include <chrono>
+
+namespace circuit {
+
+/*
+ * Loop visits items round-robin, so the longest waiting item is always next (aging).
+ * Base quota (count / rate + 1) keeps the old cycle length; items not processed because
+ * budget ran out become debt of the next frames. Expensive frame is spread over the
+ * following cheap ones instead of piling up, and no item waits forever.
+ * At least one item is processed per frame.
+ * Usage:
+ *   budget.Start(items.size(), RATE);
+ *   while (... && budget.IsAvailable()) { ...; budget.Done(); }
+ *   budget.Finish();
+ */
+class CFrameBudget {
+public:
+	using clock = std::chrono::steady_clock;
+
+	CFrameBudget(const char* name);
+
+	/*
+	 * @param budgetUs  microseconds per frame, <= 0 for no limit
+	 */
+	void SetBudget(int budgetUs) { budget = std::chrono::microseconds(budgetUs); }
+
+	void Start(unsigned count, unsigned rate);
+	bool IsAvailable();
+	void Done() { ++processed; }
+	void Finish();
+
+	unsigned GetDebt() const { return debt; }
+
+private:
+	int overrunId;  // profiler counters
+	int overrunTimeId;
+	int deferId;
+
+	clock::duration budget;
+	clock::time_point t0;
+	unsigned count;
+	unsigned quota;
+	unsigned processed;
+	unsigned debt;  // items deferred by previous frames
+	bool isExpired;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_FRAMEBUDGET_H_
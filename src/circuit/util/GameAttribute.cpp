@@ -8,6 +8,7 @@
 #include "util/GameAttribute.h"
 #include "util/utils.h"
 #include "CircuitAI.h"
+#include "json/json.h"
 
 namespace circuit {
 
@@ -38,4 +39,10 @@ void CGameAttribute::SetGameEnd(bool value)
 	isGameEnd = value;
 }
 
+CGameAttribute::ConfigPtr CGameAttribute::GetConfig(uint64_t hash) const
+{
+	auto it = configs.find(hash);
+	return (it != configs.end()) ? it->second : nullptr;
+}
+
 } // namespace circuit
@@ -11,7 +11,11 @@
 #include "setup/SetupData.h"
 #include "resource/MetalData.h"
 #include "terrain/TerrainData.h"
+#include "unit/DefCatalog.h"
+#include "json/json-forwards.h"
 
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace circuit {
@@ -21,6 +25,7 @@ class CCircuitAI;
 class CGameAttribute {
 public:
 	using Circuits = std::unordered_set<CCircuitAI*>;
+	using ConfigPtr = std::shared_ptr<const Json::Value>;
 
 	CGameAttribute(unsigned int seed);
 	virtual ~CGameAttribute();
@@ -34,6 +39,13 @@ public:
 	CSetupData& GetSetupData() { return setupData; }
 	CMetalData& GetMetalData() { return metalData; }
 	CTerrainData& GetTerrainData() { return terrainData; }
+	CDefCatalog& GetDefCatalog() { return defCatalog; }
+
+	/*
+	 * Parsed config by hash of its sources and overrides
+	 */
+	ConfigPtr GetConfig(uint64_t hash) const;
+	void SetConfig(uint64_t hash, const ConfigPtr& config) { configs[hash] = config; }
 
 private:
 	bool isGameEnd;
@@ -41,6 +53,8 @@ private:
 	CSetupData setupData;
 	CMetalData metalData;
 	CTerrainData terrainData;
+	CDefCatalog defCatalog;
+	std::unordered_map<uint64_t, ConfigPtr> configs;
 };
 
 } // namespace circuit
@@ -0,0 +1,100 @@
+/*
+ * ObjectPool.h
+ *
+ *  Slab pool for polymorphic objects of one hierarchy (tasks, actions)
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_OBJECTPOOL_H_
+#define SRC_CIRCUIT_UTIL_OBJECTPOOL_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Derived classes differ in size, so every size class (ALIGN step) has own slabs of SLAB_SLOTS slots.
+ * Freed slots go to per-class free list and are reused LIFO, slabs are kept until Trim().
+ * Every slot carries generation counter, bumped on free: SHandle of dead object never resolves.
+ * NOTE: Not thread-safe, tasks and actions live in main thread only.
+ *       T must be the primary base of pooled classes (single inheritance), Resolve() relies on it.
+ */
+template <typename T>
+class CObjectPool {
+public:
+	static constexpr std::size_t ALIGN = 16;
+	static constexpr std::size_t MAX_SIZE = 1024;  // larger objects fall back to global heap
+	static constexpr std::size_t NUM_CLASSES = MAX_SIZE / ALIGN;
+	static constexpr unsigned SLAB_SLOTS = 64;
+
+	struct SHandle {
+		uint32_t id;  // size class << 24 | slot
+		uint32_t generation;
+
+		bool operator==(const SHandle& other) const { return (id == other.id) && (generation == other.generation); }
+		bool operator!=(const SHandle& other) const { return !(*this == other); }
+	};
+	static constexpr SHandle INVALID_HANDLE = {0xFFFFFFFF, 0};
+
+	CObjectPool();
+	CObjectPool(const CObjectPool&) = delete;  // disable copying
+	~CObjectPool();
+
+	void* Allocate(std::size_t size);
+	void Deallocate(void* ptr);
+
+	/*
+	 * @param ptr  address of the most derived object, i.e. dynamic_cast<const void*>(obj)
+	 */
+	SHandle GetHandle(const void* ptr) const;
+	/*
+	 * nullptr if object was freed (slot may be reused by another object)
+	 */
+	T* Resolve(const SHandle& handle) const;
+
+	/*
+	 * Release slabs of size classes without live objects
+	 */
+	void Trim();
+
+	std::size_t GetLiveCount() const { return liveCount; }
+	std::size_t GetSlabCount() const { return slabCount; }
+
+	CObjectPool& operator=(const CObjectPool&) = delete;  // disable assignment
+
+private:
+	struct alignas(ALIGN) SSlotHeader {
+		uint32_t generation;
+		uint32_t slot;  // index within size class
+		uint16_t sizeClass;  // NUM_CLASSES for heap fallback
+		bool isAlive;
+	};
+	struct SFreeNode {
+		SFreeNode* next;
+	};
+	struct SSizeClass {
+		std::vector<char*> slabs;
+		SFreeNode* freeList = nullptr;
+		std::size_t liveCount = 0;
+		uint32_t baseGeneration = 0;  // of new slabs, keeps handles stale across Trim()
+	};
+
+	static std::size_t Stride(std::size_t sizeClass) { return sizeof(SSlotHeader) + (sizeClass + 1) * ALIGN; }
+	static SSlotHeader* HeaderOf(const void* ptr) {
+		return reinterpret_cast<SSlotHeader*>(static_cast<char*>(const_cast<void*>(ptr)) - sizeof(SSlotHeader));
+	}
+	void NewSlab(std::size_t sizeClass);
+
+	SSizeClass classes[NUM_CLASSES];
+	std::size_t liveCount;
+	std::size_t slabCount;
+};
+
+} // namespace circuit
+
+#include "util/ObjectPool.hpp"
+
+#endif // SRC_CIRCUIT_UTIL_OBJECTPOOL_H_
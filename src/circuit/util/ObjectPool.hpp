@@ -0,0 +1,168 @@
+/*
+ * ObjectPool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_OBJECTPOOL_H_
+#	error "Don't include this file directly, include ObjectPool.h instead"
+#endif
+
+#include "util/ObjectPool.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <new>
+#include <cassert>
+
+namespace circuit {
+
+template <typename T>
+constexpr typename CObjectPool<T>::SHandle CObjectPool<T>::INVALID_HANDLE;
+
+template <typename T>
+CObjectPool<T>::CObjectPool()
+		: liveCount(0)
+		, slabCount(0)
+{
+}
+
+template <typename T>
+CObjectPool<T>::~CObjectPool()
+{
+	for (SSizeClass& sc : classes) {
+		for (char* slab : sc.slabs) {
+			::operator delete(slab);
+		}
+	}
+}
+
+template <typename T>
+void* CObjectPool<T>::Allocate(std::size_t size)
+{
+	++liveCount;
+	const std::size_t sizeClass = (size + ALIGN - 1) / ALIGN - 1;
+	if (sizeClass >= NUM_CLASSES) {
+		char* mem = static_cast<char*>(::operator new(sizeof(SSlotHeader) + size));
+		SSlotHeader* header = reinterpret_cast<SSlotHeader*>(mem);
+		header->generation = 0;
+		header->slot = 0;
+		header->sizeClass = NUM_CLASSES;
+		header->isAlive = true;
+		return mem + sizeof(SSlotHeader);
+	}
+
+	SSizeClass& sc = classes[sizeClass];
+	if (sc.freeList == nullptr) {
+		NewSlab(sizeClass);
+	}
+	SFreeNode* node = sc.freeList;
+	sc.freeList = node->next;
+	++sc.liveCount;
+
+	SSlotHeader* header = HeaderOf(node);
+	header->isAlive = true;
+	return node;
+}
+
+template <typename T>
+void CObjectPool<T>::Deallocate(void* ptr)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+	--liveCount;
+	SSlotHeader* header = HeaderOf(ptr);
+	assert(header->isAlive);
+	header->isAlive = false;
+	if (header->sizeClass == NUM_CLASSES) {
+		::operator delete(header);
+		return;
+	}
+
+	++header->generation;
+	SSizeClass& sc = classes[header->sizeClass];
+	SFreeNode* node = static_cast<SFreeNode*>(ptr);
+	node->next = sc.freeList;
+	sc.freeList = node;
+	--sc.liveCount;
+}
+
+template <typename T>
+typename CObjectPool<T>::SHandle CObjectPool<T>::GetHandle(const void* ptr) const
+{
+	const SSlotHeader* header = HeaderOf(ptr);
+	if (header->sizeClass == NUM_CLASSES) {
+		return INVALID_HANDLE;
+	}
+	return {(uint32_t(header->sizeClass) << 24) | header->slot, header->generation};
+}
+
+template <typename T>
+T* CObjectPool<T>::Resolve(const SHandle& handle) const
+{
+	const std::size_t sizeClass = handle.id >> 24;
+	if (sizeClass >= NUM_CLASSES) {
+		return nullptr;
+	}
+	const SSizeClass& sc = classes[sizeClass];
+	const uint32_t slot = handle.id & 0x00FFFFFF;
+	if (slot / SLAB_SLOTS >= sc.slabs.size()) {
+		return nullptr;
+	}
+	char* mem = sc.slabs[slot / SLAB_SLOTS] + (slot % SLAB_SLOTS) * Stride(sizeClass);
+	SSlotHeader* header = reinterpret_cast<SSlotHeader*>(mem);
+	if (!header->isAlive || (header->generation != handle.generation)) {
+		return nullptr;
+	}
+	return reinterpret_cast<T*>(mem + sizeof(SSlotHeader));
+}
+
+template <typename T>
+void CObjectPool<T>::Trim()
+{
+	for (SSizeClass& sc : classes) {
+		if (sc.liveCount > 0) {
+			continue;
+		}
+		const std::size_t stride = Stride(&sc - classes);
+		for (char* slab : sc.slabs) {
+			for (unsigned i = 0; i < SLAB_SLOTS; ++i) {
+				SSlotHeader* header = reinterpret_cast<SSlotHeader*>(slab + i * stride);
+				sc.baseGeneration = std::max(sc.baseGeneration, header->generation + 1);
+			}
+			::operator delete(slab);
+		}
+		slabCount -= sc.slabs.size();
+		sc.slabs.clear();
+		sc.freeList = nullptr;
+	}
+}
+
+template <typename T>
+void CObjectPool<T>::NewSlab(std::size_t sizeClass)
+{
+	PROFILE_COUNT("CObjectPool::NewSlab", 1);
+	SSizeClass& sc = classes[sizeClass];
+	const std::size_t stride = Stride(sizeClass);
+	// NOTE: global operator new guarantees at least ALIGN alignment on supported platforms
+	char* slab = static_cast<char*>(::operator new(stride * SLAB_SLOTS));
+	const uint32_t firstSlot = sc.slabs.size() * SLAB_SLOTS;
+	sc.slabs.push_back(slab);
+	++slabCount;
+
+	// Link in reverse to hand out slots in address order
+	for (int i = SLAB_SLOTS - 1; i >= 0; --i) {
+		SSlotHeader* header = reinterpret_cast<SSlotHeader*>(slab + i * stride);
+		header->generation = sc.baseGeneration;
+		header->slot = firstSlot + i;
+		header->sizeClass = sizeClass;
+		header->isAlive = false;
+		SFreeNode* node = reinterpret_cast<SFreeNode*>(slab + i * stride + sizeof(SSlotHeader));
+		node->next = sc.freeList;
+		sc.freeList = node;
+	}
+}
+
+} // namespace circuit
@@ -0,0 +1,169 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "util/Profiler.h"
+
+#include <algorithm>
+
+namespace circuit {
+
+std::atomic<bool> CProfiler::isEnabled(false);
+spring::mutex CProfiler::mutex;
+std::vector<std::string> CProfiler::names(MAX_SCOPES);
+std::atomic<int> CProfiler::scopeCount(0);
+std::vector<CProfiler::SThreadBuffer*> CProfiler::buffers;
+
+int CProfiler::RegisterScope(const char* name)
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+	const int count = scopeCount.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i) {
+		if (names[i] == name) {
+			return i;
+		}
+	}
+	if (count >= MAX_SCOPES) {
+		return -1;
+	}
+	names[count] = name;
+	scopeCount.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+CProfiler::SThreadBuffer* CProfiler::GetThreadBuffer()
+{
+	static thread_local SThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr) {
+		buffer = new SThreadBuffer;
+		std::lock_guard<spring::mutex> lock(mutex);
+		buffers.push_back(buffer);
+	}
+	return buffer;
+}
+
+void CProfiler::Record(int scopeId, uint64_t ns)
+{
+	if (scopeId < 0) {
+		return;
+	}
+	// Only owner thread writes into its buffer: relaxed load/store instead of RMW
+	SScopeStats& stats = GetThreadBuffer()->scopes[scopeId];
+	stats.count.store(stats.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	stats.total.store(stats.total.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+	if (stats.max.load(std::memory_order_relaxed) < ns) {
+		stats.max.store(ns, std::memory_order_relaxed);
+	}
+	std::atomic<uint32_t>& bucket = stats.hist[BucketOf(ns)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void CProfiler::Count(int scopeId, uint64_t value)
+{
+	if (scopeId < 0) {
+		return;
+	}
+	SScopeStats& stats = GetThreadBuffer()->scopes[scopeId];
+	stats.count.store(stats.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	stats.total.store(stats.total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	if (stats.max.load(std::memory_order_relaxed) < value) {
+		stats.max.store(value, std::memory_order_relaxed);
+	}
+}
+
+std::vector<CProfiler::SSummary> CProfiler::Collect()
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+	const int count = scopeCount.load(std::memory_order_acquire);
+	std::vector<SSummary> result;
+	std::vector<uint64_t> hist(BUCKETS);
+
+	for (int i = 0; i < count; ++i) {
+		SSummary summary = {names[i], 0, 0, 0, 0, 0};
+		std::fill(hist.begin(), hist.end(), 0);
+		uint64_t samples = 0;
+		for (SThreadBuffer* buffer : buffers) {
+			const SScopeStats& stats = buffer->scopes[i];
+			summary.count += stats.count.load(std::memory_order_relaxed);
+			summary.total += stats.total.load(std::memory_order_relaxed);
+			summary.max = std::max<uint64_t>(summary.max, stats.max.load(std::memory_order_relaxed));
+			for (int b = 0; b < BUCKETS; ++b) {
+				const uint32_t n = stats.hist[b].load(std::memory_order_relaxed);
+				hist[b] += n;
+				samples += n;
+			}
+		}
+		if (summary.count == 0) {
+			continue;
+		}
+
+		// counters (see Count) have no histogram
+		if (samples > 0) {
+			const uint64_t rank50 = (samples * 50 + 99) / 100;
+			const uint64_t rank99 = (samples * 99 + 99) / 100;
+			uint64_t acc = 0;
+			for (int b = 0; b < BUCKETS; ++b) {
+				if (hist[b] == 0) {
+					continue;
+				}
+				const uint64_t prev = acc;
+				acc += hist[b];
+				const uint64_t value = std::min(BucketValue(b), summary.max);
+				if ((prev < rank50) && (acc >= rank50)) {
+					summary.p50 = value;
+				}
+				if ((prev < rank99) && (acc >= rank99)) {
+					summary.p99 = value;
+					break;
+				}
+			}
+		}
+		result.push_back(summary);
+	}
+	return result;
+}
+
+void CProfiler::WriteCSV(std::ostream& os)
+{
+	os << "scope,count,total_ns,mean_ns,p50_ns,p99_ns,max_ns\n";
+	for (const SSummary& s : Collect()) {
+		os << '"' << s.name << "\"," << s.count << ',' << s.total << ',' << s.total / s.count << ','
+		   << s.p50 << ',' << s.p99 << ',' << s.max << '\n';
+	}
+}
+
+void CProfiler::WriteJSON(std::ostream& os)
+{
+	os << "[\n";
+	bool isFirst = true;
+	for (const SSummary& s : Collect()) {
+		if (!isFirst) {
+			os << ",\n";
+		}
+		isFirst = false;
+		os << "\t{\"scope\": \"" << s.name << "\", \"count\": " << s.count << ", \"total_ns\": " << s.total
+		   << ", \"mean_ns\": " << s.total / s.count << ", \"p50_ns\": " << s.p50 << ", \"p99_ns\": " << s.p99
+		   << ", \"max_ns\": " << s.max << "}";
+	}
+	os << "\n]\n";
+}
+
+void CProfiler::Reset()
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+	for (SThreadBuffer* buffer : buffers) {
+		for (SScopeStats& stats : buffer->scopes) {
+			stats.count.store(0, std::memory_order_relaxed);
+			stats.total.store(0, std::memory_order_relaxed);
+			stats.max.store(0, std::memory_order_relaxed);
+			for (std::atomic<uint32_t>& bucket : stats.hist) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+} // namespace circuit
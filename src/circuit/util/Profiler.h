@@ -0,0 +1,147 @@
+/*
+ * Profiler.h
+ *
+ *  Per-scope frame-time statistics with log-linear latency histograms
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_PROFILER_H_
+#define SRC_CIRCUIT_UTIL_PROFILER_H_
+
+#include "System/Threading/SpringThreading.h"
+
+#include <chrono>
+#include <array>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <ostream>
+
+namespace circuit {
+
+class CProfiler {
+public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr int MAX_SCOPES = 128;
+	/*
+	 * HDR-style buckets: 2^SUB_BITS linear sub-buckets per power of 2,
+	 * relative error of any reported percentile is below 1 / 2^SUB_BITS.
+	 */
+	static constexpr int SUB_BITS = 3;
+	static constexpr int SUB_COUNT = 1 << SUB_BITS;
+	static constexpr int MAX_EXP = 40;  // 2^40 ns ~ 18 min, longer samples are clamped
+	static constexpr int BUCKETS = (MAX_EXP - SUB_BITS + 1) * SUB_COUNT;
+
+	struct SScopeStats {
+		std::atomic<uint64_t> count{0};
+		std::atomic<uint64_t> total{0};  // ns
+		std::atomic<uint64_t> max{0};  // ns
+		std::array<std::atomic<uint32_t>, BUCKETS> hist{};
+	};
+
+	struct SSummary {
+		std::string name;
+		uint64_t count;
+		uint64_t total;
+		uint64_t p50;
+		uint64_t p99;
+		uint64_t max;
+	};
+
+	/*
+	 * Register named scope once, returns its id or -1 if table is full
+	 */
+	static int RegisterScope(const char* name);
+
+	static void SetEnabled(bool value) { isEnabled.store(value, std::memory_order_relaxed); }
+	static bool IsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+
+	/*
+	 * Add sample to calling thread's buffer. Single writer per buffer, no locks.
+	 */
+	static void Record(int scopeId, uint64_t ns);
+	/*
+	 * Add arbitrary counter value to named scope, i.e. cache hits or saved expansions
+	 */
+	static void Count(int scopeId, uint64_t value);
+
+	static std::vector<SSummary> Collect();
+	static void WriteCSV(std::ostream& os);
+	static void WriteJSON(std::ostream& os);
+	static void Reset();
+
+	static inline int BucketOf(uint64_t ns);
+	static inline uint64_t BucketValue(int bucket);
+
+private:
+	struct SThreadBuffer {
+		std::array<SScopeStats, MAX_SCOPES> scopes;
+	};
+	static SThreadBuffer* GetThreadBuffer();
+
+	static std::atomic<bool> isEnabled;
+	static spring::mutex mutex;  // guards registration only
+	static std::vector<std::string> names;
+	static std::atomic<int> scopeCount;
+	static std::vector<SThreadBuffer*> buffers;  // owner
+};
+
+inline int CProfiler::BucketOf(uint64_t ns)
+{
+	if (ns < SUB_COUNT) {
+		return ns;
+	}
+	int exp = 63 - __builtin_clzll(ns);
+	if (exp >= MAX_EXP) {
+		return BUCKETS - 1;
+	}
+	const int mantissa = (ns >> (exp - SUB_BITS)) & (SUB_COUNT - 1);
+	return (exp - SUB_BITS + 1) * SUB_COUNT + mantissa;
+}
+
+inline uint64_t CProfiler::BucketValue(int bucket)
+{
+	if (bucket < SUB_COUNT) {
+		return bucket;
+	}
+	const int exp = bucket / SUB_COUNT + SUB_BITS - 1;
+	const uint64_t mantissa = bucket & (SUB_COUNT - 1);
+	// upper bound of the bucket
+	return ((SUB_COUNT + mantissa + 1) << (exp - SUB_BITS)) - 1;
+}
+
+class CScopedProfile {
+public:
+	CScopedProfile(int scopeId)
+		: id(CProfiler::IsEnabled() ? scopeId : -1)
+	{
+		if (id >= 0) {
+			t0 = CProfiler::clock::now();
+		}
+	}
+	~CScopedProfile() {
+		if (id >= 0) {
+			CProfiler::Record(id, std::chrono::duration_cast<std::chrono::nanoseconds>(CProfiler::clock::now() - t0).count());
+		}
+	}
+private:
+	int id;
+	CProfiler::clock::time_point t0;
+};
+
+} // namespace circuit
+
+#define PROFILE_CONCAT_(a, b)	a##b
+#define PROFILE_CONCAT(a, b)	PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)	\
+	static const int PROFILE_CONCAT(profId, __LINE__) = circuit::CProfiler::RegisterScope(name);	\
+	circuit::CScopedProfile PROFILE_CONCAT(profScope, __LINE__)(PROFILE_CONCAT(profId, __LINE__))
+#define PROFILE_COUNT(name, value)	\
+	do {	\
+		static const int profCountId = circuit::CProfiler::RegisterScope(name);	\
+		if (circuit::CProfiler::IsEnabled()) circuit::CProfiler::Count(profCountId, value);	\
+	} while (false)
+
+#endif // SRC_CIRCUIT_UTIL_PROFILER_H_
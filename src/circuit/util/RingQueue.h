@@ -0,0 +1,106 @@
+/*
+ * RingQueue.h
+ *
+ *  Bounded lock-free multi-producer multi-consumer queue
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *      Origin: Dmitry Vyukov (http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue)
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_RINGQUEUE_H_
+#define SRC_CIRCUIT_UTIL_RINGQUEUE_H_
+
+#include "System/Threading/SpringThreading.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace circuit {
+
+/*
+ * Ring of cells, each cell has sequence number that tells whose turn it is: producer or consumer.
+ * Push and pop are one CAS on own index, producers don't contend with consumers.
+ * Mutex and condition variables are touched only by thread that has nothing to do
+ * (consumer of empty queue, producer of full queue) and went to sleep, and by the other
+ * side that sees a sleeper: no syscalls while queue is neither empty nor full.
+ */
+template <typename T>
+class CRingQueue {
+public:
+	using ProcessFunction = std::function<void (T& item)>;
+
+	/*
+	 * @param capacity rounded up to power of 2
+	 */
+	explicit CRingQueue(std::size_t capacity = 1024);
+	CRingQueue(const CRingQueue&) = delete; // disable copying
+	~CRingQueue();
+
+	/*
+	 * Pop object from queue if any exists and return it, otherwise wait for object to appear in queue
+	 */
+	T Pop();
+	/*
+	 * @see Pop()
+	 */
+	void Pop(T& item);
+	void Push(const T& item);
+	/*
+	 * Non-blocking versions, false if queue is empty / full
+	 */
+	bool TryPop(T& item);
+	bool TryPush(const T& item);
+	/*
+	 * Snapshot, may be outdated at return when other threads are active
+	 */
+	bool IsEmpty() const;
+	/*
+	 * Pop object if any exists in queue and process it, quit immediately otherwise
+	 */
+	void PopAndProcess(ProcessFunction process);
+	void Clear();
+
+	std::size_t GetCapacity() const { return mask + 1; }
+
+	CRingQueue& operator=(const CRingQueue&) = delete; // disable assignment
+
+private:
+	static constexpr std::size_t CACHE_LINE = 64;
+	static constexpr int SPIN_COUNT = 64;  // TryPop/TryPush attempts before sleep
+
+	struct SCell {
+		std::atomic<std::size_t> sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		T* Get() { return reinterpret_cast<T*>(&storage); }
+	};
+
+	/*
+	 * Ring operations without wakeup: safe inside wait predicate that holds _mutex
+	 * @param isRaw item points to uninitialized storage
+	 */
+	bool Dequeue(T* item, bool isRaw);
+	bool Enqueue(const T& item);
+	void Notify(std::atomic<int>& sleepers, spring::condition_variable_any& cond);
+	void NotifyPush();
+
+	std::unique_ptr<SCell[]> buffer;
+	std::size_t mask;
+
+	alignas(CACHE_LINE) std::atomic<std::size_t> enqueuePos;
+	alignas(CACHE_LINE) std::atomic<std::size_t> dequeuePos;
+
+	alignas(CACHE_LINE) std::atomic<int> popSleepers;
+	std::atomic<int> pushSleepers;
+	spring::mutex _mutex;
+	spring::condition_variable_any _condPop;  // not empty
+	spring::condition_variable_any _condPush;  // not full
+};
+
+} // namespace circuit
+
+#include "util/RingQueue.hpp"
+
+#endif // SRC_CIRCUIT_UTIL_RINGQUEUE_H_
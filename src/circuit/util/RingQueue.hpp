@@ -0,0 +1,228 @@
+/*
+ * RingQueue.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_RINGQUEUE_H_
+#	error "Don't include this file directly, include RingQueue.h instead"
+#endif
+
+#include "util/RingQueue.h"
+
+#include <cstdint>
+
+namespace circuit {
+
+template <typename T>
+constexpr std::size_t CRingQueue<T>::CACHE_LINE;
+template <typename T>
+constexpr int CRingQueue<T>::SPIN_COUNT;
+
+template <typename T>
+CRingQueue<T>::CRingQueue(std::size_t capacity)
+		: enqueuePos(0)
+		, dequeuePos(0)
+		, popSleepers(0)
+		, pushSleepers(0)
+{
+	std::size_t size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	mask = size - 1;
+	buffer.reset(new SCell [size]);
+	for (std::size_t i = 0; i < size; ++i) {
+		buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+CRingQueue<T>::~CRingQueue()
+{
+	Clear();
+}
+
+template <typename T>
+T CRingQueue<T>::Pop()
+{
+	// NOTE: T may be not default constructible, cell's object is moved into raw storage
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	T* item = reinterpret_cast<T*>(&storage);
+	int i = 0;
+	while ((i < SPIN_COUNT) && !Dequeue(item, true)) {
+		++i;
+	}
+	if (i == SPIN_COUNT) {
+		std::unique_lock<spring::mutex> mlock(_mutex);
+		popSleepers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		_condPop.wait(mlock, [this, item]() { return Dequeue(item, true); });
+		popSleepers.fetch_sub(1);
+	}
+	NotifyPush();
+
+	T val = std::move(*item);
+	item->~T();
+	return val;
+}
+
+template <typename T>
+void CRingQueue<T>::Pop(T& item)
+{
+	int i = 0;
+	while ((i < SPIN_COUNT) && !Dequeue(&item, false)) {
+		++i;
+	}
+	if (i == SPIN_COUNT) {
+		std::unique_lock<spring::mutex> mlock(_mutex);
+		popSleepers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		_condPop.wait(mlock, [this, &item]() { return Dequeue(&item, false); });
+		popSleepers.fetch_sub(1);
+	}
+	NotifyPush();
+}
+
+template <typename T>
+void CRingQueue<T>::Push(const T& item)
+{
+	int i = 0;
+	while ((i < SPIN_COUNT) && !Enqueue(item)) {
+		++i;
+	}
+	if (i == SPIN_COUNT) {
+		std::unique_lock<spring::mutex> mlock(_mutex);
+		pushSleepers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		_condPush.wait(mlock, [this, &item]() { return Enqueue(item); });
+		pushSleepers.fetch_sub(1);
+	}
+	Notify(popSleepers, _condPop);
+}
+
+template <typename T>
+bool CRingQueue<T>::TryPop(T& item)
+{
+	if (!Dequeue(&item, false)) {
+		return false;
+	}
+	NotifyPush();
+	return true;
+}
+
+template <typename T>
+bool CRingQueue<T>::TryPush(const T& item)
+{
+	if (!Enqueue(item)) {
+		return false;
+	}
+	Notify(popSleepers, _condPop);
+	return true;
+}
+
+template <typename T>
+bool CRingQueue<T>::IsEmpty() const
+{
+	return dequeuePos.load(std::memory_order_acquire) >= enqueuePos.load(std::memory_order_acquire);
+}
+
+template <typename T>
+void CRingQueue<T>::PopAndProcess(ProcessFunction process)
+{
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	T* item = reinterpret_cast<T*>(&storage);
+	if (Dequeue(item, true)) {
+		NotifyPush();
+		process(*item);
+		item->~T();
+	}
+}
+
+template <typename T>
+void CRingQueue<T>::Clear()
+{
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	T* item = reinterpret_cast<T*>(&storage);
+	while (Dequeue(item, true)) {
+		item->~T();
+	}
+	NotifyPush();
+}
+
+template <typename T>
+bool CRingQueue<T>::Dequeue(T* item, bool isRaw)
+{
+	SCell* cell;
+	std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		cell = &buffer[pos & mask];
+		const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+		const intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+		if (dif == 0) {
+			if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (dif < 0) {
+			return false;  // empty
+		} else {
+			pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+	if (isRaw) {
+		new (item) T(std::move(*cell->Get()));
+	} else {
+		*item = std::move(*cell->Get());
+	}
+	cell->Get()->~T();
+	cell->sequence.store(pos + mask + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+bool CRingQueue<T>::Enqueue(const T& item)
+{
+	SCell* cell;
+	std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		cell = &buffer[pos & mask];
+		const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+		const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+		if (dif == 0) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (dif < 0) {
+			return false;  // full
+		} else {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	new (cell->Get()) T(item);
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+void CRingQueue<T>::NotifyPush()
+{
+	// Hysteresis: producers wake up when half of the ring is free, not on each popped cell
+	const std::size_t size = enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+	if (size <= (mask + 1) / 2) {
+		Notify(pushSleepers, _condPush);
+	}
+}
+
+template <typename T>
+void CRingQueue<T>::Notify(std::atomic<int>& sleepers, spring::condition_variable_any& cond)
+{
+	// Pairs with fence of the sleeper: either it sees the change, or we see it sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleepers.load(std::memory_order_relaxed) > 0) {
+		std::lock_guard<spring::mutex> mlock(_mutex);
+		cond.notify_all();
+	}
+}
+
+} // namespace circuit
@@ -0,0 +1,225 @@
+/*
+ * SaveState.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "util/SaveState.h"
+
+namespace circuit {
+
+namespace {
+
+// Guard against corrupted count, 16M items is beyond any map or unit limit
+const uint32_t MAX_ITEMS = 1 << 24;
+
+// NOTE: Same layout as utils::binary_write/binary_write_array, without engine headers (bench)
+template<typename T> inline void Put(std::ostream& os, const T& value)
+{
+	os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T> inline void Get(std::istream& is, T& value)
+{
+	is.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template<typename T> inline void PutVector(std::ostream& os, const std::vector<T>& v)
+{
+	Put(os, static_cast<uint32_t>(v.size()));
+	os.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template<typename T> inline void GetVector(std::istream& is, std::vector<T>& v)
+{
+	uint32_t size = 0;
+	Get(is, size);
+	if (is.fail() || (size > MAX_ITEMS)) {
+		is.setstate(std::ios::failbit);
+		return;
+	}
+	v.resize(size);
+	is.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
+}
+
+template<typename T> inline void PutRecords(std::ostream& os, const std::vector<T>& v)
+{
+	Put(os, static_cast<uint32_t>(v.size()));
+	for (const T& r : v) {
+		r.Save(os);
+	}
+}
+
+template<typename T> inline void GetRecords(std::istream& is, std::vector<T>& v)
+{
+	uint32_t size = 0;
+	Get(is, size);
+	if (is.fail() || (size > MAX_ITEMS)) {
+		is.setstate(std::ios::failbit);
+		return;
+	}
+	v.clear();
+	for (uint32_t i = 0; (i < size) && is.good(); ++i) {
+		v.emplace_back();
+		v.back().Load(is);
+	}
+}
+
+} // namespace
+
+void SEnemyState::Save(std::ostream& os) const
+{
+	Put(os, unitId);
+	Put(os, defId);
+	Put(os, lastSeen);
+	Put(os, cost);
+	Put(os, pos);
+	Put(os, newPos);
+	Put(os, threat);
+	Put(os, range);
+	Put(os, losStatus);
+}
+
+bool SEnemyState::Load(std::istream& is)
+{
+	Get(is, unitId);
+	Get(is, defId);
+	Get(is, lastSeen);
+	Get(is, cost);
+	Get(is, pos);
+	Get(is, newPos);
+	Get(is, threat);
+	Get(is, range);
+	Get(is, losStatus);
+	return !is.fail();
+}
+
+void SThreatState::Save(std::ostream& os) const
+{
+	Put(os, width);
+	Put(os, height);
+	Put(os, squareSize);
+	PutRecords(os, hostileUnits);
+	PutRecords(os, peaceUnits);
+	PutVector(os, airThreat);
+	PutVector(os, surfThreat);
+	PutVector(os, amphThreat);
+	PutVector(os, cloakThreat);
+	PutVector(os, shield);
+}
+
+bool SThreatState::Load(std::istream& is)
+{
+	Get(is, width);
+	Get(is, height);
+	Get(is, squareSize);
+	GetRecords(is, hostileUnits);
+	GetRecords(is, peaceUnits);
+	GetVector(is, airThreat);
+	GetVector(is, surfThreat);
+	GetVector(is, amphThreat);
+	GetVector(is, cloakThreat);
+	GetVector(is, shield);
+	return !is.fail();
+}
+
+void SMetalState::Save(std::ostream& os) const
+{
+	Put(os, markFrame);
+	PutVector(os, markedMexes);
+	PutVector(os, clusters);
+}
+
+bool SMetalState::Load(std::istream& is)
+{
+	Get(is, markFrame);
+	GetVector(is, markedMexes);
+	GetVector(is, clusters);
+	return !is.fail();
+}
+
+void SEnergyState::Save(std::ostream& os) const
+{
+	PutVector(os, isValid);
+}
+
+bool SEnergyState::Load(std::istream& is)
+{
+	GetVector(is, isValid);
+	return !is.fail();
+}
+
+void SEconomyState::Save(std::ostream& os) const
+{
+	PutVector(os, metalIncomes);
+	PutVector(os, energyIncomes);
+	Put(os, indexRes);
+	Put(os, metalIncome);
+	Put(os, energyIncome);
+	Put(os, metalProduced);
+	Put(os, metalUsed);
+	Put(os, lastFacFrame);
+}
+
+bool SEconomyState::Load(std::istream& is)
+{
+	GetVector(is, metalIncomes);
+	GetVector(is, energyIncomes);
+	Get(is, indexRes);
+	Get(is, metalIncome);
+	Get(is, energyIncome);
+	Get(is, metalProduced);
+	Get(is, metalUsed);
+	Get(is, lastFacFrame);
+	return !is.fail();
+}
+
+void SMilitaryState::Save(std::ostream& os) const
+{
+	Put(os, enemyInfos);
+	Put(os, enemyMobileCost);
+	Put(os, mobileThreat);
+	Put(os, staticThreat);
+	Put(os, enemyPos);
+	Put(os, scoutIdx);
+	Put(os, defenceIdx);
+	Put(os, static_cast<uint32_t>(groups.size()));
+	for (const SGroup& group : groups) {
+		PutVector(os, group.units);
+		Put(os, group.pos);
+		Put(os, group.roleCosts);
+		Put(os, group.cost);
+		Put(os, group.threat);
+	}
+}
+
+bool SMilitaryState::Load(std::istream& is)
+{
+	Get(is, enemyInfos);
+	Get(is, enemyMobileCost);
+	Get(is, mobileThreat);
+	Get(is, staticThreat);
+	Get(is, enemyPos);
+	Get(is, scoutIdx);
+	Get(is, defenceIdx);
+	uint32_t size = 0;
+	Get(is, size);
+	if (is.fail() || (size > MAX_ITEMS)) {
+		is.setstate(std::ios::failbit);
+		return false;
+	}
+	groups.clear();
+	for (uint32_t i = 0; (i < size) && is.good(); ++i) {
+		groups.emplace_back();
+		SGroup& group = groups.back();
+		GetVector(is, group.units);
+		Get(is, group.pos);
+		Get(is, group.roleCosts);
+		Get(is, group.cost);
+		Get(is, group.threat);
+	}
+	return !is.fail();
+}
+
+} // namespace circuit
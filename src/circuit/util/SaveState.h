@@ -0,0 +1,126 @@
+/*
+ * SaveState.h
+ *
+ *  Persistent state of modules as plain data, serialized without engine
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_SAVESTATE_H_
+#define SRC_CIRCUIT_UTIL_SAVESTATE_H_
+
+#include "AIFloat3.h"
+
+#include <array>
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Module copies its fields into state to Save, and applies state read by Load
+ * only when it's complete and valid, so failed load never leaves half-read module.
+ * Load returns false on truncated data; state content is unspecified then.
+ * NOTE: Fixed sizes are checked against CCircuitDef enums where modules use them.
+ */
+#define SAVE_THREAT_TYPES	6
+#define SAVE_ROLE_TYPES		20
+
+struct SEnemyState {
+	int unitId;
+	int defId;  // -1 for unknown def
+	int lastSeen;
+	float cost;
+	springai::AIFloat3 pos;
+	springai::AIFloat3 newPos;
+	float threat;
+	std::array<int, SAVE_THREAT_TYPES> range;
+	char losStatus;
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+struct SThreatState {
+	int width;
+	int height;
+	int squareSize;
+	std::vector<SEnemyState> hostileUnits;
+	std::vector<SEnemyState> peaceUnits;
+	std::vector<float> airThreat;
+	std::vector<float> surfThreat;
+	std::vector<float> amphThreat;
+	std::vector<float> cloakThreat;
+	std::vector<float> shield;
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+struct SMetalState {
+	struct SMex {
+		int unitId;
+		int index;
+	};
+	struct SCluster {
+		unsigned int queuedCount;
+		unsigned int finishedCount;
+	};
+	int markFrame;
+	std::vector<SMex> markedMexes;
+	std::vector<SCluster> clusters;
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+struct SEnergyState {
+	std::vector<uint8_t> isValid;  // per link
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+struct SEconomyState {
+	std::vector<float> metalIncomes;
+	std::vector<float> energyIncomes;
+	int indexRes;
+	float metalIncome;
+	float energyIncome;
+	float metalProduced;
+	float metalUsed;
+	int lastFacFrame;
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+struct SMilitaryState {
+	struct SEnemyInfo {
+		float cost;
+		float threat;
+	};
+	struct SGroup {
+		std::vector<int> units;
+		springai::AIFloat3 pos;
+		std::array<float, SAVE_ROLE_TYPES> roleCosts;
+		float cost;
+		float threat;
+	};
+	std::array<SEnemyInfo, SAVE_ROLE_TYPES> enemyInfos;
+	float enemyMobileCost;
+	float mobileThreat;
+	float staticThreat;
+	springai::AIFloat3 enemyPos;
+	unsigned int scoutIdx;
+	unsigned int defenceIdx;
+	std::vector<SGroup> groups;
+
+	void Save(std::ostream& os) const;
+	bool Load(std::istream& is);
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_SAVESTATE_H_
@@ -0,0 +1,94 @@
+/*
+ * SaveStream.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "util/SaveStream.h"
+
+#include <sstream>
+#include <cstring>
+
+namespace circuit {
+
+namespace {
+
+const char MAGIC[4] = {'C', 'S', 'A', 'V'};
+const uint32_t FORMAT_VERSION = 1;
+
+// NOTE: No util/utils.h here, stream stays usable without engine (bench)
+template<typename T> inline std::ostream& Put(std::ostream& os, const T& value)
+{
+	return os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T> inline std::istream& Get(std::istream& is, T& value)
+{
+	return is.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+CSaveWriter::CSaveWriter(std::ostream& os)
+		: os(os)
+{
+	os.write(MAGIC, sizeof(MAGIC));
+	Put(os, FORMAT_VERSION);
+}
+
+void CSaveWriter::Write(SaveSection id, uint32_t version, const SaveFunc& save)
+{
+	std::ostringstream buf(std::ios::binary);
+	save(buf);
+	const std::string& payload = buf.str();
+
+	Put(os, static_cast<uint32_t>(id));
+	Put(os, version);
+	Put(os, static_cast<uint64_t>(payload.size()));
+	os.write(payload.data(), payload.size());
+}
+
+CSaveReader::CSaveReader(std::istream& is)
+		: isValid(false)
+{
+	char magic[sizeof(MAGIC)];
+	uint32_t format;
+	if (!is.read(magic, sizeof(MAGIC)) || !Get(is, format)
+		|| (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) || (format != FORMAT_VERSION))
+	{
+		return;
+	}
+
+	uint32_t id;
+	while (Get(is, id)) {
+		SSection section;
+		uint64_t length;
+		if (!Get(is, section.version) || !Get(is, length)) {
+			return;
+		}
+		section.payload.resize(length);
+		if (!is.read(&section.payload[0], length)) {
+			return;
+		}
+		sections[id] = std::move(section);
+	}
+	isValid = true;
+}
+
+bool CSaveReader::HasSection(SaveSection id) const
+{
+	return sections.find(static_cast<uint32_t>(id)) != sections.end();
+}
+
+bool CSaveReader::Read(SaveSection id, uint32_t version, const LoadFunc& load) const
+{
+	auto it = sections.find(static_cast<uint32_t>(id));
+	if ((it == sections.end()) || (it->second.version != version)) {
+		return false;
+	}
+	std::istringstream buf(it->second.payload, std::ios::binary);
+	return load(buf) && !buf.fail();
+}
+
+} // namespace circuit
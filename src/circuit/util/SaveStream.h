@@ -0,0 +1,75 @@
+/*
+ * SaveStream.h
+ *
+ *  Chunked binary save: versioned sections with explicit length
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_SAVESTREAM_H_
+#define SRC_CIRCUIT_UTIL_SAVESTREAM_H_
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Ids are stored in file, never reuse or renumber
+ */
+enum class SaveSection: uint32_t {THREAT = 1, METAL = 2, ENERGY = 3, ECONOMY = 4, MILITARY = 5};
+
+/*
+ * File: header {magic, format version}, then sections {id, version, length, payload}.
+ * Section of unknown id or other version is skipped as a whole, so adding or changing
+ * one module's layout doesn't break loading of the others.
+ * NOTE: Native endianness, save and load happen on the same platform.
+ */
+class CSaveWriter {
+public:
+	using SaveFunc = std::function<void (std::ostream& os)>;
+
+	CSaveWriter(std::ostream& os);
+
+	/*
+	 * Payload is buffered to know its length before it's written
+	 */
+	void Write(SaveSection id, uint32_t version, const SaveFunc& save);
+
+	bool IsGood() const { return os.good(); }
+
+private:
+	std::ostream& os;
+};
+
+class CSaveReader {
+public:
+	using LoadFunc = std::function<bool (std::istream& is)>;
+
+	CSaveReader(std::istream& is);
+
+	/*
+	 * False on wrong magic or format, or truncated section table
+	 */
+	bool IsValid() const { return isValid; }
+	bool HasSection(SaveSection id) const;
+	/*
+	 * @return false if section is missing, of other version, or load failed
+	 */
+	bool Read(SaveSection id, uint32_t version, const LoadFunc& load) const;
+
+private:
+	struct SSection {
+		uint32_t version;
+		std::string payload;
+	};
+	std::map<uint32_t, SSection> sections;
+	bool isValid;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_SAVESTREAM_H_
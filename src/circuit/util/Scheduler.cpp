@@ -6,17 +6,20 @@
  */
 
 #include "util/Scheduler.h"
+#include "util/Profiler.h"
+#include "util/Tracer.h"
 #include "util/utils.h"
 
 namespace circuit {
 
-CMultiQueue<CScheduler::WorkTask> CScheduler::workTasks;
+CRingQueue<CScheduler::WorkTask> CScheduler::workTasks(4096);
 spring::thread CScheduler::workerThread;
 std::atomic<bool> CScheduler::workerRunning(false);
 unsigned int CScheduler::counterInstance = 0;
 
 CScheduler::CScheduler()
-		: lastFrame(-1)
+		: traceId(-1)
+		, lastFrame(-1)
 		, isProcessing(false)
 {
 	counterInstance++;
@@ -46,16 +49,13 @@ void CScheduler::ProcessRelease()
 
 void CScheduler::Release()
 {
-	std::weak_ptr<CScheduler>& scheduler = self;
-	CMultiQueue<WorkTask>::ConditionFunction condition = [&scheduler](WorkTask& item) -> bool {
-		return !scheduler.owner_before(item.scheduler) && !item.scheduler.owner_before(scheduler);
-	};
-	workTasks.RemoveAllIf(condition);
+	// self is expired by now: tasks of this scheduler are removed along with other released ones
+	PurgeWorkTasks();
 
 	if (counterInstance == 0 && workerRunning.load()) {
 		workerRunning = false;
 		// At this point workTasks is empty. Push empty task in case worker stuck at Pop().
-		workTasks.Push({self, nullptr, nullptr});
+		workTasks.TryPush({self, nullptr, nullptr, traceId});
 		if (workerThread.joinable()) {
 			PRINT_DEBUG("Entering join: %s\n", __PRETTY_FUNCTION__);
 			workerThread.join();
@@ -64,6 +64,22 @@ void CScheduler::Release()
 	}
 }
 
+void CScheduler::PurgeWorkTasks()
+{
+	// NOTE: All AIs live in main thread, the only producer. Tasks pushed back after the pop
+	//       keep their order and always fit, worker can only free more cells meanwhile.
+	std::vector<WorkTask> liveTasks;
+	WorkTask item(std::weak_ptr<CScheduler>(), nullptr, nullptr, -1);
+	while (workTasks.TryPop(item)) {
+		if (!item.scheduler.expired()) {
+			liveTasks.push_back(item);
+		}
+	}
+	for (const WorkTask& task : liveTasks) {
+		workTasks.TryPush(task);
+	}
+}
+
 void CScheduler::RunTaskEvery(std::shared_ptr<CGameTask> task, int frameInterval, int frameOffset)
 {
 	if (frameOffset > 0) {
@@ -77,6 +93,7 @@ void CScheduler::RunTaskEvery(std::shared_ptr<CGameTask> task, int frameInterval
 
 void CScheduler::ProcessTasks(int frame)
 {
+	PROFILE_SCOPE("CScheduler::ProcessTasks");
 	isProcessing = true;
 	lastFrame = frame;
 
@@ -84,6 +101,7 @@ void CScheduler::ProcessTasks(int frame)
 	std::list<OnceTask>::iterator ionce = onceTasks.begin();
 	while (ionce != onceTasks.end()) {
 		if (ionce->frame <= frame) {
+			TRACE_SCOPE("OnceTask", traceId);
 			ionce->task->Run();
 			ionce = onceTasks.erase(ionce);  // alternatively, onceTasks.erase(iter++);
 		} else {
@@ -94,13 +112,20 @@ void CScheduler::ProcessTasks(int frame)
 	// Process repeat tasks
 	for (auto& container : repeatTasks) {
 		if (frame - container.lastFrame >= container.frameInterval) {
+			TRACE_SCOPE("RepeatTask", traceId);
 			container.task->Run();
 			container.lastFrame = frame;
 		}
 	}
 
+	// Retry parallel tasks that didn't fit into workTasks
+	while (!pendingTasks.empty() && workTasks.TryPush(pendingTasks.front())) {
+		pendingTasks.pop_front();
+	}
+
 	// Process onComplete from parallel tasks
-	CMultiQueue<FinishTask>::ProcessFunction process = [](FinishTask& item) {
+	CMultiQueue<FinishTask>::ProcessFunction process = [this](FinishTask& item) {
+		TRACE_SCOPE("FinishTask", traceId);
 		item.task->Run();
 	};
 	finishTasks.PopAndProcess(process);
@@ -123,7 +148,10 @@ void CScheduler::RunParallelTask(std::shared_ptr<CGameTask> task, std::shared_pt
 		workerRunning = true;
 		workerThread = spring::thread(&CScheduler::WorkerThread);
 	}
-	workTasks.Push({self, task, onComplete});
+	WorkTask container(self, task, onComplete, traceId);
+	if (!pendingTasks.empty() || !workTasks.TryPush(container)) {
+		pendingTasks.push_back(container);  // keep order, sent by ProcessTasks
+	}
 }
 
 void CScheduler::RemoveTask(std::shared_ptr<CGameTask>& task)
@@ -138,9 +166,21 @@ void CScheduler::RemoveTask(std::shared_ptr<CGameTask>& task)
 
 void CScheduler::WorkerThread()
 {
+	if (CTracer::IsEnabled()) {
+		CTracer::SetThreadName("worker");
+	}
 	WorkTask container = workTasks.Pop();
 	while (workerRunning.load()) {
-		container.task->Run();
+		if (container.scheduler.expired()) {  // owner AI is released
+			container.task = nullptr;
+			container.onComplete = nullptr;
+			container = workTasks.Pop();
+			continue;
+		}
+		{
+			TRACE_SCOPE("ParallelTask", container.traceId);
+			container.task->Run();
+		}
 		container.task = nullptr;
 		if (container.onComplete != nullptr) {
 			std::shared_ptr<CScheduler> scheduler = container.scheduler.lock();
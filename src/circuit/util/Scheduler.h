@@ -11,10 +11,12 @@
 #include "util/MultiQueue.h"
 #include "util/GameTask.h"
 #include "util/Defines.h"
+#include "util/RingQueue.h"
 
 #include "System/Threading/SpringThreading.h"
 
 #include <memory>
+#include <deque>
 #include <list>
 
 namespace circuit {
@@ -24,12 +26,16 @@ public:
 	CScheduler();
 	virtual ~CScheduler();
 
-	void Init(const std::shared_ptr<CScheduler>& thisPtr) { self = thisPtr; }
+	void Init(const std::shared_ptr<CScheduler>& thisPtr, int id) { self = thisPtr; traceId = id; }
 	void ProcessInit();
 	void ProcessRelease();
 
 private:
 	void Release();
+	/*
+	 * Drop queued work of released schedulers, ring can't erase in place
+	 */
+	static void PurgeWorkTasks();
 
 public:
 	/*
@@ -82,6 +88,7 @@ public:
 
 private:
 	std::weak_ptr<CScheduler> self;
+	int traceId;  // owner's skirmishAIId
 	int lastFrame;
 	bool isProcessing;
 
@@ -111,12 +118,16 @@ private:
 	std::vector<std::shared_ptr<CGameTask>> removeTasks;
 
 	struct WorkTask: public BaseContainer {
-		WorkTask(std::weak_ptr<CScheduler> scheduler, std::shared_ptr<CGameTask> task, std::shared_ptr<CGameTask> onComplete) :
-			BaseContainer(task), onComplete(onComplete), scheduler(scheduler) {}
+		WorkTask(std::weak_ptr<CScheduler> scheduler, std::shared_ptr<CGameTask> task, std::shared_ptr<CGameTask> onComplete, int traceId) :
+			BaseContainer(task), onComplete(onComplete), scheduler(scheduler), traceId(traceId) {}
 		std::shared_ptr<CGameTask> onComplete;
 		std::weak_ptr<CScheduler> scheduler;
+		int traceId;
 	};
-	static CMultiQueue<WorkTask> workTasks;
+	// Shared by all AIs of the process, tasks of destroyed scheduler are skipped by worker
+	static CRingQueue<WorkTask> workTasks;
+	// Overflow of full workTasks, main thread never waits for worker
+	std::deque<WorkTask> pendingTasks;
 
 	struct FinishTask: public BaseContainer {
 		FinishTask(std::shared_ptr<CGameTask> task) :
@@ -124,6 +135,7 @@ private:
 		FinishTask(const WorkTask& workTask) :
 			BaseContainer(workTask.onComplete) {}
 	};
+	// NOTE: Unbounded, worker must never wait for main thread: main may wait for it on Release
 	CMultiQueue<FinishTask> finishTasks;
 
 	std::vector<std::shared_ptr<CGameTask>> initTasks;
@@ -0,0 +1,168 @@
+/*
+ * SlotMap.h
+ *
+ *  Dense slot table keyed by engine id, drop-in for std::map of units and defs
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_SLOTMAP_H_
+#define SRC_CIRCUIT_UTIL_SLOTMAP_H_
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+namespace circuit {
+
+/*
+ * Engine ids are small non-negative integers (bounded by max units / number of defs),
+ * so key maps through sparse array straight to slot in packed vector of {key, value}.
+ * Lookup is 2 array reads, iteration walks contiguous memory.
+ * Erase moves the last element into the freed place (swap-remove): order of iteration
+ * is not sorted by key, and erase(it) returns iterator to the element moved in.
+ * Every key carries generation counter, bumped on erase: SHandle of erased entry never
+ * resolves, even if engine reuses the id for a new unit.
+ * NOTE: Like std::vector any insert invalidates iterators; erase invalidates the last one.
+ */
+template <typename K, typename T>
+class CSlotMap {
+	static_assert(std::is_integral<K>::value, "CSlotMap key must be an integral id");
+public:
+	using key_type = K;
+	using mapped_type = T;
+	using value_type = std::pair<K, T>;
+	using size_type = std::size_t;
+	using iterator = typename std::vector<value_type>::iterator;
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	struct SHandle {
+		K key;
+		uint32_t generation;
+
+		bool operator==(const SHandle& other) const { return (key == other.key) && (generation == other.generation); }
+		bool operator!=(const SHandle& other) const { return !(*this == other); }
+	};
+
+	iterator begin() { return dense.begin(); }
+	iterator end() { return dense.end(); }
+	const_iterator begin() const { return dense.begin(); }
+	const_iterator end() const { return dense.end(); }
+	size_type size() const { return dense.size(); }
+	bool empty() const { return dense.empty(); }
+	void reserve(size_type count) { dense.reserve(count); }
+
+	iterator find(K key) {
+		const uint32_t index = IndexOf(key);
+		return (index == NONE) ? dense.end() : dense.begin() + index;
+	}
+	const_iterator find(K key) const {
+		const uint32_t index = IndexOf(key);
+		return (index == NONE) ? dense.end() : dense.begin() + index;
+	}
+	size_type count(K key) const { return (IndexOf(key) == NONE) ? 0 : 1; }
+
+	/*
+	 * Inserts T() if key is missing, as std::map does
+	 */
+	T& operator[](K key) {
+		uint32_t index = IndexOf(key);
+		if (index == NONE) {
+			index = Insert(key);
+		}
+		return dense[index].second;
+	}
+	std::pair<iterator, bool> emplace(K key, const T& value) {
+		uint32_t index = IndexOf(key);
+		if (index != NONE) {
+			return std::make_pair(dense.begin() + index, false);
+		}
+		index = Insert(key);
+		dense[index].second = value;
+		return std::make_pair(dense.begin() + index, true);
+	}
+
+	size_type erase(K key) {
+		const uint32_t index = IndexOf(key);
+		if (index == NONE) {
+			return 0;
+		}
+		Remove(index);
+		return 1;
+	}
+	iterator erase(const_iterator it) {
+		const uint32_t index = it - dense.cbegin();
+		Remove(index);
+		return dense.begin() + index;
+	}
+
+	void clear() {
+		for (const value_type& kv : dense) {
+			SSlot& slot = sparse[kv.first];
+			slot.index = NONE;
+			++slot.generation;
+		}
+		dense.clear();
+	}
+
+	/*
+	 * Invalid handle (never resolves) if key is missing
+	 */
+	SHandle GetHandle(K key) const {
+		return (IndexOf(key) == NONE) ? SHandle{key, INVALID_GEN} : SHandle{key, sparse[key].generation};
+	}
+	/*
+	 * T() if entry was erased since handle was taken
+	 */
+	T Resolve(const SHandle& handle) const {
+		const uint32_t index = IndexOf(handle.key);
+		return ((index == NONE) || (sparse[handle.key].generation != handle.generation)) ? T() : dense[index].second;
+	}
+
+private:
+	static constexpr uint32_t NONE = 0xFFFFFFFF;
+	static constexpr uint32_t INVALID_GEN = 0xFFFFFFFF;  // generation wraps before reaching it in practice
+
+	struct SSlot {
+		uint32_t index;  // in dense, NONE if key is not present
+		uint32_t generation;
+	};
+
+	uint32_t IndexOf(K key) const {
+		return ((key < 0) || ((size_type)key >= sparse.size())) ? NONE : sparse[key].index;
+	}
+	uint32_t Insert(K key) {
+		assert(key >= 0);
+		if ((size_type)key >= sparse.size()) {
+			sparse.resize(key + 1, SSlot{NONE, 0});
+		}
+		const uint32_t index = dense.size();
+		sparse[key].index = index;
+		dense.emplace_back(key, T());
+		return index;
+	}
+	void Remove(uint32_t index) {
+		SSlot& slot = sparse[dense[index].first];
+		slot.index = NONE;
+		++slot.generation;
+		if (index + 1 != dense.size()) {
+			dense[index] = std::move(dense.back());
+			sparse[dense[index].first].index = index;
+		}
+		dense.pop_back();
+	}
+
+	std::vector<SSlot> sparse;
+	std::vector<value_type> dense;
+};
+
+template <typename K, typename T>
+constexpr uint32_t CSlotMap<K, T>::NONE;
+template <typename K, typename T>
+constexpr uint32_t CSlotMap<K, T>::INVALID_GEN;
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_SLOTMAP_H_
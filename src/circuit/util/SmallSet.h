@@ -0,0 +1,149 @@
+/*
+ * SmallSet.h
+ *
+ *  Sorted flat set with inline storage, drop-in for small std::set of pointers
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_SMALLSET_H_
+#define SRC_CIRCUIT_UTIL_SMALLSET_H_
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <cstring>
+
+namespace circuit {
+
+/*
+ * Keeps std::set's order (std::less) so iteration is deterministic and matches the old containers.
+ * First N elements live inside the object, heap is used only beyond that.
+ * NOTE: Unlike std::set any insert/erase invalidates iterators, iterate over a copy when modifying.
+ */
+template <typename T, unsigned N>
+class CSmallSet {
+	static_assert(std::is_trivially_copyable<T>::value, "CSmallSet supports trivially copyable types only");
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using iterator = const T*;
+	using const_iterator = const T*;
+
+	CSmallSet() : data(local), length(0), capacity(N) {}
+	CSmallSet(const CSmallSet& other) : CSmallSet() { Assign(other.begin(), other.end()); }
+	CSmallSet(CSmallSet&& other) : CSmallSet() { Steal(other); }
+	~CSmallSet() { Release(); }
+
+	CSmallSet& operator=(const CSmallSet& other) {
+		if (this != &other) {
+			Assign(other.begin(), other.end());
+		}
+		return *this;
+	}
+	CSmallSet& operator=(CSmallSet&& other) {
+		if (this != &other) {
+			clear();
+			Steal(other);
+		}
+		return *this;
+	}
+
+	const_iterator begin() const { return data; }
+	const_iterator end() const { return data + length; }
+	const T& operator[](size_type idx) const { return data[idx]; }
+	size_type size() const { return length; }
+	bool empty() const { return length == 0; }
+	void clear() { length = 0; }
+
+	const_iterator find(const T& value) const {
+		const_iterator it = std::lower_bound(begin(), end(), value, std::less<T>());
+		return ((it != end()) && !std::less<T>()(value, *it)) ? it : end();
+	}
+	size_type count(const T& value) const { return (find(value) != end()) ? 1 : 0; }
+
+	std::pair<iterator, bool> insert(const T& value) {
+		T* it = const_cast<T*>(std::lower_bound(begin(), end(), value, std::less<T>()));
+		if ((it != data + length) && !std::less<T>()(value, *it)) {
+			return std::make_pair(it, false);
+		}
+		const size_type pos = it - data;
+		Reserve(length + 1);
+		std::memmove(data + pos + 1, data + pos, (length - pos) * sizeof(T));
+		data[pos] = value;
+		++length;
+		return std::make_pair(data + pos, true);
+	}
+	template <typename InputIt>
+	void insert(InputIt first, InputIt last) {
+		for (; first != last; ++first) {
+			insert(*first);
+		}
+	}
+
+	size_type erase(const T& value) {
+		const_iterator it = find(value);
+		if (it == end()) {
+			return 0;
+		}
+		erase(it);
+		return 1;
+	}
+	iterator erase(const_iterator it) {
+		const size_type pos = it - data;
+		std::memmove(data + pos, data + pos + 1, (length - pos - 1) * sizeof(T));
+		--length;
+		return data + pos;
+	}
+
+private:
+	template <typename InputIt>
+	void Assign(InputIt first, InputIt last) {
+		clear();
+		Reserve(std::distance(first, last));
+		for (; first != last; ++first) {
+			data[length++] = *first;  // already sorted and unique
+		}
+	}
+	void Reserve(size_type size) {
+		if (size <= capacity) {
+			return;
+		}
+		const size_type newCapacity = std::max<size_type>(size, capacity * 2);
+		T* newData = new T[newCapacity];
+		std::memcpy(newData, data, length * sizeof(T));
+		Release();
+		data = newData;
+		capacity = newCapacity;
+	}
+	void Release() {
+		if (data != local) {
+			delete[] data;
+		}
+	}
+	void Steal(CSmallSet& other) {
+		// NOTE: this is empty
+		if (other.data == other.local) {
+			Assign(other.begin(), other.end());
+			other.clear();
+		} else {
+			Release();
+			data = other.data;
+			length = other.length;
+			capacity = other.capacity;
+			other.data = other.local;
+			other.length = 0;
+			other.capacity = N;
+		}
+	}
+
+	T* data;
+	size_type length;
+	size_type capacity;
+	T local[N];
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_SMALLSET_H_
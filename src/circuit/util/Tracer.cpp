@@ -0,0 +1,106 @@
+/*
+ * Tracer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "util/Tracer.h"
+
+#include <set>
+
+namespace circuit {
+
+std::atomic<bool> CTracer::isEnabled(false);
+CTracer::clock::time_point CTracer::startTime = CTracer::clock::now();
+spring::mutex CTracer::mutex;
+std::vector<CTracer::SThreadBuffer*> CTracer::buffers;
+
+void CTracer::SetEnabled(bool value)
+{
+	if (value && !IsEnabled()) {
+		startTime = clock::now();
+	}
+	isEnabled.store(value, std::memory_order_relaxed);
+}
+
+CTracer::SThreadBuffer* CTracer::GetThreadBuffer()
+{
+	static thread_local SThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr) {
+		buffer = new SThreadBuffer;
+		buffer->name = nullptr;
+		std::lock_guard<spring::mutex> lock(mutex);
+		buffer->tid = buffers.size();
+		buffers.push_back(buffer);
+	}
+	return buffer;
+}
+
+void CTracer::Complete(const char* name, int pid, int64_t ts)
+{
+	const int64_t dur = Now() - ts;
+	SThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<spring::mutex> lock(buffer->mutex);
+	if (buffer->events.size() < MAX_EVENTS) {
+		buffer->events.push_back({name, pid, ts, dur});
+	}
+}
+
+void CTracer::SetThreadName(const char* name)
+{
+	SThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<spring::mutex> lock(buffer->mutex);
+	buffer->name = name;
+}
+
+void CTracer::WriteJSON(std::ostream& os)
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+	std::set<int> pids;
+
+	os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool isFirst = true;
+	auto separate = [&os, &isFirst]() {
+		if (!isFirst) {
+			os << ",\n";
+		}
+		isFirst = false;
+	};
+	for (SThreadBuffer* buffer : buffers) {
+		std::lock_guard<spring::mutex> bufLock(buffer->mutex);
+		for (const SEvent& e : buffer->events) {
+			separate();
+			os << "{\"name\": \"" << e.name << "\", \"ph\": \"X\", \"ts\": " << e.ts << ", \"dur\": " << e.dur
+			   << ", \"pid\": " << e.pid << ", \"tid\": " << buffer->tid << "}";
+			pids.insert(e.pid);
+		}
+	}
+	// Name every thread within every AI "process"
+	for (int pid : pids) {
+		separate();
+		os << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+		   << ", \"args\": {\"name\": \"Circuit AI [" << pid << "]\"}}";
+		for (SThreadBuffer* buffer : buffers) {
+			if (buffer->name == nullptr) {
+				continue;
+			}
+			separate();
+			os << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << buffer->tid
+			   << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+		}
+	}
+	os << "\n]}\n";
+}
+
+void CTracer::Reset()
+{
+	std::lock_guard<spring::mutex> lock(mutex);
+	for (SThreadBuffer* buffer : buffers) {
+		std::lock_guard<spring::mutex> bufLock(buffer->mutex);
+		buffer->events.clear();
+		buffer->events.shrink_to_fit();
+	}
+}
+
+} // namespace circuit
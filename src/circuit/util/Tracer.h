@@ -0,0 +1,94 @@
+/*
+ * Tracer.h
+ *
+ *  Timeline of scheduler, worker and engine event activity in Chrome trace JSON format
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_TRACER_H_
+#define SRC_CIRCUIT_UTIL_TRACER_H_
+
+#include "System/Threading/SpringThreading.h"
+
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <ostream>
+
+namespace circuit {
+
+class CTracer {
+public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr size_t MAX_EVENTS = 1 << 21;  // per thread, the rest is dropped
+
+	struct SEvent {
+		const char* name;  // must be static string
+		int pid;  // skirmishAIId
+		int64_t ts;  // us
+		int64_t dur;  // us
+	};
+
+	static void SetEnabled(bool value);
+	static bool IsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+
+	static int64_t Now() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - startTime).count();
+	}
+	/*
+	 * Add complete event (begin timestamp + duration) into calling thread's buffer
+	 */
+	static void Complete(const char* name, int pid, int64_t ts);
+	static void SetThreadName(const char* name);
+
+	/*
+	 * Chrome trace viewer / Perfetto compatible JSON
+	 */
+	static void WriteJSON(std::ostream& os);
+	static void Reset();
+
+private:
+	struct SThreadBuffer {
+		int tid;
+		const char* name;
+		std::vector<SEvent> events;
+		spring::mutex mutex;  // uncontended, only WriteJSON competes with owner
+	};
+	static SThreadBuffer* GetThreadBuffer();
+
+	static std::atomic<bool> isEnabled;
+	static clock::time_point startTime;
+	static spring::mutex mutex;
+	static std::vector<SThreadBuffer*> buffers;  // owner
+};
+
+class CScopedTrace {
+public:
+	CScopedTrace(const char* name, int pid)
+		: name(CTracer::IsEnabled() ? name : nullptr)
+		, pid(pid)
+	{
+		if (this->name != nullptr) {
+			ts = CTracer::Now();
+		}
+	}
+	~CScopedTrace() {
+		if (name != nullptr) {
+			CTracer::Complete(name, pid, ts);
+		}
+	}
+private:
+	const char* name;
+	int pid;
+	int64_t ts;
+};
+
+} // namespace circuit
+
+#define TRACE_CONCAT_(a, b)	a##b
+#define TRACE_CONCAT(a, b)	TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name, pid)	circuit::CScopedTrace TRACE_CONCAT(traceScope, __LINE__)(name, pid)
+
+#endif // SRC_CIRCUIT_UTIL_TRACER_H_
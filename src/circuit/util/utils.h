@@ -17,6 +17,8 @@
 #include <string.h>
 #include <stdarg.h>  // for va_start, etc
 #include <memory>    // for std::unique_ptr
+#include <iostream>
+#include <type_traits>
 //#include <random>
 //#include <iterator>
 
@@ -269,6 +271,34 @@ template<typename T> static inline std::istream& binary_read(std::istream& strea
     return stream.read(reinterpret_cast<char*>(&value), sizeof(T));
 }
 
+/*
+ * Bulk array: element count, then raw memory in one write
+ */
+template<typename T> static inline std::ostream& binary_write_array(std::ostream& stream, const std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Bulk write of non-trivial type");
+	binary_write(stream, static_cast<uint32_t>(values.size()));
+	return stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/*
+ * Fails stream if stored count differs from values.size(): size is known by the reader
+ * (map dims, number of links), mismatch means save of other map or config
+ */
+template<typename T> static inline std::istream& binary_read_array(std::istream& stream, std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Bulk read of non-trivial type");
+	uint32_t size;
+	if (!binary_read(stream, size)) {
+		return stream;
+	}
+	if (size != values.size()) {
+		stream.setstate(std::ios::failbit);
+		return stream;
+	}
+	return stream.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+}
+
 #ifdef DEBUG_LOG
 	class CScopedTime {
 	public:
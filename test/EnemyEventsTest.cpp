@@ -0,0 +1,314 @@
+/*
+ * EnemyEventsTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "unit/EnemyEvents.h"
+
+#include <algorithm>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+/*
+ * Enemies stamp threat into grid as CThreatMap does. Same event stream is applied
+ * directly (handler per event) and through CEnemyEvents as CCircuitAI does it;
+ * visibility, stamp positions and grid must end up equal.
+ */
+struct SEventsModel {
+	struct SEnemy {
+		enum Mask: uint8_t {LOS = 0x01, RADAR = 0x02, STAMPED = 0x04};
+
+		int GetId() const { return id; }
+		bool IsInLOS() const { return status & LOS; }
+		bool IsInRadar() const { return status & RADAR; }
+
+		int id;
+		int x, z;  // in threat squares
+		uint8_t status;
+		int stampX, stampZ;
+	};
+	enum class Evt: char {ENTER_LOS, LEAVE_LOS, ENTER_RADAR, LEAVE_RADAR, DAMAGED};
+	struct SEvent {
+		Evt evt;
+		int id;
+	};
+	struct SFrame {
+		std::vector<std::pair<int, int>> moves;  // new position of each enemy
+		std::vector<SEvent> events;
+	};
+	struct SState {
+		std::vector<SEnemy> enemies;
+		std::vector<int> grid;
+	};
+	using Events = CEnemyEvents<SEnemy>;
+
+	/*
+	 * @param numFlicker  enemies with a burst of random events per frame
+	 * @param numBlink  enemies out of LOS that enter and leave it within frame
+	 */
+	SEventsModel(unsigned seed, int numEnemies, int numFlicker, int numBlink)
+		: numEnemies(numEnemies)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> posX(0, WIDTH - 1), posZ(0, HEIGHT - 1);
+		init.enemies.resize(numEnemies);
+		for (int i = 0; i < numEnemies; ++i) {
+			init.enemies[i] = {i, posX(rng), posZ(rng), 0, 0, 0};
+		}
+		init.grid.assign(WIDTH * HEIGHT, 0);
+
+		// Engine side truth: events are always consistent with it
+		std::vector<uint8_t> truth(numEnemies, 0);
+		std::uniform_int_distribution<int> anyEnemy(0, numEnemies - 1), numEvents(1, 12), anyEvt(0, 4);
+		std::uniform_int_distribution<int> step(-1, 1);
+		std::vector<std::pair<int, int>> pos(numEnemies);
+		for (int i = 0; i < numEnemies; ++i) {
+			pos[i] = {init.enemies[i].x, init.enemies[i].z};
+		}
+		frames.resize(NUM_FRAMES);
+		for (SFrame& frame : frames) {
+			for (std::pair<int, int>& p : pos) {
+				p.first = std::min(std::max(p.first + step(rng), 0), WIDTH - 1);
+				p.second = std::min(std::max(p.second + step(rng), 0), HEIGHT - 1);
+			}
+			frame.moves = pos;
+			for (int i = 0; i < numFlicker; ++i) {
+				const int id = anyEnemy(rng);
+				for (int n = numEvents(rng); n > 0; --n) {
+					uint8_t& t = truth[id];
+					switch (anyEvt(rng)) {
+						case 0: frame.events.push_back({(t & SEnemy::LOS) ? Evt::LEAVE_LOS : Evt::ENTER_LOS, id});
+							t ^= SEnemy::LOS; break;
+						case 1: frame.events.push_back({(t & SEnemy::RADAR) ? Evt::LEAVE_RADAR : Evt::ENTER_RADAR, id});
+							t ^= SEnemy::RADAR; break;
+						default: frame.events.push_back({Evt::DAMAGED, id}); break;
+					}
+				}
+			}
+			for (int i = 0; i < numBlink; ++i) {
+				const int id = anyEnemy(rng);
+				if (!(truth[id] & SEnemy::LOS)) {
+					frame.events.push_back({Evt::ENTER_LOS, id});
+					frame.events.push_back({Evt::LEAVE_LOS, id});
+				}
+			}
+		}
+	}
+
+	void Stamp(SState& state, SEnemy& e, int sign) {
+		const int x0 = e.stampX;
+		const int z0 = e.stampZ;
+		for (int z = std::max(z0 - RANGE, 0); z <= std::min(z0 + RANGE, HEIGHT - 1); ++z) {
+			for (int x = std::max(x0 - RANGE, 0); x <= std::min(x0 + RANGE, WIDTH - 1); ++x) {
+				if ((x - x0) * (x - x0) + (z - z0) * (z - z0) <= RANGE * RANGE) {
+					state.grid[z * WIDTH + x] += sign * (RANGE + 1);
+				}
+			}
+		}
+	}
+	void Restamp(SState& state, SEnemy& e) {
+		if (e.status & SEnemy::STAMPED) {
+			Stamp(state, e, -1);
+		}
+		e.stampX = e.x;
+		e.stampZ = e.z;
+		e.status |= SEnemy::STAMPED;
+		Stamp(state, e, +1);
+	}
+	// CThreatMap::Update: moving units in radar or LOS re-stamped at new position
+	void Update(SState& state) {
+		for (SEnemy& e : state.enemies) {
+			if ((e.status & SEnemy::STAMPED) && (e.status & (SEnemy::LOS | SEnemy::RADAR))) {
+				Restamp(state, e);
+			}
+		}
+	}
+
+	// CThreatMap counterparts
+	void EnterLOS(SState& state, SEnemy& e) { e.status |= SEnemy::LOS; Restamp(state, e); }
+	void LeaveLOS(SState& state, SEnemy& e) { e.status &= ~SEnemy::LOS; }
+	void EnterRadar(SState& state, SEnemy& e) {
+		const bool wasInLOS = e.IsInLOS();
+		e.status |= SEnemy::RADAR;
+		if (!wasInLOS) {
+			Restamp(state, e);
+		}
+	}
+	void LeaveRadar(SState& state, SEnemy& e) { e.status &= ~SEnemy::RADAR; }
+	void Damaged(SState& state, SEnemy& e) {  // new threat, same position
+		if (e.IsInLOS() && (e.status & SEnemy::STAMPED)) {
+			Stamp(state, e, -1);
+			Stamp(state, e, +1);
+		}
+	}
+
+	void Move(SState& state, const SFrame& frame) {
+		for (int i = 0; i < numEnemies; ++i) {
+			state.enemies[i].x = frame.moves[i].first;
+			state.enemies[i].z = frame.moves[i].second;
+		}
+	}
+
+	void RunDirect(SState& state) {
+		for (const SFrame& frame : frames) {
+			Move(state, frame);
+			for (const SEvent& ev : frame.events) {
+				SEnemy& e = state.enemies[ev.id];
+				switch (ev.evt) {
+					case Evt::ENTER_LOS: EnterLOS(state, e); break;
+					case Evt::LEAVE_LOS: LeaveLOS(state, e); break;
+					case Evt::ENTER_RADAR: EnterRadar(state, e); break;
+					case Evt::LEAVE_RADAR: LeaveRadar(state, e); break;
+					case Evt::DAMAGED: Damaged(state, e); break;
+				}
+			}
+		}
+		Update(state);
+	}
+
+	// CCircuitAI::ApplyEnemyEvents
+	void Apply(SState& state, const Events::SRecord& r) {
+		if (r.enemy == nullptr) {
+			return;
+		}
+		SEnemy& e = *r.enemy;
+		if (r.IsLeave(Events::LOS)) { LeaveLOS(state, e); }
+		if (r.IsEnter(Events::RADAR)) { EnterRadar(state, e); }
+		if (r.IsEnter(Events::LOS)) { EnterLOS(state, e); }
+		if (r.IsLeave(Events::RADAR)) { LeaveRadar(state, e); }
+		if (r.isDamaged) { Damaged(state, e); }
+	}
+
+	// CCircuitAI::EnemyEnterLOS, CCircuitAI::EnemyEnterRadar
+	void RunCoalesced(SState& state, Events& events) {
+		for (const SFrame& frame : frames) {
+			Move(state, frame);
+			for (const SEvent& ev : frame.events) {
+				SEnemy* e = &state.enemies[ev.id];
+				if ((ev.evt == Evt::ENTER_LOS) && !events.IsSighted(e)) {
+					Apply(state, events.Take(e, true));
+					EnterLOS(state, *e);
+					continue;
+				}
+				if ((ev.evt == Evt::ENTER_RADAR) && !events.IsSighted(e)) {
+					Apply(state, events.Take(e, !(events.GetState(e) & Events::LOS)));
+					EnterRadar(state, *e);
+					continue;
+				}
+				switch (ev.evt) {
+					case Evt::ENTER_LOS: events.EnterLOS(e); break;
+					case Evt::LEAVE_LOS: events.LeaveLOS(e); break;
+					case Evt::ENTER_RADAR: events.EnterRadar(e); break;
+					case Evt::LEAVE_RADAR: events.LeaveRadar(e); break;
+					case Evt::DAMAGED: events.Damaged(e); break;
+				}
+			}
+			for (const Events::SRecord& r : events.GetRecords()) {
+				Apply(state, r);
+			}
+			events.Clear();
+		}
+		Update(state);
+	}
+
+	void CheckSame(const SState& a, const SState& b) {
+		int numEnemyDiff = 0, first = -1;
+		for (int i = 0; i < numEnemies; ++i) {
+			const SEnemy& ea = a.enemies[i];
+			const SEnemy& eb = b.enemies[i];
+			if ((ea.status != eb.status) || (ea.stampX != eb.stampX) || (ea.stampZ != eb.stampZ)) {
+				first = (first < 0) ? i : first;
+				++numEnemyDiff;
+			}
+		}
+		CHECK_MSG(numEnemyDiff == 0, numEnemyDiff << " enemies differ, first " << first
+			<< " status " << int(a.enemies[first].status) << " vs " << int(b.enemies[first].status)
+			<< " stamp (" << a.enemies[first].stampX << ", " << a.enemies[first].stampZ
+			<< ") vs (" << b.enemies[first].stampX << ", " << b.enemies[first].stampZ << ")");
+		int numDiff = 0;
+		for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+			numDiff += (a.grid[i] != b.grid[i]) ? 1 : 0;
+		}
+		CHECK_MSG(numDiff == 0, numDiff << " grid cells differ");
+	}
+
+	void Check() {
+		Events events;
+		SState direct = init, coalesced = init;
+		RunDirect(direct);
+		RunCoalesced(coalesced, events);
+		CheckSame(direct, coalesced);
+	}
+
+	static constexpr int WIDTH = 64;
+	static constexpr int HEIGHT = 64;
+	static constexpr int NUM_FRAMES = 30;
+	static constexpr int RANGE = 6;  // in threat squares
+
+	int numEnemies;
+	SState init;
+	std::vector<SFrame> frames;
+};
+
+constexpr int SEventsModel::WIDTH;
+constexpr int SEventsModel::HEIGHT;
+constexpr int SEventsModel::RANGE;
+
+TEST_CASE("EnemyEvents/flicker_matches_direct")
+{
+	for (unsigned seed = 1; seed <= 20; ++seed) {
+		SEventsModel(seed, 300, 90, 0).Check();
+	}
+}
+
+TEST_CASE("EnemyEvents/blink_matches_direct")
+{
+	for (unsigned seed = 1; seed <= 20; ++seed) {
+		SEventsModel(seed, 100, 0, 40).Check();
+	}
+}
+
+TEST_CASE("EnemyEvents/mixed_matches_direct")
+{
+	for (unsigned seed = 1; seed <= 20; ++seed) {
+		SEventsModel(seed, 200, 60, 20).Check();
+	}
+}
+
+TEST_CASE("EnemyEvents/net_transitions")
+{
+	using SEnemy = SEventsModel::SEnemy;
+	using Events = SEventsModel::Events;
+	SEnemy a{1, 0, 0, SEnemy::RADAR, 0, 0}, b{2, 0, 0, 0, 0, 0};
+	Events events;
+	events.LeaveRadar(&a);
+	events.EnterLOS(&b);
+	events.EnterRadar(&a);
+	events.LeaveLOS(&b);
+	events.EnterLOS(&b);
+	events.Damaged(&a);
+	CHECK(events.GetRecords().size() == 2);
+	const Events::SRecord& ra = events.GetRecords()[0];  // order of the first event
+	const Events::SRecord& rb = events.GetRecords()[1];
+	CHECK((ra.enemy == &a) && (rb.enemy == &b));
+	CHECK(!ra.IsEnter(Events::RADAR) && !ra.IsLeave(Events::RADAR) && ra.isDamaged);
+	CHECK(rb.IsEnter(Events::LOS) && !rb.isDamaged);
+	CHECK(events.GetState(&b) == Events::LOS);
+
+	events.Forget(&b);
+	CHECK(events.GetRecords()[1].enemy == nullptr);
+	CHECK(events.GetState(&b) == Events::NONE);
+	events.Clear();
+	CHECK(events.IsEmpty() && events.GetRecords().empty());
+}
+
+} // namespace test
+
+} // namespace circuit
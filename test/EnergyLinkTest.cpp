@@ -0,0 +1,118 @@
+/*
+ * EnergyLinkTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "resource/EnergyLink.h"
+#include "util/Defines.h"
+
+#include <map>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+using namespace springai;
+
+/*
+ * Pylons of a link as CEnergyGrid feeds them, with flood fill over overlapping pylons
+ * as reference for union-find connectivity of CEnergyLink
+ */
+struct SPylonSet {
+	struct SPylon {
+		AIFloat3 pos;
+		float range;
+	};
+
+	SPylonSet(const AIFloat3& p0, const AIFloat3& p1) : p0(p0), p1(p1), link(0, p0, 1, p1, 400.f), nextId(0) {}
+
+	void Add(const AIFloat3& pos, float range) {
+		link.AddPylon(nextId, pos, range);
+		pylons[nextId++] = {pos, range};
+	}
+	void Remove(int id) {
+		CHECK(link.RemovePylon(id));
+		pylons.erase(id);
+	}
+
+	// Is P1 reachable from P0 through chain of overlapping pylons
+	bool IsConnected() const {
+		std::vector<const SPylon*> open, rest;
+		for (const auto& kv : pylons) {
+			const SPylon& p = kv.second;
+			(p0.SqDistance2D(p.pos) < SQUARE(p.range) ? open : rest).push_back(&p);
+		}
+		while (!open.empty()) {
+			const SPylon* p = open.back();
+			open.pop_back();
+			if (p1.SqDistance2D(p->pos) < SQUARE(p->range)) {
+				return true;
+			}
+			for (auto it = rest.begin(); it != rest.end();) {
+				if (p->pos.SqDistance2D((*it)->pos) < SQUARE(p->range + (*it)->range)) {
+					open.push_back(*it);
+					it = rest.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+		return false;
+	}
+
+	void CheckConnection(int step) {
+		link.CheckConnection();
+		CHECK_MSG(link.IsFinished() == IsConnected(), "step " << step << " of " << pylons.size() << " pylons");
+	}
+
+	AIFloat3 p0, p1;
+	CEnergyLink link;
+	std::map<int, SPylon> pylons;
+	int nextId;
+};
+
+TEST_CASE("EnergyLink/matches_flood_fill")
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> coord(0.f, 3200.f), range(100.f, 400.f), end(1000.f, 3000.f);
+	for (int t = 0; t < 100; ++t) {
+		SPylonSet ps(AIFloat3(100.f, 0.f, 100.f), AIFloat3(end(rng), 0.f, end(rng)));
+		for (int step = 0; step < 300; ++step) {
+			if (ps.pylons.empty() || (rng() % 3 != 0)) {
+				ps.Add(AIFloat3(coord(rng), 0.f, coord(rng)), range(rng));
+			} else {
+				auto it = ps.pylons.begin();
+				std::advance(it, rng() % ps.pylons.size());
+				ps.Remove(it->first);
+			}
+			ps.CheckConnection(step);
+		}
+	}
+}
+
+TEST_CASE("EnergyLink/bridge_removed")
+{
+	// Chain of pylons from P0 to P1, removal of any middle pylon splits its component
+	SPylonSet ps(AIFloat3(0.f, 0.f, 0.f), AIFloat3(2000.f, 0.f, 0.f));
+	for (int i = 0; i <= 10; ++i) {
+		ps.Add(AIFloat3(i * 200.f, 0.f, 0.f), 120.f);
+	}
+	ps.CheckConnection(0);
+	CHECK(ps.link.IsFinished());
+	ps.Remove(5);
+	ps.CheckConnection(1);
+	CHECK(!ps.link.IsFinished());
+	ps.Add(AIFloat3(1000.f, 0.f, 50.f), 150.f);  // rebuilt
+	ps.CheckConnection(2);
+	CHECK(ps.link.IsFinished());
+	CHECK(!ps.link.RemovePylon(5));
+}
+
+} // namespace test
+
+} // namespace circuit
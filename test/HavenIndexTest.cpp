@@ -0,0 +1,158 @@
+/*
+ * HavenIndexTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "terrain/HavenIndex.h"
+#include "terrain/TerrainData.h"
+#include "util/Defines.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+using namespace springai;
+
+/*
+ * Synthetic area layout: river cross splits map into 4 land areas, river is invalid;
+ * flying units (nullptr area) reach any land. Linear scan is the reference,
+ * as CFactoryManager::GetClosestHaven did it before the index.
+ */
+struct SHavenMap {
+	SHavenMap(unsigned seed, unsigned numHavens)
+		: rng(seed)
+		, width(4096.f)
+		, height(2048.f)
+		, areas(4, STerrainMapArea(nullptr))
+		, index([this](STerrainMapArea* area, const AIFloat3& pos) { return CanMoveToPos(area, pos); })
+	{
+		while (havens.size() < numHavens) {
+			AddHaven(RandPos());
+		}
+	}
+
+	AIFloat3 RandPos() {
+		std::uniform_real_distribution<float> posX(0.f, width), posZ(0.f, height);
+		return AIFloat3(posX(rng), 0.f, posZ(rng));
+	}
+	void AddHaven(const AIFloat3& pos) {
+		if (GetArea(pos) != nullptr) {
+			havens.push_back(pos);
+			index.Add(pos);
+		}
+	}
+	void RemoveNear(const AIFloat3& pos, float sqRadius) {
+		index.RemoveNear(pos, sqRadius);
+		havens.erase(std::remove_if(havens.begin(), havens.end(), [&pos, sqRadius](const AIFloat3& hav) {
+			return hav.SqDistance2D(pos) < sqRadius;
+		}), havens.end());
+	}
+
+	STerrainMapArea* GetArea(const AIFloat3& pos) {
+		const float band = width / 32;
+		if ((std::fabs(pos.x - width / 2) < band) || (std::fabs(pos.z - height / 2) < band)) {
+			return nullptr;  // river
+		}
+		return &areas[(pos.x < width / 2 ? 0 : 1) + (pos.z < height / 2 ? 0 : 2)];
+	}
+	// CTerrainManager::CanMoveToPos
+	bool CanMoveToPos(STerrainMapArea* area, const AIFloat3& pos) {
+		STerrainMapArea* dest = GetArea(pos);
+		return (dest != nullptr) && ((area == nullptr) || (area == dest));
+	}
+
+	AIFloat3 FindLinear(STerrainMapArea* area, const AIFloat3& position) {
+		float metric = std::numeric_limits<float>::max();
+		auto havIt = havens.end();
+		for (auto it = havens.begin(); it != havens.end(); ++it) {
+			if (!CanMoveToPos(area, *it)) {
+				continue;
+			}
+			float qdist = it->SqDistance2D(position);
+			if (qdist < metric) {
+				havIt = it;
+				metric = qdist;
+			}
+		}
+		return (havIt != havens.end()) ? *havIt : AIFloat3(-RgtVector);
+	}
+
+	/*
+	 * Retreats from every area and from air, index must pick haven as close as linear scan
+	 */
+	void CheckQueries(int count) {
+		CHECK(index.GetHavens().size() == havens.size());
+		int numDiff = 0;
+		for (int i = 0; i < count; ++i) {
+			const AIFloat3 pos = RandPos();
+			STerrainMapArea* area = (i % 10 == 0) ? nullptr : GetArea(pos);
+			const AIFloat3 a = FindLinear(area, pos);
+			const AIFloat3 b = index.FindClosest(area, pos);
+			// equal distance ties may pick other haven
+			if ((a.x != b.x || a.z != b.z) && (a.SqDistance2D(pos) != b.SqDistance2D(pos))) {
+				++numDiff;
+			}
+		}
+		CHECK_MSG(numDiff == 0, numDiff << " of " << count << " retreats differ from linear scan");
+	}
+
+	std::mt19937 rng;
+	float width, height;
+	std::vector<STerrainMapArea> areas;
+	std::vector<AIFloat3> havens;
+	CHavenIndex index;
+};
+
+TEST_CASE("HavenIndex/matches_linear")
+{
+	for (unsigned seed = 1; seed <= 10; ++seed) {
+		SHavenMap hm(seed, 64);
+		hm.CheckQueries(300);
+	}
+}
+
+TEST_CASE("HavenIndex/matches_after_changes")
+{
+	for (unsigned seed = 1; seed <= 10; ++seed) {
+		SHavenMap hm(seed, 64);
+		hm.CheckQueries(100);
+		for (int round = 0; round < 10; ++round) {
+			// nano lost: havens around it go away, then new ones appear
+			const AIFloat3 lost = hm.havens[hm.rng() % hm.havens.size()];
+			hm.RemoveNear(lost, SQUARE(hm.width / 8));
+			hm.CheckQueries(100);
+			hm.AddHaven(lost);
+			hm.AddHaven(hm.RandPos());
+			if (round % 3 == 0) {
+				hm.index.Invalidate();  // areas updated
+			}
+			hm.CheckQueries(100);
+		}
+	}
+}
+
+TEST_CASE("HavenIndex/unreachable")
+{
+	SHavenMap hm(7, 0);
+	const AIFloat3 pos(hm.width / 4, 0.f, hm.height / 4);
+	CHECK(hm.index.IsEmpty());
+	CHECK(hm.index.FindClosest(hm.GetArea(pos), pos) == -RgtVector);
+	hm.AddHaven(AIFloat3(hm.width * 3 / 4, 0.f, hm.height * 3 / 4));  // other area only
+	CHECK(hm.index.FindClosest(hm.GetArea(pos), pos) == -RgtVector);
+	CHECK(hm.index.FindClosest(nullptr, pos) == hm.havens[0]);
+	CHECK(hm.index.FindClosest(pos) == hm.havens[0]);
+	CHECK(hm.index.IsNear(hm.havens[0], 1.f) && !hm.index.IsNear(pos, 1.f));
+}
+
+} // namespace test
+
+} // namespace circuit
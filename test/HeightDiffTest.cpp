@@ -0,0 +1,205 @@
+/*
+ * HeightDiffTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "terrain/HeightDiff.h"
+#include "util/Defines.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+/*
+ * Height map with sectors of CTerrainData: incremental re-evaluation of dirty rectangles
+ * must equal full recompute, and rectangles must cover exactly the changed tiles, once.
+ */
+struct SHeightMap {
+	struct SSector {  // height-derived fields of STerrainMapSector
+		float minElevation;
+		float maxElevation;
+		float percentLand;
+
+		bool operator!=(const SSector& o) const {
+			return (minElevation != o.minElevation) || (maxElevation != o.maxElevation) || (percentLand != o.percentLand);
+		}
+	};
+
+	// Partial tiles at the right and bottom edges if size is not a multiple of tile
+	SHeightMap(unsigned seed, int width, int height, int tile)
+		: width(width)
+		, height(height)
+		, tile(tile)
+		, tilesX((width + tile - 1) / tile)
+		, tilesZ((height + tile - 1) / tile)
+		, rng(seed)
+	{
+		heightMap.resize(width * height);
+		std::uniform_real_distribution<float> phase(0.f, 6.28f);
+		const float px = phase(rng), pz = phase(rng);
+		for (int z = 0; z < height; ++z) {
+			for (int x = 0; x < width; ++x) {
+				heightMap[z * width + x] = 120.f * std::sin(x * 0.011f + px) * std::cos(z * 0.007f + pz) + 30.f;
+			}
+		}
+		sectors.resize(tilesX * tilesZ);
+		for (int i = 0; i < tilesX * tilesZ; ++i) {
+			sectors[i] = Evaluate(heightMap, i % tilesX, i / tilesX);
+		}
+		diff.Init(heightMap, width, height, tile);
+	}
+
+	SSector Evaluate(const std::vector<float>& hm, int x, int z) const {
+		const int iMapH = z * tile * width + x * tile;
+		const int xEnd = std::min(tile, width - x * tile), zEnd = std::min(tile, height - z * tile);
+		SSector s = {hm[iMapH], hm[iMapH], 0.f};
+		for (int zH = 0; zH < zEnd; zH++) {
+			for (int xH = 0, iH = iMapH + zH * width; xH < xEnd; xH++, iH++) {
+				if (hm[iH] >= 0) {
+					s.percentLand++;
+				}
+				s.minElevation = std::min(s.minElevation, hm[iH]);
+				s.maxElevation = std::max(s.maxElevation, hm[iH]);
+			}
+		}
+		s.percentLand *= 100.0 / (xEnd * zEnd);
+		return s;
+	}
+
+	bool IsTileChanged(const std::vector<float>& hm, const std::vector<float>& prev, int x, int z) const {
+		const int iMapH = z * tile * width + x * tile;
+		const int xEnd = std::min(tile, width - x * tile), zEnd = std::min(tile, height - z * tile);
+		for (int zH = 0; zH < zEnd; zH++) {
+			for (int xH = 0, iH = iMapH + zH * width; xH < xEnd; xH++, iH++) {
+				if (hm[iH] != prev[iH]) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	void Crater(std::vector<float>& hm, int cx, int cz, int radius, float depth) const {
+		for (int z = std::max(0, cz - radius); z < std::min(height, cz + radius + 1); ++z) {
+			for (int x = std::max(0, cx - radius); x < std::min(width, cx + radius + 1); ++x) {
+				const float sqDist = SQUARE(x - cx) + SQUARE(z - cz);
+				if (sqDist <= SQUARE(radius)) {
+					hm[z * width + x] -= depth * (1.f - sqDist / SQUARE(radius));
+				}
+			}
+		}
+	}
+
+	std::vector<float> Perturb(int numCraters) {
+		std::vector<float> result = heightMap;
+		std::uniform_int_distribution<int> posX(0, width - 1), posZ(0, height - 1), radius(1, 12);
+		std::uniform_real_distribution<float> depth(1.f, 60.f);
+		for (int i = 0; i < numCraters; ++i) {
+			Crater(result, posX(rng), posZ(rng), radius(rng), depth(rng));
+		}
+		return result;
+	}
+
+	/*
+	 * CTerrainData::UpdateAreas: re-evaluate dirty rectangles, then commit
+	 */
+	void Update(const std::vector<float>& next) {
+		std::vector<int> count(sectors.size(), 0);
+		int numOutside = 0;
+		for (const CHeightDiff::SRect& r : diff.Diff(next)) {
+			if ((r.x1 < 0) || (r.z1 < 0) || (r.x2 > tilesX) || (r.z2 > tilesZ) || (r.x1 >= r.x2) || (r.z1 >= r.z2)) {
+				++numOutside;
+				continue;
+			}
+			for (int z = r.z1; z < r.z2; ++z) {
+				for (int x = r.x1; x < r.x2; ++x) {
+					const int i = z * tilesX + x;
+					sectors[i] = Evaluate(next, x, z);
+					++count[i];
+				}
+			}
+		}
+		CHECK_MSG(numOutside == 0, numOutside << " empty or out of map rectangles");
+		int numStale = 0, numMiscovered = 0;
+		for (int i = 0; i < tilesX * tilesZ; ++i) {
+			const int x = i % tilesX, z = i / tilesX;
+			numStale += (sectors[i] != Evaluate(next, x, z)) ? 1 : 0;
+			numMiscovered += (count[i] != (IsTileChanged(next, heightMap, x, z) ? 1 : 0)) ? 1 : 0;
+		}
+		CHECK_MSG(numStale == 0, numStale << " sectors differ from full recompute");
+		CHECK_MSG(numMiscovered == 0, numMiscovered << " tiles covered not once if changed, or covered if unchanged");
+		diff.Commit();
+		heightMap = next;
+	}
+
+	int width, height;
+	int tile;
+	int tilesX, tilesZ;
+	std::mt19937 rng;
+	std::vector<float> heightMap;
+	std::vector<SSector> sectors;
+	CHeightDiff diff;
+};
+
+// Craters, unchanged map and terraform of a big block
+static void CheckRounds(SHeightMap& hm)
+{
+	for (int round = 0; round < 20; ++round) {
+		std::vector<float> next = (round % 5 == 4) ? hm.heightMap : hm.Perturb(1 + round * 4);
+		if (round % 7 == 3) {
+			for (int z = hm.height / 4; z < hm.height / 2; ++z) {
+				for (int x = hm.width / 3; x < hm.width / 2; ++x) {
+					next[z * hm.width + x] = 10.f;
+				}
+			}
+		}
+		hm.Update(next);
+	}
+}
+
+TEST_CASE("HeightDiff/matches_full_recompute")
+{
+	for (unsigned seed = 1; seed <= 5; ++seed) {
+		SHeightMap hm(seed, 512, 256, 8);
+		CheckRounds(hm);
+	}
+}
+
+TEST_CASE("HeightDiff/partial_edge_tiles")
+{
+	for (unsigned seed = 1; seed <= 5; ++seed) {
+		SHeightMap hm(seed, 203, 97, 8);
+		CheckRounds(hm);
+	}
+	SHeightMap odd(11, 61, 45, 7);  // odd tile: hash tail of single cell
+	CheckRounds(odd);
+}
+
+TEST_CASE("HeightDiff/single_cell")
+{
+	SHeightMap hm(3, 128, 64, 8);
+	CHECK(hm.diff.Diff(hm.heightMap).empty());
+	for (int i = 0; i < 200; ++i) {
+		std::vector<float> next = hm.heightMap;
+		const int x = hm.rng() % hm.width, z = hm.rng() % hm.height;
+		next[z * hm.width + x] += 0.5f;
+		const std::vector<CHeightDiff::SRect>& rects = hm.diff.Diff(next);
+		CHECK_MSG((rects.size() == 1) && (rects[0].x1 == x / 8) && (rects[0].z1 == z / 8)
+			&& (rects[0].x2 == x / 8 + 1) && (rects[0].z2 == z / 8 + 1), "cell (" << x << ", " << z << ")");
+		// Not committed: the same map is still dirty
+		CHECK(hm.diff.Diff(next).size() == 1);
+		hm.Update(next);
+	}
+}
+
+} // namespace test
+
+} // namespace circuit
@@ -0,0 +1,142 @@
+/*
+ * MicroPatherTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "terrain/MicroPather.h"
+#include "terrain/ThreatRaster.h"
+#include "util/Defines.h"
+
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+class CTestGraph: public NSMicroPather::Graph {
+};
+
+/*
+ * Random move map with 1-cell impassable edges and threat-weighted costs, layout of CPathFinder
+ */
+struct SPathMap {
+	SPathMap(unsigned seed, int width, int height) : rng(seed), width(width), height(height) {
+		canMove.assign(width * height, false);
+		std::uniform_int_distribution<int> block(0, 9);
+		for (int z = 1; z < height - 1; ++z) {
+			for (int x = 1; x < width - 1; ++x) {
+				canMove[z * width + x] = (block(rng) > 1);
+			}
+		}
+		costs.assign(width * height, THREAT_BASE);
+		std::uniform_int_distribution<int> distX(1, width - 2), distZ(1, height - 2);
+		for (int i = 0; i < 40; ++i) {
+			raster::AddThreat(&costs[0], width, height, distX(rng), distZ(rng), 12, 50.f);
+		}
+	}
+
+	int RandomPassable() {
+		std::uniform_int_distribution<int> dist(0, width * height - 1);
+		int idx;
+		do {
+			idx = dist(rng);
+		} while (!canMove[idx]);
+		return idx;
+	}
+
+	// Ring of goals around target as in CPathFinder::FindBestPath
+	void AddRing(int target, int radius, std::vector<void*>& outNodes) const {
+		const int tz = target / width, tx = target % width;
+		for (int z = -radius; z <= radius; ++z) {
+			for (int x = -radius; x <= radius; ++x) {
+				const int r = int(std::round(std::sqrt(float(x * x + z * z))));
+				const int sx = tx + x, sz = tz + z;
+				if ((r == radius) && (sx > 0) && (sx < width - 1) && (sz > 0) && (sz < height - 1)) {
+					outNodes.push_back((void*)(intptr_t)(sz * width + sx));
+				}
+			}
+		}
+	}
+
+	// @return cost to the closest goal, -1 if none is reachable
+	float Dijkstra(int start, const std::vector<void*>& endNodes) const {
+		std::vector<char> isGoal(costs.size(), 0);
+		for (void* node : endNodes) {
+			isGoal[(intptr_t)node] = 1;
+		}
+		const int offsets[8] = {-1, 1, width, -width, -width - 1, -width + 1, width - 1, width + 1};
+		std::vector<float> dist(costs.size(), std::numeric_limits<float>::max());
+		using Item = std::pair<float, int>;
+		std::priority_queue<Item, std::vector<Item>, std::greater<Item>> open;
+		dist[start] = 0.f;
+		open.push({0.f, start});
+		while (!open.empty()) {
+			const Item item = open.top();
+			open.pop();
+			if (item.first > dist[item.second]) {
+				continue;
+			}
+			if (isGoal[item.second]) {
+				return item.first;
+			}
+			for (int i = 0; i < 8; ++i) {
+				const int next = item.second + offsets[i];
+				if (!canMove[next]) {
+					continue;
+				}
+				const float cost = item.first + ((i > 3) ? costs[next] * SQRT_2 : costs[next]);
+				if (cost < dist[next]) {
+					dist[next] = cost;
+					open.push({cost, next});
+				}
+			}
+		}
+		return -1.f;
+	}
+
+	std::mt19937 rng;
+	int width, height;
+	std::vector<char> canMove;  // not vector<bool>, MicroPather wants bool*
+	std::vector<float> costs;
+};
+
+/*
+ * First reached goal must be the closest one: few targets (defence) and many (mex spots)
+ */
+TEST_CASE("MicroPather/any_goal_is_closest")
+{
+	for (int numTargets : {1, 4, 24}) {
+		SPathMap map(numTargets, 130, 98);
+		CTestGraph graph;
+		NSMicroPather::CMicroPather pather(&graph, map.width, map.height);
+		pather.SetMapData(reinterpret_cast<bool*>(&map.canMove[0]), &map.costs[0]);
+		std::vector<void*> path;
+		for (int i = 0; i < 40; ++i) {
+			const int start = map.RandomPassable();
+			std::vector<void*> endNodes;
+			for (int j = 0; j < numTargets; ++j) {
+				map.AddRing(map.RandomPassable(), 4, endNodes);
+			}
+			const float costRef = map.Dijkstra(start, endNodes);
+			float cost = -1.f;
+			const int result = pather.FindBestPathToAnyGivenPoint((void*)(intptr_t)start, endNodes, &path, &cost);
+			if (costRef < 0.f) {
+				CHECK(result == NSMicroPather::CMicroPather::NO_SOLUTION);
+			} else {
+				CHECK_MSG((result == NSMicroPather::CMicroPather::SOLVED) && (std::fabs(cost - costRef) <= 1e-3f * costRef + 1e-3f),
+						  numTargets << " targets: cost " << cost << " differs from Dijkstra " << costRef);
+			}
+		}
+	}
+}
+
+} // namespace test
+
+} // namespace circuit
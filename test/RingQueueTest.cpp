@@ -0,0 +1,138 @@
+/*
+ * RingQueueTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "util/RingQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace circuit {
+
+namespace test {
+
+// Mimics CScheduler::WorkTask: 2 shared_ptr and owner id
+struct SItem {
+	std::shared_ptr<int> task;
+	std::shared_ptr<int> onComplete;
+	int producer;
+	int seq;
+};
+
+/*
+ * Producers and consumers through small queue (full and empty most of the time):
+ * every item must arrive exactly once and in order of its producer.
+ */
+static void Stress(std::size_t capacity, int numProducers, int numConsumers, int numItems)
+{
+	CRingQueue<SItem> queue(capacity);
+	std::vector<std::vector<int>> lastSeq(numConsumers, std::vector<int>(numProducers, -1));
+	std::vector<std::vector<int>> counts(numConsumers, std::vector<int>(numProducers, 0));
+	std::atomic<int> numPopped(0);
+	std::atomic<int> numBroken(0);
+	std::atomic<int> numReordered(0);
+	std::vector<std::thread> threads;
+	for (int p = 0; p < numProducers; ++p) {
+		threads.emplace_back([&queue, p, numItems]() {
+			auto task = std::make_shared<int>(p);
+			for (int i = 0; i < numItems; ++i) {
+				queue.Push({task, nullptr, p, i});
+			}
+		});
+	}
+	const int total = numProducers * numItems;
+	for (int c = 0; c < numConsumers; ++c) {
+		threads.emplace_back([&, c]() {
+			while (numPopped.fetch_add(1) < total) {
+				SItem item = queue.Pop();
+				if ((item.task == nullptr) || (*item.task != item.producer)) {
+					++numBroken;
+					continue;
+				}
+				if (item.seq <= lastSeq[c][item.producer]) {
+					++numReordered;
+				}
+				lastSeq[c][item.producer] = item.seq;
+				++counts[c][item.producer];
+			}
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	CHECK_MSG(numBroken == 0, numBroken << " items with wrong payload");
+	CHECK_MSG(numReordered == 0, numReordered << " items out of producer's order");
+	for (int p = 0; p < numProducers; ++p) {
+		int count = 0;
+		for (int c = 0; c < numConsumers; ++c) {
+			count += counts[c][p];
+		}
+		CHECK_MSG(count == numItems, "producer " << p << " delivered " << count << " of " << numItems);
+	}
+	CHECK(queue.IsEmpty());
+}
+
+TEST_CASE("RingQueue/stress_mpmc")
+{
+	Stress(16, 8, 2, 100000);
+}
+
+TEST_CASE("RingQueue/stress_spsc_tiny")
+{
+	Stress(2, 1, 1, 100000);
+}
+
+TEST_CASE("RingQueue/stress_many_consumers")
+{
+	Stress(64, 2, 6, 50000);
+}
+
+TEST_CASE("RingQueue/full_and_empty")
+{
+	CRingQueue<int> queue(5);
+	CHECK(queue.GetCapacity() == 8);
+	CHECK(queue.IsEmpty());
+	int item = -1;
+	CHECK(!queue.TryPop(item) && (item == -1));
+	for (int i = 0; i < 8; ++i) {
+		CHECK(queue.TryPush(i));
+	}
+	CHECK(!queue.TryPush(8));
+	for (int i = 0; i < 8; ++i) {
+		CHECK(queue.TryPop(item) && (item == i));
+	}
+	CHECK(!queue.TryPop(item));
+	CHECK(queue.IsEmpty());
+}
+
+TEST_CASE("RingQueue/items_destroyed")
+{
+	auto task = std::make_shared<int>(0);
+	{
+		CRingQueue<SItem> queue(8);
+		for (int i = 0; i < 6; ++i) {
+			queue.Push({task, nullptr, 0, i});
+		}
+		int seq = -1;
+		queue.PopAndProcess([&seq](SItem& item) { seq = item.seq; });
+		CHECK(seq == 0);
+		CHECK(task.use_count() == 6);
+		queue.Clear();
+		CHECK(queue.IsEmpty() && (task.use_count() == 1));
+		for (int i = 0; i < 3; ++i) {
+			queue.Push({task, nullptr, 0, i});
+		}
+	}  // destructor clears
+	CHECK(task.use_count() == 1);
+}
+
+} // namespace test
+
+} // namespace circuit
@@ -0,0 +1,279 @@
+/*
+ * SaveStateTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "util/SaveState.h"
+#include "util/SaveStream.h"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace circuit {
+
+namespace test {
+
+using namespace springai;
+
+/*
+ * Random state of every module, as CCircuitAI::Save writes it
+ */
+struct SSaveData {
+	SSaveData(unsigned seed) : rng(seed), dist(0.f, 100.f) {
+		threat.width = 66;
+		threat.height = 34;
+		threat.squareSize = 64;
+		for (std::vector<float>* layer : {&threat.airThreat, &threat.surfThreat, &threat.amphThreat, &threat.cloakThreat, &threat.shield}) {
+			layer->resize(threat.width * threat.height);
+			for (float& v : *layer) {
+				v = dist(rng);
+			}
+		}
+		threat.hostileUnits.resize(160);
+		threat.peaceUnits.resize(40);
+		int unitId = 0;
+		for (std::vector<SEnemyState>* units : {&threat.hostileUnits, &threat.peaceUnits}) {
+			for (SEnemyState& e : *units) {
+				e.unitId = unitId++;
+				e.defId = (unitId % 7 == 0) ? -1 : unitId % 300;
+				e.lastSeen = unitId * 3;
+				e.cost = dist(rng);
+				e.pos = RandPos();
+				e.newPos = RandPos();
+				e.threat = dist(rng);
+				for (int& r : e.range) {
+					r = rng() % 1000;
+				}
+				e.losStatus = rng() % 16;
+			}
+		}
+
+		metal.markFrame = 1234;
+		for (int i = 0; i < 50; ++i) {
+			metal.markedMexes.push_back({i * 2, i});
+		}
+		for (int i = 0; i < 20; ++i) {
+			metal.clusters.push_back({unsigned(rng() % 5), unsigned(rng() % 5)});
+		}
+
+		energy.isValid.resize(60);
+		for (uint8_t& v : energy.isValid) {
+			v = rng() % 2;
+		}
+
+		economy.metalIncomes.resize(5);
+		economy.energyIncomes.resize(5);
+		for (unsigned i = 0; i < 5; ++i) {
+			economy.metalIncomes[i] = dist(rng);
+			economy.energyIncomes[i] = dist(rng);
+		}
+		economy.indexRes = 3;
+		economy.metalIncome = dist(rng);
+		economy.energyIncome = dist(rng);
+		economy.metalProduced = dist(rng);
+		economy.metalUsed = dist(rng);
+		economy.lastFacFrame = 900;
+
+		for (SMilitaryState::SEnemyInfo& info : military.enemyInfos) {
+			info = {dist(rng), dist(rng)};
+		}
+		military.enemyMobileCost = dist(rng);
+		military.mobileThreat = dist(rng);
+		military.staticThreat = dist(rng);
+		military.enemyPos = RandPos();
+		military.scoutIdx = 7;
+		military.defenceIdx = 11;
+		military.groups.resize(30);
+		for (SMilitaryState::SGroup& group : military.groups) {
+			group.units.resize(1 + rng() % 20);
+			for (int& id : group.units) {
+				id = rng() % unitId;
+			}
+			group.pos = RandPos();
+			for (float& c : group.roleCosts) {
+				c = dist(rng);
+			}
+			group.cost = dist(rng);
+			group.threat = dist(rng);
+		}
+	}
+
+	AIFloat3 RandPos() {
+		return AIFloat3(dist(rng) * 40.f, dist(rng), dist(rng) * 20.f);
+	}
+
+	// @param skip  section written with other version
+	std::string Write(SaveSection skip = SaveSection(0)) const {
+		auto version = [skip](SaveSection id) { return (id == skip) ? 2u : 1u; };
+		std::ostringstream buf(std::ios::binary);
+		CSaveWriter writer(buf);
+		writer.Write(SaveSection::THREAT, version(SaveSection::THREAT), [this](std::ostream& os) { threat.Save(os); });
+		writer.Write(SaveSection::METAL, version(SaveSection::METAL), [this](std::ostream& os) { metal.Save(os); });
+		writer.Write(SaveSection::ENERGY, version(SaveSection::ENERGY), [this](std::ostream& os) { energy.Save(os); });
+		writer.Write(SaveSection::ECONOMY, version(SaveSection::ECONOMY), [this](std::ostream& os) { economy.Save(os); });
+		writer.Write(SaveSection::MILITARY, version(SaveSection::MILITARY), [this](std::ostream& os) { military.Save(os); });
+		CHECK(writer.IsGood());
+		return buf.str();
+	}
+
+	std::mt19937 rng;
+	std::uniform_real_distribution<float> dist;
+	SThreatState threat;
+	SMetalState metal;
+	SEnergyState energy;
+	SEconomyState economy;
+	SMilitaryState military;
+};
+
+template<typename T> static bool Load(const std::string& data, SaveSection id, T& outState)
+{
+	std::istringstream is(data, std::ios::binary);
+	CSaveReader reader(is);
+	return reader.IsValid() && reader.Read(id, 1, [&outState](std::istream& is) {
+		return outState.Load(is);
+	});
+}
+
+static bool Same(const SEnemyState& a, const SEnemyState& b)
+{
+	return (a.unitId == b.unitId) && (a.defId == b.defId) && (a.lastSeen == b.lastSeen)
+		&& (a.cost == b.cost) && (a.pos == b.pos) && (a.newPos == b.newPos)
+		&& (a.threat == b.threat) && (a.range == b.range) && (a.losStatus == b.losStatus);
+}
+
+static bool Same(const std::vector<SEnemyState>& a, const std::vector<SEnemyState>& b)
+{
+	return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin(),
+		[](const SEnemyState& l, const SEnemyState& r) { return Same(l, r); });
+}
+
+static bool Same(const SThreatState& a, const SThreatState& b)
+{
+	return (a.width == b.width) && (a.height == b.height) && (a.squareSize == b.squareSize)
+		&& Same(a.hostileUnits, b.hostileUnits) && Same(a.peaceUnits, b.peaceUnits)
+		&& (a.airThreat == b.airThreat) && (a.surfThreat == b.surfThreat) && (a.amphThreat == b.amphThreat)
+		&& (a.cloakThreat == b.cloakThreat) && (a.shield == b.shield);
+}
+
+static bool Same(const SMetalState& a, const SMetalState& b)
+{
+	return (a.markFrame == b.markFrame) && (a.markedMexes.size() == b.markedMexes.size())
+		&& std::equal(a.markedMexes.begin(), a.markedMexes.end(), b.markedMexes.begin(),
+			[](const SMetalState::SMex& l, const SMetalState::SMex& r) {
+				return (l.unitId == r.unitId) && (l.index == r.index);
+			})
+		&& (a.clusters.size() == b.clusters.size())
+		&& std::equal(a.clusters.begin(), a.clusters.end(), b.clusters.begin(),
+			[](const SMetalState::SCluster& l, const SMetalState::SCluster& r) {
+				return (l.queuedCount == r.queuedCount) && (l.finishedCount == r.finishedCount);
+			});
+}
+
+static bool Same(const SEnergyState& a, const SEnergyState& b)
+{
+	return a.isValid == b.isValid;
+}
+
+static bool Same(const SEconomyState& a, const SEconomyState& b)
+{
+	return (a.metalIncomes == b.metalIncomes) && (a.energyIncomes == b.energyIncomes)
+		&& (a.indexRes == b.indexRes) && (a.metalIncome == b.metalIncome) && (a.energyIncome == b.energyIncome)
+		&& (a.metalProduced == b.metalProduced) && (a.metalUsed == b.metalUsed) && (a.lastFacFrame == b.lastFacFrame);
+}
+
+static bool Same(const SMilitaryState& a, const SMilitaryState& b)
+{
+	return std::equal(a.enemyInfos.begin(), a.enemyInfos.end(), b.enemyInfos.begin(),
+			[](const SMilitaryState::SEnemyInfo& l, const SMilitaryState::SEnemyInfo& r) {
+				return (l.cost == r.cost) && (l.threat == r.threat);
+			})
+		&& (a.enemyMobileCost == b.enemyMobileCost) && (a.mobileThreat == b.mobileThreat)
+		&& (a.staticThreat == b.staticThreat) && (a.enemyPos == b.enemyPos)
+		&& (a.scoutIdx == b.scoutIdx) && (a.defenceIdx == b.defenceIdx)
+		&& (a.groups.size() == b.groups.size())
+		&& std::equal(a.groups.begin(), a.groups.end(), b.groups.begin(),
+			[](const SMilitaryState::SGroup& l, const SMilitaryState::SGroup& r) {
+				return (l.units == r.units) && (l.pos == r.pos) && (l.roleCosts == r.roleCosts)
+					&& (l.cost == r.cost) && (l.threat == r.threat);
+			});
+}
+
+template<typename T> static void CheckRoundTrip(const std::string& data, SaveSection id, const T& state, const char* name)
+{
+	T fresh{};
+	CHECK_MSG(Load(data, id, fresh) && Same(fresh, state), name << " round-trip mismatch");
+}
+
+/*
+ * Truncated section must fail to load, whatever byte it's cut at
+ */
+template<typename T> static void CheckTruncated(const T& state, const char* name)
+{
+	std::ostringstream os(std::ios::binary);
+	state.Save(os);
+	const std::string payload = os.str();
+	for (std::size_t len = 0; len < payload.size(); len += 1 + len / 8) {
+		std::istringstream is(payload.substr(0, len), std::ios::binary);
+		T fresh{};
+		CHECK_MSG(!fresh.Load(is), name << " truncated at " << len << " of " << payload.size() << " loaded");
+	}
+}
+
+TEST_CASE("SaveState/round_trip")
+{
+	SSaveData sd(17);
+	const std::string data = sd.Write();
+	CheckRoundTrip(data, SaveSection::THREAT, sd.threat, "THREAT");
+	CheckRoundTrip(data, SaveSection::METAL, sd.metal, "METAL");
+	CheckRoundTrip(data, SaveSection::ENERGY, sd.energy, "ENERGY");
+	CheckRoundTrip(data, SaveSection::ECONOMY, sd.economy, "ECONOMY");
+	CheckRoundTrip(data, SaveSection::MILITARY, sd.military, "MILITARY");
+}
+
+TEST_CASE("SaveState/truncated_section")
+{
+	SSaveData sd(23);
+	CheckTruncated(sd.threat, "THREAT");
+	CheckTruncated(sd.metal, "METAL");
+	CheckTruncated(sd.energy, "ENERGY");
+	CheckTruncated(sd.economy, "ECONOMY");
+	CheckTruncated(sd.military, "MILITARY");
+}
+
+TEST_CASE("SaveState/other_version_skipped")
+{
+	SSaveData sd(31);
+	const std::string data = sd.Write(SaveSection::METAL);
+	SMetalState metal{};
+	CHECK(!Load(data, SaveSection::METAL, metal));
+	// Sections after skipped one are intact
+	CheckRoundTrip(data, SaveSection::ENERGY, sd.energy, "ENERGY");
+	CheckRoundTrip(data, SaveSection::MILITARY, sd.military, "MILITARY");
+}
+
+TEST_CASE("SaveState/corrupted_file")
+{
+	SSaveData sd(37);
+	const std::string data = sd.Write();
+	{
+		std::string bad = data;
+		bad[0] ^= 0x5a;  // magic
+		std::istringstream is(bad, std::ios::binary);
+		CHECK(!CSaveReader(is).IsValid());
+	}
+	for (std::size_t len : {std::size_t(0), std::size_t(3), data.size() / 2, data.size() - 1}) {
+		std::istringstream is(data.substr(0, len), std::ios::binary);
+		CSaveReader reader(is);
+		CHECK_MSG(!reader.IsValid() || !reader.HasSection(SaveSection::MILITARY), "file truncated at " << len << " is complete");
+	}
+}
+
+} // namespace test
+
+} // namespace circuit
@@ -0,0 +1,94 @@
+/*
+ * SlotMapTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "util/SlotMap.h"
+
+#include <map>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+/*
+ * Random inserts, erases (by key and by iterator) and lookups against std::map,
+ * which CSlotMap replaced for units and defs
+ */
+TEST_CASE("SlotMap/matches_std_map")
+{
+	std::mt19937 rng(5);
+	std::uniform_int_distribution<int> anyId(0, 999), anyOp(0, 9);
+	CSlotMap<int, int> slots;
+	std::map<int, int> ref;
+	int numDiff = 0;
+	for (int i = 0; i < 100000; ++i) {
+		const int id = anyId(rng);
+		switch (anyOp(rng)) {
+			case 0: case 1: case 2: {
+				const bool isNew = slots.emplace(id, i).second;
+				numDiff += (isNew != ref.emplace(id, i).second) ? 1 : 0;
+			} break;
+			case 3: {
+				slots[id] += 1;
+				ref[id] += 1;
+			} break;
+			case 4: case 5: {
+				numDiff += (slots.erase(id) != ref.erase(id)) ? 1 : 0;
+			} break;
+			case 6: {  // erase while iterating, as unit loops do
+				for (auto it = slots.begin(); it != slots.end();) {
+					if (it->second % 97 == id % 97) {
+						ref.erase(it->first);
+						it = slots.erase(it);
+					} else {
+						++it;
+					}
+				}
+			} break;
+			default: {
+				auto it = slots.find(id);
+				auto refIt = ref.find(id);
+				numDiff += ((it == slots.end()) != (refIt == ref.end())) ? 1 : 0;
+				numDiff += ((it != slots.end()) && (refIt != ref.end()) && (it->second != refIt->second)) ? 1 : 0;
+				numDiff += (slots.count(id) != ref.count(id)) ? 1 : 0;
+			} break;
+		}
+	}
+	CHECK_MSG(numDiff == 0, numDiff << " operations differ from std::map");
+	CHECK(slots.size() == ref.size());
+	std::map<int, int> content(slots.begin(), slots.end());
+	CHECK(content == ref);
+}
+
+TEST_CASE("SlotMap/handle_of_erased_key")
+{
+	CSlotMap<int, const char*> units;
+	units.emplace(7, "first");
+	const CSlotMap<int, const char*>::SHandle handle = units.GetHandle(7);
+	CHECK(units.Resolve(handle) == units[7]);
+	units.erase(7);
+	CHECK(units.Resolve(handle) == nullptr);
+	units.emplace(7, "reused");  // engine reuses id for a new unit
+	CHECK(units.Resolve(handle) == nullptr);
+	CHECK(units.GetHandle(7) != handle);
+	CHECK(units.Resolve(units.GetHandle(7)) == units[7]);
+
+	const CSlotMap<int, const char*>::SHandle missing = units.GetHandle(100);
+	units.emplace(100, "late");
+	CHECK(units.Resolve(missing) == nullptr);
+
+	const CSlotMap<int, const char*>::SHandle cleared = units.GetHandle(100);
+	units.clear();
+	CHECK(units.empty() && (units.Resolve(cleared) == nullptr));
+	CHECK((units.find(-1) == units.end()) && (units.count(1 << 20) == 0));
+}
+
+} // namespace test
+
+} // namespace circuit
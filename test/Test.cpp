@@ -0,0 +1,55 @@
+/*
+ * Test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include <iostream>
+#include <cstring>
+
+namespace circuit {
+
+namespace test {
+
+static int failCount = 0;
+
+std::vector<SCase>& GetCases()
+{
+	static std::vector<SCase> cases;
+	return cases;
+}
+
+void Fail(const char* file, int line, const std::string& message)
+{
+	std::cerr << file << ":" << line << ": check failed: " << message << "\n";
+	++failCount;
+}
+
+} // namespace test
+
+} // namespace circuit
+
+using namespace circuit::test;
+
+/*
+ * Usage: circuit_test_<name> [filter], runs cases whose name contains filter
+ */
+int main(int argc, char* argv[])
+{
+	const char* filter = (argc > 1) ? argv[1] : "";
+	int failedCases = 0;
+	for (const SCase& c : GetCases()) {
+		if (strstr(c.name, filter) == nullptr) {
+			continue;
+		}
+		const int fails = failCount;
+		c.func();
+		const bool isOk = (fails == failCount);
+		std::cout << (isOk ? "[  OK  ] " : "[ FAIL ] ") << c.name << std::endl;
+		failedCases += isOk ? 0 : 1;
+	}
+	return (failedCases == 0) ? 0 : 1;
+}
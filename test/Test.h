@@ -0,0 +1,53 @@
+/*
+ * Test.h
+ *
+ *  Minimal harness of circuit tests: case registry and checks
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef TEST_TEST_H_
+#define TEST_TEST_H_
+
+#include <functional>
+#include <sstream>
+#include <vector>
+
+namespace circuit {
+
+namespace test {
+
+/*
+ * Case keeps running after failed check, executable exits with 1 if any check failed
+ */
+struct SCase {
+	const char* name;
+	std::function<void ()> func;
+};
+
+std::vector<SCase>& GetCases();
+
+struct SRegistrar {
+	SRegistrar(const char* name, std::function<void ()> func) { GetCases().push_back({name, func}); }
+};
+
+void Fail(const char* file, int line, const std::string& message);
+
+} // namespace test
+
+} // namespace circuit
+
+#define TEST_CONCAT_(a, b)	a##b
+#define TEST_CONCAT(a, b)	TEST_CONCAT_(a, b)
+#define TEST_CASE(name)	\
+	static void TEST_CONCAT(testCase, __LINE__)();	\
+	static circuit::test::SRegistrar TEST_CONCAT(testRegistrar, __LINE__)(name, TEST_CONCAT(testCase, __LINE__));	\
+	static void TEST_CONCAT(testCase, __LINE__)()
+
+#define CHECK(cond)	\
+	do { if (!(cond)) { circuit::test::Fail(__FILE__, __LINE__, #cond); } } while (false)
+// @param msg  stream expression, e.g. "cost " << cost
+#define CHECK_MSG(cond, msg)	\
+	do { if (!(cond)) { std::ostringstream testOs; testOs << #cond << ": " << msg; circuit::test::Fail(__FILE__, __LINE__, testOs.str()); } } while (false)
+
+#endif // TEST_TEST_H_
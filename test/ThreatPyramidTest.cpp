@@ -0,0 +1,208 @@
+/*
+ * ThreatPyramidTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "Test.h"
+
+#include "terrain/ThreatPyramid.h"
+#include "terrain/ThreatRaster.h"
+#include "util/Defines.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace circuit {
+
+namespace test {
+
+/*
+ * Threat layer of 256 enemies in 8 armies, rasterized as CThreatMap does,
+ * with brute-force scans as reference for CThreatPyramid queries.
+ */
+struct SThreatLayer {
+	struct SEnemy {
+		int x, z, range;
+		float threat;
+	};
+
+	SThreatLayer(unsigned seed, int width, int height) : rng(seed), width(width), height(height) {
+		layer.assign(width * height, THREAT_BASE);
+		std::uniform_int_distribution<int> distX(1, width - 2), distZ(1, height - 2);
+		std::uniform_int_distribution<int> range(2, 12), spread(-8, 8);
+		std::uniform_real_distribution<float> threat(1.f, 200.f);
+		for (int army = 0; army < 8; ++army) {
+			const int ax = distX(rng), az = distZ(rng);
+			for (int i = 0; i < 32; ++i) {
+				const int x = std::max(1, std::min(width - 2, ax + spread(rng)));
+				const int z = std::max(1, std::min(height - 2, az + spread(rng)));
+				enemies.push_back({x, z, range(rng), threat(rng)});
+				Add(enemies.back());
+			}
+		}
+		pyramid.Init(&layer[0], width, height);
+	}
+
+	void Add(const SEnemy& e) {
+		raster::AddThreat(&layer[0], width, height, e.x, e.z, e.range, e.threat);
+		pyramid.MarkDirty(e.x - e.range, e.z - e.range, e.x + e.range + 1, e.z + e.range + 1);
+	}
+	void Del(const SEnemy& e) {
+		raster::DelThreat(&layer[0], width, height, e.x, e.z, e.range, e.threat);
+		pyramid.MarkDirty(e.x - e.range, e.z - e.range, e.x + e.range + 1, e.z + e.range + 1);
+	}
+	void Move() {
+		SEnemy& e = enemies[rng() % enemies.size()];
+		Del(e);
+		e.x = std::max(1, std::min(width - 2, e.x + int(rng() % 3) - 1));
+		e.z = std::max(1, std::min(height - 2, e.z + int(rng() % 3) - 1));
+		Add(e);
+	}
+	void Kill() {
+		const unsigned index = rng() % enemies.size();
+		Del(enemies[index]);
+		enemies[index] = enemies.back();
+		enemies.pop_back();
+	}
+	// As CThreatMap::Update: only cells that decayed mark their tile
+	void Decay(float decay) {
+		for (int z = 0, index = 0; z < height; ++z) {
+			for (int x = 0; x < width; ++x, ++index) {
+				const float value = std::max<float>(layer[index] - decay, THREAT_BASE);
+				if (value != layer[index]) {
+					layer[index] = value;
+					pyramid.MarkDirty(x, z);
+				}
+			}
+		}
+	}
+
+	float ScanMaxInRect(int x1, int z1, int x2, int z2) const {
+		float best = std::numeric_limits<float>::lowest();
+		for (int z = std::max(z1, 0); z <= std::min(z2, height - 1); ++z) {
+			for (int x = std::max(x1, 0); x <= std::min(x2, width - 1); ++x) {
+				best = std::max(best, layer[z * width + x]);
+			}
+		}
+		return best;
+	}
+	double ScanSumInCircle(float cx, float cz, float radius, int& outCount) const {
+		double sum = 0.0;
+		outCount = 0;
+		for (int z = 0; z < height; ++z) {
+			for (int x = 0; x < width; ++x) {
+				if (SQUARE(x + 0.5f - cx) + SQUARE(z + 0.5f - cz) <= SQUARE(radius)) {
+					sum += layer[z * width + x];
+					++outCount;
+				}
+			}
+		}
+		return sum;
+	}
+	// Test of every cell box [x, x+1] x [z, z+1] against segment, Liang-Barsky clip
+	float ScanMaxAlongSegment(float x1, float z1, float x2, float z2) const {
+		float best = std::numeric_limits<float>::lowest();
+		const float dx = x2 - x1, dz = z2 - z1;
+		for (int z = int(std::min(z1, z2)); z <= int(std::max(z1, z2)); ++z) {
+			for (int x = int(std::min(x1, x2)); x <= int(std::max(x1, x2)); ++x) {
+				float t0 = 0.f, t1 = 1.f;
+				auto clip = [&t0, &t1](float p, float q) {  // p * t <= q
+					if (p == 0.f) {
+						return q >= 0.f;
+					}
+					const float r = q / p;
+					if (p < 0.f) {
+						t0 = std::max(t0, r);
+					} else {
+						t1 = std::min(t1, r);
+					}
+					return t0 <= t1;
+				};
+				if (clip(-dx, x1 - x) && clip(dx, x + 1 - x1) && clip(-dz, z1 - z) && clip(dz, z + 1 - z1)) {
+					best = std::max(best, layer[z * width + x]);
+				}
+			}
+		}
+		return best;
+	}
+
+	// Random queries of all three kinds, rectangles may cross the border
+	void CheckQueries(int count) {
+		std::uniform_int_distribution<int> x(0, width - 1), z(0, height - 1), size(0, 48);
+		std::uniform_real_distribution<float> fx(0.f, width - 0.001f), fz(0.f, height - 0.001f), radius(0.f, 32.f);
+		for (int i = 0; i < count; ++i) {
+			const int x1 = x(rng), z1 = z(rng), x2 = x1 + size(rng), z2 = z1 + size(rng);
+			const float max = pyramid.GetMaxInRect(x1, z1, x2, z2);
+			const float maxRef = ScanMaxInRect(x1, z1, x2, z2);
+			CHECK_MSG(max == maxRef, "rect " << x1 << "," << z1 << " " << x2 << "," << z2 << ": " << max << " vs " << maxRef);
+
+			const float cx = fx(rng), cz = fz(rng), r = radius(rng);
+			int count, countRef;
+			const float sum = pyramid.GetSumInCircle(cx, cz, r, count);
+			const double sumRef = ScanSumInCircle(cx, cz, r, countRef);
+			CHECK_MSG((count == countRef) && (std::fabs(sum - sumRef) <= 1e-4 * std::max(1.0, sumRef)),
+					  "circle " << cx << "," << cz << " r " << r << ": " << sum << " (" << count << ") vs " << sumRef << " (" << countRef << ")");
+
+			const float sx1 = fx(rng), sz1 = fz(rng), sx2 = fx(rng), sz2 = fz(rng);
+			const float segMax = pyramid.GetMaxAlongSegment(sx1, sz1, sx2, sz2);
+			const float segMaxRef = ScanMaxAlongSegment(sx1, sz1, sx2, sz2);
+			CHECK_MSG(segMax == segMaxRef, "segment " << sx1 << "," << sz1 << " " << sx2 << "," << sz2 << ": " << segMax << " vs " << segMaxRef);
+		}
+	}
+
+	std::mt19937 rng;
+	int width, height;
+	std::vector<float> layer;
+	std::vector<SEnemy> enemies;
+	CThreatPyramid pyramid;
+};
+
+TEST_CASE("ThreatPyramid/queries_after_moves")
+{
+	for (unsigned seed : {1, 2, 3}) {
+		SThreatLayer tl(seed, 130 + seed * 7, 66 + seed * 31);  // not power of 2, not square
+		tl.CheckQueries(200);
+		for (int round = 1; round < 20; ++round) {
+			for (int i = 0; i < round * 3; ++i) {
+				tl.Move();
+			}
+			tl.CheckQueries(100);
+		}
+	}
+}
+
+TEST_CASE("ThreatPyramid/queries_after_decay")
+{
+	SThreatLayer tl(4, 258, 130);
+	tl.CheckQueries(50);
+	for (int round = 0; round < 10; ++round) {
+		if (round % 3 == 2) {
+			tl.Kill();  // leaves residue that only decay clears
+		}
+		tl.Decay(round * 5.f + 0.05f);
+		tl.CheckQueries(100);
+	}
+}
+
+TEST_CASE("ThreatPyramid/mark_all_dirty")
+{
+	SThreatLayer tl(5, 97, 203);
+	for (float& v : tl.layer) {
+		v = THREAT_BASE + float(tl.rng() % 1000);
+	}
+	tl.pyramid.MarkAllDirty();
+	tl.CheckQueries(300);
+}
+
+TEST_CASE("ThreatPyramid/tiny_layer")
+{
+	SThreatLayer tl(6, 3, 3);
+	tl.CheckQueries(300);
+}
+
+} // namespace test
+
+} // namespace circuit
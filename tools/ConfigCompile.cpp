@@ -0,0 +1,167 @@
+/*
+ * ConfigCompile.cpp
+ *
+ *  circuit_config_compile: merges JSON config parts and writes binary config
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "setup/ConfigCompiler.h"
+#include "json/json.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <cstring>
+
+using namespace circuit;
+
+static bool ReadFile(const std::string& filename, std::string& outContent)
+{
+	std::ifstream ifs(filename, std::ios::binary);
+	if (!ifs) {
+		return false;
+	}
+	outContent.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static std::string BaseName(const std::string& filename)
+{
+	const std::size_t pos = filename.find_last_of("/\\");
+	return (pos == std::string::npos) ? filename : filename.substr(pos + 1);
+}
+
+/*
+ * Same steps as CSetupManager::ReadConfig: parse parts in order, merge into first
+ */
+static bool ParseSources(const std::vector<std::pair<std::string, std::string>>& sources, Json::Value& outRoot)
+{
+	std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+	bool isFirst = true;
+	for (const auto& src : sources) {
+		JSONCPP_STRING errs;
+		Json::Value json;
+		const std::string& str = src.second;
+		if (!reader->parse(str.c_str(), str.c_str() + str.size(), &json, &errs)) {
+			std::cerr << "Malformed config format! (" << src.first << ")\n" << errs << "\n";
+			return false;
+		}
+		if (isFirst) {
+			outRoot = json;
+			isFirst = false;
+		} else {
+			CConfigCompiler::Merge(outRoot, json, [](const std::string& key) {
+				std::cerr << "Config override: " << key << "\n";
+			});
+		}
+	}
+	return !isFirst;
+}
+
+/*
+ * Round-trip check: blob decodes into exactly the tree that JSON path produces
+ */
+static int Verify(const std::vector<std::pair<std::string, std::string>>& sources, const Json::Value& root,
+				  const CConfigCompiler::Blob& blob, uint64_t hash)
+{
+	using clock = std::chrono::steady_clock;
+	const int REPEAT = 20;
+
+	Json::Value decoded;
+	if (!CConfigCompiler::Decompile(blob, hash, decoded)) {
+		std::cerr << "FAIL: blob rejected\n";
+		return 1;
+	}
+	if (!(decoded == root)) {
+		std::cerr << "FAIL: decoded config differs from JSON\n";
+		return 1;
+	}
+	if (CConfigCompiler::Decompile(blob, hash + 1, decoded)) {
+		std::cerr << "FAIL: blob accepted with wrong hash\n";
+		return 1;
+	}
+
+	clock::time_point t0 = clock::now();
+	for (int i = 0; i < REPEAT; ++i) {
+		Json::Value tmp;
+		ParseSources(sources, tmp);
+	}
+	const double parseMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count() / REPEAT;
+	t0 = clock::now();
+	for (int i = 0; i < REPEAT; ++i) {
+		Json::Value tmp;
+		CConfigCompiler::Decompile(blob, hash, tmp);
+	}
+	const double decodeMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count() / REPEAT;
+
+	std::cout << "OK: round-trip matches, parse " << parseMs << " ms, decode " << decodeMs << " ms\n";
+	return 0;
+}
+
+static void Usage(const char* self)
+{
+	std::cout << "Usage: " << self << " [options] part.json [part.json ...]\n"
+			"  Parts are merged in given order, as in config_file option of AI.\n"
+			"  -o <file>   output binary config, default config.bin\n"
+			"  --verify    check round-trip against JSON and compare load time\n";
+}
+
+int main(int argc, char* argv[])
+{
+	std::string outPath = "config.bin";
+	bool isVerify = false;
+	std::vector<std::string> inPaths;
+
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		if ((strcmp(arg, "-o") == 0) && (i + 1 < argc)) {
+			outPath = argv[++i];
+		} else if (strcmp(arg, "--verify") == 0) {
+			isVerify = true;
+		} else if (arg[0] != '-') {
+			inPaths.push_back(arg);
+		} else {
+			Usage(argv[0]);
+			return (strcmp(arg, "--help") == 0) ? 0 : 1;
+		}
+	}
+	if (inPaths.empty()) {
+		Usage(argv[0]);
+		return 1;
+	}
+
+	// NOTE: Hash uses file names without directory, AI reads parts by name from config dir
+	std::vector<std::pair<std::string, std::string>> sources;
+	uint64_t hash = CConfigCompiler::Hash(nullptr, 0);
+	for (const std::string& path : inPaths) {
+		std::string content;
+		if (!ReadFile(path, content)) {
+			std::cerr << "No config file! (" << path << ")\n";
+			return 1;
+		}
+		const std::string name = BaseName(path);
+		hash = CConfigCompiler::HashSource(name, content, hash);
+		sources.push_back(std::make_pair(name, content));
+	}
+
+	Json::Value root;
+	if (!ParseSources(sources, root)) {
+		return 1;
+	}
+	CConfigCompiler::Blob blob;
+	CConfigCompiler::Compile(root, hash, blob);
+
+	std::ofstream ofs(outPath, std::ios::binary);
+	ofs.write(blob.data(), blob.size());
+	if (!ofs) {
+		std::cerr << "Can't write " << outPath << "\n";
+		return 1;
+	}
+	std::cout << "Wrote " << outPath << ": " << blob.size() << " bytes, hash " << std::hex << hash << std::dec << "\n";
+
+	return isVerify ? Verify(sources, root, blob, hash) : 0;
+}